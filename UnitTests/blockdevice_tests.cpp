@@ -0,0 +1,58 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "../pcodedump/blockdevice.hpp"
+
+    BOOST_AUTO_TEST_CASE(blockdevice_dos_order)
+    {
+        using pcodedump::InterleavedBlockDevice;
+        // Two tracks, with every byte of a sector set to the sector number plus 16 times the track.
+        std::vector<std::uint8_t> image(2 * InterleavedBlockDevice::TRACK_SIZE);
+        for (std::size_t offset = 0; offset != image.size(); ++offset) {
+            image[offset] = static_cast<std::uint8_t>(offset / InterleavedBlockDevice::SECTOR_SIZE);
+        }
+        auto device = pcodedump::BlockDevice::open({ image.data(), image.data() + image.size() }, "TEST.DO");
+        BOOST_TEST_REQUIRE(device->getBlockCount() == 16);
+        BOOST_TEST_CHECK(device->isDiskImage());
+
+        std::uint8_t const expected[8][2] = { { 0, 14 }, { 13, 12 }, { 11, 10 }, { 9, 8 }, { 7, 6 }, { 5, 4 }, { 3, 2 }, { 1, 15 } };
+        for (int block = 0; block != 16; ++block) {
+            auto data = device->block(block);
+            BOOST_TEST_CHECK(data.begin()[0] == expected[block % 8][0] + 16 * (block / 8));
+            BOOST_TEST_CHECK(data.begin()[256] == expected[block % 8][1] + 16 * (block / 8));
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(blockdevice_2img)
+    {
+        std::vector<std::uint8_t> image(64 + 4 * pcodedump::BLOCK_SIZE);
+        std::memcpy(image.data(), "2IMG", 4);
+        image[8] = 64;
+        image[12] = 1;
+        image[20] = 4;
+        image[24] = 64;
+        image[64 + pcodedump::BLOCK_SIZE] = 0xa5;
+
+        auto device = pcodedump::BlockDevice::open({ image.data(), image.data() + image.size() }, "TEST.2MG");
+        BOOST_TEST_REQUIRE(device->getBlockCount() == 4);
+        BOOST_TEST_CHECK(device->block(1).begin()[0] == 0xa5);
+        BOOST_TEST_CHECK(device->block(1).begin() == image.data() + 64 + pcodedump::BLOCK_SIZE);
+    }
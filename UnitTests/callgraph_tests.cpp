@@ -0,0 +1,116 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <sstream>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/callgraph.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+        using testcode::linkRecord;
+        using testcode::linkReference;
+        using testcode::operator+;
+
+        constexpr int LINKED = 0;
+        constexpr int UNITSEG = 3;
+        constexpr int PCODE_LITTLE = 2;
+        constexpr int EOF_MARK = 0;
+        constexpr int UNIT_REF = 1;
+
+        std::string graph(Bytes const & file, pcodedump::graph_format_t format) {
+            pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+            std::wostringstream os;
+            pcodedump::CallGraph{ pcodeFile }.write(os, L"TEST", format);
+            std::string result;
+            for (auto character : os.str()) {
+                result += static_cast<char>(character);
+            }
+            return result;
+        }
+
+        /* A program that calls its second procedure twice, a unit in the file by segment number
+           and again through a unit reference, and a segment that isn't in the file. */
+        Bytes program() {
+            auto code = testcode::segment(1, {
+                testcode::pcodeProcedure({ CIP, 2, CIP, 2, CXP, 5, 1, CXP, 0, 2, CXP, 9, 1, RNP, 0 }, 1, 1),
+                testcode::pcodeProcedure({ RNP, 0 }, 2, 2) });
+            auto unit = testcode::segment(5, { testcode::pcodeProcedure({ RNP, 0 }, 1, 1) });
+            return testcode::codeFile({
+                { "PROG", 1, LINKED, PCODE_LITTLE, code, linkReference("MYUNIT", UNIT_REF, { 8 }) + linkRecord("", EOF_MARK) },
+                { "MYUNIT", 5, UNITSEG, PCODE_LITTLE, unit } });
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(callgraph_json)
+    {
+        BOOST_TEST_CHECK(graph(program(), pcodedump::graph_format_t::json) ==
+            "{\"file\":\"TEST\",\"segments\":["
+            "{\"number\":1,\"name\":\"PROG\",\"procedures\":[1,2]},"
+            "{\"number\":5,\"name\":\"MYUNIT\",\"procedures\":[1,2]},"
+            "{\"number\":9,\"procedures\":[1]}],"
+            "\"calls\":["
+            "{\"caller\":[1,1],\"callee\":[1,2],\"sites\":2},"
+            "{\"caller\":[1,1],\"callee\":[5,1],\"sites\":1},"
+            "{\"caller\":[1,1],\"callee\":[5,2],\"sites\":1},"
+            "{\"caller\":[1,1],\"callee\":[9,1],\"sites\":1}],"
+            "\"segmentCalls\":[[2,2,1],[0,0,0],[0,0,0]]}\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(callgraph_dot)
+    {
+        BOOST_TEST_CHECK(graph(program(), pcodedump::graph_format_t::dot) ==
+            "digraph \"TEST\" {\n"
+            "\tsubgraph \"cluster_1\" {\n"
+            "\t\tlabel = \"Segment 1: PROG\";\n"
+            "\t\t\"1.1\";\n"
+            "\t\t\"1.2\";\n"
+            "\t}\n"
+            "\tsubgraph \"cluster_5\" {\n"
+            "\t\tlabel = \"Segment 5: MYUNIT\";\n"
+            "\t\t\"5.1\";\n"
+            "\t\t\"5.2\";\n"
+            "\t}\n"
+            "\tsubgraph \"cluster_9\" {\n"
+            "\t\tlabel = \"Segment 9\";\n"
+            "\t\t\"9.1\";\n"
+            "\t}\n"
+            "\t\"1.1\" -> \"1.2\" [label = \"2\"];\n"
+            "\t\"1.1\" -> \"5.1\";\n"
+            "\t\"1.1\" -> \"5.2\";\n"
+            "\t\"1.1\" -> \"9.1\";\n"
+            "}\n"
+            "digraph \"TEST segments\" {\n"
+            "\t\"1\" [label = \"PROG\"];\n"
+            "\t\"5\" [label = \"MYUNIT\"];\n"
+            "\t\"9\";\n"
+            "\t\"1\" -> \"5\" [label = \"2\"];\n"
+            "\t\"1\" -> \"9\" [label = \"1\"];\n"
+            "}\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(callgraph_version_iv_undecoded)
+    {
+        auto unit = testcode::segment(17, { testcode::pcodeProcedure({ RNP, 0 }, 1, 1) });
+        auto file = testcode::chainedCodeFile({ { { "NEWUNIT", 17, UNITSEG, PCODE_LITTLE, unit } } });
+        BOOST_TEST_CHECK(graph(file, pcodedump::graph_format_t::json) ==
+            "{\"file\":\"TEST\",\"segments\":[],\"calls\":[],\"segmentCalls\":[],\"undecoded\":[17]}\n");
+    }
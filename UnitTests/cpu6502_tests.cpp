@@ -0,0 +1,155 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include "testcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/segment.hpp"
+#include "../pcodedump/basecode.hpp"
+#include "../pcodedump/native6502.hpp"
+#include "../pcodedump/cpu6502.hpp"
+
+    namespace {
+        using testcode::Bytes;
+        using pcodedump::cpu_t;
+
+        constexpr int NATIVE_6502 = 7;
+
+        /* What running a native procedure counted, and the trace it wrote. */
+        struct Run {
+            std::uint64_t instructions;
+            std::uint64_t cycles;
+            std::string trace;
+        };
+
+        /* Run a native procedure that is the only one in a code file, loaded at $2000. */
+        Run run(cpu_t cpu, Bytes const & code, pcodedump::MemoryMap const & map = {}) {
+            auto file = testcode::codeFile({ { "NATIVE", 1, 0, NATIVE_6502, testcode::segment(1, { testcode::nativeProcedure(code) }) } });
+            pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+            auto segment = dynamic_cast<pcodedump::CodeSegment const *>(pcodeFile.getSegments().front().get());
+            auto & codePart = *segment->getCodePart();
+            auto procedure = dynamic_cast<pcodedump::Native6502Procedure const *>(codePart.getProcedures()->front().get());
+            std::wostringstream trace;
+            pcodedump::Cpu6502 emulator{ cpu, trace };
+            emulator.load(codePart, *procedure, map);
+            emulator.run();
+            std::string narrow;
+            for (auto c : trace.str()) {
+                narrow += static_cast<char>(c);
+            }
+            return { emulator.getInstructionCount(), emulator.getCycles(), narrow };
+        }
+    }
+
+    BOOST_AUTO_TEST_SUITE(cpu6502)
+
+    BOOST_AUTO_TEST_CASE(runs_to_return)
+    {
+        // LDA #$01; CLC; ADC #$02; STA $10; RTS
+        auto result = run(cpu_t::_6502, { 0xa9, 0x01, 0x18, 0x69, 0x02, 0x85, 0x10, 0x60 });
+        BOOST_TEST_CHECK(result.instructions == 5u);
+        BOOST_TEST_CHECK(result.cycles == 15u);
+        BOOST_TEST_CHECK(result.trace ==
+            "  2000  A9 01     LDA #$01        A=01 X=00 Y=00 S=FD nv-bdIzc  2        2\n"
+            "  2002  18        CLC             A=01 X=00 Y=00 S=FD nv-bdIzc  2        4\n"
+            "  2003  69 02     ADC #$02        A=03 X=00 Y=00 S=FD nv-bdIzc  2        6\n"
+            "  2005  85 10     STA $10         A=03 X=00 Y=00 S=FD nv-bdIzc  3        9\n"
+            "  2007  60        RTS             A=03 X=00 Y=00 S=FF nv-bdIzc  6       15\n"
+            "Instructions: 5\n"
+            "Cycles: 15\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(branch_cycles)
+    {
+        // LDX #$03; DEX; BNE -3; RTS; the branch is taken twice, in the same page.
+        auto result = run(cpu_t::_6502, { 0xa2, 0x03, 0xca, 0xd0, 0xfd, 0x60 });
+        BOOST_TEST_CHECK(result.instructions == 8u);
+        BOOST_TEST_CHECK(result.cycles == 2u + 3 * 2 + 2 * 3 + 2 + 6);
+    }
+
+    BOOST_AUTO_TEST_CASE(page_crossing_cycles)
+    {
+        // LDX #$01; LDA $00FF,X; LDA $0010,X; RTS; only the first load crosses a page.
+        auto result = run(cpu_t::_6502, { 0xa2, 0x01, 0xbd, 0xff, 0x00, 0xbd, 0x10, 0x00, 0x60 });
+        BOOST_TEST_CHECK(result.cycles == 2u + 5 + 4 + 6);
+    }
+
+    BOOST_AUTO_TEST_CASE(decimal_mode)
+    {
+        // SED; CLC; LDA #$09; ADC #$01; RTS; the 65c02 takes a cycle more for the decimal add.
+        Bytes code{ 0xf8, 0x18, 0xa9, 0x09, 0x69, 0x01, 0x60 };
+        auto nmos = run(cpu_t::_6502, code);
+        auto cmos = run(cpu_t::_65c02, code);
+        BOOST_TEST_CHECK(nmos.trace.find("ADC #$01        A=10") != std::string::npos);
+        BOOST_TEST_CHECK(cmos.trace.find("ADC #$01        A=10") != std::string::npos);
+        BOOST_TEST_CHECK(nmos.cycles == 14u);
+        BOOST_TEST_CHECK(cmos.cycles == 15u);
+    }
+
+    BOOST_AUTO_TEST_CASE(stops_on_brk)
+    {
+        // LDA #$01; BRK; NOP; RTS
+        auto result = run(cpu_t::_6502, { 0xa9, 0x01, 0x00, 0xea, 0x60, 0xea });
+        BOOST_TEST_CHECK(result.instructions == 2u);
+        BOOST_TEST_CHECK(result.cycles == 9u);
+    }
+
+    BOOST_AUTO_TEST_CASE(stops_at_limit)
+    {
+        // CLV; BVC -2; a loop that never returns.
+        pcodedump::MemoryMap map;
+        map.limit = 10;
+        auto result = run(cpu_t::_6502, { 0xb8, 0x50, 0xfe, 0x60 }, map);
+        BOOST_TEST_CHECK(result.instructions == 10u);
+        BOOST_TEST_CHECK(result.cycles == 2u + 9 * 3);
+        BOOST_TEST_CHECK(result.trace.find("Stopped after 10 instructions\n") != std::string::npos);
+    }
+
+    BOOST_AUTO_TEST_CASE(undefined_opcode)
+    {
+        // $02 is undefined on the 6502.
+        BOOST_CHECK_EXCEPTION(run(cpu_t::_6502, { 0xa9, 0x01, 0x02, 0x60 }), std::runtime_error,
+            [](std::runtime_error const & e) { return std::string{ e.what() } == "6502 fault at $2002: undefined opcode"; });
+    }
+
+    BOOST_AUTO_TEST_CASE(no_65c816)
+    {
+        std::wostringstream trace;
+        BOOST_CHECK_THROW(pcodedump::Cpu6502(cpu_t::_65c816, trace), std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE(cycle_tables)
+    {
+        using pcodedump::cycleTable;
+        // LDA #, LDA abs,X and JMP (abs), which takes a cycle more on the 65c02.
+        BOOST_TEST_CHECK(cycleTable(cpu_t::_6502)[0xa9].base == 2);
+        BOOST_TEST_CHECK(!cycleTable(cpu_t::_6502)[0xa9].pageCross);
+        BOOST_TEST_CHECK(cycleTable(cpu_t::_6502)[0xbd].base == 4);
+        BOOST_TEST_CHECK(cycleTable(cpu_t::_6502)[0xbd].pageCross);
+        BOOST_TEST_CHECK(cycleTable(cpu_t::_6502)[0x6c].base == 5);
+        BOOST_TEST_CHECK(cycleTable(cpu_t::_65c02)[0x6c].base == 6);
+        // ASL abs,X only takes the extra cycle on the 65c02 when a page is crossed.
+        BOOST_TEST_CHECK(cycleTable(cpu_t::_6502)[0x1e].base == 7);
+        BOOST_TEST_CHECK(!cycleTable(cpu_t::_6502)[0x1e].pageCross);
+        BOOST_TEST_CHECK(cycleTable(cpu_t::_65c02)[0x1e].base == 6);
+        BOOST_TEST_CHECK(cycleTable(cpu_t::_65c02)[0x1e].pageCross);
+    }
+
+    BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,112 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/segment.hpp"
+#include "../pcodedump/dedup.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+        using testcode::linkRecord;
+        using testcode::linkReference;
+        using testcode::operator+;
+
+        constexpr int LINKED = 0;
+        constexpr int PCODE_LITTLE = 2;
+        constexpr int EOF_MARK = 0;
+        constexpr int GLOBAL_REF = 2;
+
+        /* A code file of one segment, with the procedures given and an optional set of link
+           records. */
+        Bytes codeFile(int number, std::vector<Bytes> const & procedures, Bytes const & linkage = {}) {
+            return testcode::codeFile({ { "DEDUP", number, LINKED, PCODE_LITTLE, testcode::segment(number, procedures),
+                linkage.empty() ? linkage : linkage + linkRecord("", EOF_MARK) } });
+        }
+
+        /* The code hashes of the only segment of a file, by procedure number. */
+        std::vector<std::uint64_t> hashes(Bytes const & file) {
+            pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+            auto segment = dynamic_cast<pcodedump::CodeSegment const *>(pcodeFile.getSegments().front().get());
+            std::vector<std::uint64_t> result;
+            for (auto & [procedure, hash] : segment->getCodeHashes()) {
+                result.push_back(hash);
+            }
+            return result;
+        }
+
+        std::uint64_t hash(Bytes const & file) {
+            auto result = hashes(file);
+            BOOST_TEST_REQUIRE(result.size() == 1u);
+            return result.front();
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(dedup_segment_relative_operands)
+    {
+        // The segment of an external call and of an external load, and the procedure number,
+        // depend on where the procedure is linked.
+        auto first = hash(codeFile(1, { testcode::pcodeProcedure({ CXP, 3, 1, LDE, 3, 4, RNP, 0 }, 1, 1) }));
+        auto second = hash(codeFile(2, { testcode::pcodeProcedure({ CXP, 7, 1, LDE, 9, 4, RNP, 0 }, 5, 1) }));
+        BOOST_TEST_CHECK(first == second);
+    }
+
+    BOOST_AUTO_TEST_CASE(dedup_relocated_operands)
+    {
+        // The operand of LDCI is a reference that the linker fills in.
+        auto linkage = linkReference("SHARED", GLOBAL_REF, { 1 });
+        auto first = hash(codeFile(1, { testcode::pcodeProcedure({ LDCI, 0x34, 0x12, RNP, 0 }, 1, 1) }, linkage));
+        auto second = hash(codeFile(1, { testcode::pcodeProcedure({ LDCI, 0x78, 0x56, RNP, 0 }, 1, 1) }, linkage));
+        BOOST_TEST_CHECK(first == second);
+    }
+
+    BOOST_AUTO_TEST_CASE(dedup_different_code)
+    {
+        auto constant = hash(codeFile(1, { testcode::pcodeProcedure({ LDCI, 0x34, 0x12, RNP, 0 }, 1, 1) }));
+        auto other = hash(codeFile(1, { testcode::pcodeProcedure({ LDCI, 0x78, 0x56, RNP, 0 }, 1, 1) }));
+        auto call = hash(codeFile(1, { testcode::pcodeProcedure({ CXP, 3, 2, LDE, 3, 4, RNP, 0 }, 1, 1) }));
+        auto load = hash(codeFile(1, { testcode::pcodeProcedure({ CXP, 3, 1, LDE, 3, 5, RNP, 0 }, 1, 1) }));
+        BOOST_TEST_CHECK(constant != other);
+        BOOST_TEST_CHECK(call != load);
+    }
+
+    BOOST_AUTO_TEST_CASE(dedup_first_copy_in_input_order)
+    {
+        auto code = testcode::pcodeProcedure({ CXP, 3, 1, RNP, 0 }, 1, 1);
+        auto first = codeFile(1, { code });
+        auto second = codeFile(2, { testcode::pcodeProcedure({ 0, RNP, 0 }, 1, 1), code });
+        pcodedump::DuplicateIndex corpus;
+        for (auto & [source, file] : std::vector<std::pair<std::wstring, Bytes>>{ { L"SECOND", second }, { L"FIRST", first } }) {
+            pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+            pcodedump::DuplicateIndex index;
+            index.add(source, pcodeFile);
+            corpus.add(index);
+        }
+        auto copies = corpus.firstCopies();
+        BOOST_TEST_REQUIRE(copies.size() == 2u);
+        auto copy = copies.find({ hash(first), code.size() });
+        BOOST_TEST_REQUIRE((copy != copies.end()));
+        BOOST_CHECK(copy->second.source == L"SECOND");
+        BOOST_TEST_CHECK(copy->second.segment == 2);
+        BOOST_TEST_CHECK(copy->second.procedure == 2);
+    }
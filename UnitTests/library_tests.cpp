@@ -0,0 +1,108 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <sstream>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/library.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+
+        constexpr int LINKED = 0;
+        constexpr int UNITSEG = 3;
+        constexpr int LINKED_INTRINS = 6;
+        constexpr int PCODE_LITTLE = 2;
+
+        Bytes unit(int number) {
+            return testcode::segment(number, { testcode::pcodeProcedure({ RNP, 0 }, 1, 1) });
+        }
+
+        /* A library of two intrinsic units and one still to be linked, and another library with
+           units of the same numbers and names. */
+        pcodedump::LibraryIndex libraries(std::vector<Bytes> & files) {
+            files.push_back(testcode::codeFile({ { "PASCALIO", 5, LINKED_INTRINS, PCODE_LITTLE, unit(5) },
+                { "TURTLE  ", 6, LINKED_INTRINS, PCODE_LITTLE, unit(6) }, { "HELPERS", 7, UNITSEG, PCODE_LITTLE, unit(7) } }));
+            files.push_back(testcode::codeFile({ { "OTHERIO", 5, LINKED_INTRINS, PCODE_LITTLE, unit(5) },
+                { "HELPERS", 8, UNITSEG, PCODE_LITTLE, unit(8) } }));
+            pcodedump::LibraryIndex index;
+            index.add(L"SYSTEM.LIBRARY", pcodedump::PcodeFile{ { files[0].data(), files[0].data() + files[0].size() } });
+            index.add(L"OTHER.LIBRARY", pcodedump::PcodeFile{ { files[1].data(), files[1].data() + files[1].size() } });
+            return index;
+        }
+
+        std::string narrow(std::wstring const & text) {
+            std::string result;
+            for (auto character : text) {
+                result += static_cast<char>(character);
+            }
+            return result;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(library_find)
+    {
+        std::vector<Bytes> files;
+        auto index = libraries(files);
+        auto found = index.findSegment(5);
+        BOOST_TEST_REQUIRE(found);
+        BOOST_CHECK(found->name == L"PASCALIO");
+        BOOST_CHECK(found->library == L"SYSTEM.LIBRARY");
+        BOOST_CHECK(index.findSegment(6)->name == L"TURTLE");
+        BOOST_CHECK(index.findSegment(8)->library == L"OTHER.LIBRARY");
+        BOOST_TEST_CHECK(!index.findSegment(9));
+        auto helpers = index.findUnit(L"HELPERS ");
+        BOOST_TEST_REQUIRE(helpers);
+        BOOST_TEST_CHECK(helpers->segmentNumber == 7);
+        BOOST_TEST_CHECK(!index.findUnit(L"MISSING"));
+    }
+
+    BOOST_AUTO_TEST_CASE(library_write)
+    {
+        std::vector<Bytes> files;
+        auto index = libraries(files);
+        auto file = testcode::codeFile({ { "PROG", 1, LINKED, PCODE_LITTLE, unit(1) }, { "HELPERS", 7, UNITSEG, PCODE_LITTLE, unit(7) },
+            { "GONE", 10, UNITSEG, PCODE_LITTLE, unit(10) } });
+        // The intrinsic unit flags, after the dictionary entries and the segment information.
+        testcode::putWord(file, 288, 1 << 5 | 1 << 9);
+        std::wostringstream os;
+        index.write(os, pcodedump::PcodeFile{ { file.data(), file.data() + file.size() } });
+        BOOST_TEST_CHECK(narrow(os.str()) ==
+            "Library units:\n"
+            "  Intrinsic segment 5 : PASCALIO (LINKED-INTRINS) segment 5 in SYSTEM.LIBRARY\n"
+            "  Intrinsic segment 9 : not found\n"
+            "  Segment 7 HELPERS (UNITSEG) : HELPERS (UNITSEG) segment 7 in SYSTEM.LIBRARY\n"
+            "  Segment 10 GONE (UNITSEG) : not found\n"
+            "\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(library_write_version_iv)
+    {
+        std::vector<Bytes> files;
+        auto index = libraries(files);
+        auto file = testcode::chainedCodeFile({ { { "PROG", 1, LINKED, PCODE_LITTLE, unit(1) } } });
+        std::wostringstream os;
+        index.write(os, pcodedump::PcodeFile{ { file.data(), file.data() + file.size() } });
+        BOOST_TEST_CHECK(narrow(os.str()) ==
+            "Library units:\n"
+            "  Intrinsic segments : not recorded in a Version IV code file\n"
+            "\n");
+    }
@@ -0,0 +1,95 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <sstream>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/linker.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+        using testcode::linkRecord;
+        using testcode::linkReference;
+        using testcode::operator+;
+
+        constexpr int LINKED = 0;
+        constexpr int UNITSEG = 3;
+        constexpr int SEPRTSEG = 4;
+        constexpr int PCODE_LITTLE = 2;
+
+        constexpr int EOF_MARK = 0;
+        constexpr int UNIT_REF = 1;
+        constexpr int GLOBAL_REF = 2;
+        constexpr int GLOBAL_DEF = 6;
+        constexpr int EXTERNAL_PROC = 9;
+        constexpr int SEPARATE_PROC = 11;
+
+        /* A code file of one segment, with the link records given. */
+        Bytes codeFile(std::string const & name, int number, int kind, Bytes const & linkage) {
+            auto code = testcode::segment(number, { testcode::pcodeProcedure({ RNP, 0 }, 1, 0) });
+            return testcode::codeFile({ { name, number, kind, PCODE_LITTLE, code, linkage + linkRecord("", EOF_MARK) } });
+        }
+
+        /* Add each file to a table of its own, and combine them, as the link check does. */
+        std::string check(std::vector<std::pair<std::wstring, Bytes>> const & files, int & problems) {
+            pcodedump::SymbolTable corpus;
+            for (auto & [source, file] : files) {
+                pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+                pcodedump::SymbolTable table;
+                table.add(source, pcodeFile);
+                corpus.add(table);
+            }
+            std::wostringstream os;
+            problems = corpus.write(os);
+            std::string result;
+            for (auto character : os.str()) {
+                result += static_cast<char>(character);
+            }
+            return result;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(linker_symbol_resolution)
+    {
+        // A host that uses a unit, a global of that unit, a routine defined twice, and a
+        // global that nothing defines.
+        auto host = codeFile("PROG", 1, LINKED, linkReference("MYUNIT", UNIT_REF, { 1 })
+            + linkReference("SHARED", GLOBAL_REF, { 1, 3 }) + linkRecord("ROUTINE", EXTERNAL_PROC, 1)
+            + linkReference("MISSING", GLOBAL_REF, { 1 }));
+        auto unit = codeFile("MYUNIT", 7, UNITSEG, linkRecord("SHARED", GLOBAL_DEF, 1));
+        auto routine = codeFile("ASMSEG", 1, SEPRTSEG, linkRecord("ROUTINE", SEPARATE_PROC, 1));
+        auto again = codeFile("DUPSEG", 2, SEPRTSEG, linkRecord("ROUTINE", SEPARATE_PROC, 1));
+        int problems = 0;
+        auto result = check({ { L"HOST", host }, { L"UNIT", unit }, { L"ASM", routine }, { L"DUP", again } }, problems);
+        BOOST_TEST_CHECK(problems == 2);
+        BOOST_TEST_CHECK(result ==
+            "Unresolved symbols:\n"
+            "  Global MISSING : referred to by HOST 1 (PROG)\n"
+            "Duplicate symbols:\n"
+            "  Routine ROUTINE : defined by ASM 1 (ASMSEG), DUP 2 (DUPSEG)\n"
+            "Resolved symbols:\n"
+            "  Unit MYUNIT : UNIT 7 (MYUNIT) for HOST 1 (PROG)\n"
+            "  Global SHARED : UNIT 7 (MYUNIT) for HOST 1 (PROG)\n"
+            "  Routine ROUTINE : ASM 1 (ASMSEG) for HOST 1 (PROG)\n"
+            "Symbols : 4, 1 unresolved, 1 duplicate\n");
+    }
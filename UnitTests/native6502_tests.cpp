@@ -0,0 +1,145 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "testcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/segment.hpp"
+#include "../pcodedump/basecode.hpp"
+#include "../pcodedump/native6502.hpp"
+
+    namespace {
+        using testcode::Bytes;
+
+        constexpr int NATIVE_6502 = 7;
+
+        /* Decoding follows the flow of control through 65c816 code, for the length of a test. */
+        struct Follow65c816 {
+            Follow65c816() {
+                pcodedump::Native6502Procedure::initialiseCpu(pcodedump::cpu_t::_65c816);
+                pcodedump::Native6502Procedure::followFlow = true;
+            }
+
+            ~Follow65c816() {
+                pcodedump::Native6502Procedure::initialiseCpu(pcodedump::cpu_t::_6502);
+                pcodedump::Native6502Procedure::followFlow = false;
+            }
+        };
+
+        /* Apply a function to a native procedure that is the only one in a code file. */
+        template <typename Function>
+        auto withProcedure(Bytes const & code, Function function) {
+            auto file = testcode::codeFile({ { "NATIVE", 1, 0, NATIVE_6502, testcode::segment(1, { testcode::nativeProcedure(code) }) } });
+            pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+            auto segment = dynamic_cast<pcodedump::CodeSegment const *>(pcodeFile.getSegments().front().get());
+            auto procedure = dynamic_cast<pcodedump::Native6502Procedure const *>(segment->getCodePart()->getProcedures()->front().get());
+            return function(*procedure);
+        }
+
+        /* The offsets of the instructions reached in a native procedure. */
+        std::vector<int> instructions(Bytes const & code) {
+            return withProcedure(code, [](auto & procedure) {
+                std::vector<int> result;
+                for (auto & instruction : procedure.getDecodedInstructions()) {
+                    result.push_back(instruction.offset);
+                }
+                return result;
+            });
+        }
+    }
+
+    BOOST_FIXTURE_TEST_SUITE(native65c816, Follow65c816)
+
+    BOOST_AUTO_TEST_CASE(widths_rep_sep)
+    {
+        // REP #$30; LDA #$1234; SEP #$20; LDA #$01; LDX #$5678; RTS
+        Bytes code{ 0xc2, 0x30, 0xa9, 0x34, 0x12, 0xe2, 0x20, 0xa9, 0x01, 0xa2, 0x78, 0x56, 0x60 };
+        BOOST_TEST_CHECK(instructions(code) == std::vector<int>({ 0, 2, 5, 7, 9, 12 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_CASE(widths_restored_by_plp)
+    {
+        // REP #$30; PHP; SEP #$30; LDX #$01; PLP; LDY #$5678; RTS
+        Bytes code{ 0xc2, 0x30, 0x08, 0xe2, 0x30, 0xa2, 0x01, 0x28, 0xa0, 0x78, 0x56, 0x60 };
+        BOOST_TEST_CHECK(instructions(code) == std::vector<int>({ 0, 2, 3, 5, 7, 8, 11 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_CASE(widths_unknown_after_plp)
+    {
+        // PLP; LDA #?; with nothing pushed, the width of the accumulator isn't known.
+        Bytes code{ 0x28, 0xa9, 0x01, 0x00, 0x60 };
+        BOOST_TEST_CHECK(instructions(code) == std::vector<int>({ 0 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_CASE(widths_after_xce)
+    {
+        // SEP #$30; XCE; LDA #$01; REP #$10; XCE; LDX #?
+        Bytes code{ 0xe2, 0x30, 0xfb, 0xa9, 0x01, 0xc2, 0x10, 0xfb, 0xa2, 0x01, 0x00, 0x60 };
+        BOOST_TEST_CHECK(instructions(code) == std::vector<int>({ 0, 2, 3, 5, 7 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_CASE(widths_merged_at_join)
+    {
+        // BCC +2; REP #$20; LDA #?; the paths meet with different widths.
+        Bytes code{ 0x90, 0x02, 0xc2, 0x20, 0xa9, 0x01, 0x00, 0x60 };
+        BOOST_TEST_CHECK(instructions(code) == std::vector<int>({ 0, 2 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_CASE(widths_agree_at_join)
+    {
+        // BCC +2; REP #$20; REP #$20; LDA #$1234; RTS
+        Bytes code{ 0x90, 0x02, 0xc2, 0x20, 0xc2, 0x20, 0xa9, 0x34, 0x12, 0x60 };
+        BOOST_TEST_CHECK(instructions(code) == std::vector<int>({ 0, 2, 4, 6, 9 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_SUITE_END()
+
+    BOOST_AUTO_TEST_CASE(cycles_of_reached_instructions)
+    {
+        // BNE +1; .BYTE $FF; RTS; the undefined byte is never reached, so it isn't timed.
+        Bytes code{ 0xd0, 0x01, 0xff, 0x60 };
+        auto counts = withProcedure(code, [](auto & procedure) { return procedure.getCycleCounts(); });
+        BOOST_TEST_REQUIRE(counts.instructions.size() == 2u);
+        BOOST_TEST_CHECK(counts.instructions[0].offset == 0);
+        BOOST_TEST_CHECK(counts.instructions[1].offset == 3);
+        BOOST_TEST_CHECK(counts.blocks.size() == 2u);
+        BOOST_TEST_CHECK(counts.cycles == 8);
+        BOOST_TEST_CHECK(counts.penalty == 2);
+    }
+
+    BOOST_AUTO_TEST_CASE(cycles_of_blocks)
+    {
+        // LDA $1000,X; BEQ +1; NOP; RTS; the penalties of indexing and branching are kept apart.
+        Bytes code{ 0xbd, 0x00, 0x10, 0xf0, 0x01, 0xea, 0x60, 0xea };
+        auto counts = withProcedure(code, [](auto & procedure) { return procedure.getCycleCounts(); });
+        BOOST_TEST_REQUIRE(counts.instructions.size() == 4u);
+        BOOST_TEST_CHECK(counts.instructions[0].pageCross);
+        BOOST_TEST_CHECK(counts.instructions[1].branch);
+        BOOST_TEST_CHECK(counts.instructions[1].penalty() == 2);
+        BOOST_TEST_REQUIRE(counts.blocks.size() == 3u);
+        BOOST_TEST_CHECK(counts.blocks[0].first == 0u);
+        BOOST_TEST_CHECK(counts.blocks[0].last == 1u);
+        BOOST_TEST_CHECK(counts.blocks[0].cycles == 6);
+        BOOST_TEST_CHECK(counts.blocks[0].penalty == 3);
+        BOOST_TEST_CHECK(counts.blocks[1].cycles == 2);
+        BOOST_TEST_CHECK(counts.blocks[2].cycles == 6);
+        BOOST_TEST_CHECK(counts.cycles == 14);
+        BOOST_TEST_CHECK(counts.penalty == 3);
+    }
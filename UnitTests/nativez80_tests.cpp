@@ -0,0 +1,95 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "testcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/segment.hpp"
+#include "../pcodedump/basecode.hpp"
+#include "../pcodedump/native.hpp"
+
+    namespace {
+        using testcode::Bytes;
+
+        constexpr int NATIVE_8080 = 4;
+        constexpr int NATIVE_Z80 = 5;
+
+        /* A native procedure that is the only one in a code file, and the file it lives in. */
+        struct NativeCode {
+            NativeCode(Bytes const & code, int machineType) :
+                file{ testcode::codeFile({ { "NATIVE", 1, 0, machineType, testcode::segment(1, { testcode::nativeProcedure(code) }) } }) },
+                pcodeFile{ { file.data(), file.data() + file.size() } } {
+            }
+
+            pcodedump::NativeProcedure const & procedure() const {
+                auto segment = dynamic_cast<pcodedump::CodeSegment const *>(pcodeFile.getSegments().front().get());
+                return dynamic_cast<pcodedump::NativeProcedure const &>(*segment->getCodePart()->getProcedures()->front());
+            }
+
+            Bytes file;
+            pcodedump::PcodeFile pcodeFile;
+        };
+
+        std::vector<int> offsets(pcodedump::NativeProcedure const & procedure) {
+            std::vector<int> result;
+            for (auto & instruction : procedure.getDecodedInstructions()) {
+                result.push_back(instruction.offset);
+            }
+            return result;
+        }
+
+        std::string narrow(std::wstring const & text) {
+            return std::string(text.begin(), text.end());
+        }
+
+        std::string mnemonic(pcodedump::NativeProcedure const & procedure, std::size_t index) {
+            return narrow(procedure.getMnemonic(procedure.getDecodedInstructions().at(index)));
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(z80_prefixed_instructions)
+    {
+        // LD A,$05; LD A,(IX+$05); BIT 0,(IX+$03); LDIR; RET
+        NativeCode code{ { 0x3e, 0x05, 0xdd, 0x7e, 0x05, 0xdd, 0xcb, 0x03, 0x46, 0xed, 0xb0, 0xc9 }, NATIVE_Z80 };
+        auto & procedure = code.procedure();
+        BOOST_TEST_CHECK(offsets(procedure) == std::vector<int>({ 0, 2, 5, 9, 11 }), boost::test_tools::per_element());
+        auto instructions = procedure.getDecodedInstructions();
+        BOOST_TEST_CHECK(instructions[1].opcode == 0xdd7eu);
+        BOOST_TEST_CHECK(instructions[1].operandOffset == 2);
+        BOOST_TEST_CHECK(instructions[1].operandSize == 1);
+        BOOST_TEST_CHECK(instructions[2].opcode == 0xddcb46u);
+        BOOST_TEST_CHECK(instructions[2].operandSize == 1);
+        BOOST_TEST_CHECK(instructions[3].opcode == 0xedb0u);
+        BOOST_TEST_CHECK(mnemonic(procedure, 2) == "BIT");
+        BOOST_TEST_CHECK(mnemonic(procedure, 3) == "LDIR");
+        BOOST_TEST_CHECK(narrow(procedure.getProcessor()) == "Z80");
+    }
+
+    BOOST_AUTO_TEST_CASE(i8080_instructions)
+    {
+        // MVI A,$05; LXI H,$1234; MOV A,B; NOP; RET
+        NativeCode code{ { 0x3e, 0x05, 0x21, 0x34, 0x12, 0x78, 0x00, 0xc9 }, NATIVE_8080 };
+        auto & procedure = code.procedure();
+        BOOST_TEST_CHECK(offsets(procedure) == std::vector<int>({ 0, 2, 5, 6, 7 }), boost::test_tools::per_element());
+        BOOST_TEST_CHECK(mnemonic(procedure, 0) == "MVI");
+        BOOST_TEST_CHECK(mnemonic(procedure, 1) == "LXI");
+        BOOST_TEST_CHECK(procedure.getDecodedInstructions()[1].operandSize == 2);
+        BOOST_TEST_CHECK(narrow(procedure.getProcessor()) == "8080");
+    }
@@ -0,0 +1,51 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "../pcodedump/nufx.hpp"
+
+    namespace {
+        std::string const expected = "TOBEORNOTTOBEORTOBEORNOT";
+
+        std::string expand(pcodedump::ThreadFormat format, std::vector<std::uint8_t> const & data) {
+            auto result = pcodedump::expandThread(format, { data.data(), data.data() + data.size() }, expected.size());
+            return std::string(result.begin(), result.end());
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(nufx_lzw1)
+    {
+        std::vector<std::uint8_t> const data = {
+            0x00, 0x00, 0x00, 0xdb, 0x48, 0x00, 0x01, 0x54, 0x9e, 0x08, 0x29, 0xf2, 0x44, 0x8a, 0x93, 0x27,
+            0x54, 0x02, 0x0e, 0x2c, 0xa8, 0x90, 0xa0, 0x41, 0x84, 0xdb, 0x00, 0xfc, 0x8b, 0x38, 0x51, 0x22,
+            0xc5, 0x8b, 0x16, 0x33, 0x56, 0xdc, 0x88, 0x91, 0xa3, 0xc6, 0x88, 0xe7, 0x00,
+        };
+        BOOST_TEST_CHECK(expand(pcodedump::ThreadFormat::lzw1, data) == expected);
+    }
+
+    BOOST_AUTO_TEST_CASE(nufx_lzw2)
+    {
+        std::vector<std::uint8_t> const data = {
+            0x00, 0xdb, 0x48, 0x80, 0x2a, 0x00, 0x54, 0x9e, 0x08, 0x29, 0xf2, 0x44, 0x8a, 0x93, 0x27, 0x54,
+            0x02, 0x0e, 0x2c, 0xa8, 0x90, 0xa0, 0x41, 0x84, 0xdb, 0x00, 0xfc, 0x8b, 0x38, 0x51, 0x22, 0xc5,
+            0x8b, 0x16, 0x33, 0x56, 0xdc, 0x88, 0x91, 0xa3, 0xc6, 0x88, 0xe7, 0x00,
+        };
+        BOOST_TEST_CHECK(expand(pcodedump::ThreadFormat::lzw2, data) == expected);
+    }
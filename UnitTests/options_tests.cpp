@@ -0,0 +1,72 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <boost/program_options/errors.hpp>
+#include "../pcodedump/options.hpp"
+
+    namespace {
+        pcodedump::CodeLocation location(std::string const & text) {
+            std::istringstream in{ text };
+            pcodedump::CodeLocation result{};
+            in >> result;
+            return result;
+        }
+
+        bool parses(std::vector<char const *> arguments) {
+            arguments.insert(arguments.begin(), "pcodedump");
+            std::ostringstream discarded;
+            auto original = std::cout.rdbuf(discarded.rdbuf());
+            bool result = pcodedump::parseOptions(static_cast<int>(arguments.size()), const_cast<char **>(arguments.data()));
+            std::cout.rdbuf(original);
+            return result;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(options_code_location)
+    {
+        auto segmentOffset = location("3:1a");
+        BOOST_TEST_CHECK(segmentOffset.segment == 3);
+        BOOST_TEST_CHECK(!segmentOffset.procedure.has_value());
+        BOOST_TEST_CHECK(segmentOffset.offset == 0x1au);
+        auto procedureOffset = location("3.12:$0040");
+        BOOST_TEST_CHECK(procedureOffset.segment == 3);
+        BOOST_TEST_CHECK(procedureOffset.procedure.value_or(0) == 12);
+        BOOST_TEST_CHECK(procedureOffset.offset == 0x40u);
+        BOOST_TEST_CHECK(location("1:0x10").offset == 0x10u);
+    }
+
+    BOOST_AUTO_TEST_CASE(options_invalid_code_location)
+    {
+        for (auto text : { "3", "3:", "3:-1", "3:1g", "x:10", "3.x:10" }) {
+            BOOST_CHECK_THROW(location(text), boost::program_options::invalid_option_value);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(options_window)
+    {
+        BOOST_TEST_CHECK(parses({ "--locate", "1:0", "--window", "0", "FILE" }));
+        BOOST_TEST_CHECK(pcodedump::locateWindow == 0);
+        BOOST_TEST_CHECK(!parses({ "--locate", "1:0", "--window=-1", "FILE" }));
+        pcodedump::locateWindow = 4;
+        pcodedump::locate.reset();
+        pcodedump::filenames.clear();
+    }
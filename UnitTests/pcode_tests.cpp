@@ -16,11 +16,144 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include "testcode.hpp"
 #include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/segment.hpp"
+#include "../pcodedump/basecode.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+
+        constexpr int PCODE_BIG = 1;
+        constexpr int PCODE_LITTLE = 2;
+
+        std::vector<int> targets(pcodedump::PcodeFlowGraph const & flowGraph, pcodedump::PcodeInstruction const & instruction) {
+            auto range = flowGraph.targets(instruction);
+            return { range.begin(), range.end() };
+        }
+
+        Bytes littleEndianFile(std::vector<Bytes> const & procedures) {
+            return testcode::codeFile({ { "LITTLE", 1, 0, PCODE_LITTLE, testcode::segment(1, procedures) } });
+        }
+
+        /* The procedure that is listed first in the only segment of a file. */
+        pcodedump::PcodeProcedure const & firstProcedure(pcodedump::PcodeFile const & pcodeFile) {
+            auto segment = dynamic_cast<pcodedump::CodeSegment const *>(pcodeFile.getSegments().front().get());
+            auto pcodeProcedure = dynamic_cast<pcodedump::PcodeProcedure const *>(segment->getCodePart()->getProcedures()->front().get());
+            BOOST_TEST_REQUIRE(pcodeProcedure != nullptr);
+            return *pcodeProcedure;
+        }
+
+        std::vector<std::uint32_t> successors(pcodedump::BasicBlock const & block) {
+            return { block.successors.begin(), block.successors.end() };
+        }
+
+        /* The lex level in the last byte of the attribute table is read as an LDCI, which has
+           no room for its operand. */
+        Bytes truncatedProcedure() {
+            return testcode::pcodeProcedure({ 0 }, 1, LDCI);
+        }
+    }
 
 	BOOST_AUTO_TEST_CASE(convert_real) {
         std::uint8_t const testData[] = {
             0xf0, 0x40, 0x00, 0x00,
         };
         BOOST_TEST_CHECK(pcodedump::convertToReal(testData) == 7.5f);
-	}
\ No newline at end of file
+	}
+
+    BOOST_AUTO_TEST_CASE(big_endian_procedure)
+    {
+        // A constant, a case jump and a backward jump through the jump table, with words high
+        // byte first.
+        auto code = Bytes{ LDCI, 0x12, 0x34, 1, XJP, 0, 0x00, 0x00, 0x00, 0x01, UJP, 6, 0xff, 0xfc, 0xff, 0xfc, UJP, 0xf6, RNP, 0 };
+        auto procedure = testcode::pcodeProcedure(code, 1, 2, 6, true);
+        // The first entry of the jump table is a self relative pointer back to the SLDC.
+        testcode::putWord(procedure, code.size(), static_cast<int>(code.size()) - 3, true);
+        auto file = testcode::codeFile({ { "BIGSEG", 1, 0, PCODE_BIG, testcode::segment(1, { procedure }, true) } }, true);
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        BOOST_TEST_REQUIRE(pcodeFile.getSegments().size() == 1u);
+        auto segment = dynamic_cast<pcodedump::CodeSegment const *>(pcodeFile.getSegments().front().get());
+        BOOST_TEST_REQUIRE((segment && segment->getCodePart() && segment->getCodePart()->getProcedures()));
+        auto & procedures = *segment->getCodePart()->getProcedures();
+        BOOST_TEST_REQUIRE(procedures.size() == 1u);
+        auto pcodeProcedure = dynamic_cast<pcodedump::PcodeProcedure const *>(procedures.front().get());
+        BOOST_TEST_REQUIRE(pcodeProcedure != nullptr);
+        BOOST_TEST_CHECK(pcodeProcedure->getProcedureNumber() == 1);
+        BOOST_TEST_CHECK(pcodeProcedure->getLexicalLevel().value_or(-1) == 2);
+        BOOST_TEST_CHECK(pcodeProcedure->getDataSize() == 6);
+
+        auto & flowGraph = pcodeProcedure->getFlowGraph();
+        auto & instructions = flowGraph.getInstructions();
+        BOOST_TEST_REQUIRE(instructions.size() == 5u);
+        BOOST_TEST_CHECK(instructions[0].operand1 == 0x1234);
+        BOOST_TEST_CHECK(instructions[2].opcode == XJP);
+        BOOST_TEST_CHECK(instructions[2].operand1 == 0);
+        BOOST_TEST_CHECK(instructions[2].operand2 == 1);
+        BOOST_TEST_CHECK(targets(flowGraph, instructions[2]) == std::vector<int>({ 18, 16, 18 }), boost::test_tools::per_element());
+        BOOST_TEST_CHECK(instructions[3].offset == 16);
+        BOOST_TEST_CHECK(targets(flowGraph, instructions[3]) == std::vector<int>({ 3 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_CASE(flow_graph_jump_blocks)
+    {
+        // A conditional jump over two constants ends a block, and its target starts another.
+        auto file = littleEndianFile({ testcode::pcodeProcedure({ 1, FJP, 2, 2, 3, RNP, 0 }, 1, 0) });
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        auto & flowGraph = firstProcedure(pcodeFile).getFlowGraph();
+        BOOST_TEST_REQUIRE(flowGraph.getInstructions().size() == 5u);
+        BOOST_TEST_CHECK(targets(flowGraph, flowGraph.getInstructions()[1]) == std::vector<int>({ 5 }), boost::test_tools::per_element());
+        BOOST_TEST_CHECK(flowGraph.isTarget(5));
+        BOOST_TEST_CHECK(!flowGraph.isTarget(3));
+        auto & blocks = flowGraph.getBlocks();
+        BOOST_TEST_REQUIRE(blocks.size() == 3u);
+        BOOST_TEST_CHECK(blocks[0].firstInstruction == 0u);
+        BOOST_TEST_CHECK(blocks[1].firstInstruction == 2u);
+        BOOST_TEST_CHECK(blocks[2].firstInstruction == 4u);
+        BOOST_TEST_CHECK(successors(blocks[0]) == std::vector<std::uint32_t>({ 2, 1 }), boost::test_tools::per_element());
+        BOOST_TEST_CHECK(successors(blocks[1]) == std::vector<std::uint32_t>({ 2 }), boost::test_tools::per_element());
+        BOOST_TEST_CHECK(blocks[2].successors.empty());
+    }
+
+    BOOST_AUTO_TEST_CASE(flow_graph_case_table)
+    {
+        // Cases 0 and 1, with self relative pointers to offsets 12 and 13, and a default jump to 12.
+        auto file = littleEndianFile({ testcode::pcodeProcedure({ 0, XJP, 0, 0, 1, 0, UJP, 4, 0xfc, 0xff, 0xfd, 0xff, 1, RNP, 0 }, 1, 0) });
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        auto & flowGraph = firstProcedure(pcodeFile).getFlowGraph();
+        auto & instructions = flowGraph.getInstructions();
+        BOOST_TEST_REQUIRE(instructions.size() == 4u);
+        BOOST_TEST_CHECK(instructions[1].operand1 == 0);
+        BOOST_TEST_CHECK(instructions[1].operand2 == 1);
+        BOOST_TEST_CHECK(instructions[1].length == 11u);
+        BOOST_TEST_CHECK(targets(flowGraph, instructions[1]) == std::vector<int>({ 12, 12, 13 }), boost::test_tools::per_element());
+        auto & blocks = flowGraph.getBlocks();
+        BOOST_TEST_REQUIRE(blocks.size() == 3u);
+        BOOST_TEST_CHECK(successors(blocks[0]) == std::vector<std::uint32_t>({ 1, 2 }), boost::test_tools::per_element());
+        BOOST_TEST_CHECK(successors(blocks[1]) == std::vector<std::uint32_t>({ 2 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_CASE(flow_graph_truncated_procedure)
+    {
+        auto file = littleEndianFile({ truncatedProcedure() });
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        BOOST_CHECK_THROW(firstProcedure(pcodeFile).getFlowGraph(), std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE(listing_truncated_procedure)
+    {
+        // The procedure that can't be decoded is reported, and the next one is still listed.
+        auto file = littleEndianFile({ truncatedProcedure(), testcode::pcodeProcedure({ 7, RNP, 0 }, 2, 1) });
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        std::wostringstream listing;
+        pcodedump::CodeSegment::listProcs = pcodedump::CodePart::disasmProcs = true;
+        listing << pcodeFile;
+        pcodedump::CodeSegment::listProcs = pcodedump::CodePart::disasmProcs = false;
+        BOOST_CHECK(listing.str().find(L"Not decoded: Instruction extends past the end of the procedure") != std::wstring::npos);
+        BOOST_CHECK(listing.str().find(L"0001: RNP") != std::wstring::npos);
+    }
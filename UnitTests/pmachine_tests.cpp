@@ -0,0 +1,114 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/pmachine.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+        using testcode::word;
+        using testcode::operator+;
+
+        constexpr std::uint8_t CONSOLE = 1;
+
+        /* Run a procedure that is the only one in segment 1, and return what it writes. */
+        std::string run(Bytes const & code) {
+            auto file = testcode::codeFile({ { "TEST", 1, 0, 2, testcode::segment(1, { testcode::pcodeProcedure(code, 1, 0) }) } });
+            pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+            std::wostringstream console;
+            pcodedump::PMachine machine{ pcodeFile, console };
+            machine.run(1, 1);
+            std::string result;
+            for (auto character : console.str()) {
+                result += static_cast<char>(character);
+            }
+            return result;
+        }
+
+        /* A character is stored at 0x300 and written from there. */
+        Bytes const stackCharacter = Bytes{ LDCI } + word(0x300) + Bytes{ 0 };
+        Bytes const writeCharacter = Bytes{ STB, CONSOLE, LDCI } + word(0x300) + Bytes{ 1, 0, 0, CSP, 6 };
+
+        bool faultsWith(std::runtime_error const & ex, std::string const & reason) {
+            return std::string(ex.what()).find(reason) != std::string::npos;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(pmachine_packed_field)
+    {
+        // Store 0xA in bits 4-7 of the word at 0x200, and load it back as a letter.
+        auto code = Bytes{ LDCI } + word(0x200) + Bytes{ 4, 4, 10, STP }
+            + stackCharacter + Bytes{ LDCI } + word(0x200) + Bytes{ 4, 4, LDP, 55, ADI }
+            + writeCharacter + Bytes{ RNP, 0 };
+        BOOST_TEST_CHECK(run(code) == "A");
+    }
+
+    BOOST_AUTO_TEST_CASE(pmachine_packed_field_too_wide)
+    {
+        auto code = Bytes{ LDCI } + word(0x200) + Bytes{ 17, 0, LDP, RNP, 0 };
+        BOOST_CHECK_EXCEPTION(run(code), std::runtime_error, [](auto & ex) { return faultsWith(ex, "Packed field out of range"); });
+    }
+
+    BOOST_AUTO_TEST_CASE(pmachine_string_compare)
+    {
+        // Two copies of 'AB' at 0x200 and 0x210, compared for equality.
+        auto code = Bytes{ LSA, 2, 'A', 'B', LDCI } + word(0x200) + Bytes{ 3, CSP, 2 }
+            + Bytes{ LSA, 2, 'A', 'B', LDCI } + word(0x210) + Bytes{ 3, CSP, 2 }
+            + stackCharacter + Bytes{ LDCI } + word(0x200) + Bytes{ LDCI } + word(0x210) + Bytes{ EQU, 4, 48, ADI }
+            + writeCharacter + Bytes{ RNP, 0 };
+        BOOST_TEST_CHECK(run(code) == "1");
+    }
+
+    BOOST_AUTO_TEST_CASE(pmachine_string_compare_out_of_range)
+    {
+        // A string of 100 characters in the last byte of memory.
+        auto code = Bytes{ LDCI } + word(0xffff) + Bytes{ 0, 100, STB }
+            + Bytes{ LDCI } + word(0x200) + Bytes{ LDCI } + word(0xffff) + Bytes{ EQU, 4, RNP, 0 };
+        BOOST_CHECK_EXCEPTION(run(code), std::runtime_error, [](auto & ex) { return faultsWith(ex, "Memory access out of range"); });
+    }
+
+    BOOST_AUTO_TEST_CASE(pmachine_string_assign_out_of_range)
+    {
+        auto code = Bytes{ LDCI } + word(0xffff) + Bytes{ 0, 100, STB }
+            + Bytes{ LDCI } + word(0x200) + Bytes{ LDCI } + word(0xffff) + Bytes{ SAS, 255, RNP, 0 };
+        BOOST_CHECK_EXCEPTION(run(code), std::runtime_error, [](auto & ex) { return faultsWith(ex, "Memory access out of range"); });
+    }
+
+    BOOST_AUTO_TEST_CASE(pmachine_packed_array_no_elements)
+    {
+        auto code = Bytes{ 0, 0, IXP, 0, 1, RNP, 0 };
+        BOOST_CHECK_EXCEPTION(run(code), std::runtime_error, [](auto & ex) { return faultsWith(ex, "Packed array with no elements in a word"); });
+    }
+
+    BOOST_AUTO_TEST_CASE(pmachine_stack_underflow)
+    {
+        auto code = Bytes{ ADI, ADI, RNP, 0 };
+        BOOST_CHECK_EXCEPTION(run(code), std::runtime_error, [](auto & ex) { return faultsWith(ex, "Stack underflow"); });
+    }
+
+    BOOST_AUTO_TEST_CASE(pmachine_result_out_of_range)
+    {
+        auto code = Bytes{ RNP, 100 };
+        BOOST_CHECK_EXCEPTION(run(code), std::runtime_error, [](auto & ex) { return faultsWith(ex, "Function result out of range"); });
+    }
@@ -0,0 +1,104 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <sstream>
+#include <stdexcept>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/search.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+
+        constexpr int LINKED = 0;
+        constexpr int PCODE_LITTLE = 2;
+        constexpr int NATIVE_6502 = 7;
+
+        /* A segment of p-code calls with constant parameters, and a segment of 6502 code. */
+        Bytes program() {
+            auto pcode = testcode::segment(1, { testcode::pcodeProcedure(
+                { LDCI, 1, 0, CXP, 3, 1, LDCI, 2, 0, CXP, 3, 2, LDCI, 2, 0, CXP, 4, 2, RNP, 0 }, 1, 1) });
+            auto native = testcode::segment(2, { testcode::nativeProcedure({ 0xa9, 0x00, 0xa9, 0x01, 0xea, 0x60 }) });
+            return testcode::codeFile({ { "PROG", 1, LINKED, PCODE_LITTLE, pcode }, { "ASM", 2, LINKED, NATIVE_6502, native } });
+        }
+
+        std::string search(std::vector<std::pair<std::string, bool>> const & patterns) {
+            pcodedump::InstructionSearch searcher;
+            for (auto & [pattern, native] : patterns) {
+                searcher.addPattern(pattern, native);
+            }
+            searcher.compile();
+            auto file = program();
+            pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+            std::wostringstream os;
+            for (auto & match : searcher.find(pcodeFile)) {
+                searcher.write(os, L"PROG", match);
+            }
+            std::string result;
+            for (auto character : os.str()) {
+                result += static_cast<char>(character);
+            }
+            return result;
+        }
+
+        bool fails(std::string const & pattern, bool native = false) {
+            pcodedump::InstructionSearch searcher;
+            try {
+                searcher.addPattern(pattern, native);
+            } catch (std::runtime_error &) {
+                return true;
+            }
+            return false;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(search_patterns)
+    {
+        // Patterns that overlap and share instructions, with wildcard mnemonics and operands.
+        BOOST_TEST_CHECK(search({ { "LDCI 2; CXP 3 *", false }, { "CXP; LDCI; CXP", false }, { "* ; CXP 4", false }, { "ldci; cxp", false },
+            { "LDA #$01; NOP", true }, { "* 0; LDA", true } }) ==
+            "PROG 1.1:0000 ldci; cxp\n"
+            "PROG 1.1:0003 CXP; LDCI; CXP\n"
+            "PROG 1.1:0006 LDCI 2; CXP 3 *\n"
+            "PROG 1.1:0006 ldci; cxp\n"
+            "PROG 1.1:0009 CXP; LDCI; CXP\n"
+            "PROG 1.1:000c * ; CXP 4\n"
+            "PROG 1.1:000c ldci; cxp\n"
+            "PROG 2.1:0000 * 0; LDA\n"
+            "PROG 2.1:0002 LDA #$01; NOP\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(search_no_match)
+    {
+        BOOST_TEST_CHECK(search({ { "CXP 5", false }, { "LDCI; LDCI", false }, { "RTS; LDA", true } }) == "");
+    }
+
+    BOOST_AUTO_TEST_CASE(search_invalid_patterns)
+    {
+        BOOST_TEST_CHECK(fails("LDX"));
+        BOOST_TEST_CHECK(!fails("LDX", true));
+        BOOST_TEST_CHECK(fails("CXP 1 2 3"));
+        BOOST_TEST_CHECK(fails("*; * 1"));
+        BOOST_TEST_CHECK(fails("LDCI x"));
+        BOOST_TEST_CHECK(fails("LDCI; ; RNP"));
+    }
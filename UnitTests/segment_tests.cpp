@@ -0,0 +1,190 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <sstream>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/segment.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+
+        constexpr int PCODE_BIG = 1;
+        constexpr int PCODE_LITTLE = 2;
+        constexpr int UNITSEG = 3;
+
+        testcode::Segment unit(std::string const & name, int number, int machineType = PCODE_LITTLE) {
+            return { name, number, UNITSEG, machineType, testcode::segment(number, { testcode::pcodeProcedure({ 0xad, 0x00 }, 1, 0) }) };
+        }
+
+        /* Three segments, in two dictionaries. */
+        Bytes chain(bool bigEndian) {
+            int machineType = bigEndian ? PCODE_BIG : PCODE_LITTLE;
+            return testcode::chainedCodeFile({ { unit("FIRST", 1, machineType), unit("SECOND", 2, machineType) }, { unit("THIRD", 17, machineType) } }, bigEndian);
+        }
+
+        std::vector<int> segmentNumbers(Bytes const & file) {
+            pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+            std::vector<int> result;
+            for (auto & segment : pcodeFile.getSegments()) {
+                result.push_back(segment->getSegmentNumber());
+            }
+            return result;
+        }
+
+        bool failsWith(std::runtime_error const & ex, std::string const & reason) {
+            return std::string(ex.what()).find(reason) != std::string::npos;
+        }
+
+        /* The second dictionary of a chain starts after the two segments of the first. */
+        constexpr std::size_t SECOND_DICTIONARY = 3 * testcode::BLOCK;
+
+        /* A segment of two procedures, the first of which is 23 bytes long. */
+        Bytes locateFile() {
+            auto code = testcode::segment(1, {
+                testcode::pcodeProcedure({ LDCI, 1, 0, LDCI, 2, 0, ADI, 3, ADI, RNP, 0 }, 1, 1),
+                testcode::pcodeProcedure({ RNP, 0 }, 2, 2) });
+            return testcode::codeFile({ { "LOCATE", 1, 0, PCODE_LITTLE, code } });
+        }
+
+        std::string around(pcodedump::CodeSegment const & segment, std::size_t offset, int window) {
+            std::wostringstream os;
+            if (!segment.disassembleAround(os, offset, window)) {
+                return "";
+            }
+            std::string result;
+            for (auto character : os.str()) {
+                result += static_cast<char>(character);
+            }
+            return result;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(segment_dictionary_big_endian)
+    {
+        auto file = testcode::codeFile({ { "BIGSEG", 5, UNITSEG, PCODE_BIG, testcode::segment(5, { testcode::pcodeProcedure({ 0xad, 0x00 }, 1, 0, 0, true) }, true) } }, true);
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        BOOST_TEST_REQUIRE(pcodeFile.getSegments().size() == 1u);
+        auto segment = dynamic_cast<pcodedump::CodeSegment const *>(pcodeFile.getSegments().front().get());
+        BOOST_TEST_REQUIRE(segment != nullptr);
+        BOOST_TEST_CHECK(segment->getSegmentNumber() == 5);
+        BOOST_CHECK(segment->getName() == L"BIGSEG  ");
+        BOOST_CHECK(segment->getSegmentKind() == pcodedump::SegmentKind::unitseg);
+        BOOST_CHECK(segment->getMachineType() == pcodedump::MachineType::pcode_big);
+        BOOST_TEST_CHECK(segment->getFirstBlock() == 1);
+    }
+
+    BOOST_AUTO_TEST_CASE(segment_dictionary_chain)
+    {
+        BOOST_TEST_CHECK(segmentNumbers(chain(false)) == std::vector<int>({ 1, 2, 17 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_CASE(segment_dictionary_chain_big_endian)
+    {
+        BOOST_TEST_CHECK(segmentNumbers(chain(true)) == std::vector<int>({ 1, 2, 17 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_CASE(segment_dictionary_chain_mixed_byte_orders)
+    {
+        auto file = chain(false);
+        testcode::putWord(file, SECOND_DICTIONARY + testcode::BLOCK - 2, 1, true);
+        BOOST_CHECK_EXCEPTION(segmentNumbers(file), std::runtime_error, [](auto & ex) { return failsWith(ex, "mixes byte orders"); });
+    }
+
+    BOOST_AUTO_TEST_CASE(segment_dictionary_chain_no_byte_order)
+    {
+        auto file = chain(false);
+        testcode::putWord(file, SECOND_DICTIONARY + testcode::BLOCK - 2, 0);
+        BOOST_CHECK_EXCEPTION(segmentNumbers(file), std::runtime_error, [](auto & ex) { return failsWith(ex, "has no byte order"); });
+    }
+
+    BOOST_AUTO_TEST_CASE(segment_dictionary_comment_not_byte_order)
+    {
+        // The last word of an Apple dictionary is the end of the comment, not a byte order.
+        auto file = testcode::codeFile({ unit("LITTLE", 1) });
+        testcode::putWord(file, testcode::BLOCK - 2, 1, true);
+        BOOST_TEST_CHECK(segmentNumbers(file) == std::vector<int>({ 1 }), boost::test_tools::per_element());
+    }
+
+    BOOST_AUTO_TEST_CASE(segment_dictionary_chain_read_lazily)
+    {
+        // A broken second dictionary isn't read until an entry past the first is needed.
+        auto file = chain(false);
+        testcode::putWord(file, SECOND_DICTIONARY + testcode::BLOCK - 2, 0);
+        pcodedump::SegmentDictionaryChain dictionaries{ { file.data(), file.data() + file.size() } };
+        BOOST_TEST_CHECK(dictionaries.nextStart(1, 100) == 2);
+        BOOST_TEST_CHECK(dictionaries.nextStart(2, 100) == 3);
+        BOOST_TEST_CHECK(dictionaries.contains(15));
+        BOOST_CHECK_EXCEPTION(dictionaries.contains(16), std::runtime_error, [](auto & ex) { return failsWith(ex, "has no byte order"); });
+    }
+
+    BOOST_AUTO_TEST_CASE(segment_dictionary_chain_next_start)
+    {
+        auto file = chain(false);
+        pcodedump::SegmentDictionaryChain dictionaries{ { file.data(), file.data() + file.size() } };
+        BOOST_TEST_CHECK(dictionaries.nextStart(3, 100) == 4);
+        BOOST_TEST_CHECK(dictionaries.nextStart(4, 100) == 100);
+        BOOST_TEST_CHECK(dictionaries.size() == 32);
+    }
+
+    BOOST_AUTO_TEST_CASE(segment_procedure_offset)
+    {
+        auto file = locateFile();
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        auto & segment = dynamic_cast<pcodedump::CodeSegment const &>(*pcodeFile.getSegments().front());
+        BOOST_TEST_CHECK(segment.procedureOffset(1, 3) == 3u);
+        BOOST_TEST_CHECK(segment.procedureOffset(2, 1) == 24u);
+        BOOST_CHECK_EXCEPTION(segment.procedureOffset(1, 23), std::runtime_error, [](auto & ex) { return failsWith(ex, "past the end of procedure 1"); });
+        BOOST_CHECK_EXCEPTION(segment.procedureOffset(3, 0), std::runtime_error, [](auto & ex) { return failsWith(ex, "No procedure 3"); });
+    }
+
+    BOOST_AUTO_TEST_CASE(segment_disassemble_around)
+    {
+        auto file = locateFile();
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        auto & segment = dynamic_cast<pcodedump::CodeSegment const &>(*pcodeFile.getSegments().front());
+        BOOST_TEST_CHECK(around(segment, 7, 1) ==
+            "Segment offset 0007 is procedure offset 0007, in the instruction at 0007\n"
+            "Proc #1    (0000:0016)  P-Code (LSB)   Lex level = 1   Parameters = 0   Variables = 0   \n"
+            "   0006: ADI\n"
+            "   0007: SDLC_3\n"
+            "   0008: ADI\n");
+        // An offset inside an instruction finds the instruction that holds it.
+        BOOST_TEST_CHECK(around(segment, 4, 0) ==
+            "Segment offset 0004 is procedure offset 0004, in the instruction at 0003\n"
+            "Proc #1    (0000:0016)  P-Code (LSB)   Lex level = 1   Parameters = 0   Variables = 0   \n"
+            "   0003: LDCI     2\n");
+        // A window past either end of the procedure stops there.
+        BOOST_TEST_CHECK(around(segment, 9, 10) ==
+            "Segment offset 0009 is procedure offset 0009, in the instruction at 0009\n"
+            "Proc #1    (0000:0016)  P-Code (LSB)   Lex level = 1   Parameters = 0   Variables = 0   \n"
+            "ENTER  :\n"
+            "   0000: LDCI     1\n"
+            "   0003: LDCI     2\n"
+            "   0006: ADI\n"
+            "   0007: SDLC_3\n"
+            "   0008: ADI\n"
+            "EXIT   :\n"
+            "   0009: RNP\n");
+        BOOST_TEST_CHECK(around(segment, 200, 1) == "");
+    }
@@ -0,0 +1,110 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <sstream>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/segment.hpp"
+#include "../pcodedump/basecode.hpp"
+#include "../pcodedump/similar.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+
+        constexpr int LINKED = 0;
+        constexpr int PCODE_LITTLE = 2;
+
+        /* Arithmetic on locals and globals, with the constants and the multiplying operator
+           given. */
+        Bytes arithmetic(int first, int second, std::uint8_t multiply, int number) {
+            return testcode::pcodeProcedure({ LDCI, static_cast<std::uint8_t>(first), 0, LDL, 1, ADI, STL, 2, LDL, 2,
+                LDCI, static_cast<std::uint8_t>(second), 0, multiply, SRO, 3, LDO, 3, 1, ADI, SRO, 4, RNP, 0 }, number, 1);
+        }
+
+        Bytes copying(int number) {
+            return testcode::pcodeProcedure({ LAO, 5, LAO, 6, MOV, 2, LAO, 7, 0, STO, RNP, 0 }, number, 1);
+        }
+
+        Bytes codeFile(int segment, std::vector<Bytes> const & procedures) {
+            return testcode::codeFile({ { "SIMILAR", segment, LINKED, PCODE_LITTLE, testcode::segment(segment, procedures) } });
+        }
+
+        /* Each file of the corpus is indexed on its own, and the indexes added together, as the
+           workers do. */
+        std::string matches(std::vector<std::pair<std::wstring, Bytes>> const & corpus, Bytes const & query) {
+            pcodedump::SimilarityIndex index;
+            for (auto & [source, file] : corpus) {
+                pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+                pcodedump::SimilarityIndex part;
+                part.add(source, pcodeFile);
+                index.add(part);
+            }
+            index.build();
+            pcodedump::PcodeFile queryFile{ { query.data(), query.data() + query.size() } };
+            std::wostringstream os;
+            index.writeMatches(os, L"QUERY", queryFile);
+            std::string result;
+            for (auto character : os.str()) {
+                result += static_cast<char>(character);
+            }
+            return result;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(similar_matches)
+    {
+        // Operands don't count, and a different operator leaves some trigrams the same.
+        auto first = codeFile(1, { arithmetic(1, 2, MPI, 1), copying(2) });
+        auto second = codeFile(3, { arithmetic(3, 4, MPI, 1), arithmetic(5, 6, DVI, 2) });
+        BOOST_TEST_CHECK(matches({ { L"FIRST", first }, { L"SECOND", second } }, codeFile(7, { arithmetic(7, 8, MPI, 1), copying(2) })) ==
+            "QUERY 7.1 (36 bytes)\n"
+            "  1.00 FIRST 1.1 (36 bytes)\n"
+            "  1.00 SECOND 3.1 (36 bytes)\n"
+            "  0.64 SECOND 3.2 (36 bytes)\n"
+            "QUERY 7.2 (24 bytes)\n"
+            "  1.00 FIRST 1.2 (24 bytes)\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(similar_match_count)
+    {
+        auto first = codeFile(1, { arithmetic(1, 2, MPI, 1), arithmetic(5, 6, DVI, 2) });
+        pcodedump::SimilarityIndex::matchCount = 1;
+        auto result = matches({ { L"FIRST", first } }, codeFile(7, { arithmetic(5, 6, DVI, 1) }));
+        pcodedump::SimilarityIndex::matchCount = 5;
+        BOOST_TEST_CHECK(result ==
+            "QUERY 7.1 (36 bytes)\n"
+            "  1.00 FIRST 1.2 (36 bytes)\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(similar_short_procedure)
+    {
+        // A procedure shorter than a trigram is one shingle, and still matches itself.
+        auto file = codeFile(1, { testcode::pcodeProcedure({ RNP, 0 }, 1, 1) });
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        auto segment = dynamic_cast<pcodedump::CodeSegment const *>(pcodeFile.getSegments().front().get());
+        auto signature = pcodedump::SimilarityIndex::fingerprint(*segment->getCodePart()->getProcedures()->front());
+        BOOST_TEST_REQUIRE(signature.has_value());
+        BOOST_TEST_CHECK(matches({ { L"FIRST", file } }, file) ==
+            "QUERY 1.1 (14 bytes)\n"
+            "  1.00 FIRST 1.1 (14 bytes)\n");
+    }
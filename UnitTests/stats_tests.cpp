@@ -0,0 +1,114 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <sstream>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/stats.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+
+        constexpr int LINKED = 0;
+        constexpr int PCODE_LITTLE = 2;
+        constexpr int NATIVE_6502 = 7;
+
+        /* A segment of two p-code procedures, and a segment of one 6502 procedure. */
+        Bytes program() {
+            auto pcode = testcode::segment(1, {
+                testcode::pcodeProcedure({ LDCI, 1, 0, LDCI, 2, 0, ADI, RNP, 0 }, 1, 1),
+                testcode::pcodeProcedure({ 1, RNP, 0 }, 2, 2) });
+            auto native = testcode::segment(2, { testcode::nativeProcedure({ 0xa9, 0x00, 0xa9, 0x01, 0xea, 0x60 }) });
+            return testcode::codeFile({ { "PROG", 1, LINKED, PCODE_LITTLE, pcode }, { "ASM", 2, LINKED, NATIVE_6502, native } });
+        }
+
+        /* Each file is counted on its own, and the counts added together, as the workers do. */
+        std::string statistics(int files) {
+            auto file = program();
+            pcodedump::CodeStatistics total;
+            for (int count = 0; count != files; ++count) {
+                pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+                pcodedump::CodeStatistics statistics;
+                statistics.add(pcodeFile);
+                total.add(statistics);
+            }
+            std::wostringstream os;
+            total.write(os);
+            std::string result;
+            for (auto character : os.str()) {
+                result += static_cast<char>(character);
+            }
+            return result;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(stats_counts)
+    {
+        // Counts most frequent first, n-grams within each procedure, and sizes in powers of two.
+        BOOST_TEST_CHECK(statistics(2) ==
+            "  Code files : 2\n"
+            "  Procedures : 4 p-code, 2 native\n"
+            "  P-code opcodes\n"
+            "    RNP                                    4\n"
+            "    LDCI                                   4\n"
+            "    SDLC_1                                 2\n"
+            "    ADI                                    2\n"
+            "  P-code operand formats\n"
+            "    implied                                4\n"
+            "    word                                   4\n"
+            "    procedure return                       4\n"
+            "  P-code bigrams\n"
+            "    ADI RNP                                2\n"
+            "    LDCI ADI                               2\n"
+            "    LDCI LDCI                              2\n"
+            "    SDLC_1 RNP                             2\n"
+            "  P-code trigrams\n"
+            "    LDCI ADI RNP                           2\n"
+            "    LDCI LDCI ADI                          2\n"
+            "  P-code procedure sizes\n"
+            "    8-15                                   2\n"
+            "    16-31                                  2\n"
+            "  6502 opcodes\n"
+            "    LDA immediate                          4\n"
+            "    RTS implied                            2\n"
+            "    NOP implied                            2\n"
+            "  6502 address modes\n"
+            "    implied                                4\n"
+            "    immediate                              4\n"
+            "  6502 bigrams\n"
+            "    LDA LDA                                2\n"
+            "    LDA NOP                                2\n"
+            "    NOP RTS                                2\n"
+            "  6502 trigrams\n"
+            "    LDA LDA NOP                            2\n"
+            "    LDA NOP RTS                            2\n"
+            "  Native procedure sizes\n"
+            "    16-31                                  2\n"
+            "\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(stats_empty)
+    {
+        BOOST_TEST_CHECK(statistics(0) ==
+            "  Code files : 0\n"
+            "  Procedures : 0 p-code, 0 native\n"
+            "\n");
+    }
@@ -0,0 +1,179 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _38868D8D_B264_4D52_B4F2_8CAD418E4BE4
+#define _38868D8D_B264_4D52_B4F2_8CAD418E4BE4
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+/* Small code files for tests, built a procedure at a time. */
+namespace testcode {
+
+    using Bytes = std::vector<std::uint8_t>;
+
+    inline void putWord(Bytes & data, std::size_t offset, int value, bool bigEndian = false) {
+        data[offset + (bigEndian ? 1 : 0)] = static_cast<std::uint8_t>(value);
+        data[offset + (bigEndian ? 0 : 1)] = static_cast<std::uint8_t>(value >> 8);
+    }
+
+    inline Bytes word(int value) {
+        return { static_cast<std::uint8_t>(value), static_cast<std::uint8_t>(value >> 8) };
+    }
+
+    inline Bytes operator+(Bytes left, Bytes const & right) {
+        left.insert(left.end(), right.begin(), right.end());
+        return left;
+    }
+
+    /* A p-code procedure that is entered at the start and exits at the last instruction, which
+       should be a two byte RNP or RBP. The attributes follow the code, with the first entry of
+       the jump table, which is left as 0. The procedure number and lexical level are the low and
+       high bytes of the last word. */
+    inline Bytes pcodeProcedure(Bytes code, int number, int lexLevel, int dataSize = 0, bool bigEndian = false) {
+        auto exit = code.size() - 2;
+        auto attributes = code.size();
+        code.resize(code.size() + 12);
+        putWord(code, attributes + 2, dataSize, bigEndian);
+        putWord(code, attributes + 4, 0, bigEndian);
+        putWord(code, attributes + 6, static_cast<int>(attributes + 6 - exit), bigEndian);
+        putWord(code, attributes + 8, static_cast<int>(attributes + 8), bigEndian);
+        putWord(code, attributes + 10, (number & 0xff) | (lexLevel & 0xff) << 8, bigEndian);
+        return code;
+    }
+
+    /* A native procedure with no relocations, entered at an offset into the code. */
+    inline Bytes nativeProcedure(Bytes code, int enter = 0) {
+        if (code.size() % 2) {
+            code.push_back(0);
+        }
+        code.resize(code.size() + 8);
+        auto attributes = code.size();
+        code.resize(code.size() + 4);
+        putWord(code, attributes, static_cast<int>(attributes) - enter);
+        return code;
+    }
+
+    /* The procedures of a segment, followed by the procedure dictionary. Its last word has the
+       segment number in the low byte and the number of procedures in the high byte. */
+    inline Bytes segment(int number, std::vector<Bytes> const & procedures, bool bigEndian = false) {
+        Bytes code;
+        std::vector<std::size_t> ends;
+        for (auto & procedure : procedures) {
+            code = code + procedure;
+            ends.push_back(code.size());
+        }
+        auto dictionary = code.size() + 2 * procedures.size();
+        code.resize(dictionary);
+        for (std::size_t index = 0; index != ends.size(); ++index) {
+            auto entry = dictionary - 2 - 2 * index;
+            putWord(code, entry, static_cast<int>(entry + 2 - ends[index]), bigEndian);
+        }
+        code.resize(code.size() + 2);
+        putWord(code, code.size() - 2, number | static_cast<int>(procedures.size()) << 8, bigEndian);
+        return code;
+    }
+
+    /* A link record with three words of fields: a definition, an external or separate routine,
+       or the one that ends the linkage. */
+    inline Bytes linkRecord(std::string const & name, int type, int first = 0, int second = 0) {
+        Bytes record(16);
+        auto padded = name + std::string(8, ' ');
+        std::copy(padded.begin(), padded.begin() + 8, record.begin());
+        putWord(record, 8, type);
+        putWord(record, 10, first);
+        putWord(record, 12, second);
+        return record;
+    }
+
+    /* A link record that lists the code that refers to it, with its references in groups of
+       eight. */
+    inline Bytes linkReference(std::string const & name, int type, std::vector<int> const & references) {
+        auto record = linkRecord(name, type, 0, static_cast<int>(references.size()));
+        auto first = record.size();
+        record.resize(first + 16 * ((references.size() + 7) / 8));
+        for (std::size_t index = 0; index != references.size(); ++index) {
+            putWord(record, first + 2 * index, references[index]);
+        }
+        return record;
+    }
+
+    struct Segment {
+        std::string name;
+        int number;
+        int kind;
+        int machineType;
+        Bytes code;
+        /* Link records, which start in the block after the code. */
+        Bytes linkage{};
+    };
+
+    constexpr std::size_t BLOCK = 512;
+
+    /* Add a segment to the end of a code file, with its entry in the slot of the dictionary
+       that starts at the given offset. */
+    inline void addSegment(Bytes & file, std::size_t dictionary, std::size_t slot, Segment const & segment, int version, bool bigEndian) {
+        putWord(file, dictionary + 4 * slot, static_cast<int>(file.size() / BLOCK), bigEndian);
+        putWord(file, dictionary + 4 * slot + 2, static_cast<int>(segment.code.size()), bigEndian);
+        auto name = segment.name + std::string(8, ' ');
+        std::copy(name.begin(), name.begin() + 8, file.begin() + dictionary + 64 + 8 * slot);
+        putWord(file, dictionary + 192 + 2 * slot, segment.kind, bigEndian);
+        putWord(file, dictionary + 256 + 2 * slot, segment.number | segment.machineType << 8 | version << 13, bigEndian);
+        file = file + segment.code;
+        file.resize((file.size() / BLOCK + 1) * BLOCK);
+        if (!segment.linkage.empty()) {
+            file = file + segment.linkage;
+            file.resize((file.size() + BLOCK - 1) / BLOCK * BLOCK);
+        }
+    }
+
+    /* A Version IV code file, with a dictionary for each list of segments, each chained to the
+       next. The segments are in the slots of a dictionary in the order they are listed, and the
+       last word of each dictionary records the byte order. */
+    inline Bytes chainedCodeFile(std::vector<std::vector<Segment>> const & dictionaries, bool bigEndian = false) {
+        Bytes file;
+        std::size_t previous = 0;
+        for (auto & segments : dictionaries) {
+            auto dictionary = file.size();
+            file.resize(dictionary + BLOCK);
+            if (dictionary) {
+                putWord(file, previous + 416, static_cast<int>(dictionary / BLOCK), bigEndian);
+            }
+            putWord(file, dictionary + BLOCK - 2, 1, bigEndian);
+            for (std::size_t slot = 0; slot != segments.size(); ++slot) {
+                addSegment(file, dictionary, slot, segments[slot], 4, bigEndian);
+            }
+            previous = dictionary;
+        }
+        return file;
+    }
+
+    /* A code file from before Version IV, with each segment in the dictionary slot of its
+       number. The words of a big-endian dictionary are the only sign of its byte order. */
+    inline Bytes codeFile(std::vector<Segment> const & segments, bool bigEndian = false) {
+        Bytes file(BLOCK);
+        for (auto & segment : segments) {
+            addSegment(file, 0, static_cast<std::size_t>(segment.number), segment, 2, bigEndian);
+        }
+        return file;
+    }
+
+}
+
+#endif // !_38868D8D_B264_4D52_B4F2_8CAD418E4BE4
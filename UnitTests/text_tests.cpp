@@ -0,0 +1,35 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "../pcodedump/text.hpp"
+
+    BOOST_AUTO_TEST_CASE(textfile_decode)
+    {
+        std::string const expected = "BEGIN\n  WRITELN\nEND.\n";
+        std::vector<std::uint8_t> data(pcodedump::TextFile::HEADER_SIZE + 2 * pcodedump::TextFile::PAGE_SIZE, 0);
+        std::string const page1 = "BEGIN\r\x10\x22WRITELN\r";
+        std::string const page2 = "END.\r";
+        std::copy(page1.begin(), page1.end(), data.begin() + pcodedump::TextFile::HEADER_SIZE);
+        std::copy(page2.begin(), page2.end(), data.begin() + pcodedump::TextFile::HEADER_SIZE + pcodedump::TextFile::PAGE_SIZE);
+
+        pcodedump::TextFile file{ { data.data(), data.data() + data.size() } };
+        BOOST_TEST_CHECK(file.decode() == expected);
+    }
@@ -0,0 +1,99 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <sstream>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/translate.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+        using testcode::word;
+        using testcode::operator+;
+
+        /* The program for a procedure that is the only one in segment 1. */
+        std::string translate(Bytes const & code) {
+            auto file = testcode::codeFile({ { "TEST", 1, 0, 2, testcode::segment(1, { testcode::pcodeProcedure(code, 1, 0) }) } });
+            pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+            std::wostringstream program;
+            pcodedump::PcodeTranslator{ pcodeFile }.write(program, L"TEST", 1, 1);
+            std::string result;
+            for (auto character : program.str()) {
+                result += static_cast<char>(character);
+            }
+            return result;
+        }
+
+        bool contains(std::string const & text, std::string const & part) {
+            return text.find(part) != std::string::npos;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(translate_packed_field)
+    {
+        auto program = translate(Bytes{ LDCI } + word(0x200) + Bytes{ 4, 4, LDP, LDCI } + word(0x200) + Bytes{ 4, 4, 10, STP, RNP, 0 });
+        BOOST_TEST_CHECK(contains(program, "s0 = m.loadField(s0, s1, s2, 1, 1, 5);"));
+        BOOST_TEST_CHECK(contains(program, "m.storeField(s1, s2, s3, s4, 1, 1, 12);"));
+        BOOST_TEST_CHECK(contains(program, "\"Packed field out of range\""));
+    }
+
+    BOOST_AUTO_TEST_CASE(translate_strings)
+    {
+        auto program = translate(Bytes{ LDCI } + word(0x200) + Bytes{ LDCI } + word(0x210) + Bytes{ EQU, 4 }
+            + Bytes{ LDCI } + word(0x200) + Bytes{ LDCI } + word(0x210) + Bytes{ SAS, 80, RNP, 0 });
+        BOOST_TEST_CHECK(contains(program, "s0 = m.compareStrings(s0, s1, 1, 1, 6) == 0;"));
+        BOOST_TEST_CHECK(contains(program, "m.assignString(s1, s2, 80, 1, 1, 14);"));
+        BOOST_TEST_CHECK(contains(program, "checkRange(left, memory[left] + 1, segment, procedure, offset);"));
+        BOOST_TEST_CHECK(contains(program, "checkRange(source, memory[source] + 1, segment, procedure, offset);"));
+    }
+
+    BOOST_AUTO_TEST_CASE(translate_packed_array_no_elements)
+    {
+        auto program = translate(Bytes{ 0, 0, IXP, 0, 1, RNP, 0 });
+        BOOST_TEST_CHECK(contains(program, "m.fault(\"Packed array with no elements in a word\", 1, 1, 2);"));
+        BOOST_TEST_CHECK(!contains(program, "index / 0"));
+    }
+
+    BOOST_AUTO_TEST_CASE(translate_result_checked)
+    {
+        auto program = translate(Bytes{ RNP, 1 });
+        BOOST_TEST_CHECK(contains(program, "m.leave(1, 1, 1, 0);"));
+        BOOST_TEST_CHECK(contains(program, "fault(\"Function result out of range\", segment, procedure, offset);"));
+    }
+
+    BOOST_AUTO_TEST_CASE(translate_sets_in_memory)
+    {
+        // Whether 5 is in [3..9], stored in local 1.
+        auto program = translate(Bytes{ 5, 3, 9, SRS, INN, STL, 1, RNP, 0 });
+        BOOST_TEST_CHECK(contains(program, "// Operand stack in memory: SRS at 0003"));
+        BOOST_TEST_CHECK(contains(program, "\ts0 = 5;\n\tm.push(s0);\n"));
+        BOOST_TEST_CHECK(contains(program, "\tm.makeSet(true, 1, 1, 3);\n\tm.inSet();\n\ts0 = m.pop();\n\tm.setWord(locals + 0, s0);\n"));
+        BOOST_TEST_CHECK(!contains(program, "Procedure wasn't translated"));
+    }
+
+    BOOST_AUTO_TEST_CASE(translate_exit)
+    {
+        // Exit from this procedure, which resumes at its exit code.
+        auto program = translate(Bytes{ 1, 1, CSP, 4, RNP, 0 });
+        BOOST_TEST_CHECK(contains(program, "\tm.standardProc(4, 1, 1, 2);\n"));
+        BOOST_TEST_CHECK(contains(program, "\tif (exiting) goto L0004;\n"));
+        BOOST_TEST_CHECK(contains(program, "\t} catch (Exit & exited) {\n\t\tif (exited.frame != frame) throw;\n"));
+    }
@@ -0,0 +1,113 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <sstream>
+#include "testcode.hpp"
+#include "../pcodedump/pcode.hpp"
+#include "../pcodedump/pcodefile.hpp"
+#include "../pcodedump/xref.hpp"
+
+    namespace {
+        using namespace pcodedump::op;
+        using testcode::Bytes;
+
+        constexpr int LINKED = 0;
+        constexpr int PCODE_LITTLE = 2;
+
+        /* Procedure 1 is nested in 2, which is nested in 3. Procedure 1 uses variables of both
+           of the procedures around it, and of a level outside the segment, as well as globals
+           and the variables of a data segment. */
+        Bytes program() {
+            auto code = testcode::segment(1, {
+                testcode::pcodeProcedure({ LOD, 1, 4, LOD, 2, 6, STR, 1, 5, LDA, 3, 2, LDO, 3, SLDO_1, SRO, 3, LAO, 7,
+                    LDE, 4, 2, STE, 4, 2, LAE, 4, 3, RNP, 0 }, 1, 3),
+                testcode::pcodeProcedure({ LDO, 3, RNP, 0 }, 2, 2),
+                testcode::pcodeProcedure({ RNP, 0 }, 3, 1) });
+            return testcode::codeFile({ { "PROG", 1, LINKED, PCODE_LITTLE, code } });
+        }
+
+        std::string listing(pcodedump::VariableXref const & xref) {
+            std::wostringstream os;
+            xref.write(os);
+            std::string result;
+            for (auto character : os.str()) {
+                result += static_cast<char>(character);
+            }
+            return result;
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(xref_listing)
+    {
+        auto file = program();
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        BOOST_TEST_CHECK(listing(pcodedump::VariableXref{ pcodeFile }) ==
+            "Variable cross-reference\n"
+            "  Global offset 1\n"
+            "      read    1.1:000e\n"
+            "  Global offset 3\n"
+            "      read    1.1:000c\n"
+            "      write   1.1:000f\n"
+            "      read    1.2:0000\n"
+            "  Global offset 7\n"
+            "      address 1.1:0011\n"
+            "  Intermediate 1.? offset 2\n"
+            "      address 1.1:0009\n"
+            "  Intermediate 1.2 offset 4\n"
+            "      read    1.1:0000\n"
+            "  Intermediate 1.2 offset 5\n"
+            "      write   1.1:0006\n"
+            "  Intermediate 1.3 offset 6\n"
+            "      read    1.1:0003\n"
+            "  External segment 4 offset 2\n"
+            "      read    1.1:0013\n"
+            "      write   1.1:0016\n"
+            "  External segment 4 offset 3\n"
+            "      address 1.1:0019\n"
+            "\n");
+    }
+
+    BOOST_AUTO_TEST_CASE(xref_users)
+    {
+        auto file = program();
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        pcodedump::VariableXref xref{ pcodeFile };
+        auto users = xref.users(pcodedump::VariableScope::global, 0, 0, 3);
+        BOOST_TEST_REQUIRE(users.end() - users.begin() == 3);
+        BOOST_TEST_CHECK(users.begin()[2].userProcedure == 2);
+        auto none = xref.users(pcodedump::VariableScope::global, 0, 0, 2);
+        BOOST_TEST_CHECK((none.begin() == none.end()));
+    }
+
+    BOOST_AUTO_TEST_CASE(xref_offset)
+    {
+        auto file = program();
+        pcodedump::PcodeFile pcodeFile{ { file.data(), file.data() + file.size() } };
+        pcodedump::VariableXref::offset = 2;
+        auto result = listing(pcodedump::VariableXref{ pcodeFile });
+        pcodedump::VariableXref::offset.reset();
+        BOOST_TEST_CHECK(result ==
+            "Variable cross-reference\n"
+            "  Intermediate 1.? offset 2\n"
+            "      address 1.1:0009\n"
+            "  External segment 4 offset 2\n"
+            "      read    1.1:0013\n"
+            "      write   1.1:0016\n"
+            "\n");
+    }
@@ -16,10 +16,12 @@
 
 #include "basecode.hpp"
 #include "pcode.hpp"
-#include "native6502.hpp"
+#include "native.hpp"
 #include "types.hpp"
 #include "segment.hpp"
 #include "linkage.hpp"
+#include "dedup.hpp"
+#include "textio.hpp"
 #include <iterator>
 #include <cstddef>
 
@@ -27,12 +29,18 @@
 #include <optional>
 #include <string>
 #include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+#include <boost/algorithm/string/trim.hpp>
 
 using namespace std;
 using namespace boost::endian;
 
 namespace pcodedump {
 
+	/* The last word of a segment is its number, in the low byte, and the number of procedures,
+	   in the high byte. Before it are self relative pointers to the end of each procedure. */
+	template <typename Endian>
 	class ProcedureDictionary final {
 	private:
 		ProcedureDictionary() = delete;
@@ -46,39 +54,56 @@ namespace pcodedump {
 
 		std::uint8_t const * operator[](int index) const;
 
-	public:
-		boost::endian::little_uint8_t const segmentNumber;
-		boost::endian::little_uint8_t const numProcedures;
+		int segmentNumber() const {
+			return word[Endian::low];
+		}
+
+		int numProcedures() const {
+			return word[Endian::high];
+		}
+
+	private:
+		std::uint8_t const word[2];
 	};
 
-	ProcedureDictionary const & ProcedureDictionary::place(std::uint8_t const * segStart, int segLength) {
+	template <typename Endian>
+	ProcedureDictionary<Endian> const & ProcedureDictionary<Endian>::place(std::uint8_t const * segStart, int segLength) {
 		return pcodedump::place<ProcedureDictionary>(segStart + segLength - sizeof(ProcedureDictionary));
 	}
 
-	std::uint8_t const * ProcedureDictionary::operator[](int index) const
+	template <typename Endian>
+	std::uint8_t const * ProcedureDictionary<Endian>::operator[](int index) const
 	{
-		return derefSelfPtr(reinterpret_cast<std::uint8_t const *>(this) - 2 - 2 * index) + sizeof(little_int16_t);
+		return derefSelfPtr<Endian>(reinterpret_cast<std::uint8_t const *>(this) - 2 - 2 * index) + sizeof(typename Endian::int16_t);
 	}
 
+	/* Segments of big-endian p-code have their words in the other order. */
 	CodePart::CodePart(CodeSegment & segment, std::uint8_t const * segBegin, int segLength) :
 		segment{ segment },
 		data{ segBegin, segBegin + segLength },
-		procDict{ ProcedureDictionary::place(segBegin, segLength) },
-		procedures{ extractProcedures() }, treeRoot{ extractTree() }
+		bigEndian{ segment.getMachineType() == MachineType::pcode_big },
+		numProcedures{ bigEndian ? ProcedureDictionary<BigEndian>::place(segBegin, segLength).numProcedures() : ProcedureDictionary<LittleEndian>::place(segBegin, segLength).numProcedures() },
+		procedures{ bigEndian ? extractProcedures<BigEndian>() : extractProcedures<LittleEndian>() }, treeRoot{ extractTree() }
 	{
 	}
 
+	/* Procedures are kept in address order, so the procedure that starts last at or before an
+	   address is the only one that can hold it. */
 	Procedure const * CodePart::findProcedure(std::uint8_t const * address) const {
-		auto result = find_if(cbegin(*procedures), cend(*procedures), [address](Procedures::value_type const & proc) {return proc->contains(address); });
-		if (result == cend(*procedures)) {
+		auto next = upper_bound(cbegin(*procedures), cend(*procedures), address, [](uint8_t const * value, Procedures::value_type const & proc) { return value < proc->getProcBegin(); });
+		if (next == cbegin(*procedures) || !(*(next - 1))->contains(address)) {
 			return nullptr;
 		} else {
-			return result->get();
+			return (next - 1)->get();
 		}
 	}
 
+	int CodePart::getSegmentNumber() const {
+		return segment.getSegmentNumber();
+	}
+
 	void CodePart::writeHeader(std::wostream& os) const {
-		os << L"    Procedures : " << procDict.numProcedures << endl;
+		os << L"    Procedures : " << numProcedures << endl;
 	}
 
 	bool procedureNumberOrder(shared_ptr<Procedure const> left, shared_ptr<Procedure const> right) {
@@ -104,26 +129,106 @@ namespace pcodedump {
 		return result;
 	}
 
+	/* The calls made by each procedure, by procedure number. There are none if the details of
+	   the segment aren't being decoded. */
+	map<int, CallList> CodePart::getCalls(LinkageInfo * linkageInfo) const {
+		map<int, CallList> result;
+		if (procedures) {
+			auto references = getCodeReferences(this->begin(), linkageInfo);
+			for (auto & procedure : *procedures) {
+				result[procedure->getProcedureNumber()] = procedure->getCalls(references);
+			}
+		}
+		return result;
+	}
+
+	/* FNV-1a, over the normalised code. */
+	uint64_t Procedure::getCodeHash(linkref_map_t const & linkage) const {
+		uint64_t result = 0xcbf29ce484222325;
+		for (auto byte : getNormalisedCode(linkage)) {
+			result = (result ^ byte) * 0x100000001b3;
+		}
+		return result;
+	}
+
+	/* The code hash of each procedure, by procedure number. */
+	map<int, uint64_t> CodePart::getCodeHashes(LinkageInfo * linkageInfo) const {
+		map<int, uint64_t> result;
+		if (procedures) {
+			auto references = getCodeReferences(this->begin(), linkageInfo);
+			for (auto & procedure : *procedures) {
+				result[procedure->getProcedureNumber()] = procedure->getCodeHash(references);
+			}
+		}
+		return result;
+	}
+
 	bool CodePart::disasmProcs = false;
 	bool CodePart::treeProcs = false;
 
+	/* A procedure that can't be decoded is reported, and the rest of the segment is still listed. */
 	void CodePart::disassemble(std::wostream& os, LinkageInfo * linkageInfo) const {
 		if (treeProcs && treeRoot) {
 			treeRoot->writeOut(os, L"");
 			os << endl;
 		}
 		if (!(treeProcs && treeRoot) || disasmProcs) {
+			auto references = getCodeReferences(this->begin(), linkageInfo);
 			for (auto & procedure : *procedures) {
 				procedure->writeHeader(os);
 				if (disasmProcs) {
-					auto references = getCodeReferences(this->begin(), linkageInfo);
-					procedure->disassemble(os, references);
+					try {
+						auto original = RenderedProcedures::elideCopies
+							? RenderedProcedures::original(procedure->getCodeHash(references), { RenderedProcedures::source, boost::trim_copy(segment.getName()), getSegmentNumber(), procedure->getProcedureNumber(), procedure->getSize() })
+							: nullopt;
+						if (original) {
+							os << L"Same as " << original->source << L" " << dec << original->segment << L"." << original->procedure << L" (" << original->segmentName << L")" << endl;
+						} else {
+							procedure->disassemble(os, references);
+						}
+					} catch (runtime_error & ex) {
+						os << L"Not decoded: " << ex.what() << endl;
+					}
 					os << endl;
 				}
 			}
 		}
 	}
 
+	/* Write the instructions either side of the one that holds an offset from the start of the
+	   segment. Return false if the offset isn't in a procedure. */
+	bool CodePart::disassembleAround(std::wostream& os, LinkageInfo * linkageInfo, std::size_t offset, int window) const {
+		auto procedure = procedures && offset < static_cast<size_t>(data.end() - data.begin()) ? findProcedure(begin() + offset) : nullptr;
+		if (!procedure) {
+			return false;
+		}
+		FmtSentry<wostream::char_type> sentry{ os };
+		auto starts = procedure->getInstructionStarts();
+		size_t procOffset = begin() + offset - procedure->getProcBegin();
+		auto instruction = procOffset;
+		while (instruction != 0 && !starts[instruction]) {
+			--instruction;
+		}
+		auto first = instruction;
+		for (int count = 0; count != window && first != 0; ++count) {
+			do {
+				--first;
+			} while (first != 0 && !starts[first]);
+		}
+		auto last = instruction;
+		for (int count = 0; count <= window && last != starts.size(); ++count) {
+			do {
+				++last;
+			} while (last != starts.size() && !starts[last]);
+		}
+		os << L"Segment offset " << hex << setfill(L'0') << right << setw(4) << offset;
+		os << L" is procedure offset " << setw(4) << procOffset << L", in the instruction at " << setw(4) << instruction << endl;
+		procedure->writeHeader(os);
+		auto references = getCodeReferences(this->begin(), linkageInfo);
+		procedure->disassembleRange(os, references, first, last);
+		return true;
+	}
+
 	ScopeNode::ScopeNode(std::shared_ptr<Procedure const> procedure) : procedure{ procedure }, children{ std::make_unique<ScopeNodes>() }
 	{
 	}
@@ -150,24 +255,28 @@ namespace pcodedump {
 	   The procedure pointers in the segment point to the end of each pointer.  In
 	   memory this works well for the P-machine, but for disassembling the procedures
 	   we need to begin at the start. Once the ranges are known, an object for each
-	   procedure will be constructed with the full information.*/
+	   procedure will be constructed with the full information. The procedure number is
+	   the low byte of the last word of a procedure, and is zero for native code.*/
+	template <typename Endian>
 	unique_ptr<CodePart::Procedures> CodePart::extractProcedures() {
 		if (!segment.detailEnabled()) {
 			return unique_ptr<CodePart::Procedures>();
 		} else {
+			auto & procDict = ProcedureDictionary<Endian>::place(begin(), static_cast<int>(end() - begin()));
 			map<uint8_t const *, int> procEnds;
-			for (int index = 0; index != procDict.numProcedures; ++index) {
+			for (int index = 0; index != procDict.numProcedures(); ++index) {
 				procEnds[procDict[index]] = index;
 			}
 
 			auto result = make_unique<Procedures>();
+			auto decode = nativeDecoder(segment.getMachineType());
 			auto currentStart = begin();
 			for (auto[end, procNumber] : procEnds) {
 				Range range(currentStart, end);
-				if (*(range.end() - 2)) {
-					result->push_back(make_shared<PcodeProcedure>(*this, procNumber + 1, range));
+				if (*(range.end() - 2 + Endian::low)) {
+					result->push_back(make_shared<PcodeProcedure>(*this, procNumber + 1, range, Endian{}));
 				} else {
-					result->push_back(make_shared<Native6502Procedure>(*this, procNumber + 1, range));
+					result->push_back(decode(*this, procNumber + 1, range));
 				}
 				currentStart = end;
 			}
@@ -18,9 +18,11 @@
 #define _0058CB76_8CFA_4C70_8961_2F643D0EF3FB
 
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 #include <map>
 #include <memory>
+#include <string>
 #include <optional>
 #include <tuple>
 #include <type_traits>
@@ -35,6 +37,16 @@ namespace pcodedump {
 
 	using linkref_map_t = std::map<std::uint8_t const *, std::shared_ptr<LinkRecord const>>;
 
+	/* A call to a procedure, found in the code of another procedure. The unit is named when
+	   the segment number is one to be set by the linker. */
+	struct ProcedureCall {
+		int segment;
+		int procedure;
+		std::wstring unit{};
+	};
+
+	using CallList = std::vector<ProcedureCall>;
+
 	class Procedure {
 	public:
 		Procedure(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> data) :
@@ -42,7 +54,22 @@ namespace pcodedump {
 		{}
 
 		virtual void writeHeader(std::wostream& os) const = 0;
-		virtual void disassemble(std::wostream& os, linkref_map_t & linkage) const = 0;
+		void disassemble(std::wostream& os, linkref_map_t & linkage) const {
+			disassembleRange(os, linkage, 0, getSize());
+		}
+
+		/* Disassemble the code from first up to last, as offsets from the start of the procedure. */
+		virtual void disassembleRange(std::wostream& os, linkref_map_t & linkage, std::size_t first, std::size_t last) const = 0;
+
+		/* A bit for each byte of the procedure, set where an instruction starts. Instructions
+		   are found by their lengths, without formatting them. */
+		virtual std::vector<bool> getInstructionStarts() const = 0;
+		virtual CallList getCalls(linkref_map_t const & linkage) const = 0;
+
+		/* The code of the procedure with the fields that are set by the linker or when it is
+		   loaded cleared, so that copies of a procedure in different code files are the same. */
+		virtual std::vector<std::uint8_t> getNormalisedCode(linkref_map_t const & linkage) const = 0;
+		std::uint64_t getCodeHash(linkref_map_t const & linkage) const;
 
 		virtual ~Procedure() = default;
 		
@@ -56,6 +83,10 @@ namespace pcodedump {
 			return data.begin();
 		}
 
+		std::size_t getSize() const {
+			return data.end() - data.begin();
+		}
+
 		bool contains(std::uint8_t const * address) const {
 			return data.begin() <= address && address < data.end();
 		}
@@ -63,7 +94,7 @@ namespace pcodedump {
 		template<typename AT, typename PT>
 		inline PT* align(PT* pointer) const {
 			size_t space = data.end() - reinterpret_cast<uint8_t const*>(pointer);
-			void* result = const_cast<std::remove_const<PT>::type*>(pointer);
+			void* result = const_cast<typename std::remove_const<PT>::type*>(pointer);
 			std::align(sizeof(AT), sizeof(AT), result, space);
 			return reinterpret_cast<PT*>(result);
 		}
@@ -89,6 +120,14 @@ namespace pcodedump {
 
 		void writeOut(std::wostream& os, std::wstring prefix) const;
 
+		Procedure const & getProcedure() const {
+			return *procedure;
+		}
+
+		ScopeNodes const & getChildren() const {
+			return *children;
+		}
+
 	private:
 		std::shared_ptr<Procedure const> procedure;
 		std::unique_ptr<ScopeNodes> children;
@@ -96,10 +135,11 @@ namespace pcodedump {
 
 
 	class CodeSegment;
-	class ProcedureDictionary;
 
 	class CodePart final {
 	public:
+		using Procedures = std::vector<std::shared_ptr<Procedure const>>;
+
 		CodePart() = delete;
 		CodePart(const CodePart &) = delete;
 		CodePart(const CodePart &&) = delete;
@@ -110,20 +150,39 @@ namespace pcodedump {
 			return data.begin();
 		}
 
+		uint8_t const * end() const {
+			return data.end();
+		}
+
 		void writeHeader(std::wostream& os) const;
 		void disassemble(std::wostream& os, LinkageInfo * linkageInfo) const;
+		bool disassembleAround(std::wostream& os, LinkageInfo * linkageInfo, std::size_t offset, int window) const;
 		Procedure const * findProcedure(std::uint8_t const * address) const;
+		int getSegmentNumber() const;
+		std::map<int, CallList> getCalls(LinkageInfo * linkageInfo) const;
+		std::map<int, std::uint64_t> getCodeHashes(LinkageInfo * linkageInfo) const;
 
+		/* Null if the details of the segment aren't being decoded. */
+		Procedures const * getProcedures() const {
+			return procedures.get();
+		}
+
+		/* The lexical nesting of the p-code procedures. Null if there are none or the
+		   details of the segment aren't being decoded. */
+		ScopeNode const * getTree() const {
+			return treeRoot.get();
+		}
 
 	private:
-		using Procedures = std::vector<std::shared_ptr<Procedure const>>;
+		template <typename Endian>
 		std::unique_ptr<Procedures> extractProcedures();
 		std::shared_ptr<ScopeNode> extractTree();
 
 	private:
 		CodeSegment & segment;
 		Range<std::uint8_t const> data;
-		ProcedureDictionary const & procDict;
+		bool const bigEndian;
+		int const numProcedures;
 		std::unique_ptr<Procedures const> procedures;
 		std::shared_ptr<ScopeNode> treeRoot;
 
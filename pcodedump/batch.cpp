@@ -0,0 +1,119 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "batch.hpp"
+#include "options.hpp"
+
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <optional>
+#include <algorithm>
+#include <exception>
+#include <system_error>
+
+using namespace std;
+
+namespace pcodedump {
+
+	namespace {
+
+		template <typename CharT>
+		basic_string<CharT> widen(string const & text) {
+			return basic_string<CharT>(text.begin(), text.end());
+		}
+
+		/* Run the action on a single file, converting any exception into a message in the output. */
+		template <typename CharT>
+		bool processFile(size_t index, string const & filename, indexed_file_action_t<CharT> & action, basic_ostream<CharT> & os) {
+			try {
+				action(index, filename, os);
+				return true;
+			} catch (system_error & ex) {
+				os << widen<CharT>(filename + ": " + ex.what() + ": " + ex.code().message()) << endl;
+			} catch (exception & ex) {
+				os << widen<CharT>(filename + ": " + ex.what()) << endl;
+			}
+			return false;
+		}
+	}
+
+	template <typename CharT>
+	int processFiles(vector<string> const & filenames, file_action_t<CharT> action, basic_ostream<CharT> & os) {
+		return processFiles<CharT>(filenames, indexed_file_action_t<CharT>{ [&action](size_t, string const & filename, basic_ostream<CharT> & fileOs) {
+			action(filename, fileOs);
+		} }, os);
+	}
+
+	template <typename CharT>
+	int processFiles(vector<string> const & filenames, indexed_file_action_t<CharT> action, basic_ostream<CharT> & os) {
+		unsigned int threads = static_cast<unsigned int>(min<size_t>(max(jobs, 1u), filenames.size()));
+		if (threads <= 1) {
+			int failures = 0;
+			for (size_t index = 0; index != filenames.size(); ++index) {
+				failures += processFile(index, filenames[index], action, os) ? 0 : 1;
+			}
+			return failures;
+		}
+
+		vector<optional<basic_string<CharT>>> results(filenames.size());
+		mutex lock;
+		condition_variable ready;
+		atomic<size_t> next{ 0 };
+		atomic<int> failures{ 0 };
+
+		auto worker = [&]() {
+			for (size_t index = next++; index < filenames.size(); index = next++) {
+				basic_ostringstream<CharT> buffer;
+				if (!processFile(index, filenames[index], action, buffer)) {
+					++failures;
+				}
+				{
+					lock_guard<mutex> guard{ lock };
+					results[index] = buffer.str();
+				}
+				ready.notify_one();
+			}
+		};
+
+		vector<thread> pool;
+		for (unsigned int count = 0; count != threads; ++count) {
+			pool.emplace_back(worker);
+		}
+		for (auto & result : results) {
+			basic_string<CharT> text;
+			{
+				unique_lock<mutex> guard{ lock };
+				ready.wait(guard, [&result]() { return result.has_value(); });
+				text.swap(*result);
+				result.reset();
+			}
+			os << text;
+		}
+		for (auto & thread : pool) {
+			thread.join();
+		}
+		return failures;
+	}
+
+	template int processFiles<char>(vector<string> const &, file_action_t<char>, ostream &);
+	template int processFiles<wchar_t>(vector<string> const &, file_action_t<wchar_t>, wostream &);
+	template int processFiles<char>(vector<string> const &, indexed_file_action_t<char>, ostream &);
+	template int processFiles<wchar_t>(vector<string> const &, indexed_file_action_t<wchar_t>, wostream &);
+
+}
@@ -0,0 +1,49 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _A103C340_7030_4C99_B604_C0D5F2EF845B
+#define _A103C340_7030_4C99_B604_C0D5F2EF845B
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+namespace pcodedump {
+
+	template <typename CharT>
+	using file_action_t = std::function<void(std::string const &, std::basic_ostream<CharT> &)>;
+
+	/* An action that is also given the position of the file in the batch, for actions that
+	   collect results by file. A file given twice has two positions. */
+	template <typename CharT>
+	using indexed_file_action_t = std::function<void(std::size_t, std::string const &, std::basic_ostream<CharT> &)>;
+
+	/* Apply an action to each file in a batch using a pool of worker threads. Each action writes
+	   to its own buffer, and the buffers are copied to the output stream in the original file
+	   order, so the output of a batch doesn't depend on the number of threads. An exception from
+	   an action is reported in that file's output and doesn't stop the batch. Returns the number
+	   of files that failed. */
+	template <typename CharT>
+	int processFiles(std::vector<std::string> const & filenames, file_action_t<CharT> action, std::basic_ostream<CharT> & os);
+
+	template <typename CharT>
+	int processFiles(std::vector<std::string> const & filenames, indexed_file_action_t<CharT> action, std::basic_ostream<CharT> & os);
+
+}
+
+#endif // !_A103C340_7030_4C99_B604_C0D5F2EF845B
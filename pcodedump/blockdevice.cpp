@@ -0,0 +1,184 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "blockdevice.hpp"
+#include "volume.hpp"
+
+#include <map>
+#include <cctype>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <boost/endian/arithmetic.hpp>
+
+using namespace std;
+using namespace boost::endian;
+
+namespace pcodedump {
+
+	namespace {
+
+		/* The two DOS 3.3 sectors that hold the first and second halves of each block of a track. */
+		constexpr uint8_t blockSectors[8][2] = {
+			{ 0, 14 }, { 13, 12 }, { 11, 10 }, { 9, 8 }, { 7, 6 }, { 5, 4 }, { 3, 2 }, { 1, 15 },
+		};
+
+		/* The 64 byte header at the start of a .2mg (2IMG) universal disk image. */
+		struct TwoImgHeader {
+			char magic[4];
+			char creator[4];
+			little_uint16_t headerSize;
+			little_uint16_t version;
+			little_uint32_t imageFormat;
+			little_uint32_t flags;
+			little_uint32_t prodosBlocks;
+			little_uint32_t dataOffset;
+			little_uint32_t dataLength;
+			little_uint32_t commentOffset;
+			little_uint32_t commentLength;
+			little_uint32_t creatorOffset;
+			little_uint32_t creatorLength;
+			char reserved[16];
+		};
+
+		enum class SectorOrder {
+			unknown,
+			dos,
+			prodos,
+		};
+
+		map<string, SectorOrder> imageExtensions = {
+			{ ".po",  SectorOrder::prodos },
+			{ ".do",  SectorOrder::dos },
+			{ ".dsk", SectorOrder::unknown },
+		};
+
+		int countBlocks(Range<uint8_t const> data) {
+			return static_cast<int>((data.end() - data.begin() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+		}
+
+		string lowerExtension(filesystem::path const & filename) {
+			auto extension = filename.extension().string();
+			transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+			return extension;
+		}
+
+		bool isTwoImg(Range<uint8_t const> data) {
+			return data.end() - data.begin() >= static_cast<ptrdiff_t>(sizeof(TwoImgHeader))
+				&& memcmp(data.begin(), "2IMG", 4) == 0;
+		}
+
+		/* The sector order of an image isn't recorded in a .dsk file. An image is DOS order unless
+		   an Apple Pascal directory is only found when it is read in ProDOS order. */
+		unique_ptr<BlockDevice> openDiskImage(Range<uint8_t const> data, SectorOrder order) {
+			if (order == SectorOrder::unknown) {
+				if (Volume::isVolume(LinearBlockDevice{ data })) {
+					order = SectorOrder::prodos;
+				} else if ((data.end() - data.begin()) % InterleavedBlockDevice::TRACK_SIZE != 0) {
+					order = SectorOrder::prodos;
+				} else {
+					order = SectorOrder::dos;
+				}
+			}
+			if (order == SectorOrder::dos) {
+				return make_unique<InterleavedBlockDevice>(data);
+			}
+			return make_unique<LinearBlockDevice>(data, L"ProDOS order", true);
+		}
+
+		unique_ptr<BlockDevice> openTwoImg(Range<uint8_t const> data) {
+			static_assert(sizeof(TwoImgHeader) == 64, "2IMG header is 64 bytes");
+			auto & header = place<TwoImgHeader>(data.begin());
+			auto fileSize = static_cast<size_t>(data.end() - data.begin());
+			size_t length = header.dataLength;
+			if (length == 0 && header.imageFormat == 1) {
+				length = static_cast<size_t>(header.prodosBlocks) * BLOCK_SIZE;
+			}
+			if (header.dataOffset > fileSize || length > fileSize - header.dataOffset) {
+				throw runtime_error("2IMG image data extends past the end of the file");
+			}
+			Range<uint8_t const> image{ data.begin() + header.dataOffset, data.begin() + header.dataOffset + length };
+			switch (header.imageFormat) {
+			case 0:
+				return make_unique<InterleavedBlockDevice>(image, L"2IMG, DOS 3.3 order");
+			case 1:
+				return make_unique<LinearBlockDevice>(image, L"2IMG, ProDOS order", true);
+			default:
+				throw runtime_error("Unsupported 2IMG image format: " + to_string(header.imageFormat));
+			}
+		}
+	}
+
+	BlockDevice::BlockDevice(int blockCount, wstring format, bool diskImage) :
+		blockCount{ blockCount }, format{ format }, diskImage{ diskImage }
+	{
+	}
+
+	void BlockDevice::checkRange(int first, int count) const {
+		if (first < 0 || count < 0 || first > blockCount || count > blockCount - first) {
+			throw runtime_error("Blocks " + to_string(first) + " to " + to_string(first + count - 1) + " are past the end of the device");
+		}
+	}
+
+	/* Select the block device for an input file. 2IMG images are recognised by their header and
+	   other disk images by their extension. Anything else is read as a plain file. */
+	unique_ptr<BlockDevice> BlockDevice::open(Range<uint8_t const> data, filesystem::path const & filename) {
+		if (isTwoImg(data)) {
+			return openTwoImg(data);
+		}
+		auto extension = imageExtensions.find(lowerExtension(filename));
+		if (extension != imageExtensions.end()) {
+			return openDiskImage(data, extension->second);
+		}
+		return make_unique<LinearBlockDevice>(data);
+	}
+
+	LinearBlockDevice::LinearBlockDevice(Range<uint8_t const> data, wstring format, bool diskImage) :
+		BlockDevice{ countBlocks(data), format, diskImage }, data{ data }
+	{
+	}
+
+	Range<uint8_t const> LinearBlockDevice::blocks(int first, int count) const {
+		checkRange(first, count);
+		auto begin = data.begin() + static_cast<ptrdiff_t>(first) * BLOCK_SIZE;
+		auto end = min(begin + static_cast<ptrdiff_t>(count) * BLOCK_SIZE, data.end());
+		return Range<uint8_t const>{ begin, end };
+	}
+
+	InterleavedBlockDevice::InterleavedBlockDevice(Range<uint8_t const> data, wstring format) :
+		BlockDevice{ countBlocks(data), format, true }, translated(data.end() - data.begin())
+	{
+		if (translated.size() % TRACK_SIZE != 0) {
+			throw runtime_error("DOS order image is not a whole number of tracks");
+		}
+		auto target = translated.data();
+		for (auto track = data.begin(); track != data.end(); track += TRACK_SIZE) {
+			for (auto & sectors : blockSectors) {
+				for (auto sector : sectors) {
+					target = copy_n(track + sector * SECTOR_SIZE, SECTOR_SIZE, target);
+				}
+			}
+		}
+	}
+
+	Range<uint8_t const> InterleavedBlockDevice::blocks(int first, int count) const {
+		checkRange(first, count);
+		auto begin = translated.data() + static_cast<ptrdiff_t>(first) * BLOCK_SIZE;
+		return Range<uint8_t const>{ begin, begin + static_cast<ptrdiff_t>(count) * BLOCK_SIZE };
+	}
+
+}
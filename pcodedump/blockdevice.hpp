@@ -0,0 +1,95 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _38D36108_508D_4A23_9D09_4A1DF006F1B7
+#define _38D36108_508D_4A23_9D09_4A1DF006F1B7
+
+#include "types.hpp"
+
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <filesystem>
+
+namespace pcodedump {
+
+	/* An input file viewed as a sequence of logical 512 byte blocks, in the order that an Apple
+	   Pascal or ProDOS file system sees them. Any range of blocks is returned as contiguous bytes,
+	   so the code file and volume overlays can be placed directly over them. */
+	class BlockDevice {
+	public:
+		BlockDevice(const BlockDevice &) = delete;
+		BlockDevice & operator=(const BlockDevice &) = delete;
+		virtual ~BlockDevice() = default;
+
+		int getBlockCount() const { return blockCount; }
+		std::wstring const & getFormat() const { return format; }
+		bool isDiskImage() const { return diskImage; }
+
+		virtual Range<std::uint8_t const> blocks(int first, int count) const = 0;
+
+		Range<std::uint8_t const> block(int index) const {
+			return blocks(index, 1);
+		}
+
+		Range<std::uint8_t const> contents() const {
+			return blocks(0, blockCount);
+		}
+
+		static std::unique_ptr<BlockDevice> open(Range<std::uint8_t const> data, std::filesystem::path const & filename);
+
+	protected:
+		BlockDevice(int blockCount, std::wstring format, bool diskImage);
+		void checkRange(int first, int count) const;
+
+	private:
+		int blockCount;
+		std::wstring format;
+		bool diskImage;
+	};
+
+	/* Blocks that are stored in order, as in a ProDOS order image or a plain file. Blocks are
+	   returned directly from the underlying data. The last block may be short. */
+	class LinearBlockDevice final : public BlockDevice {
+	public:
+		LinearBlockDevice(Range<std::uint8_t const> data, std::wstring format = L"Plain file", bool diskImage = false);
+
+		Range<std::uint8_t const> blocks(int first, int count) const override;
+
+	private:
+		Range<std::uint8_t const> data;
+	};
+
+	/* A 5.25" disk image in DOS 3.3 sector order. Each block is made of two 256 byte sectors
+	   of the same track that aren't adjacent in the image. The image is translated once into
+	   block order using the sector interleave table. */
+	class InterleavedBlockDevice final : public BlockDevice {
+	public:
+		static constexpr unsigned int SECTOR_SIZE = 256;
+		static constexpr unsigned int SECTORS_PER_TRACK = 16;
+		static constexpr unsigned int TRACK_SIZE = SECTOR_SIZE * SECTORS_PER_TRACK;
+
+		InterleavedBlockDevice(Range<std::uint8_t const> data, std::wstring format = L"DOS 3.3 order");
+
+		Range<std::uint8_t const> blocks(int first, int count) const override;
+
+	private:
+		buff_t translated;
+	};
+
+}
+
+#endif // !_38D36108_508D_4A23_9D09_4A1DF006F1B7
@@ -0,0 +1,234 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "callgraph.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "basecode.hpp"
+#include "textio.hpp"
+
+#include <map>
+#include <set>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+namespace pcodedump {
+
+	namespace {
+
+		/* A string quoted for both DOT and JSON. */
+		wstring quoted(wstring const & text) {
+			wostringstream result;
+			result << L'"';
+			for (auto c : text) {
+				if (c == L'"' || c == L'\\') {
+					result << L'\\' << c;
+				} else if (c < 32) {
+					result << L"\\u" << hex << setfill(L'0') << setw(4) << static_cast<int>(c);
+				} else {
+					result << c;
+				}
+			}
+			result << L'"';
+			return result.str();
+		}
+
+		wstring trimmed(wstring text) {
+			text.erase(text.find_last_not_of(L' ') + 1);
+			return text;
+		}
+
+		wstring nodeName(int segment, int procedure) {
+			return quoted(to_wstring(segment) + L"." + to_wstring(procedure));
+		}
+
+		wstring nodeName(pair<int, int> const & node) {
+			return nodeName(node.first, node.second);
+		}
+
+	}
+
+	/* Segments that aren't decoded, because of the --seg option, aren't part of the graph, but
+	   calls to units are still resolved to them. */
+	CallGraph::CallGraph(PcodeFile const & file) {
+		map<wstring, int> units;
+		for (auto & segment : file.getSegments()) {
+			units.insert({ trimmed(segment->getName()), segment->getSegmentNumber() });
+		}
+		for (auto & segment : file.getSegments()) {
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			if (codeSegment && codeSegment->isVersionIV()) {
+				undecoded.push_back(codeSegment->getSegmentNumber());
+			} else if (codeSegment) {
+				SegmentNodes nodes{ codeSegment->getSegmentNumber(), trimmed(codeSegment->getName()), {} };
+				for (auto & [procedure, procedureCalls] : codeSegment->getCalls()) {
+					nodes.procedures.push_back(procedure);
+					Node caller{ nodes.number, procedure };
+					for (auto & call : procedureCalls) {
+						auto unit = call.unit.empty() ? units.end() : units.find(call.unit);
+						++calls[{ caller, { unit != units.end() ? unit->second : call.segment, call.procedure } }];
+					}
+				}
+				if (!nodes.procedures.empty()) {
+					segments.push_back(move(nodes));
+				}
+			}
+		}
+	}
+
+	/* The segments of the file, and the segments that are called from the file, in segment
+	   number order. Called procedures are added to the segments that they are in. */
+	vector<CallGraph::SegmentNodes> CallGraph::allSegments() const {
+		map<int, SegmentNodes> bySegment;
+		map<int, set<int>> procedures;
+		for (auto & nodes : segments) {
+			bySegment[nodes.number] = nodes;
+			procedures[nodes.number].insert(nodes.procedures.begin(), nodes.procedures.end());
+		}
+		for (auto & [edge, count] : calls) {
+			auto [segment, procedure] = edge.second;
+			if (!bySegment.count(segment)) {
+				bySegment[segment] = SegmentNodes{ segment, L"", {} };
+			}
+			procedures[segment].insert(procedure);
+		}
+		vector<SegmentNodes> result;
+		for (auto & [number, nodes] : bySegment) {
+			nodes.procedures.assign(procedures[number].begin(), procedures[number].end());
+			result.push_back(move(nodes));
+		}
+		return result;
+	}
+
+	void CallGraph::write(std::wostream & os, std::wstring const & name, graph_format_t format) const {
+		switch (format) {
+		case graph_format_t::dot:
+			writeDot(os, name);
+			break;
+		case graph_format_t::json:
+			writeJson(os, name);
+			break;
+		default:
+			break;
+		}
+	}
+
+	/* Two graphs: the procedures, clustered by segment, and the calls between segments. Edges are
+	   labelled with the number of call sites when there is more than one. */
+	void CallGraph::writeDot(std::wostream & os, std::wstring const & name) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		os << dec;
+		auto allSegments = this->allSegments();
+
+		os << L"digraph " << quoted(name) << L" {" << endl;
+		for (auto segment : undecoded) {
+			os << L"\t// Segment " << segment << L" is Version IV, and its calls aren't decoded" << endl;
+		}
+		for (auto & nodes : allSegments) {
+			os << L"\tsubgraph " << quoted(L"cluster_" + to_wstring(nodes.number)) << L" {" << endl;
+			os << L"\t\tlabel = " << quoted(L"Segment " + to_wstring(nodes.number) + (nodes.name.empty() ? L"" : L": " + nodes.name)) << L";" << endl;
+			for (auto procedure : nodes.procedures) {
+				os << L"\t\t" << nodeName(nodes.number, procedure) << L";" << endl;
+			}
+			os << L"\t}" << endl;
+		}
+		for (auto & [edge, count] : calls) {
+			os << L"\t" << nodeName(edge.first) << L" -> " << nodeName(edge.second);
+			if (count > 1) {
+				os << L" [label = \"" << count << L"\"]";
+			}
+			os << L";" << endl;
+		}
+		os << L"}" << endl;
+
+		map<pair<int, int>, int> segmentCalls;
+		for (auto & [edge, count] : calls) {
+			if (edge.first.first != edge.second.first) {
+				segmentCalls[{ edge.first.first, edge.second.first }] += count;
+			}
+		}
+		os << L"digraph " << quoted(name + L" segments") << L" {" << endl;
+		for (auto & nodes : allSegments) {
+			os << L"\t" << quoted(to_wstring(nodes.number));
+			if (!nodes.name.empty()) {
+				os << L" [label = " << quoted(nodes.name) << L"]";
+			}
+			os << L";" << endl;
+		}
+		for (auto & [fromTo, count] : segmentCalls) {
+			os << L"\t" << quoted(to_wstring(fromTo.first)) << L" -> " << quoted(to_wstring(fromTo.second)) << L" [label = \"" << count << L"\"];" << endl;
+		}
+		os << L"}" << endl;
+	}
+
+	/* One object to a line. The segment call matrix is indexed by the position of the segments in
+	   its list, caller first. Calls within a segment are on the diagonal. Version IV segments
+	   whose calls aren't decoded are listed as undecoded. */
+	void CallGraph::writeJson(std::wostream & os, std::wstring const & name) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		os << dec;
+		auto allSegments = this->allSegments();
+
+		os << L"{\"file\":" << quoted(name) << L",\"segments\":[";
+		map<int, size_t> segmentIndex;
+		for (auto & nodes : allSegments) {
+			auto index = segmentIndex.size();
+			segmentIndex[nodes.number] = index;
+			os << (index == 0 ? L"" : L",") << L"{\"number\":" << nodes.number;
+			if (!nodes.name.empty()) {
+				os << L",\"name\":" << quoted(nodes.name);
+			}
+			os << L",\"procedures\":[";
+			for (auto procedure = nodes.procedures.begin(); procedure != nodes.procedures.end(); ++procedure) {
+				os << (procedure == nodes.procedures.begin() ? L"" : L",") << *procedure;
+			}
+			os << L"]}";
+		}
+
+		os << L"],\"calls\":[";
+		vector<vector<int>> matrix(allSegments.size(), vector<int>(allSegments.size()));
+		for (auto call = calls.begin(); call != calls.end(); ++call) {
+			auto [edge, count] = *call;
+			os << (call == calls.begin() ? L"" : L",");
+			os << L"{\"caller\":[" << edge.first.first << L"," << edge.first.second << L"]";
+			os << L",\"callee\":[" << edge.second.first << L"," << edge.second.second << L"]";
+			os << L",\"sites\":" << count << L"}";
+			matrix[segmentIndex[edge.first.first]][segmentIndex[edge.second.first]] += count;
+		}
+
+		os << L"],\"segmentCalls\":[";
+		for (size_t row = 0; row != matrix.size(); ++row) {
+			os << (row == 0 ? L"[" : L",[");
+			for (size_t column = 0; column != matrix.size(); ++column) {
+				os << (column == 0 ? L"" : L",") << matrix[row][column];
+			}
+			os << L"]";
+		}
+		os << L"]";
+		if (!undecoded.empty()) {
+			os << L",\"undecoded\":[";
+			for (auto segment = undecoded.begin(); segment != undecoded.end(); ++segment) {
+				os << (segment == undecoded.begin() ? L"" : L",") << *segment;
+			}
+			os << L"]";
+		}
+		os << L"}" << endl;
+	}
+
+}
@@ -0,0 +1,68 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _CF0129EA_28DE_4511_99B9_2876F1C8ECE4
+#define _CF0129EA_28DE_4511_99B9_2876F1C8ECE4
+
+#include "options.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <cstdint>
+
+namespace pcodedump {
+
+	class PcodeFile;
+
+	/* The calls between the procedures of a code file, built in one pass over the decoded code of
+	   every procedure. A procedure is identified by its segment number and procedure number. Each
+	   edge counts the call sites from one procedure to another. Calls to a unit that the linker
+	   hasn't resolved go to the segment of the unit, if it's in the file. Procedures that are
+	   called in segments that aren't in the file are included, but without a segment name.
+	   Version IV segments aren't decoded, so the graph notes that their calls are missing. */
+	class CallGraph {
+	public:
+		explicit CallGraph(PcodeFile const & file);
+
+		void write(std::wostream & os, std::wstring const & name, graph_format_t format) const;
+		void writeDot(std::wostream & os, std::wstring const & name) const;
+		void writeJson(std::wostream & os, std::wstring const & name) const;
+
+	private:
+		/* Segment number and procedure number. */
+		using Node = std::pair<int, int>;
+		/* Caller and callee. */
+		using Edge = std::pair<Node, Node>;
+
+		struct SegmentNodes {
+			int number;
+			std::wstring name;
+			std::vector<int> procedures;
+		};
+
+		std::vector<SegmentNodes> allSegments() const;
+
+		std::vector<SegmentNodes> segments;
+		std::map<Edge, int> calls;
+		std::vector<int> undecoded;
+	};
+
+}
+
+#endif // !_CF0129EA_28DE_4511_99B9_2876F1C8ECE4
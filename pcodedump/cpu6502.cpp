@@ -0,0 +1,540 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "cpu6502.hpp"
+#include "basecode.hpp"
+#include "native6502.hpp"
+#include "textio.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+namespace pcodedump {
+
+	bool Cpu6502::emulate = false;
+	std::string Cpu6502::memoryMap;
+
+	namespace {
+
+		uint16_t parseAddress(string const & token, int line) {
+			size_t used = 0;
+			unsigned long value = 0;
+			auto digits = token.size() > 1 && token[0] == '$' ? token.substr(1) : token;
+			try {
+				value = stoul(digits, &used, 16);
+			} catch (logic_error &) {
+				used = 0;
+			}
+			if (used != digits.size() || digits.empty() || value > 0xFFFF) {
+				throw runtime_error("Memory map line " + to_string(line) + ": bad value " + token);
+			}
+			return static_cast<uint16_t>(value);
+		}
+
+		uint8_t parseByte(string const & token, int line) {
+			auto value = parseAddress(token, line);
+			if (value > 0xFF) {
+				throw runtime_error("Memory map line " + to_string(line) + ": bad byte " + token);
+			}
+			return static_cast<uint8_t>(value);
+		}
+
+	}
+
+	MemoryMap MemoryMap::read(std::string const & filename) {
+		MemoryMap result;
+		if (filename.empty()) {
+			return result;
+		}
+		ifstream input{ filename };
+		if (!input) {
+			throw runtime_error("Can't read memory map " + filename);
+		}
+		string text;
+		for (int line = 1; getline(input, text); ++line) {
+			istringstream words{ text.substr(0, text.find(';')) };
+			vector<string> tokens{ istream_iterator<string>{ words }, istream_iterator<string>{} };
+			if (tokens.empty()) {
+				continue;
+			}
+			auto & keyword = tokens[0];
+			auto expect = [&](size_t count) {
+				if (tokens.size() != count) {
+					throw runtime_error("Memory map line " + to_string(line) + ": " + keyword + " takes " + to_string(count - 1) + " values");
+				}
+			};
+			if (keyword == "load" || keyword == "base" || keyword == "interp" || keyword == "return") {
+				expect(2);
+				auto address = parseAddress(tokens[1], line);
+				(keyword == "load" ? result.load : keyword == "base" ? result.base : keyword == "interp" ? result.interpreter : result.returnAddress) = address;
+			} else if (keyword == "segment") {
+				expect(3);
+				result.segments[stoi(tokens[1])] = parseAddress(tokens[2], line);
+			} else if (keyword == "stub") {
+				expect(3);
+				result.stubs[parseAddress(tokens[1], line)] = wstring(tokens[2].begin(), tokens[2].end());
+			} else if (keyword == "byte" && tokens.size() > 2) {
+				vector<uint8_t> bytes;
+				transform(tokens.begin() + 2, tokens.end(), back_inserter(bytes), [&](string const & token) { return parseByte(token, line); });
+				result.contents.push_back({ parseAddress(tokens[1], line), bytes });
+			} else if (keyword == "a" || keyword == "x" || keyword == "y" || keyword == "s" || keyword == "p") {
+				expect(2);
+				auto value = parseByte(tokens[1], line);
+				(keyword == "a" ? result.a : keyword == "x" ? result.x : keyword == "y" ? result.y : keyword == "s" ? result.s : result.p) = value;
+			} else if (keyword == "limit") {
+				expect(2);
+				result.limit = stoull(tokens[1]);
+			} else {
+				throw runtime_error("Memory map line " + to_string(line) + ": unknown " + keyword);
+			}
+		}
+		return result;
+	}
+
+	enum class Cpu6502::Operation : std::uint8_t {
+		ADC, AND, ASL, BCC, BCS, BEQ, BIT, BMI, BNE, BPL, BRA, BRK, BVC, BVS, CLC, CLD, CLI, CLV,
+		CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC, INX, INY, JMP, JSR, LDA, LDX, LDY, LSR, NOP, ORA,
+		PHA, PHP, PHX, PHY, PLA, PLP, PLX, PLY, ROL, ROR, RTI, RTS, SBC, SEC, SED, SEI, STA, STX,
+		STY, STZ, TAX, TAY, TRB, TSB, TSX, TXA, TXS, TYA, undefined
+	};
+
+	namespace {
+
+		constexpr uint8_t FLAG_C = 0x01;
+		constexpr uint8_t FLAG_Z = 0x02;
+		constexpr uint8_t FLAG_I = 0x04;
+		constexpr uint8_t FLAG_D = 0x08;
+		constexpr uint8_t FLAG_B = 0x10;
+		constexpr uint8_t FLAG_U = 0x20;
+		constexpr uint8_t FLAG_V = 0x40;
+		constexpr uint8_t FLAG_N = 0x80;
+
+		/* In the same order as the operations. */
+		wchar_t const * const mnemonics[] = {
+			L"ADC", L"AND", L"ASL", L"BCC", L"BCS", L"BEQ", L"BIT", L"BMI", L"BNE", L"BPL", L"BRA", L"BRK", L"BVC", L"BVS", L"CLC", L"CLD", L"CLI", L"CLV",
+			L"CMP", L"CPX", L"CPY", L"DEC", L"DEX", L"DEY", L"EOR", L"INC", L"INX", L"INY", L"JMP", L"JSR", L"LDA", L"LDX", L"LDY", L"LSR", L"NOP", L"ORA",
+			L"PHA", L"PHP", L"PHX", L"PHY", L"PLA", L"PLP", L"PLX", L"PLY", L"ROL", L"ROR", L"RTI", L"RTS", L"SBC", L"SEC", L"SED", L"SEI", L"STA", L"STX",
+			L"STY", L"STZ", L"TAX", L"TAY", L"TRB", L"TSB", L"TSX", L"TXA", L"TXS", L"TYA"
+		};
+
+		constexpr uint8_t RTS_OPCODE = 0x60;
+		constexpr uint8_t JSR_OPCODE = 0x20;
+		constexpr uint8_t JMP_OPCODE = 0x4C;
+
+	}
+
+	/* The operation of each opcode is found once from its mnemonic, so the opcode table is the
+	   only place that says what an opcode does. */
+	Cpu6502::Cpu6502(cpu_t cpu, std::wostream & trace) :
+		cpu{ cpu }, trace{ trace }, opcodes{ opcodeTable(cpu) }, timing{ cycleTable(cpu) }, memory(0x10000)
+	{
+		if (cpu == cpu_t::_65c816) {
+			throw runtime_error("The 65c816 can't be emulated");
+		}
+		for (size_t opcode = 0; opcode != opcodes.size(); ++opcode) {
+			auto found = find_if(begin(mnemonics), end(mnemonics), [&](wchar_t const * mnemonic) { return wstring{ mnemonic } == opcodes[opcode].mnemonic; });
+			operations[opcode] = found == end(mnemonics) ? Operation::undefined : static_cast<Operation>(found - begin(mnemonics));
+		}
+	}
+
+	/* Relocated addresses are offsets that have the address of the segment, the procedure, the
+	   base or the interpreter added to them. */
+	void Cpu6502::load(CodePart const & codePart, Native6502Procedure const & procedure, MemoryMap const & map) {
+		auto segmentAddress = static_cast<uint16_t>(map.load - (procedure.getProcBegin() - codePart.begin()));
+		for (auto current = codePart.begin(); current != codePart.end(); ++current) {
+			memory[static_cast<uint16_t>(segmentAddress + (current - codePart.begin()))] = *current;
+		}
+		vector<uint16_t> calls;
+		for (auto & entry : *codePart.getProcedures()) {
+			auto native = dynamic_cast<Native6502Procedure const *>(entry.get());
+			if (!native) {
+				continue;
+			}
+			auto procAddress = static_cast<uint16_t>(segmentAddress + (native->getProcBegin() - codePart.begin()));
+			auto segment = native->getRelocationSegment();
+			auto base = segment == 0 ? map.base : map.segments.count(segment) ? map.segments.at(segment) : map.base;
+			using Relocation = Native6502Procedure::Relocation;
+			for (auto [kind, delta] : { pair{ Relocation::base, base }, pair{ Relocation::segment, segmentAddress }, pair{ Relocation::procedure, procAddress }, pair{ Relocation::interpreter, map.interpreter } }) {
+				for (auto offset : native->getRelocations(kind)) {
+					auto address = static_cast<uint16_t>(procAddress + offset);
+					auto value = static_cast<uint16_t>(readWord(address) + delta);
+					memory[address] = static_cast<uint8_t>(value);
+					memory[static_cast<uint16_t>(address + 1)] = static_cast<uint8_t>(value >> 8);
+					auto opcode = read(static_cast<uint16_t>(address - 1));
+					if (kind == Relocation::interpreter && (opcode == JSR_OPCODE || opcode == JMP_OPCODE)) {
+						calls.push_back(value);
+					}
+				}
+			}
+		}
+		stubs = map.stubs;
+		for (auto address : calls) {
+			wostringstream name;
+			name << L"interp+$" << hex << uppercase << setfill(L'0') << setw(4) << static_cast<uint16_t>(address - map.interpreter);
+			stubs.insert({ address, name.str() });
+		}
+		for (auto & stub : stubs) {
+			memory[stub.first] = RTS_OPCODE;
+		}
+		for (auto & [address, bytes] : map.contents) {
+			for (size_t index = 0; index != bytes.size(); ++index) {
+				memory[static_cast<uint16_t>(address + index)] = bytes[index];
+			}
+		}
+		a = map.a;
+		x = map.x;
+		y = map.y;
+		s = map.s;
+		p = map.p | FLAG_U;
+		returnAddress = map.returnAddress;
+		limit = map.limit;
+		auto back = static_cast<uint16_t>(returnAddress - 1);
+		push(static_cast<uint8_t>(back >> 8));
+		push(static_cast<uint8_t>(back));
+		pc = static_cast<uint16_t>(map.load + procedure.getEnterOffset());
+		halted = false;
+		instructions = cycles = 0;
+	}
+
+	void Cpu6502::run() {
+		FmtSentry<wostream::char_type> sentry{ trace };
+		while (!halted && pc != returnAddress) {
+			if (instructions == limit) {
+				trace << L"Stopped after " << dec << instructions << L" instructions" << endl;
+				break;
+			}
+			step();
+		}
+		trace << L"Instructions: " << dec << instructions << endl;
+		trace << L"Cycles: " << cycles << endl;
+	}
+
+	void Cpu6502::push(std::uint8_t value) {
+		memory[0x100 + s--] = value;
+	}
+
+	std::uint8_t Cpu6502::pull() {
+		return memory[0x100 + ++s];
+	}
+
+	void Cpu6502::setFlag(std::uint8_t flag, bool value) {
+		p = value ? p | flag : p & ~flag;
+	}
+
+	void Cpu6502::setNZ(std::uint8_t value) {
+		setFlag(FLAG_Z, value == 0);
+		setFlag(FLAG_N, value & 0x80);
+	}
+
+	/* Indexing that carries into the high byte of the address crosses a page. The 6502 reads
+	   the high byte of an indirect JMP from the start of the page when the pointer is at its end. */
+	std::uint16_t Cpu6502::effectiveAddress(AddressMode mode, bool & crossed) {
+		auto operand = static_cast<uint16_t>(pc + 1);
+		auto indexed = [&](uint16_t base, uint8_t index) {
+			auto result = static_cast<uint16_t>(base + index);
+			crossed = (base ^ result) & 0xFF00;
+			return result;
+		};
+		switch (mode) {
+		case AddressMode::immediate:
+			return operand;
+		case AddressMode::absolute:
+			return readWord(operand);
+		case AddressMode::absoluteIndirect: {
+			auto pointer = readWord(operand);
+			if (cpu == cpu_t::_6502) {
+				return static_cast<uint16_t>(read(pointer) | read(static_cast<uint16_t>((pointer & 0xFF00) | ((pointer + 1) & 0x00FF))) << 8);
+			}
+			return readWord(pointer);
+		}
+		case AddressMode::absoluteIndexedIndirect:
+			return readWord(static_cast<uint16_t>(readWord(operand) + x));
+		case AddressMode::zeroPage:
+			return read(operand);
+		case AddressMode::zeroPageIndirect:
+			return readZeroPageWord(read(operand));
+		case AddressMode::absoluteIndexedX:
+			return indexed(readWord(operand), x);
+		case AddressMode::absoluteIndexedY:
+			return indexed(readWord(operand), y);
+		case AddressMode::zeroPageIndexedX:
+			return static_cast<uint8_t>(read(operand) + x);
+		case AddressMode::zeroPageIndexedY:
+			return static_cast<uint8_t>(read(operand) + y);
+		case AddressMode::relative:
+			return static_cast<uint16_t>(pc + 2 + static_cast<int8_t>(read(operand)));
+		case AddressMode::indexedIndirect:
+			return readZeroPageWord(static_cast<uint8_t>(read(operand) + x));
+		case AddressMode::indirectIndexed:
+			return indexed(readZeroPageWord(read(operand)), y);
+		default:
+			return 0;
+		}
+	}
+
+	/* In decimal mode the 6502 sets the negative, overflow and zero flags from the binary sum,
+	   and the 65c02 sets negative and zero from the decimal result, taking one more cycle. */
+	void Cpu6502::addWithCarry(std::uint8_t value) {
+		unsigned carry = p & FLAG_C;
+		unsigned binary = a + value + carry;
+		if (!(p & FLAG_D)) {
+			setFlag(FLAG_V, ~(a ^ value) & (a ^ binary) & 0x80);
+			setFlag(FLAG_C, binary > 0xFF);
+			a = static_cast<uint8_t>(binary);
+			setNZ(a);
+			return;
+		}
+		unsigned low = (a & 0x0F) + (value & 0x0F) + carry;
+		if (low > 9) {
+			low += 6;
+		}
+		unsigned sum = (a & 0xF0) + (value & 0xF0) + (low > 0x0F ? 0x10 : 0) + (low & 0x0F);
+		setFlag(FLAG_V, ~(a ^ value) & (a ^ sum) & 0x80);
+		setNZ(static_cast<uint8_t>(sum));
+		if (sum > 0x9F) {
+			sum += 0x60;
+		}
+		setFlag(FLAG_C, sum > 0xFF);
+		a = static_cast<uint8_t>(sum);
+		if (cpu == cpu_t::_6502) {
+			setFlag(FLAG_Z, static_cast<uint8_t>(binary) == 0);
+		} else {
+			setNZ(a);
+			++cycles;
+		}
+	}
+
+	void Cpu6502::subtractWithBorrow(std::uint8_t value) {
+		int borrow = (p & FLAG_C) ? 0 : 1;
+		int binary = a - value - borrow;
+		setFlag(FLAG_V, (a ^ value) & (a ^ binary) & 0x80);
+		setFlag(FLAG_C, binary >= 0);
+		if (!(p & FLAG_D)) {
+			a = static_cast<uint8_t>(binary);
+			setNZ(a);
+			return;
+		}
+		int low = (a & 0x0F) - (value & 0x0F) - borrow;
+		int high = (a >> 4) - (value >> 4);
+		if (low < 0) {
+			low += 10;
+			--high;
+		}
+		if (high < 0) {
+			high += 10;
+		}
+		a = static_cast<uint8_t>(high << 4 | (low & 0x0F));
+		if (cpu == cpu_t::_6502) {
+			setNZ(static_cast<uint8_t>(binary));
+		} else {
+			setNZ(a);
+			++cycles;
+		}
+	}
+
+	void Cpu6502::compare(std::uint8_t reg, std::uint8_t value) {
+		setFlag(FLAG_C, reg >= value);
+		setNZ(static_cast<uint8_t>(reg - value));
+	}
+
+	/* One instruction. Shifts and rotates, INC and DEC work on the accumulator in accumulator
+	   mode and on memory otherwise. */
+	void Cpu6502::step() {
+		auto address = pc;
+		auto stub = stubs.find(address);
+		if (stub != stubs.end()) {
+			trace << stub->second << L":" << endl;
+		}
+		auto opcode = read(pc);
+		auto operation = operations[opcode];
+		if (operation == Operation::undefined) {
+			throw fault("undefined opcode");
+		}
+		auto mode = opcodes[opcode].mode;
+		auto startCycles = cycles;
+		bool crossed = false;
+		auto target = effectiveAddress(mode, crossed);
+		cycles += timing[opcode].base + (timing[opcode].pageCross && crossed ? 1 : 0);
+		pc = static_cast<uint16_t>(pc + 1 + operandSize(mode));
+
+		auto branch = [&](bool condition) {
+			if (condition) {
+				cycles += (pc ^ target) & 0xFF00 ? 2 : 1;
+				pc = target;
+			}
+		};
+		auto modify = [&](auto change) {
+			if (mode == AddressMode::accumulator) {
+				a = change(a);
+				setNZ(a);
+			} else {
+				memory[target] = change(memory[target]);
+				setNZ(memory[target]);
+			}
+		};
+		auto value = [&]() { return memory[target]; };
+
+		switch (operation) {
+		case Operation::ADC: addWithCarry(value()); break;
+		case Operation::AND: a &= value(); setNZ(a); break;
+		case Operation::ASL: modify([&](uint8_t m) { setFlag(FLAG_C, m & 0x80); return static_cast<uint8_t>(m << 1); }); break;
+		case Operation::BCC: branch(!(p & FLAG_C)); break;
+		case Operation::BCS: branch(p & FLAG_C); break;
+		case Operation::BEQ: branch(p & FLAG_Z); break;
+		case Operation::BIT:
+			setFlag(FLAG_Z, (a & value()) == 0);
+			if (mode != AddressMode::immediate) {
+				setFlag(FLAG_N, value() & 0x80);
+				setFlag(FLAG_V, value() & 0x40);
+			}
+			break;
+		case Operation::BMI: branch(p & FLAG_N); break;
+		case Operation::BNE: branch(!(p & FLAG_Z)); break;
+		case Operation::BPL: branch(!(p & FLAG_N)); break;
+		case Operation::BRA: branch(true); break;
+		case Operation::BRK: halted = true; break;
+		case Operation::BVC: branch(!(p & FLAG_V)); break;
+		case Operation::BVS: branch(p & FLAG_V); break;
+		case Operation::CLC: setFlag(FLAG_C, false); break;
+		case Operation::CLD: setFlag(FLAG_D, false); break;
+		case Operation::CLI: setFlag(FLAG_I, false); break;
+		case Operation::CLV: setFlag(FLAG_V, false); break;
+		case Operation::CMP: compare(a, value()); break;
+		case Operation::CPX: compare(x, value()); break;
+		case Operation::CPY: compare(y, value()); break;
+		case Operation::DEC: modify([](uint8_t m) { return static_cast<uint8_t>(m - 1); }); break;
+		case Operation::DEX: setNZ(--x); break;
+		case Operation::DEY: setNZ(--y); break;
+		case Operation::EOR: a ^= value(); setNZ(a); break;
+		case Operation::INC: modify([](uint8_t m) { return static_cast<uint8_t>(m + 1); }); break;
+		case Operation::INX: setNZ(++x); break;
+		case Operation::INY: setNZ(++y); break;
+		case Operation::JMP: pc = target; break;
+		case Operation::JSR:
+			push(static_cast<uint8_t>((pc - 1) >> 8));
+			push(static_cast<uint8_t>(pc - 1));
+			pc = target;
+			break;
+		case Operation::LDA: a = value(); setNZ(a); break;
+		case Operation::LDX: x = value(); setNZ(x); break;
+		case Operation::LDY: y = value(); setNZ(y); break;
+		case Operation::LSR: modify([&](uint8_t m) { setFlag(FLAG_C, m & 0x01); return static_cast<uint8_t>(m >> 1); }); break;
+		case Operation::NOP: break;
+		case Operation::ORA: a |= value(); setNZ(a); break;
+		case Operation::PHA: push(a); break;
+		case Operation::PHP: push(p | FLAG_B | FLAG_U); break;
+		case Operation::PHX: push(x); break;
+		case Operation::PHY: push(y); break;
+		case Operation::PLA: a = pull(); setNZ(a); break;
+		case Operation::PLP: p = (pull() & ~FLAG_B) | FLAG_U; break;
+		case Operation::PLX: x = pull(); setNZ(x); break;
+		case Operation::PLY: y = pull(); setNZ(y); break;
+		case Operation::ROL: modify([&](uint8_t m) { auto carry = p & FLAG_C; setFlag(FLAG_C, m & 0x80); return static_cast<uint8_t>(m << 1 | carry); }); break;
+		case Operation::ROR: modify([&](uint8_t m) { auto carry = p & FLAG_C; setFlag(FLAG_C, m & 0x01); return static_cast<uint8_t>(m >> 1 | carry << 7); }); break;
+		case Operation::RTI:
+			p = (pull() & ~FLAG_B) | FLAG_U;
+			pc = pull();
+			pc |= pull() << 8;
+			break;
+		case Operation::RTS:
+			pc = pull();
+			pc = static_cast<uint16_t>((pc | pull() << 8) + 1);
+			break;
+		case Operation::SBC: subtractWithBorrow(value()); break;
+		case Operation::SEC: setFlag(FLAG_C, true); break;
+		case Operation::SED: setFlag(FLAG_D, true); break;
+		case Operation::SEI: setFlag(FLAG_I, true); break;
+		case Operation::STA: memory[target] = a; break;
+		case Operation::STX: memory[target] = x; break;
+		case Operation::STY: memory[target] = y; break;
+		case Operation::STZ: memory[target] = 0; break;
+		case Operation::TAX: x = a; setNZ(x); break;
+		case Operation::TAY: y = a; setNZ(y); break;
+		case Operation::TRB: setFlag(FLAG_Z, (a & value()) == 0); memory[target] &= ~a; break;
+		case Operation::TSB: setFlag(FLAG_Z, (a & value()) == 0); memory[target] |= a; break;
+		case Operation::TSX: x = s; setNZ(x); break;
+		case Operation::TXA: a = x; setNZ(a); break;
+		case Operation::TXS: s = x; break;
+		case Operation::TYA: a = y; setNZ(a); break;
+		case Operation::undefined: break;
+		}
+		++instructions;
+		writeTrace(address, static_cast<int>(cycles - startCycles));
+	}
+
+	/* The operand as the disassembler writes it, with branch targets as absolute addresses. */
+	std::wstring Cpu6502::formatOperand(AddressMode mode, std::uint16_t address) const {
+		wostringstream result;
+		result << hex << uppercase << setfill(L'0') << right;
+		auto byte = read(static_cast<uint16_t>(address + 1));
+		auto word = readWord(static_cast<uint16_t>(address + 1));
+		switch (mode) {
+		case AddressMode::implied: break;
+		case AddressMode::accumulator: result << L"A"; break;
+		case AddressMode::immediate: result << L"#$" << setw(2) << static_cast<int>(byte); break;
+		case AddressMode::absolute: result << L"$" << setw(4) << word; break;
+		case AddressMode::absoluteIndirect: result << L"($" << setw(4) << word << L")"; break;
+		case AddressMode::absoluteIndexedIndirect: result << L"($" << setw(4) << word << L",X)"; break;
+		case AddressMode::zeroPage: result << L"$" << setw(2) << static_cast<int>(byte); break;
+		case AddressMode::zeroPageIndirect: result << L"($" << setw(2) << static_cast<int>(byte) << L")"; break;
+		case AddressMode::absoluteIndexedX: result << L"$" << setw(4) << word << L",X"; break;
+		case AddressMode::absoluteIndexedY: result << L"$" << setw(4) << word << L",Y"; break;
+		case AddressMode::zeroPageIndexedX: result << L"$" << setw(2) << static_cast<int>(byte) << L",X"; break;
+		case AddressMode::zeroPageIndexedY: result << L"$" << setw(2) << static_cast<int>(byte) << L",Y"; break;
+		case AddressMode::relative: result << L"$" << setw(4) << static_cast<uint16_t>(address + 2 + static_cast<int8_t>(byte)); break;
+		case AddressMode::indexedIndirect: result << L"($" << setw(2) << static_cast<int>(byte) << L",X)"; break;
+		case AddressMode::indirectIndexed: result << L"($" << setw(2) << static_cast<int>(byte) << L"),Y"; break;
+		default: break;
+		}
+		return result.str();
+	}
+
+	/* The address, bytes and text of an instruction, the registers after it, the cycles it
+	   took and the cycles so far. Flags that are clear are in lower case. */
+	void Cpu6502::writeTrace(std::uint16_t address, int cycleCount) const {
+		auto opcode = read(address);
+		auto & info = opcodes[opcode];
+		wostringstream bytes;
+		bytes << hex << uppercase << setfill(L'0') << right;
+		for (int index = 0; index <= operandSize(info.mode); ++index) {
+			bytes << (index ? L" " : L"") << setw(2) << static_cast<int>(read(static_cast<uint16_t>(address + index)));
+		}
+		wstring flags = L"NV-BDIZC";
+		for (int bit = 0; bit != 8; ++bit) {
+			if (!(p & (0x80 >> bit)) && flags[bit] != L'-') {
+				flags[bit] = towlower(flags[bit]);
+			}
+		}
+		trace << L"  " << hex << uppercase << setfill(L'0') << right << setw(4) << address << L"  ";
+		trace << setfill(L' ') << left << setw(10) << bytes.str() << info.mnemonic << L" " << setw(12) << formatOperand(info.mode, address);
+		trace << setfill(L'0') << right;
+		trace << L"A=" << setw(2) << static_cast<int>(a) << L" X=" << setw(2) << static_cast<int>(x) << L" Y=" << setw(2) << static_cast<int>(y) << L" S=" << setw(2) << static_cast<int>(s) << L" " << flags;
+		trace << dec << setfill(L' ') << L" " << setw(2) << cycleCount << L" " << setw(8) << cycles << nouppercase << endl;
+	}
+
+	std::runtime_error Cpu6502::fault(std::string const & reason) const {
+		ostringstream message;
+		message << "6502 fault at $" << hex << uppercase << setfill('0') << setw(4) << pc << ": " << reason;
+		return runtime_error(message.str());
+	}
+
+}
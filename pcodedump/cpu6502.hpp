@@ -0,0 +1,152 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef _581F95E1_C0A6_4E51_9EDE_5DA5F6292782
+#define _581F95E1_C0A6_4E51_9EDE_5DA5F6292782
+
+#include "options.hpp"
+#include "opcodes6502.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <utility>
+#include <stdexcept>
+#include <cstdint>
+
+namespace pcodedump {
+
+	class CodePart;
+	class Native6502Procedure;
+
+	/* Where a native procedure is loaded and what the memory around it holds, read from a
+	   script. Each line of the script is a keyword and its values, in hex unless noted, and
+	   anything after a semicolon is a comment.
+
+	     load ADDR            the address of the procedure
+	     base ADDR            where base relocated addresses point
+	     interp ADDR          where interpreter relocated addresses point
+	     segment NUM ADDR     where base relocated addresses of a segment point, NUM in decimal
+	     stub ADDR NAME       a named interpreter entry point
+	     byte ADDR BYTE...    the contents of memory
+	     a|x|y|s|p VALUE      the registers when the procedure is entered
+	     return ADDR          the address the procedure returns to, which stops the CPU
+	     limit COUNT          the most instructions to run, in decimal */
+	struct MemoryMap {
+		std::uint16_t load = 0x2000;
+		std::uint16_t base = 0x0800;
+		std::uint16_t interpreter = 0xD000;
+		std::map<int, std::uint16_t> segments;
+		std::map<std::uint16_t, std::wstring> stubs;
+		std::vector<std::pair<std::uint16_t, std::vector<std::uint8_t>>> contents;
+		std::uint8_t a = 0;
+		std::uint8_t x = 0;
+		std::uint8_t y = 0;
+		std::uint8_t s = 0xFF;
+		std::uint8_t p = 0x24;
+		std::uint16_t returnAddress = 0xFFFF;
+		std::uint64_t limit = 100000;
+
+		static MemoryMap read(std::string const & filename);
+	};
+
+	/* A 6502 or 65c02 that runs native procedures, writing a trace of each instruction with the
+	   registers after it and the cycles it took.
+
+	   The segment that holds the procedure is copied into a 64K memory so that the procedure is
+	   at the load address, and every native procedure in it is relocated. Each interpreter
+	   address that is called or jumped to is a stub of one RTS, as is every stub named in the
+	   memory map. The procedure is entered with the return address on the stack, and the CPU
+	   stops when it returns, on BRK, or when the instruction limit is reached.
+
+	   Instructions are decoded with the same opcode tables as the disassembler, and timed with
+	   the cycle tables beside them. */
+	class Cpu6502 {
+	public:
+		Cpu6502(cpu_t cpu, std::wostream & trace);
+
+		void load(CodePart const & codePart, Native6502Procedure const & procedure, MemoryMap const & map);
+		void run();
+
+		std::uint64_t getInstructionCount() const {
+			return instructions;
+		}
+
+		std::uint64_t getCycles() const {
+			return cycles;
+		}
+
+	private:
+		enum class Operation : std::uint8_t;
+
+		void step();
+		std::uint16_t effectiveAddress(AddressMode mode, bool & crossed);
+		void writeTrace(std::uint16_t address, int cycleCount) const;
+		std::wstring formatOperand(AddressMode mode, std::uint16_t address) const;
+
+		std::uint8_t read(std::uint16_t address) const {
+			return memory[address];
+		}
+
+		std::uint16_t readWord(std::uint16_t address) const {
+			return static_cast<std::uint16_t>(memory[address] | memory[static_cast<std::uint16_t>(address + 1)] << 8);
+		}
+
+		std::uint16_t readZeroPageWord(std::uint8_t address) const {
+			return static_cast<std::uint16_t>(memory[address] | memory[static_cast<std::uint8_t>(address + 1)] << 8);
+		}
+
+		void push(std::uint8_t value);
+		std::uint8_t pull();
+		void setNZ(std::uint8_t value);
+		void setFlag(std::uint8_t flag, bool value);
+		void addWithCarry(std::uint8_t value);
+		void subtractWithBorrow(std::uint8_t value);
+		void compare(std::uint8_t reg, std::uint8_t value);
+
+		std::runtime_error fault(std::string const & reason) const;
+
+		cpu_t cpu;
+		std::wostream & trace;
+		OpcodeTable6502 const & opcodes;
+		CycleTable6502 const & timing;
+		std::array<Operation, 256> operations;
+		std::vector<std::uint8_t> memory;
+		std::map<std::uint16_t, std::wstring> stubs;
+		std::uint16_t returnAddress = 0xFFFF;
+		std::uint64_t limit = 0;
+
+		std::uint16_t pc = 0;
+		std::uint8_t a = 0;
+		std::uint8_t x = 0;
+		std::uint8_t y = 0;
+		std::uint8_t s = 0xFF;
+		std::uint8_t p = 0x24;
+		bool halted = false;
+		std::uint64_t instructions = 0;
+		std::uint64_t cycles = 0;
+
+	public:
+		static bool emulate;
+		static std::string memoryMap;
+	};
+
+}
+
+#endif // !_581F95E1_C0A6_4E51_9EDE_5DA5F6292782
@@ -0,0 +1,115 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "dedup.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "basecode.hpp"
+#include "textio.hpp"
+
+#include <map>
+#include <algorithm>
+#include <iomanip>
+#include <boost/algorithm/string/trim.hpp>
+
+using namespace std;
+
+namespace pcodedump {
+
+	bool DuplicateIndex::showDuplicates = false;
+
+	void DuplicateIndex::add(std::wstring const & source, PcodeFile const & file) {
+		for (auto & segment : file.getSegments()) {
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			auto codePart = codeSegment ? codeSegment->getCodePart() : nullptr;
+			if (codePart && codePart->getProcedures()) {
+				auto hashes = codeSegment->getCodeHashes();
+				auto segmentName = boost::trim_copy(codeSegment->getName());
+				for (auto & procedure : *codePart->getProcedures()) {
+					entries.push_back({ hashes[procedure->getProcedureNumber()],
+						{ source, segmentName, codeSegment->getSegmentNumber(), procedure->getProcedureNumber(), procedure->getSize() } });
+				}
+			}
+		}
+	}
+
+	void DuplicateIndex::add(DuplicateIndex const & other) {
+		entries.insert(entries.end(), other.entries.begin(), other.entries.end());
+	}
+
+	/* Groups of copies are written with the most bytes taken by the extra copies first, and
+	   copies are in the order they were added. */
+	void DuplicateIndex::write(std::wostream & os) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		map<pair<uint64_t, size_t>, vector<ProcedureLocation const *>> groups;
+		for (auto & entry : entries) {
+			groups[{ entry.hash, entry.location.size }].push_back(&entry.location);
+		}
+		vector<pair<uint64_t, vector<ProcedureLocation const *> const *>> copies;
+		size_t duplicateBytes = 0;
+		for (auto & [key, locations] : groups) {
+			if (locations.size() > 1) {
+				copies.push_back({ key.first, &locations });
+				duplicateBytes += key.second * (locations.size() - 1);
+			}
+		}
+		stable_sort(copies.begin(), copies.end(), [](auto & left, auto & right) {
+			return left.second->front()->size * (left.second->size() - 1) > right.second->front()->size * (right.second->size() - 1);
+		});
+		for (auto & [hash, locations] : copies) {
+			os << L"Procedure " << hex << setfill(L'0') << right << setw(16) << hash << dec;
+			os << L" : " << locations->size() << L" copies of " << locations->front()->size << L" bytes" << endl;
+			for (auto location : *locations) {
+				os << L"  " << location->source << L" " << location->segment << L"." << location->procedure << L" (" << location->segmentName << L")" << endl;
+			}
+		}
+		os << L"Procedures : " << entries.size() << L", " << groups.size() << L" distinct" << endl;
+		os << L"Bytes in copies : " << duplicateBytes << endl;
+	}
+
+	std::map<std::pair<std::uint64_t, std::size_t>, ProcedureLocation> DuplicateIndex::firstCopies() const {
+		map<pair<uint64_t, size_t>, ProcedureLocation> result;
+		for (auto & entry : entries) {
+			result.insert({ { entry.hash, entry.location.size }, entry.location });
+		}
+		return result;
+	}
+
+	bool RenderedProcedures::elideCopies = false;
+	thread_local std::wstring RenderedProcedures::source;
+
+	namespace {
+
+		/* Only read while the files are listed, so needs no lock. */
+		map<pair<uint64_t, size_t>, ProcedureLocation> rendered;
+
+	}
+
+	void RenderedProcedures::listFirst(DuplicateIndex const & corpus) {
+		rendered = corpus.firstCopies();
+	}
+
+	std::optional<ProcedureLocation> RenderedProcedures::original(std::uint64_t hash, ProcedureLocation const & location) {
+		auto entry = rendered.find({ hash, location.size });
+		if (entry == rendered.end()) {
+			return nullopt;
+		}
+		auto & first = entry->second;
+		bool same = first.source == location.source && first.segment == location.segment && first.procedure == location.procedure;
+		return same ? nullopt : optional<ProcedureLocation>{ first };
+	}
+
+}
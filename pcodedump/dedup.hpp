@@ -0,0 +1,85 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _320E6B6A_6CC0_49D0_A4BA_5FEA0774095B
+#define _320E6B6A_6CC0_49D0_A4BA_5FEA0774095B
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+namespace pcodedump {
+
+	class PcodeFile;
+
+	/* Where a procedure is: the code file, and the segment and procedure number within it. */
+	struct ProcedureLocation {
+		std::wstring source;
+		std::wstring segmentName;
+		int segment;
+		int procedure;
+		std::size_t size;
+	};
+
+	/* The procedures of a batch of code files, by the hash of their normalised code. Procedures
+	   with the same hash and size are taken to be copies of each other, such as the procedures
+	   of a unit that has been linked into many programs. */
+	class DuplicateIndex {
+	public:
+		void add(std::wstring const & source, PcodeFile const & file);
+		void add(DuplicateIndex const & other);
+
+		void write(std::wostream & os) const;
+
+		/* The first copy of each procedure, in the order they were added. */
+		std::map<std::pair<std::uint64_t, std::size_t>, ProcedureLocation> firstCopies() const;
+
+	private:
+		struct Entry {
+			std::uint64_t hash;
+			ProcedureLocation location;
+		};
+
+		std::vector<Entry> entries;
+
+	public:
+		static bool showDuplicates;
+	};
+
+	/* The procedures of every file being listed, found before any of them are disassembled.
+	   The first copy of a procedure in input order is disassembled, and the rest refer to it,
+	   however the files are shared out between worker threads. */
+	class RenderedProcedures {
+	public:
+		static void listFirst(DuplicateIndex const & corpus);
+
+		/* Where the procedure is listed, or nothing if this is the copy that is listed. */
+		static std::optional<ProcedureLocation> original(std::uint64_t hash, ProcedureLocation const & location);
+
+		static bool elideCopies;
+
+		/* The code file being listed by this thread. */
+		static thread_local std::wstring source;
+	};
+
+}
+
+#endif // !_320E6B6A_6CC0_49D0_A4BA_5FEA0774095B
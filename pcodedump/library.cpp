@@ -0,0 +1,100 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "library.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "mappedfile.hpp"
+#include "textio.hpp"
+
+#include <filesystem>
+#include <algorithm>
+#include <boost/algorithm/string/trim.hpp>
+
+using namespace std;
+
+namespace pcodedump {
+
+	vector<string> LibraryIndex::libraryFiles;
+
+	void LibraryIndex::add(std::wstring const & library, PcodeFile const & file) {
+		for (auto & segment : file.getSegments()) {
+			units.push_back({ library, boost::trim_copy(segment->getName()), segment->getSegmentNumber(), segment->getSegmentKind() });
+			bySegment.insert({ units.back().segmentNumber, units.size() - 1 });
+			byName.insert({ units.back().name, units.size() - 1 });
+		}
+	}
+
+	LibraryIndex::Unit const * LibraryIndex::findSegment(int segmentNumber) const {
+		auto found = bySegment.find(segmentNumber);
+		return found != bySegment.end() ? &units[found->second] : nullptr;
+	}
+
+	LibraryIndex::Unit const * LibraryIndex::findUnit(std::wstring const & name) const {
+		auto found = byName.find(boost::trim_copy(name));
+		return found != byName.end() ? &units[found->second] : nullptr;
+	}
+
+	namespace {
+
+		void writeUnit(std::wostream & os, LibraryIndex::Unit const * unit) {
+			if (unit) {
+				os << unit->name << L" (" << unit->kind << L") segment " << unit->segmentNumber << L" in " << unit->library << endl;
+			} else {
+				os << L"not found" << endl;
+			}
+		}
+
+	}
+
+	void LibraryIndex::write(std::wostream & os, PcodeFile const & file) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		os << dec << L"Library units:" << endl;
+		auto flags = file.intrinsicSegments();
+		for (int segmentNumber = 0; segmentNumber != 64; ++segmentNumber) {
+			if (flags >> segmentNumber & 0x1) {
+				os << L"  Intrinsic segment " << segmentNumber << L" : ";
+				writeUnit(os, findSegment(segmentNumber));
+			}
+		}
+		auto & segments = file.getSegments();
+		if (any_of(segments.begin(), segments.end(), [](auto & segment) { return segment->isVersionIV(); })) {
+			os << L"  Intrinsic segments : not recorded in a Version IV code file" << endl;
+		}
+		for (auto & segment : file.getSegments()) {
+			auto kind = segment->getSegmentKind();
+			if (kind == SegmentKind::unitseg || kind == SegmentKind::unlinkedIntrins) {
+				os << L"  Segment " << segment->getSegmentNumber() << L" " << boost::trim_copy(segment->getName()) << L" (" << kind << L") : ";
+				writeUnit(os, findUnit(segment->getName()));
+			}
+		}
+		os << endl;
+	}
+
+	/* A static local is initialised once, even when worker threads ask for it together. */
+	LibraryIndex const & LibraryIndex::libraries() {
+		static LibraryIndex const index = [] {
+			LibraryIndex result;
+			for (auto & filename : libraryFiles) {
+				MappedFile input{ filename };
+				result.add(filesystem::path(filename).filename().wstring(), PcodeFile{ input.data() });
+			}
+			return result;
+		}();
+		return index;
+	}
+
+}
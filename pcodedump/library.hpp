@@ -0,0 +1,66 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _1A9766F5_60A7_4385_99EE_AAB63A40837D
+#define _1A9766F5_60A7_4385_99EE_AAB63A40837D
+
+#include "segment.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace pcodedump {
+
+	class PcodeFile;
+
+	/* The units of one or more libraries, such as SYSTEM.LIBRARY, by segment number and by name.
+	   Intrinsic units are found by the segment numbers in the intrinsic unit flags of a code file,
+	   and units still to be linked are found by name. Where libraries have units with the same
+	   number or name, the first library given wins, as it would when linking. */
+	class LibraryIndex {
+	public:
+		struct Unit {
+			std::wstring library;
+			std::wstring name;
+			int segmentNumber;
+			SegmentKind kind;
+		};
+
+		void add(std::wstring const & library, PcodeFile const & file);
+
+		Unit const * findSegment(int segmentNumber) const;
+		Unit const * findUnit(std::wstring const & name) const;
+
+		/* Write what each intrinsic unit flag and unit segment of a code file resolves to. */
+		void write(std::wostream & os, PcodeFile const & file) const;
+
+		/* The index of the libraries given. They are read the first time the index is asked for,
+		   and only once however many code files are resolved against them. */
+		static LibraryIndex const & libraries();
+
+		static std::vector<std::string> libraryFiles;
+
+	private:
+		std::vector<Unit> units;
+		std::map<int, std::size_t> bySegment;
+		std::map<std::wstring, std::size_t> byName;
+	};
+
+}
+
+#endif // !_1A9766F5_60A7_4385_99EE_AAB63A40837D
@@ -22,6 +22,7 @@
 #include <map>
 #include <iomanip>
 #include <memory>
+#include <stdexcept>
 #include <boost/algorithm/string.hpp>
 
 using namespace std;
@@ -307,6 +308,9 @@ namespace pcodedump {
 		uint8_t const * currentBase = linkageBase;
 		do {
 			result.push_back(readLinkRecord(segment, currentBase));
+			if (!result.back()) {
+				throw runtime_error("Unrecognised linkage record");
+			}
 			currentBase = result.back()->end();
 		} while (!result.back()->endOfLinkage());
 		return result;
@@ -0,0 +1,171 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "linker.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "linkage.hpp"
+#include "textio.hpp"
+
+#include <map>
+#include <functional>
+#include <algorithm>
+#include <boost/algorithm/string/trim.hpp>
+
+using namespace std;
+
+namespace pcodedump {
+
+	bool SymbolTable::checkLinks = false;
+
+	namespace {
+
+		map<SymbolKind, wstring> symbolKind = {
+			{SymbolKind::unit,           L"Unit"},
+			{SymbolKind::global,         L"Global"},
+			{SymbolKind::publicVariable, L"Public"},
+			{SymbolKind::constant,       L"Constant"},
+			{SymbolKind::routine,        L"Routine"},
+		};
+
+		/* The symbol that a link record defines or refers to, if it is one that is resolved by
+		   name. External routines of a host are satisfied by separate routines. */
+		map<LinkageType, pair<SymbolKind, bool>> const linkSymbols = {
+			{ LinkageType::unitRef,  { SymbolKind::unit,           false } },
+			{ LinkageType::globRef,  { SymbolKind::global,         false } },
+			{ LinkageType::publRef,  { SymbolKind::publicVariable, false } },
+			{ LinkageType::constRef, { SymbolKind::constant,       false } },
+			{ LinkageType::extProc,  { SymbolKind::routine,        false } },
+			{ LinkageType::extFunc,  { SymbolKind::routine,        false } },
+			{ LinkageType::globDef,  { SymbolKind::global,         true } },
+			{ LinkageType::publDef,  { SymbolKind::publicVariable, true } },
+			{ LinkageType::constDef, { SymbolKind::constant,       true } },
+			{ LinkageType::sepProc,  { SymbolKind::routine,        true } },
+			{ LinkageType::sepFunc,  { SymbolKind::routine,        true } },
+		};
+
+		void writeSites(std::wostream & os, vector<SymbolSite> const & sites) {
+			wstring sep = L"";
+			for (auto & site : sites) {
+				os << sep << site.source << L" " << site.segment << L" (" << site.segmentName << L")";
+				sep = L", ";
+			}
+		}
+
+	}
+
+	std::wostream& operator<<(std::wostream& os, SymbolKind value) {
+		os << symbolKind[value];
+		return os;
+	}
+
+	std::size_t SymbolTable::SymbolHash::operator()(Symbol const & symbol) const {
+		return hash<wstring>{}(symbol.name) * 31 + static_cast<size_t>(symbol.kind);
+	}
+
+	void SymbolTable::define(Symbol const & symbol, SymbolSite const & site) {
+		symbols[symbol].definitions.push_back(site);
+	}
+
+	/* A segment is listed once however many times it refers to a symbol. */
+	void SymbolTable::refer(Symbol const & symbol, SymbolSite const & site) {
+		auto & references = symbols[symbol].references;
+		if (references.empty() || references.back().source != site.source || references.back().segment != site.segment) {
+			references.push_back(site);
+		}
+	}
+
+	/* Unit segments and linked intrinsic units define their units. The link records of a
+	   segment are only read if it has any. */
+	void SymbolTable::add(std::wstring const & source, PcodeFile const & file) {
+		for (auto & segment : file.getSegments()) {
+			SymbolSite site{ source, boost::trim_copy(segment->getName()), segment->getSegmentNumber() };
+			auto kind = segment->getSegmentKind();
+			if (kind == SegmentKind::unitseg || kind == SegmentKind::linkedIntrins) {
+				define({ SymbolKind::unit, site.segmentName }, site);
+			}
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			auto linkageInfo = codeSegment ? codeSegment->getLinkageInfo() : nullptr;
+			if (linkageInfo) {
+				for (auto & record : linkageInfo->getLinkRecords()) {
+					auto found = linkSymbols.find(record->linkRecordType());
+					if (found != linkSymbols.end()) {
+						Symbol symbol{ found->second.first, record->getName() };
+						if (found->second.second) {
+							define(symbol, site);
+						} else {
+							refer(symbol, site);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void SymbolTable::add(SymbolTable const & other) {
+		for (auto & [symbol, entry] : other.symbols) {
+			auto & mine = symbols[symbol];
+			mine.definitions.insert(mine.definitions.end(), entry.definitions.begin(), entry.definitions.end());
+			mine.references.insert(mine.references.end(), entry.references.begin(), entry.references.end());
+		}
+	}
+
+	/* Symbols are written in order of kind and name. A symbol that is defined but never
+	   referred to isn't written. */
+	int SymbolTable::write(std::wostream & os) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		vector<pair<Symbol const *, Entry const *>> sorted;
+		for (auto & [symbol, entry] : symbols) {
+			sorted.push_back({ &symbol, &entry });
+		}
+		sort(sorted.begin(), sorted.end(), [](auto & left, auto & right) {
+			return left.first->kind != right.first->kind ? left.first->kind < right.first->kind : left.first->name < right.first->name;
+		});
+		int unresolved = 0;
+		int duplicated = 0;
+		os << dec << L"Unresolved symbols:" << endl;
+		for (auto & [symbol, entry] : sorted) {
+			if (entry->definitions.empty()) {
+				os << L"  " << symbol->kind << L" " << symbol->name << L" : referred to by ";
+				writeSites(os, entry->references);
+				os << endl;
+				++unresolved;
+			}
+		}
+		os << L"Duplicate symbols:" << endl;
+		for (auto & [symbol, entry] : sorted) {
+			if (entry->definitions.size() > 1) {
+				os << L"  " << symbol->kind << L" " << symbol->name << L" : defined by ";
+				writeSites(os, entry->definitions);
+				os << endl;
+				++duplicated;
+			}
+		}
+		os << L"Resolved symbols:" << endl;
+		for (auto & [symbol, entry] : sorted) {
+			if (!entry->definitions.empty() && !entry->references.empty()) {
+				os << L"  " << symbol->kind << L" " << symbol->name << L" : ";
+				writeSites(os, { entry->definitions.front() });
+				os << L" for ";
+				writeSites(os, entry->references);
+				os << endl;
+			}
+		}
+		os << L"Symbols : " << symbols.size() << L", " << unresolved << L" unresolved, " << duplicated << L" duplicate" << endl;
+		return unresolved + duplicated;
+	}
+
+}
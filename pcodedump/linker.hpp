@@ -0,0 +1,87 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _BFCDB197_2BA0_4992_B678_C280F40EAAD0
+#define _BFCDB197_2BA0_4992_B678_C280F40EAAD0
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+namespace pcodedump {
+
+	class PcodeFile;
+
+	/* The name spaces that the linker resolves references in. Units are defined by unit
+	   segments, routines by the separate procedures and functions of assembly code, and the
+	   rest by the definition records of the same kind. */
+	enum class SymbolKind { unit, global, publicVariable, constant, routine };
+
+	std::wostream& operator<<(std::wostream& os, SymbolKind value);
+
+	/* Where a symbol is defined or referenced: the code file and the segment within it. */
+	struct SymbolSite {
+		std::wstring source;
+		std::wstring segmentName;
+		int segment;
+	};
+
+	/* The global symbols of a set of host and library code files, as the linker would see them:
+	   the definitions of each symbol, and the segments that refer to it. Private references are
+	   allocated by the linker rather than resolved, so they aren't symbols. */
+	class SymbolTable {
+	public:
+		void add(std::wstring const & source, PcodeFile const & file);
+		void add(SymbolTable const & other);
+
+		/* Write the symbols that are unresolved, defined more than once, and resolved, with
+		   the file that satisfies each one. Returns the number that are unresolved or defined
+		   more than once. */
+		int write(std::wostream & os) const;
+
+	private:
+		struct Symbol {
+			SymbolKind kind;
+			std::wstring name;
+
+			bool operator==(Symbol const & other) const {
+				return kind == other.kind && name == other.name;
+			}
+		};
+
+		struct SymbolHash {
+			std::size_t operator()(Symbol const & symbol) const;
+		};
+
+		struct Entry {
+			std::vector<SymbolSite> definitions;
+			std::vector<SymbolSite> references;
+		};
+
+		void define(Symbol const & symbol, SymbolSite const & site);
+		void refer(Symbol const & symbol, SymbolSite const & site);
+
+		std::unordered_map<Symbol, Entry, SymbolHash> symbols;
+
+	public:
+		static bool checkLinks;
+	};
+
+}
+
+#endif // !_BFCDB197_2BA0_4992_B678_C280F40EAAD0
@@ -0,0 +1,53 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "mappedfile.hpp"
+
+#include <string>
+#include <stdexcept>
+
+using namespace std;
+using namespace boost::interprocess;
+
+namespace pcodedump {
+
+	namespace {
+
+		filesystem::path const & checkFile(filesystem::path const & filename) {
+			if (!filesystem::is_regular_file(filename)) {
+				throw runtime_error(string("File not found: ") + filename.string());
+			}
+			return filename;
+		}
+
+	}
+
+	/* An empty file can't be mapped, so it is left with an empty region. */
+	MappedFile::MappedFile(filesystem::path const & filename) :
+		mapping{ checkFile(filename).string().c_str(), read_only },
+		region{}
+	{
+		if (filesystem::file_size(filename) != 0) {
+			mapped_region{ mapping, read_only }.swap(region);
+		}
+	}
+
+	Range<uint8_t const> MappedFile::data() const {
+		auto begin = static_cast<uint8_t const *>(region.get_address());
+		return Range<uint8_t const>{ begin, begin + region.get_size() };
+	}
+
+}
@@ -0,0 +1,48 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _FEA6AB13_DF16_44A9_B3F5_1B29905B97A6
+#define _FEA6AB13_DF16_44A9_B3F5_1B29905B97A6
+
+#include "types.hpp"
+
+#include <cstdint>
+#include <filesystem>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace pcodedump {
+
+	/* A read only memory mapping of a complete input file. Everything decoded from the file is
+	   placed directly over the mapped bytes, so the file is never copied. */
+	class MappedFile final {
+	public:
+		MappedFile(const MappedFile &) = delete;
+		MappedFile & operator=(const MappedFile &) = delete;
+
+		explicit MappedFile(std::filesystem::path const & filename);
+
+		Range<std::uint8_t const> data() const;
+
+	private:
+		boost::interprocess::file_mapping mapping;
+		boost::interprocess::mapped_region region;
+	};
+
+}
+
+#endif // !_FEA6AB13_DF16_44A9_B3F5_1B29905B97A6
@@ -0,0 +1,282 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "native.hpp"
+#include "native6502.hpp"
+#include "nativez80.hpp"
+#include "segment.hpp"
+#include "linkage.hpp"
+
+#include <iterator>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+
+using namespace std;
+using namespace boost::endian;
+
+namespace pcodedump {
+
+	class NativeProcedure::AttributeTable {
+	private:
+		AttributeTable() = delete;
+		AttributeTable(const AttributeTable &) = delete;
+		AttributeTable(const AttributeTable &&) = delete;
+		AttributeTable & operator=(const AttributeTable &) = delete;
+		AttributeTable & operator=(const AttributeTable &&) = delete;
+
+	public:
+		static AttributeTable const & place(std::uint8_t const * tabStart);
+		boost::endian::little_uint16_t enterIc;
+		boost::endian::little_uint8_t procedureNumber;
+		boost::endian::little_uint8_t relocationSeg;
+	};
+
+	NativeProcedure::AttributeTable const & NativeProcedure::AttributeTable::place(std::uint8_t const * tabStart) {
+		return pcodedump::place<AttributeTable>(tabStart);
+	}
+
+	NativeProcedure::NativeProcedure(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> data, std::wstring const & description) :
+		base(codePart, procedureNumber, data),
+		attributeTable{ AttributeTable::place(data.end() - sizeof(AttributeTable)) },
+		description{ description }
+	{
+		this->procEnd = data.end() - sizeof(AttributeTable);
+		for (auto table : { &baseRelocations, &segRelocations, &procRelocations, &interpRelocations }) {
+			procEnd = readRelocations(*table, procEnd);
+		}
+	}
+
+	/* Read one of the 4 native procedure relocation tables. Return a pointer to the start of the table. */
+	uint8_t const * NativeProcedure::readRelocations(Relocations &table, uint8_t const * rawTable) {
+		auto current = rawTable;
+		current -= sizeof(little_uint16_t);
+		int total = *reinterpret_cast<little_uint16_t const *>(current);
+		for (int count = 0; count != total; ++count) {
+			current -= sizeof(little_uint16_t);
+			table.push_back(derefSelfPtr(current));
+		}
+		return current;
+	}
+
+	void NativeProcedure::writeHeader(std::wostream & os) const {
+		auto procBegin = data.begin();
+		auto procLength = data.end() - data.begin();
+		os << "Proc #" << dec << setfill(L' ') << left << setw(4) << procedureNumber << L" (";
+		os << hex << setfill(L'0') << right << setw(4) << distance(codePart.begin(), procBegin) << ":" << setw(4) << distance(codePart.begin(), procBegin) + procLength - 1<< ") " << description << "  ";
+		os << endl;
+	}
+
+	/* Without a decoder, the code is written as data, eight bytes to a line. */
+	void NativeProcedure::disassembleRange(std::wostream & os, linkref_map_t &, std::size_t first, std::size_t last) const {
+		auto end = min(procEnd, data.begin() + last);
+		for (auto ic = data.begin() + first; ic < end; ic += min<ptrdiff_t>(8, end - ic)) {
+			printIc(os, ic);
+			writeData(os, ic, min(ic + 8, end));
+		}
+	}
+
+	vector<bool> NativeProcedure::getInstructionStarts() const {
+		return vector<bool>(getSize());
+	}
+
+	/* Any address relocated to the segment that is inside another procedure is taken to be a
+	   call to that procedure, unless it's a reference to be resolved by the linker. */
+	CallList NativeProcedure::getCalls(linkref_map_t const & linkage) const {
+		CallList result;
+		int segment = codePart.getSegmentNumber();
+		for (auto address : segRelocations) {
+			if (!linkage.count(address)) {
+				auto target = codePart.begin() + *reinterpret_cast<little_uint16_t const *>(address);
+				auto targetProc = codePart.findProcedure(target);
+				if (targetProc && targetProc != this) {
+					result.push_back({ segment, targetProc->getProcedureNumber() });
+				}
+			}
+		}
+		return result;
+	}
+
+	/* Addresses relocated to the segment, the base or the interpreter depend on where the code
+	   is loaded, as do addresses set by the linker. Addresses relocated to the procedure don't.
+	   The attribute table holds the procedure number and the segment to relocate to. */
+	vector<uint8_t> NativeProcedure::getNormalisedCode(linkref_map_t const & linkage) const {
+		vector<uint8_t> result(data.begin(), data.end());
+		auto clear = [&](uint8_t const * address) {
+			if (data.begin() <= address && address + 2 <= data.end()) {
+				auto offset = address - data.begin();
+				result[offset] = result[offset + 1] = 0;
+			}
+		};
+		for (auto table : { &baseRelocations, &segRelocations, &interpRelocations }) {
+			for (auto address : *table) {
+				clear(address);
+			}
+		}
+		for (auto field = linkage.lower_bound(data.begin()); field != linkage.end() && field->first < data.end(); ++field) {
+			clear(field->first);
+		}
+		result[result.size() - 2] = result[result.size() - 1] = 0;
+		return result;
+	}
+
+	std::vector<NativeProcedure::Instruction> NativeProcedure::getDecodedInstructions() const {
+		return {};
+	}
+
+	std::wstring NativeProcedure::getMnemonic(Instruction const &) const {
+		return L"";
+	}
+
+	std::wstring NativeProcedure::getProcessor() const {
+		return L"";
+	}
+
+	std::uint8_t const * NativeProcedure::getEnterIc() const {
+		return derefSelfPtr(reinterpret_cast<std::uint8_t const *>(&attributeTable.enterIc));
+	}
+
+	std::vector<std::uint16_t> NativeProcedure::getRelocations(Relocation kind) const {
+		auto & table = kind == Relocation::base ? baseRelocations : kind == Relocation::segment ? segRelocations : kind == Relocation::procedure ? procRelocations : interpRelocations;
+		vector<uint16_t> result;
+		for (auto address : table) {
+			result.push_back(static_cast<uint16_t>(address - data.begin()));
+		}
+		return result;
+	}
+
+	int NativeProcedure::getRelocationSegment() const {
+		return attributeTable.relocationSeg;
+	}
+
+	std::uint16_t NativeProcedure::getEnterOffset() const {
+		return static_cast<uint16_t>(getEnterIc() - data.begin());
+	}
+
+	std::uint16_t NativeProcedure::getCodeSize() const {
+		return static_cast<uint16_t>(procEnd - data.begin());
+	}
+
+	/* Write the instruction address, relative to the segment start.  Indicate the procedure entry point. */
+	void NativeProcedure::printIc(std::wostream & os, std::uint8_t const * current) const {
+		if (getEnterIc() == current) {
+			os << L"  ENTER:" << endl;
+		}
+		os << L"   ";
+		os << hex << setfill(L'0') << right << setw(4) <<  current - this->getProcBegin() << L": ";
+	}
+
+	/* Format a sequence of bytes as a string of space separated 2-digit hex values. */
+	wstring NativeProcedure::toHexString(uint8_t const * begin, uint8_t const * end) {
+		wostringstream buff;
+		buff << hex << uppercase << setfill(L'0') << right;
+		if (begin != end) {
+			buff << setw(2) << *begin;
+		}
+		for (auto current = begin + 1; current != end; ++current) {
+			buff << L" " << setw(2) << *current;
+		}
+		return buff.str();
+	}
+
+	/* Bytes that aren't code. */
+	void NativeProcedure::writeData(std::wostream & os, std::uint8_t const * begin, std::uint8_t const * end) const {
+		os << setfill(L' ') << left << setw(10) << L"" << L".BYTE ";
+		for (auto current = begin; current != end; ++current) {
+			os << (current == begin ? L"$" : L",$") << hex << uppercase << setfill(L'0') << right << setw(2) << *current;
+		}
+		os << nouppercase << endl;
+	}
+
+	namespace {
+
+		template <typename T>
+		bool contains(vector<T> vect, T value) {
+			return find(cbegin(vect), cend(vect), value) != cend(vect);
+		}
+
+	}
+
+	/* Format a 16-bit absolute address for display.  The address is embedded in an instruction.
+	   If the address is referred to by either the segment or interpreter relocation tables, indicate
+	   this in the formatting. */
+	wstring NativeProcedure::formatAddress(uint8_t const * address, linkref_map_t & linkage) const {
+		auto value = *reinterpret_cast<little_uint16_t const *>(address);
+		wostringstream result;
+		if (pcodedump::contains(segRelocations, address)) {
+			uint8_t const * target = codePart.begin() + value;
+			Procedure const * targetProc = codePart.findProcedure(target);
+			if (targetProc && !linkage.count(address)) {
+				value = static_cast<int>(target - targetProc->getProcBegin());
+				result << L".proc#" << dec << targetProc->getProcedureNumber() << L"+";
+			} else {
+				result << L".seg+";
+			}
+		} else if (pcodedump::contains(interpRelocations, address)) {
+			result << L".interp+";
+		} else if (pcodedump::contains(baseRelocations, address)) {
+			if (attributeTable.relocationSeg != 0) {
+				result << L".seg#" << dec << attributeTable.relocationSeg << L"+";
+			} else {
+				result << L".base+";
+			}
+		} else if (pcodedump::contains(procRelocations, address)) {
+			result << L".proc+";
+		}
+		if (linkage.count(address)) {
+			result << L"<" << linkage[address]->getName() << L">";
+		}
+		if (linkage.count(address) && value != 0) {
+			result << L"+";
+		}
+		if (!linkage.count(address) || value != 0) {
+			result << L"$" << uppercase << hex << setfill(L'0') << right << setw(4) << value;
+		}
+		return result.str();
+	}
+
+	namespace {
+
+		template <typename T, typename... Args>
+		NativeDecoder decoder(Args... args) {
+			return [=](CodePart & codePart, int procedureNumber, Range<std::uint8_t const> range) {
+				return make_shared<T>(codePart, procedureNumber, range, args...);
+			};
+		}
+
+		map<MachineType, NativeDecoder> const decoders = {
+			{ MachineType::undentified,  decoder<Native6502Procedure>() },
+			{ MachineType::pcode_big,    decoder<NativeProcedure>(wstring(L"Native")) },
+			{ MachineType::pcode_little, decoder<Native6502Procedure>() },
+			{ MachineType::native_m6502, decoder<Native6502Procedure>() },
+			{ MachineType::native_m8080, decoder<NativeZ80Procedure>(NativeZ80Procedure::Dialect::i8080) },
+			{ MachineType::native_z80,   decoder<NativeZ80Procedure>(NativeZ80Procedure::Dialect::z80) },
+		};
+
+	}
+
+	NativeDecoder nativeDecoder(MachineType machineType) {
+		auto found = decoders.find(machineType);
+		if (found != decoders.end()) {
+			return found->second;
+		}
+		wostringstream description;
+		description << machineType;
+		return decoder<NativeProcedure>(description.str());
+	}
+
+}
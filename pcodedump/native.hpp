@@ -0,0 +1,113 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _EA85D314_CE68_4A33_844F_D02F852C7931
+#define _EA85D314_CE68_4A33_844F_D02F852C7931
+
+#include "basecode.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <memory>
+#include <functional>
+#include <vector>
+#include <string>
+
+namespace pcodedump {
+
+	enum class MachineType;
+
+	/* A procedure of native code. Every processor lays out an assembly procedure the same way:
+	   the code, then four tables of the addresses to relocate, then an attribute table with the
+	   entry point. The base writes the code as data, for processors that have no decoder. */
+	class NativeProcedure : public Procedure {
+	public:
+		using base = Procedure;
+		NativeProcedure(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> range, std::wstring const & description);
+
+		std::optional<int> getLexicalLevel() const override {
+			return std::nullopt;
+		}
+
+		void writeHeader(std::wostream& os) const override;
+		void disassembleRange(std::wostream& os, linkref_map_t & linkage, std::size_t first, std::size_t last) const override;
+		std::vector<bool> getInstructionStarts() const override;
+		CallList getCalls(linkref_map_t const & linkage) const override;
+		std::vector<std::uint8_t> getNormalisedCode(linkref_map_t const & linkage) const override;
+
+		enum class Relocation { base, segment, procedure, interpreter };
+
+		/* The offsets, from the start of the procedure, of the addresses relocated one way. */
+		std::vector<std::uint16_t> getRelocations(Relocation kind) const;
+		/* The segment that base relocated addresses are in, or zero for the base. */
+		int getRelocationSegment() const;
+		/* The offset of the entry point and the size of the code, from the start of the procedure. */
+		std::uint16_t getEnterOffset() const;
+		std::uint16_t getCodeSize() const;
+
+		/* An instruction found by the decoder for a processor: its offset from the start of the
+		   procedure, its size, and where its operands are within it. The opcode of a prefixed
+		   instruction has the prefixes in its higher bytes. */
+		struct Instruction {
+			std::uint16_t offset;
+			std::uint8_t size;
+			std::uint8_t operandOffset;
+			std::uint8_t operandSize;
+			std::uint32_t opcode;
+		};
+
+		/* The instructions of the code, in address order. There are none for a processor that
+		   has no decoder. */
+		virtual std::vector<Instruction> getDecodedInstructions() const;
+		/* The mnemonic of an instruction, without its operands. */
+		virtual std::wstring getMnemonic(Instruction const & instruction) const;
+		/* The processor that the code is decoded for, or empty if it isn't decoded. */
+		virtual std::wstring getProcessor() const;
+
+	protected:
+		using Relocations = std::vector<std::uint8_t const *>;
+
+		std::uint8_t const * getEnterIc() const;
+		void printIc(std::wostream& os, std::uint8_t const * current) const;
+		std::wstring formatAddress(std::uint8_t const * address, linkref_map_t & linkage) const;
+		void writeData(std::wostream& os, std::uint8_t const * begin, std::uint8_t const * end) const;
+		static std::wstring toHexString(std::uint8_t const * begin, std::uint8_t const * end);
+
+		class AttributeTable;
+		AttributeTable const & attributeTable;
+		uint8_t const * procEnd;
+
+		Relocations baseRelocations;
+		Relocations segRelocations;
+		Relocations procRelocations;
+		Relocations interpRelocations;
+
+	private:
+		static std::uint8_t const * readRelocations(Relocations &table, std::uint8_t const * rawTable);
+
+		std::wstring description;
+	};
+
+	/* Makes the object for a native procedure of a segment. */
+	using NativeDecoder = std::function<std::shared_ptr<Procedure const>(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> range)>;
+
+	/* The decoder for the native procedures of segments of a machine type. Little-endian p-code
+	   segments hold 6502 procedures, as on the Apple II. Machine types that have no decoder of
+	   their own get one that writes the code as data. */
+	NativeDecoder nativeDecoder(MachineType machineType);
+
+}
+
+#endif // !_EA85D314_CE68_4A33_844F_D02F852C7931
@@ -20,86 +20,57 @@
 #include "types.hpp"
 #include "options.hpp"
 #include "linkage.hpp"
+#include "opcodes6502.hpp"
 
 #include <iterator>
+#include <optional>
+#include <vector>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 #include <iostream>
-#include <functional>
 
 using namespace std;
-using namespace std::placeholders;
 using namespace boost::endian;
 
 namespace pcodedump {
 
-	namespace {
-
-		/* Format a sequence of bytes as a string of space separated 2-digit hex values. */
-		wstring toHexString(uint8_t const * begin, uint8_t const * end) {
-			wostringstream buff;
-			buff << hex << uppercase << setfill(L'0') << right;
-			if (begin != end) {
-				buff << setw(2) << *begin;
-			}
-			for (auto current = begin + 1; current != end; ++current) {
-				buff << L" " << setw(2) << *current;
-			}
-			return buff.str();
-		}
-
-	}
-
-	class Native6502Procedure::AttributeTable {
-	private:
-		AttributeTable() = delete;
-		AttributeTable(const AttributeTable &) = delete;
-		AttributeTable(const AttributeTable &&) = delete;
-		AttributeTable & operator=(const AttributeTable &) = delete;
-		AttributeTable & operator=(const AttributeTable &&) = delete;
-
-	public:
-		static AttributeTable const & place(std::uint8_t const * tabStart);
-		boost::endian::little_uint16_t enterIc;
-		boost::endian::little_uint8_t procedureNumber;
-		boost::endian::little_uint8_t relocationSeg;
-	};
-
-	Native6502Procedure::AttributeTable const & Native6502Procedure::AttributeTable::place(std::uint8_t const * tabStart) {
-		return pcodedump::place<AttributeTable>(tabStart);
-	}
-
 	class Native6502Procedure::Disassembler final {
 	public:
 		Disassembler(std::wostream & os, Native6502Procedure const & procedure, linkref_map_t & linkage);
 
-		static void initialiseCpu(cpu_t const cpu);
-		std::uint8_t const * decode(std::uint8_t const * current) const;
+		std::uint8_t const * decode(std::uint8_t const * current, int operandBytes) const;
 
 	private:
-		std::uint8_t const * decode_implied(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_immedidate(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_accumulator(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_absolute(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_absoluteindirect(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_absoluteindirectindexed(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_zeropage(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_zeropageindirect(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_absoluteindexedx(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_absoluteindexedy(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_zeropageindexedx(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_zeropageindexedy(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_relative(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_indexedindirect(std::wstring &opCode, std::uint8_t const * current) const;
-		std::uint8_t const * decode_indirectindexed(std::wstring &opCode, std::uint8_t const * current) const;
-
-		using decode_function_t = std::uint8_t const * (Disassembler::*)(std::wstring&, std::uint8_t const *) const;
-		//using decode_binding_t = decltype(bind(declval<decode_function_t>(), _1, declval<wstring &&>(), _2));
-		using decode_binding_t = function<std::uint8_t const *(Disassembler const *, std::uint8_t const *)>;
-
-		static std::vector<decode_binding_t> dispatch;
-		static std::map<int, decode_binding_t> dispatch_65c02;
+		std::uint8_t const * decode_implied(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_immedidate(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_accumulator(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_absolute(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_absoluteindirect(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_absoluteindirectindexed(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_zeropage(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_zeropageindirect(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_absoluteindexedx(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_absoluteindexedy(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_zeropageindexedx(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_zeropageindexedy(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_relative(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_indexedindirect(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_indirectindexed(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_immediatewide(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_absolutelong(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_absolutelongindexedx(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_absoluteindirectlong(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_zeropageindirectlong(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_zeropageindirectlongindexedy(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_stackrelative(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_stackrelativeindirectindexed(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_relativelong(std::wstring const &opCode, std::uint8_t const * current) const;
+		std::uint8_t const * decode_blockmove(std::wstring const &opCode, std::uint8_t const * current) const;
+
+		using decode_function_t = std::uint8_t const * (Disassembler::*)(std::wstring const &, std::uint8_t const *) const;
+
+		static decode_function_t const modeDecoders[];
 		std::wstring formatAbsoluteAddress(std::uint8_t const* address) const;
 
 		std::wostream & os;
@@ -111,533 +82,656 @@ namespace pcodedump {
 		os{ os }, procedure{ procedure }, linkage{ linkage }
 	{}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_implied(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_implied(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 1);
 		os << opCode << endl;
 		return current + 1;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_immedidate(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_immedidate(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
 		auto value = reinterpret_cast<little_uint8_t const *>(current + 1);
 		os << opCode << L" #$" << hex << setfill(L'0') << right << setw(2) << *value << endl;
 		return current + 2;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_accumulator(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_accumulator(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 1);
 		os << opCode << L" A" << endl;
 		return current + 1;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_absolute(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_absolute(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 3);
 		os << opCode << L" " << formatAbsoluteAddress(current + 1) << endl;
 		return current + 3;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_absoluteindirect(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_absoluteindirect(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 3);
 		os << opCode << L" (" << formatAbsoluteAddress(current + 1) << L")" << endl;
 		return current + 3;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_absoluteindirectindexed(std::wstring &opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_absoluteindirectindexed(std::wstring const &opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 3);
 		os << opCode << L" (" << formatAbsoluteAddress(current + 1) << L",X)" << endl;
 		return current + 3;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_zeropage(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_zeropage(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
 		auto value = reinterpret_cast<little_uint8_t const *>(current + 1);
 		os << opCode << L" $" << hex << setfill(L'0') << right << setw(2) << *value << endl;
 		return current + 2;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_zeropageindirect(std::wstring &opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_zeropageindirect(std::wstring const &opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
 		auto value = reinterpret_cast<little_uint8_t const *>(current + 1);
 		os << opCode << L" ($" << hex << setfill(L'0') << right << setw(2) << *value << L")" << endl;
 		return current + 2;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_absoluteindexedx(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_absoluteindexedx(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 3);
 		os << opCode << L" " << formatAbsoluteAddress(current + 1) << L",X" << endl;
 		return current + 3;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_absoluteindexedy(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_absoluteindexedy(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 3);
 		os << opCode << L" " << formatAbsoluteAddress(current + 1) << L",Y" << endl;
 		return current + 3;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_zeropageindexedx(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_zeropageindexedx(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
 		auto value = reinterpret_cast<little_uint8_t const *>(current + 1);
 		os << opCode << L" $" << hex << setfill(L'0') << right << setw(2) << *value << L",X" << endl;
 		return current + 2;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_zeropageindexedy(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_zeropageindexedy(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
 		auto value = reinterpret_cast<little_uint8_t const *>(current + 1);
 		os << opCode << L" $" << hex << setfill(L'0') << right << setw(2) << *value << L",Y" << endl;
 		return current + 2;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_relative(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_relative(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
 		auto value = reinterpret_cast<little_int8_t const *>(current + 1);
 		os << opCode << L" $" << hex << setfill(L'0') << right << setw(4) << distance(procedure.getProcBegin(), current + 2 + *value) << endl;
 		return current + 2;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_indexedindirect(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_indexedindirect(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
 		auto value = reinterpret_cast<little_uint8_t const *>(current + 1);
 		os << opCode << L" ($" << hex << setfill(L'0') << right << setw(2) << *value << L",X)" << endl;
 		return current + 2;
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode_indirectindexed(std::wstring & opCode, std::uint8_t const * current) const {
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_indirectindexed(std::wstring const & opCode, std::uint8_t const * current) const {
 		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
 		auto value = reinterpret_cast<little_uint8_t const *>(current + 1);
 		os << opCode << L" ($" << hex << setfill(L'0') << right << setw(2) << *value << L"),Y" << endl;
 		return current + 2;
 	}
 
-	/* Dispatch for opcodes.  For each opcode, the table contains the mneumonic and a pointer
-		the the correct method to decode the address mode.
-
-		This vector is initialised with 6502 instructions only. Later, based on program options,
-		it might be patched with opcodes for other processors. */
-	std::vector<Native6502Procedure::Disassembler::decode_binding_t> Native6502Procedure::Disassembler::dispatch = {
-		// 0x00
-		bind(&decode_implied, _1, wstring{ L"BRK" }, _2),
-		bind(&decode_indexedindirect, _1, wstring{ L"ORA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"ORA" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"ASL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"PHP" }, _2),
-		bind(&decode_immedidate, _1, wstring{ L"ORA" }, _2),
-		bind(&decode_accumulator, _1, wstring{ L"ASL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"ORA" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"ASL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0x10
-		bind(&decode_relative, _1, wstring{ L"BPL" }, _2),
-		bind(&decode_indirectindexed, _1, wstring{ L"ORA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"ORA" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"ASL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"CLC" }, _2),
-		bind(&decode_absoluteindexedy, _1, wstring{ L"ORA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"ORA" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"ASL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0x20
-		bind(&decode_absolute, _1, wstring{ L"JSR" }, _2),
-		bind(&decode_indexedindirect, _1, wstring{ L"AND" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"BIT" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"AND" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"ROL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"PLP" }, _2),
-		bind(&decode_immedidate, _1, wstring{ L"AND" }, _2),
-		bind(&decode_accumulator, _1, wstring{ L"ROL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"BIT" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"AND" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"ROL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0x30
-		bind(&decode_relative, _1, wstring{ L"BMI" }, _2),
-		bind(&decode_indirectindexed, _1, wstring{ L"AND" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"AND" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"ROL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SEC" }, _2),
-		bind(&decode_absoluteindexedy, _1, wstring{ L"AND" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"AND" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"ROL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0x40
-		bind(&decode_implied, _1, wstring{ L"RTI" }, _2),
-		bind(&decode_indexedindirect, _1, wstring{ L"EOR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"EOR" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"LSR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"PHA" }, _2),
-		bind(&decode_immedidate, _1, wstring{ L"EOR" }, _2),
-		bind(&decode_accumulator, _1, wstring{ L"LSR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"JMP" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"EOR" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"LSR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0x50
-		bind(&decode_relative, _1, wstring{ L"BVC" }, _2),
-		bind(&decode_indirectindexed, _1, wstring{ L"EOR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"EOR" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"LSR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"CLI" }, _2),
-		bind(&decode_absoluteindexedy, _1, wstring{ L"EOR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"EOR" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"LSR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0x60
-		bind(&decode_implied, _1, wstring{ L"RTS" }, _2),
-		bind(&decode_indexedindirect, _1, wstring{ L"ADC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"ADC" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"ROR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"PLA" }, _2),
-		bind(&decode_immedidate, _1, wstring{ L"ADC" }, _2),
-		bind(&decode_accumulator, _1, wstring{ L"ROR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absoluteindirect, _1, wstring{ L"JMP" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"ADC" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"ROR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0x70
-		bind(&decode_relative, _1, wstring{ L"BVS" }, _2),
-		bind(&decode_indirectindexed, _1, wstring{ L"ADC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"ADC" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"ROR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SEI" }, _2),
-		bind(&decode_absoluteindexedy, _1, wstring{ L"ADC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"ADC" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"ROR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0x80
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_indexedindirect, _1, wstring{ L"STA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"STY" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"STA" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"STX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"DEY" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"TXA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"STY" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"STA" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"STX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0x90
-		bind(&decode_relative, _1, wstring{ L"BCC" }, _2),
-		bind(&decode_indirectindexed, _1, wstring{ L"STA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"STY" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"STA" }, _2),
-		bind(&decode_zeropageindexedy, _1, wstring{ L"STX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"TYA" }, _2),
-		bind(&decode_absoluteindexedy, _1, wstring{ L"STA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"TXS" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"STA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0xA0
-		bind(&decode_immedidate, _1, wstring{ L"LDY" }, _2),
-		bind(&decode_indexedindirect, _1, wstring{ L"LDA" }, _2),
-		bind(&decode_immedidate, _1, wstring{ L"LDX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"LDY" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"LDA" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"LDX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"TAY" }, _2),
-		bind(&decode_immedidate, _1, wstring{ L"LDA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"TAX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"LDY" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"LDA" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"LDX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0xB0
-		bind(&decode_relative, _1, wstring{ L"BCS" }, _2),
-		bind(&decode_indirectindexed, _1, wstring{ L"LDA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"LDY" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"LDA" }, _2),
-		bind(&decode_zeropageindexedy, _1, wstring{ L"LDX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"CLV" }, _2),
-		bind(&decode_absoluteindexedy, _1, wstring{ L"LDA" }, _2),
-		bind(&decode_implied, _1, wstring{ L"TSX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"LDY" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"LDA" }, _2),
-		bind(&decode_absoluteindexedy, _1, wstring{ L"LDX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0xC0
-		bind(&decode_immedidate, _1, wstring{ L"CPY" }, _2),
-		bind(&decode_indexedindirect, _1, wstring{ L"CMP" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"CPY" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"CMP" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"DEC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"INY" }, _2),
-		bind(&decode_immedidate, _1, wstring{ L"CMP" }, _2),
-		bind(&decode_implied, _1, wstring{ L"DEX" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"CPY" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"CMP" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"DEC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0xD0
-		bind(&decode_relative, _1, wstring{ L"BNE" }, _2),
-		bind(&decode_indirectindexed, _1, wstring{ L"CMP" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"CMP" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"DEC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"CLD" }, _2),
-		bind(&decode_absoluteindexedy, _1, wstring{ L"CMP" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"CMP" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"DEC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0xE0
-		bind(&decode_immedidate, _1, wstring{ L"CPX" }, _2),
-		bind(&decode_indexedindirect, _1, wstring{ L"SBC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"CPX" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"SBC" }, _2),
-		bind(&decode_zeropage, _1, wstring{ L"INC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"INX" }, _2),
-		bind(&decode_immedidate, _1, wstring{ L"SBC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"NOP" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"CPX" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"SBC" }, _2),
-		bind(&decode_absolute, _1, wstring{ L"INC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		// 0xF0
-		bind(&decode_relative, _1, wstring{ L"BEQ" }, _2),
-		bind(&decode_indirectindexed, _1, wstring{ L"SBC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"SBC" }, _2),
-		bind(&decode_zeropageindexedx, _1, wstring{ L"INC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SED" }, _2),
-		bind(&decode_absoluteindexedy, _1, wstring{ L"SBC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"SBC" }, _2),
-		bind(&decode_absoluteindexedx, _1, wstring{ L"INC" }, _2),
-		bind(&decode_implied, _1, wstring{ L"???" }, _2),
-	};
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_immediatewide(std::wstring const & opCode, std::uint8_t const * current) const {
+		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 3);
+		auto value = reinterpret_cast<little_uint16_t const *>(current + 1);
+		os << opCode << L" #$" << hex << setfill(L'0') << right << setw(4) << *value << endl;
+		return current + 3;
+	}
+
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_absolutelong(std::wstring const & opCode, std::uint8_t const * current) const {
+		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 4) + L" ";
+		os << opCode << L" $" << hex << setfill(L'0') << right << setw(6) << (current[1] | current[2] << 8 | current[3] << 16) << endl;
+		return current + 4;
+	}
+
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_absolutelongindexedx(std::wstring const & opCode, std::uint8_t const * current) const {
+		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 4) + L" ";
+		os << opCode << L" $" << hex << setfill(L'0') << right << setw(6) << (current[1] | current[2] << 8 | current[3] << 16) << L",X" << endl;
+		return current + 4;
+	}
+
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_absoluteindirectlong(std::wstring const & opCode, std::uint8_t const * current) const {
+		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 3);
+		os << opCode << L" [" << formatAbsoluteAddress(current + 1) << L"]" << endl;
+		return current + 3;
+	}
+
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_zeropageindirectlong(std::wstring const & opCode, std::uint8_t const * current) const {
+		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
+		os << opCode << L" [$" << hex << setfill(L'0') << right << setw(2) << static_cast<int>(current[1]) << L"]" << endl;
+		return current + 2;
+	}
+
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_zeropageindirectlongindexedy(std::wstring const & opCode, std::uint8_t const * current) const {
+		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
+		os << opCode << L" [$" << hex << setfill(L'0') << right << setw(2) << static_cast<int>(current[1]) << L"],Y" << endl;
+		return current + 2;
+	}
+
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_stackrelative(std::wstring const & opCode, std::uint8_t const * current) const {
+		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
+		os << opCode << L" $" << hex << setfill(L'0') << right << setw(2) << static_cast<int>(current[1]) << L",S" << endl;
+		return current + 2;
+	}
+
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_stackrelativeindirectindexed(std::wstring const & opCode, std::uint8_t const * current) const {
+		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 2);
+		os << opCode << L" ($" << hex << setfill(L'0') << right << setw(2) << static_cast<int>(current[1]) << L",S),Y" << endl;
+		return current + 2;
+	}
+
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_relativelong(std::wstring const & opCode, std::uint8_t const * current) const {
+		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 3);
+		auto value = reinterpret_cast<little_int16_t const *>(current + 1);
+		os << opCode << L" $" << hex << setfill(L'0') << right << setw(4) << distance(procedure.getProcBegin(), current + 3 + *value) << endl;
+		return current + 3;
+	}
+
+	/* The operand bytes are the destination bank and then the source bank, but the source is
+	   written first. */
+	std::uint8_t const * Native6502Procedure::Disassembler::decode_blockmove(std::wstring const & opCode, std::uint8_t const * current) const {
+		os << setfill(L' ') << left << setw(10) << toHexString(current, current + 3);
+		os << opCode << L" $" << hex << setfill(L'0') << right << setw(2) << static_cast<int>(current[2]) << L",$" << setw(2) << static_cast<int>(current[1]) << endl;
+		return current + 3;
+	}
 
-	/* Opcode patches for the dispatch table if the 65c02 is chosen. */
-	std::map<int, Native6502Procedure::Disassembler::decode_binding_t> Native6502Procedure::Disassembler::dispatch_65c02 = {
-		{0x04,bind(&decode_zeropage, _1, wstring{ L"TSB" }, _2)},
-		{0x0C,bind(&decode_absolute, _1, wstring{ L"TSB" }, _2)},
-		{0x12,bind(&decode_zeropageindirect, _1, wstring{ L"ORA" }, _2)},
-		{0x14,bind(&decode_zeropage, _1, wstring{ L"TRB" }, _2)},
-		{0x1A,bind(&decode_accumulator, _1, wstring{ L"INC" }, _2)},
-		{0x1C,bind(&decode_absolute, _1, wstring{ L"TRB" }, _2)},
-		{0x32,bind(&decode_zeropage, _1, wstring{ L"AND" }, _2)},
-		{0x34,bind(&decode_zeropageindexedx, _1, wstring{ L"BIT" }, _2)},
-		{0x3A,bind(&decode_accumulator, _1, wstring{ L"DEC" }, _2)},
-		{0x3C,bind(&decode_absoluteindexedx, _1, wstring{ L"BIT" }, _2)},
-		{0x52,bind(&decode_zeropage, _1, wstring{ L"EOR" }, _2)},
-		{0x5A,bind(&decode_implied, _1, wstring{ L"PHY" }, _2)},
-		{0x64,bind(&decode_zeropage, _1, wstring{ L"STZ" }, _2)},
-		{0x72,bind(&decode_zeropage, _1, wstring{ L"ADC" }, _2)},
-		{0x74,bind(&decode_zeropageindexedx, _1, wstring{ L"STZ" }, _2)},
-		{0x7A,bind(&decode_implied, _1, wstring{ L"PLY" }, _2)},
-		{0x7C,bind(&decode_absoluteindirectindexed, _1, wstring{ L"JMP" }, _2)},
-		{0x80,bind(&decode_relative, _1, wstring{ L"BRA" }, _2)},
-		{0x89,bind(&decode_immedidate, _1, wstring{ L"BIT" }, _2)},
-		{0x92,bind(&decode_zeropage, _1, wstring{ L"STA" }, _2)},
-		{0x9C,bind(&decode_absolute, _1, wstring{ L"STZ" }, _2)},
-		{0x9E,bind(&decode_absoluteindexedx, _1, wstring{ L"STZ" }, _2)},
-		{0xB2,bind(&decode_zeropage, _1, wstring{ L"LDA" }, _2)},
-		{0xD2,bind(&decode_zeropage, _1, wstring{ L"CMP" }, _2)},
-		{0xDA,bind(&decode_implied, _1, wstring{ L"PHX" }, _2)},
-		{0xF2,bind(&decode_zeropage, _1, wstring{ L"SBC" }, _2)},
-		{0xFA,bind(&decode_implied, _1, wstring{ L"PLX" }, _2)},
+	/* Indexed by AddressMode. */
+	Native6502Procedure::Disassembler::decode_function_t const Native6502Procedure::Disassembler::modeDecoders[] = {
+		&Disassembler::decode_implied,
+		&Disassembler::decode_immedidate,
+		&Disassembler::decode_accumulator,
+		&Disassembler::decode_absolute,
+		&Disassembler::decode_absoluteindirect,
+		&Disassembler::decode_absoluteindirectindexed,
+		&Disassembler::decode_zeropage,
+		&Disassembler::decode_zeropageindirect,
+		&Disassembler::decode_absoluteindexedx,
+		&Disassembler::decode_absoluteindexedy,
+		&Disassembler::decode_zeropageindexedx,
+		&Disassembler::decode_zeropageindexedy,
+		&Disassembler::decode_relative,
+		&Disassembler::decode_indexedindirect,
+		&Disassembler::decode_indirectindexed,
+		&Disassembler::decode_immedidate,
+		&Disassembler::decode_immedidate,
+		&Disassembler::decode_absolutelong,
+		&Disassembler::decode_absolutelongindexedx,
+		&Disassembler::decode_absoluteindirectlong,
+		&Disassembler::decode_zeropageindirectlong,
+		&Disassembler::decode_zeropageindirectlongindexedy,
+		&Disassembler::decode_stackrelative,
+		&Disassembler::decode_stackrelativeindirectindexed,
+		&Disassembler::decode_relativelong,
+		&Disassembler::decode_blockmove,
 	};
 
-	void Native6502Procedure::Disassembler::initialiseCpu(cpu_t const cpu) {
-		if (cpu == cpu_t::_65c02) {
-			for (auto&[instruction, patch] : dispatch_65c02) {
-				dispatch[instruction] = patch;
-			}
+	/* An immediate operand of a 65c816 register is two bytes when the register is 16 bits. */
+	std::uint8_t const * Native6502Procedure::Disassembler::decode(std::uint8_t const * current, int operandBytes) const {
+		auto & opcode = (*procedure.opcodes)[*current];
+		if (operandBytes == 2 && (opcode.mode == AddressMode::immediateAccumulator || opcode.mode == AddressMode::immediateIndex)) {
+			return decode_immediatewide(opcode.mnemonic, current);
 		}
+		return (this->*modeDecoders[static_cast<int>(opcode.mode)])(opcode.mnemonic, current);
 	}
 
-	std::uint8_t const * Native6502Procedure::Disassembler::decode(std::uint8_t const * current) const {
-		auto opcode = *current;
-		return dispatch[opcode](this, current);
+	wstring Native6502Procedure::Disassembler::formatAbsoluteAddress(uint8_t const * address) const {
+		return procedure.formatAddress(address, linkage);
 	}
 
-	/* Read one of the 4 6502 procedure relocation tables. Return a pointer to the start of the table. */
-	uint8_t const * Native6502Procedure::readRelocations(Relocations &table, uint8_t const * rawTable) {
-		auto current = rawTable;
-		current -= sizeof(little_uint16_t);
-		int total = *reinterpret_cast<little_uint16_t const *>(current);
-		for (int count = 0; count != total; ++count) {
-			current -= sizeof(little_uint16_t);
-			table.push_back(derefSelfPtr(current));
-		}
-		return current;
+	Native6502Procedure::Native6502Procedure(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> data) :
+		base(codePart, procedureNumber, data, L"Native (6502)")
+	{}
+
+	bool Native6502Procedure::followFlow = false;
+	bool Native6502Procedure::showCycles = false;
+
+	/* The opcode and cycle tables for the CPU chosen in the program options. */
+	OpcodeTable6502 const * Native6502Procedure::opcodes = &opcodes6502;
+	CycleTable6502 const * Native6502Procedure::cycles = &cycles6502;
+
+	void Native6502Procedure::initialiseCpu(cpu_t const & cpu) {
+		opcodes = &opcodeTable(cpu);
+		cycles = &cycleTable(cpu);
 	}
 
 	namespace {
 
-		template <typename T>
-		bool contains(vector<T> vect, T value) {
-			return find(cbegin(vect), cend(vect), value) != cend(vect);
+		/* What each byte of a procedure is, or for the opcode of an instruction the size of
+		   its operand. */
+		constexpr int8_t unreached = -2;
+		constexpr int8_t operandByte = -1;
+
+		constexpr uint8_t BRK = 0x00;
+		constexpr uint8_t PHP = 0x08;
+		constexpr uint8_t JSR = 0x20;
+		constexpr uint8_t PLP = 0x28;
+		constexpr uint8_t RTI = 0x40;
+		constexpr uint8_t JMP = 0x4C;
+		constexpr uint8_t JML = 0x5C;
+		constexpr uint8_t RTS = 0x60;
+		constexpr uint8_t RTL = 0x6B;
+		constexpr uint8_t JMP_INDIRECT = 0x6C;
+		constexpr uint8_t JMP_INDEXED_INDIRECT = 0x7C;
+		constexpr uint8_t BRA = 0x80;
+		constexpr uint8_t BRL = 0x82;
+		constexpr uint8_t REP = 0xC2;
+		constexpr uint8_t JML_INDIRECT = 0xDC;
+		constexpr uint8_t SEP = 0xE2;
+		constexpr uint8_t XCE = 0xFB;
+
+		/* The widths of the 65c816 registers at an instruction, and the widths that PHP has
+		   pushed on the way there, most recent last. */
+		struct WidthState {
+			RegisterWidths widths;
+			vector<RegisterWidths> pushed;
+
+			bool operator==(WidthState const & other) const {
+				return widths == other.widths && pushed == other.pushed;
+			}
+		};
+
+		/* Where paths meet, the pushed widths are only kept if as many were pushed on each. */
+		WidthState mergeStates(WidthState const & left, WidthState const & right) {
+			WidthState result{ mergeWidths(left.widths, right.widths), {} };
+			if (left.pushed.size() == right.pushed.size()) {
+				for (size_t index = 0; index != left.pushed.size(); ++index) {
+					result.pushed.push_back(mergeWidths(left.pushed[index], right.pushed[index]));
+				}
+			}
+			return result;
+		}
+
+		/* REP clears the M and X flags to widen the 65c816 registers, and SEP sets them. PLP
+		   restores the widths that PHP pushed, and they are unknown if nothing was pushed on the
+		   way. Going in or out of emulation mode with XCE leaves the registers 8 bits wide, or
+		   as they were, so a wide register is unknown after it. */
+		WidthState stateAfter(uint8_t const * instruction, WidthState state) {
+			auto & widths = state.widths;
+			switch (instruction[0]) {
+			case REP: case SEP: {
+				bool wide = instruction[0] == REP;
+				if (instruction[1] & 0x20) {
+					widths.wideAccumulator = wide;
+					widths.unknownAccumulator = false;
+				}
+				if (instruction[1] & 0x10) {
+					widths.wideIndex = wide;
+					widths.unknownIndex = false;
+				}
+				break;
+			}
+			case PHP:
+				state.pushed.push_back(widths);
+				break;
+			case PLP:
+				if (state.pushed.empty()) {
+					widths = RegisterWidths{ false, false, true, true };
+				} else {
+					widths = state.pushed.back();
+					state.pushed.pop_back();
+				}
+				break;
+			case XCE:
+				widths = mergeWidths(widths, RegisterWidths{});
+				break;
+			}
+			return state;
 		}
 
 	}
 
-	/* Format a 16-bit absolute address for display.  The address is embedded in a 6502 instruction.
-	   If the address is referred to by either the segment or interpreter relocation tables, indicate
-	   this in the formatting. */
-	wstring Native6502Procedure::Disassembler::formatAbsoluteAddress(uint8_t const * address) const {
-		auto value = *reinterpret_cast<little_uint16_t const *>(address);
-		wostringstream result;
-		if (pcodedump::contains(procedure.segRelocations, address)) {
-			uint8_t const * target = procedure.codePart.begin() + value;
-			Procedure const * targetProc = procedure.codePart.findProcedure(target);
-			if (targetProc && !linkage.count(address)) {
-				value = static_cast<int>(target - targetProc->getProcBegin());
-				result << L".proc#" << dec << targetProc->getProcedureNumber() << L"+";
-			} else {
-				result << L".seg+";
+	/* Follow the flow of control from the entry point with a worklist, marking the bytes of each
+	   instruction that is reached. A byte is only ever decoded once, so this is linear in the
+	   size of the procedure. A JMP or JSR is only followed if its address is relocated to a place
+	   in this procedure. Indirect jumps, returns and undefined opcodes end a path, as does an
+	   instruction that would overlap one already decoded.
+
+	   For the 65c816, the widths of the registers at each instruction are found first, by
+	   following every path until they settle, and merging them where paths meet. An immediate
+	   operand for a register whose width isn't known ends a path. Code is entered with 8 bit
+	   registers. */
+	vector<int8_t> Native6502Procedure::traceCode() const {
+		auto begin = getProcBegin();
+		auto size = procEnd - begin;
+		vector<int8_t> use(size, unreached);
+		bool trackWidths = opcodes == &opcodes65c816;
+
+		vector<bool> procRelocated(size), segRelocated(size);
+		for (auto [table, marks] : { make_pair(&procRelocations, &procRelocated), make_pair(&segRelocations, &segRelocated) }) {
+			for (auto address : *table) {
+				if (begin <= address && address < procEnd) {
+					(*marks)[address - begin] = true;
+				}
 			}
-		} else if (pcodedump::contains(procedure.interpRelocations, address)) {
-			result << L".interp+";
-		} else if (pcodedump::contains(procedure.baseRelocations, address)) {
-			if (procedure.attributeTable.relocationSeg != 0) {
-				result << L".seg#" << dec << procedure.attributeTable.relocationSeg << L"+";
-			} else {
-				result << L".base+";
+		}
+		auto internalTarget = [&](ptrdiff_t operand) -> ptrdiff_t {
+			auto value = *reinterpret_cast<little_uint16_t const *>(begin + operand);
+			if (procRelocated[operand]) {
+				return value;
+			} else if (segRelocated[operand]) {
+				return codePart.begin() + value - begin;
+			}
+			return -1;
+		};
+
+		/* Where an instruction goes other than the next one, and whether it goes on to the next. */
+		auto flow = [&](ptrdiff_t offset, ptrdiff_t next) -> pair<optional<ptrdiff_t>, bool> {
+			auto opcode = begin[offset];
+			auto mode = (*opcodes)[opcode].mode;
+			if (mode == AddressMode::relative) {
+				return { next + static_cast<int8_t>(begin[offset + 1]), opcode != BRA };
+			} else if (mode == AddressMode::relativeLong) {
+				return { next + static_cast<int16_t>(begin[offset + 1] | begin[offset + 2] << 8), opcode != BRL };
+			} else if (opcode == JMP || opcode == JSR) {
+				auto target = internalTarget(offset + 1);
+				return { target >= 0 ? optional<ptrdiff_t>{ target } : nullopt, opcode != JMP };
+			}
+			bool ends = opcode == RTS || opcode == RTI || opcode == BRK || opcode == JMP_INDIRECT || opcode == JMP_INDEXED_INDIRECT
+				|| (trackWidths && (opcode == RTL || opcode == JML || opcode == JML_INDIRECT));
+			return { nullopt, !ends };
+		};
+
+		auto enter = getEnterIc() - begin;
+		vector<optional<WidthState>> states(size);
+		if (trackWidths && 0 <= enter && enter < size) {
+			states[enter] = WidthState{};
+			vector<ptrdiff_t> pending{ enter };
+			while (!pending.empty()) {
+				auto offset = pending.back();
+				pending.pop_back();
+				auto & info = (*opcodes)[begin[offset]];
+				auto & state = *states[offset];
+				auto next = offset + 1 + operandSize(info.mode, state.widths);
+				if (!info.defined() || unknownSize(info.mode, state.widths) || next > size) {
+					continue;
+				}
+				auto after = stateAfter(begin + offset, state);
+				auto [target, fallsThrough] = flow(offset, next);
+				for (auto successor : { target.value_or(-1), fallsThrough ? next : -1 }) {
+					if (0 <= successor && successor < size) {
+						auto merged = states[successor] ? mergeStates(*states[successor], after) : after;
+						if (!states[successor] || !(merged == *states[successor])) {
+							states[successor] = merged;
+							pending.push_back(successor);
+						}
+					}
+				}
+			}
+		}
+
+		vector<ptrdiff_t> work{ enter };
+		while (!work.empty()) {
+			auto offset = work.back();
+			work.pop_back();
+			while (0 <= offset && offset < size && use[offset] == unreached) {
+				auto & info = (*opcodes)[begin[offset]];
+				if (trackWidths && !states[offset]) {
+					break;
+				}
+				auto widths = trackWidths ? states[offset]->widths : RegisterWidths{};
+				auto operandBytes = operandSize(info.mode, widths);
+				auto next = offset + 1 + operandBytes;
+				if (!info.defined() || unknownSize(info.mode, widths) || next > size
+					|| any_of(&use[offset + 1], &use[0] + next, [](int8_t byte) { return byte != unreached; })) {
+					break;
+				}
+				use[offset] = static_cast<int8_t>(operandBytes);
+				fill(&use[offset + 1], &use[0] + next, operandByte);
+				auto [target, fallsThrough] = flow(offset, next);
+				if (target) {
+					work.push_back(*target);
+				}
+				if (!fallsThrough) {
+					break;
+				}
+				offset = next;
 			}
-		} else if (pcodedump::contains(procedure.procRelocations, address)) {
-			result << L".proc+";
 		}
-		if (linkage.count(address)) {
-			result << L"<" << linkage[address]->getName() << L">";
+		return use;
+	}
+
+	/* The size of the operand of each instruction, by the offset of its opcode, either following
+	   the flow of control or read one after another. An instruction that would run past the end
+	   of the code isn't included. */
+	vector<int8_t> Native6502Procedure::operandSizes() const {
+		if (followFlow) {
+			return traceCode();
 		}
-		if (linkage.count(address) && value != 0) {
-			result << L"+";
-		} 
-		if (!linkage.count(address) || value != 0) {
-			result << L"$" << uppercase << hex << setfill(L'0') << right << setw(4) << value;
+		auto begin = getProcBegin();
+		auto size = procEnd - begin;
+		vector<int8_t> result(size, unreached);
+		bool trackWidths = opcodes == &opcodes65c816;
+		WidthState state;
+		ptrdiff_t offset = 0;
+		while (offset < size) {
+			auto operandBytes = operandSize((*opcodes)[begin[offset]].mode, state.widths);
+			if (offset + 1 + operandBytes > size) {
+				break;
+			}
+			result[offset] = static_cast<int8_t>(operandBytes);
+			fill(&result[offset + 1], &result[0] + offset + 1 + operandBytes, operandByte);
+			if (trackWidths) {
+				state = stateAfter(begin + offset, state);
+			}
+			offset += 1 + operandBytes;
 		}
-		return result.str();
+		return result;
 	}
 
-	Native6502Procedure::Native6502Procedure(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> data) :
-		base(codePart, procedureNumber, data),
-		attributeTable{ AttributeTable::place(data.end() - sizeof(AttributeTable)) }
-	{
-		this->procEnd = data.end() - sizeof(AttributeTable);
-		for (auto table : { &baseRelocations, &segRelocations, &procRelocations, &interpRelocations }) {
-			procEnd = readRelocations(*table, procEnd);
+	vector<Native6502Procedure::Instruction> Native6502Procedure::getDecodedInstructions() const {
+		vector<Instruction> result;
+		auto sizes = operandSizes();
+		for (size_t offset = 0; offset != sizes.size(); ++offset) {
+			if (sizes[offset] >= 0) {
+				auto size = static_cast<uint8_t>(sizes[offset]);
+				result.push_back({ static_cast<uint16_t>(offset), static_cast<uint8_t>(size + 1), 1, size, getProcBegin()[offset] });
+			}
 		}
+		return result;
 	}
 
+	std::wstring Native6502Procedure::getMnemonic(Instruction const & instruction) const {
+		return (*opcodes)[instruction.opcode & 0xff].mnemonic;
+	}
 
-	/* Check the nominated CPU type, and patch the opcode decoding dispatch table if necessary. */
-	void Native6502Procedure::initialiseCpu(cpu_t const & cpu) {
-		Disassembler::initialiseCpu(cpu);
+	/* The 65c02 and 65c816 are told apart by the CPU option, so every procedure is the 6502. */
+	std::wstring Native6502Procedure::getProcessor() const {
+		return L"6502";
 	}
 
-	void Native6502Procedure::writeHeader(std::wostream & os) const {
-		auto procBegin = data.begin();
-		auto procLength = data.end() - data.begin();
-		os << "Proc #" << dec << setfill(L' ') << left << setw(4) << procedureNumber << L" (";
-		os << hex << setfill(L'0') << right << setw(4) << distance(codePart.begin(), procBegin) << ":" << setw(4) << distance(codePart.begin(), procBegin) + procLength - 1<< ") Native (6502)  ";
-		os << endl;
+	vector<uint16_t> Native6502Procedure::getInstructions() const {
+		vector<uint16_t> result;
+		for (auto instruction : getDecodedInstructions()) {
+			result.push_back(instruction.offset);
+		}
+		return result;
 	}
 
-	/* Write a disassembly of the procedure to an output stream. */
-	void Native6502Procedure::disassemble(std::wostream & os, linkref_map_t & linkage) const {
-		Disassembler disassember{ os, *this, linkage };
-		uint8_t const * ic = data.begin();
-		while (ic && ic < procEnd) {
-			printIc(os, ic);
-			ic = disassember.decode(ic);
+	/* Only the instructions reached from the entry point are timed, whether or not the listing
+	   follows the flow of control. They are timed in one pass, which also marks where basic
+	   blocks start: at the entry point, at the target of a branch, or a JMP or JSR within the
+	   procedure, after a branch, jump, return or BRK, and after bytes that aren't reached. The
+	   blocks are then summed from the timed instructions. */
+	Native6502Procedure::CycleCounts Native6502Procedure::getCycleCounts() const {
+		CycleCounts result;
+		auto begin = data.begin();
+		auto size = static_cast<size_t>(procEnd - begin);
+		vector<bool> starts(size + 1), procRelocated(size);
+		for (auto address : procRelocations) {
+			if (begin <= address && address < procEnd) {
+				procRelocated[address - begin] = true;
+			}
 		}
+		auto mark = [&](ptrdiff_t target) {
+			if (0 <= target && static_cast<size_t>(target) < size) {
+				starts[target] = true;
+			}
+		};
+		bool decimalPenalty = opcodes == &opcodes65c02;
+		bool ended = true;
+		mark(getEnterIc() - begin);
+		auto reached = traceCode();
+		size_t expected = 0;
+		for (size_t offset = 0; offset != reached.size(); ++offset) {
+			if (reached[offset] < 0) {
+				continue;
+			}
+			ended |= offset != expected;
+			expected = offset + 1 + reached[offset];
+			auto opcode = begin[offset];
+			auto & info = (*opcodes)[opcode];
+			auto & timing = (*cycles)[opcode];
+			auto mnemonic = wstring{ info.mnemonic };
+			bool branch = info.mode == AddressMode::relative;
+			bool longBranch = info.mode == AddressMode::relativeLong;
+			result.instructions.push_back({ static_cast<uint16_t>(offset), timing.base, timing.pageCross, branch, decimalPenalty && (mnemonic == L"ADC" || mnemonic == L"SBC") });
+			if (ended) {
+				starts[offset] = true;
+			}
+			ended = branch || longBranch || opcode == JMP || opcode == RTS || opcode == RTI || opcode == BRK || opcode == JMP_INDIRECT || opcode == JMP_INDEXED_INDIRECT
+				|| (opcodes == &opcodes65c816 && (opcode == RTL || opcode == JML || opcode == JML_INDIRECT));
+			if (branch) {
+				mark(offset + 2 + static_cast<int8_t>(begin[offset + 1]));
+			} else if (longBranch) {
+				mark(offset + 3 + static_cast<int16_t>(begin[offset + 1] | begin[offset + 2] << 8));
+			} else if ((opcode == JMP || opcode == JSR) && procRelocated[offset + 1]) {
+				mark(*reinterpret_cast<little_uint16_t const *>(begin + offset + 1));
+			}
+		}
+		for (size_t index = 0; index != result.instructions.size(); ++index) {
+			auto & instruction = result.instructions[index];
+			if (index == 0 || starts[instruction.offset]) {
+				result.blocks.push_back({ index, index, 0, 0 });
+			}
+			auto & block = result.blocks.back();
+			block.last = index;
+			block.cycles += instruction.base;
+			block.penalty += instruction.penalty();
+			result.cycles += instruction.base;
+			result.penalty += instruction.penalty();
+		}
+		return result;
 	}
 
-	std::uint8_t const * Native6502Procedure::getEnterIc() const {
-		return derefSelfPtr(reinterpret_cast<std::uint8_t const *>(&attributeTable.enterIc));
+	namespace {
+
+		/* The cycles with a letter for each penalty: p for a page crossing, t for a branch taken
+		   and d for decimal mode. */
+		wstring formatCycles(Native6502Procedure::CycleCounts::Instruction const & instruction) {
+			wostringstream result;
+			result << dec << instruction.base;
+			if (instruction.pageCross) {
+				result << L"+p";
+			}
+			if (instruction.branch) {
+				result << L"+t";
+			}
+			if (instruction.decimal) {
+				result << L"+d";
+			}
+			return result.str();
+		}
+
+		wstring formatCycles(int cycles, int penalty) {
+			wostringstream result;
+			result << dec << cycles << L" cycles";
+			if (penalty) {
+				result << L", up to " << cycles + penalty;
+			}
+			return result.str();
+		}
+
 	}
 
-	/* Write the instruction address, relative to the segment start.  Indicate the procedure entry point. */
-	void Native6502Procedure::printIc(std::wostream & os, std::uint8_t const * current) const {
-		if (getEnterIc() == current) {
-			os << L"  ENTER:" << endl;
+	/* Write a disassembly of the procedure to an output stream. When following the flow of
+	   control, bytes that aren't reached are written as data, up to eight to a line.
+
+	   When showing cycles, each instruction is followed by its cycles, the last instruction of
+	   a basic block by the cycles of the block, and the whole procedure by its total. */
+	void Native6502Procedure::disassembleRange(std::wostream & os, linkref_map_t & linkage, std::size_t first, std::size_t last) const {
+		Disassembler disassember{ os, *this, linkage };
+		uint8_t const * ic = data.begin() + first;
+		auto end = min(procEnd, data.begin() + last);
+		auto sizes = operandSizes();
+		CycleCounts counts;
+		vector<CycleCounts::Block const *> blockEnds;
+		wostringstream line;
+		Disassembler lineDisassembler{ line, *this, linkage };
+		if (showCycles) {
+			counts = getCycleCounts();
+			blockEnds.resize(counts.instructions.size());
+			for (auto & block : counts.blocks) {
+				blockEnds[block.last] = &block;
+			}
+		}
+		auto decode = [&](uint8_t const * current) {
+			auto offset = static_cast<uint16_t>(current - data.begin());
+			auto operandBytes = offset < sizes.size() && sizes[offset] >= 0 ? sizes[offset] : operandSize((*opcodes)[*current].mode);
+			if (!showCycles) {
+				return disassember.decode(current, operandBytes);
+			}
+			line.str(L"");
+			auto next = lineDisassembler.decode(current, operandBytes);
+			auto text = line.str();
+			text.pop_back();
+			auto found = lower_bound(counts.instructions.begin(), counts.instructions.end(), offset, [](auto & instruction, uint16_t value) { return instruction.offset < value; });
+			if (found == counts.instructions.end() || found->offset != offset) {
+				os << text;
+			} else {
+				os << setfill(L' ') << left << setw(32) << text << L"; " << formatCycles(*found);
+				if (auto block = blockEnds[found - counts.instructions.begin()]) {
+					os << endl << setw(41) << L"" << L"; block $" << hex << setfill(L'0') << right << setw(4) << counts.instructions[block->first].offset;
+					os << L": " << formatCycles(block->cycles, block->penalty);
+				}
+			}
+			os << endl;
+			return next;
+		};
+		auto writeTotal = [&]() {
+			if (showCycles && first == 0 && end == procEnd) {
+				os << setfill(L' ') << setw(41) << L"" << L"; procedure: " << formatCycles(counts.cycles, counts.penalty);
+				os << L", in " << dec << counts.blocks.size() << L" blocks" << endl;
+			}
+		};
+		if (!followFlow) {
+			while (ic && ic < end) {
+				printIc(os, ic);
+				ic = decode(ic);
+			}
+			writeTotal();
+			return;
 		}
-		os << L"   ";
-		os << hex << setfill(L'0') << right << setw(4) <<  current - this->getProcBegin() << L": ";
+		while (ic < end) {
+			printIc(os, ic);
+			if (sizes[ic - data.begin()] >= 0) {
+				ic = decode(ic);
+			} else {
+				auto dataEnd = ic;
+				while (dataEnd < end && dataEnd - ic < 8 && sizes[dataEnd - data.begin()] < 0) {
+					++dataEnd;
+				}
+				writeData(os, ic, dataEnd);
+				ic = dataEnd;
+			}
+		}
+		writeTotal();
 	}
 
+	vector<bool> Native6502Procedure::getInstructionStarts() const {
+		vector<bool> result(getSize());
+		for (auto offset : getInstructions()) {
+			result[offset] = true;
+		}
+		return result;
+	}
 
 }
@@ -17,9 +17,10 @@
 #ifndef _2DBE5D93_13B5_4D23_AB77_1150B342D655
 #define _2DBE5D93_13B5_4D23_AB77_1150B342D655
 
-#include "basecode.hpp"
+#include "native.hpp"
 #include "types.hpp"
 #include "options.hpp"
+#include "opcodes6502.hpp"
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -30,41 +31,69 @@
 
 namespace pcodedump {
 
-	class Native6502Procedure : public Procedure {
+	class Native6502Procedure : public NativeProcedure {
 	public:
-		using base = Procedure;
+		using base = NativeProcedure;
 		Native6502Procedure(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> range);
 
 		static void initialiseCpu(cpu_t const &);
 
-		std::optional<int> getLexicalLevel() const override {
-			return std::nullopt;
+		void disassembleRange(std::wostream& os, linkref_map_t & linkage, std::size_t first, std::size_t last) const override;
+		std::vector<bool> getInstructionStarts() const override;
+		std::vector<std::uint16_t> getInstructions() const;
+		std::vector<Instruction> getDecodedInstructions() const override;
+		std::wstring getMnemonic(Instruction const & instruction) const override;
+		std::wstring getProcessor() const override;
+
+		/* The cycles of each instruction, with the penalties it may take: one cycle when indexing
+		   crosses a page, one when a branch is taken and another if it goes to a different page,
+		   and one for ADC and SBC in decimal mode on the 65c02. The cycles of each basic block
+		   and of the procedure are the sums of the base cycles and of the penalties. */
+		struct CycleCounts {
+			struct Instruction {
+				std::uint16_t offset;
+				std::uint8_t base;
+				bool pageCross;
+				bool branch;
+				bool decimal;
+
+				int penalty() const {
+					return (pageCross ? 1 : 0) + (branch ? 2 : 0) + (decimal ? 1 : 0);
+				}
+			};
+
+			/* Instructions are indices into the instructions of the procedure. */
+			struct Block {
+				std::size_t first;
+				std::size_t last;
+				int cycles;
+				int penalty;
+			};
+
+			std::vector<Instruction> instructions;
+			std::vector<Block> blocks;
+			int cycles = 0;
+			int penalty = 0;
+		};
+
+		CycleCounts getCycleCounts() const;
+
+		static OpcodeTable6502 const & getOpcodes() {
+			return *opcodes;
 		}
 
-		void writeHeader(std::wostream& os) const override;
-		void disassemble(std::wostream& os, linkref_map_t & linkage) const override;
-
 	private:
-		using Relocations = std::vector<std::uint8_t const *>;
-
-
-		std::uint8_t const * readRelocations(Relocations &table, std::uint8_t const * rawTable);
-		std::uint8_t const * getEnterIc() const;
-
-		void printIc(std::wostream& os, std::uint8_t const * current) const;
-
-		class AttributeTable;
-		AttributeTable const & attributeTable;
-		uint8_t const * procEnd;
+		std::vector<std::int8_t> traceCode() const;
+		std::vector<std::int8_t> operandSizes() const;
 
 	public:
+		static bool followFlow;
+		static bool showCycles;
 
 	private:
-		Relocations baseRelocations;
-		Relocations segRelocations;
-		Relocations procRelocations;
-		Relocations interpRelocations;
-		
+		static OpcodeTable6502 const * opcodes;
+		static CycleTable6502 const * cycles;
+
 		class Disassembler;
 	};
 
@@ -0,0 +1,225 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "nativez80.hpp"
+#include "linkage.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+using namespace boost::endian;
+
+namespace pcodedump {
+
+	namespace {
+
+		constexpr uint8_t PREFIX_CB = 0xCB;
+		constexpr uint8_t PREFIX_DD = 0xDD;
+		constexpr uint8_t PREFIX_ED = 0xED;
+		constexpr uint8_t PREFIX_FD = 0xFD;
+		constexpr uint8_t JP_HL = 0xE9;
+		constexpr uint8_t EX_DE_HL = 0xEB;
+
+		bool defined(wchar_t const * text) {
+			return text[0] != L'?';
+		}
+
+		void replace(wstring & text, wstring const & from, wstring const & to) {
+			text.replace(text.find(from), from.size(), to);
+		}
+
+	}
+
+	NativeZ80Procedure::NativeZ80Procedure(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> data, Dialect dialect) :
+		base(codePart, procedureNumber, data, dialect == Dialect::i8080 ? L"Native (8080)" : L"Native (Z80)"),
+		dialect{ dialect }
+	{}
+
+	/* The size of an instruction is the prefix and opcode, and the bytes of the operands in its
+	   text. An instruction that runs past the end of the code isn't one. */
+	NativeZ80Procedure::Instruction NativeZ80Procedure::withOperands(std::wstring const & text, std::uint8_t const * current, int prefixSize) const {
+		int size = prefixSize + 1;
+		for (size_t index = 0; index != text.size(); ++index) {
+			switch (text[index]) {
+			case L'n':
+				if (index + 1 != text.size() && text[index + 1] == L'n') {
+					++index;
+					++size;
+				}
+				++size;
+				break;
+			case L'e':
+			case L'd':
+				++size;
+				break;
+			}
+		}
+		if (procEnd - current < size) {
+			return { L"", current, 1 };
+		}
+		return { text, current + prefixSize + 1, size };
+	}
+
+	/* DD and FD use IX and IY in place of HL, and (IX+d) and (IY+d) in place of (HL). The
+	   displacement comes before any other operand, and in DD CB and FD CB before the opcode.
+	   A prefix on an instruction that doesn't use HL isn't an instruction. */
+	NativeZ80Procedure::Instruction NativeZ80Procedure::decodeIndexed(std::uint8_t const * current, wchar_t const * index) const {
+		if (procEnd - current < 2) {
+			return { L"", current, 1 };
+		}
+		if (current[1] == PREFIX_CB) {
+			if (procEnd - current < 4 || !defined(opcodesZ80cb[current[3]])) {
+				return { L"", current, 1 };
+			}
+			wstring text = opcodesZ80cb[current[3]];
+			if (text.find(L"(HL)") == wstring::npos) {
+				return { L"", current, 1 };
+			}
+			replace(text, L"(HL)", wstring(L"(") + index + L"d)");
+			return { text, current + 2, 4 };
+		}
+		wstring text = opcodesZ80[current[1]];
+		if (current[1] == JP_HL) {
+			replace(text, L"(HL)", wstring(L"(") + index + L")");
+		} else if (text.find(L"(HL)") != wstring::npos) {
+			replace(text, L"(HL)", wstring(L"(") + index + L"d)");
+		} else if (text.find(L"HL") != wstring::npos && current[1] != EX_DE_HL) {
+			while (text.find(L"HL") != wstring::npos) {
+				replace(text, L"HL", index);
+			}
+		} else {
+			return { L"", current, 1 };
+		}
+		return withOperands(text, current, 1);
+	}
+
+	NativeZ80Procedure::Instruction NativeZ80Procedure::decode(std::uint8_t const * current) const {
+		if (dialect == Dialect::i8080) {
+			auto text = opcodes8080[*current];
+			return defined(text) ? withOperands(text, current, 0) : Instruction{ L"", current, 1 };
+		}
+		wchar_t const * text = opcodesZ80[*current];
+		int prefixSize = 0;
+		switch (*current) {
+		case PREFIX_DD:
+			return decodeIndexed(current, L"IX");
+		case PREFIX_FD:
+			return decodeIndexed(current, L"IY");
+		case PREFIX_CB:
+		case PREFIX_ED:
+			if (procEnd - current < 2) {
+				return { L"", current, 1 };
+			}
+			text = (*current == PREFIX_CB ? opcodesZ80cb : opcodesZ80ed)[current[1]];
+			prefixSize = 1;
+			break;
+		}
+		return defined(text) ? withOperands(text, current, prefixSize) : Instruction{ L"", current, 1 };
+	}
+
+	/* Operands are written in hex. Words are addresses, which may be relocated, and relative
+	   jumps are written as the offset of their target in the procedure. */
+	std::wstring NativeZ80Procedure::formatOperands(Instruction const & instruction, std::uint8_t const * current, linkref_map_t & linkage) const {
+		wostringstream result;
+		auto operand = instruction.operands;
+		auto & text = instruction.text;
+		for (size_t index = 0; index != text.size(); ++index) {
+			switch (text[index]) {
+			case L'n':
+				if (index + 1 != text.size() && text[index + 1] == L'n') {
+					result << formatAddress(operand, linkage);
+					operand += 2;
+					++index;
+				} else {
+					result << L"$" << hex << setfill(L'0') << right << setw(2) << *operand++;
+				}
+				break;
+			case L'e': {
+				auto value = *reinterpret_cast<little_int8_t const *>(operand++);
+				result << L"$" << hex << setfill(L'0') << right << setw(4) << distance(getProcBegin(), current + instruction.size + value);
+				break;
+			}
+			case L'd': {
+				int value = *reinterpret_cast<little_int8_t const *>(operand++);
+				result << (value < 0 ? L"-$" : L"+$") << hex << setfill(L'0') << right << setw(2) << abs(value);
+				break;
+			}
+			default:
+				result << text[index];
+			}
+		}
+		return result.str();
+	}
+
+	void NativeZ80Procedure::disassembleRange(std::wostream & os, linkref_map_t & linkage, std::size_t first, std::size_t last) const {
+		auto end = min(procEnd, data.begin() + last);
+		for (auto ic = data.begin() + first; ic < end;) {
+			printIc(os, ic);
+			auto instruction = decode(ic);
+			os << setfill(L' ') << left << setw(12) << toHexString(ic, ic + instruction.size);
+			if (instruction.text.empty()) {
+				os << L".BYTE $" << hex << uppercase << setfill(L'0') << right << setw(2) << *ic << nouppercase;
+			} else {
+				os << formatOperands(instruction, ic, linkage);
+			}
+			os << endl;
+			ic += instruction.size;
+		}
+	}
+
+	/* The opcode of DD CB and FD CB instructions comes after the displacement. */
+	vector<NativeProcedure::Instruction> NativeZ80Procedure::getDecodedInstructions() const {
+		vector<base::Instruction> result;
+		for (auto ic = data.begin(); ic < procEnd;) {
+			auto instruction = decode(ic);
+			if (!instruction.text.empty()) {
+				auto operandOffset = static_cast<uint8_t>(instruction.operands - ic);
+				auto operandSize = static_cast<uint8_t>(instruction.size - operandOffset);
+				uint32_t opcode = 0;
+				for (auto byte = ic; byte != instruction.operands; ++byte) {
+					opcode = opcode << 8 | *byte;
+				}
+				if ((ic[0] == PREFIX_DD || ic[0] == PREFIX_FD) && ic[1] == PREFIX_CB) {
+					opcode = opcode << 8 | ic[3];
+					operandSize = 1;
+				}
+				result.push_back({ static_cast<uint16_t>(ic - data.begin()), static_cast<uint8_t>(instruction.size), operandOffset, operandSize, opcode });
+			}
+			ic += instruction.size;
+		}
+		return result;
+	}
+
+	std::wstring NativeZ80Procedure::getMnemonic(base::Instruction const & instruction) const {
+		auto text = decode(data.begin() + instruction.offset).text;
+		return text.substr(0, text.find(L' '));
+	}
+
+	std::wstring NativeZ80Procedure::getProcessor() const {
+		return dialect == Dialect::i8080 ? L"8080" : L"Z80";
+	}
+
+	vector<bool> NativeZ80Procedure::getInstructionStarts() const {
+		vector<bool> result(getSize());
+		for (auto ic = data.begin(); ic < procEnd; ic += decode(ic).size) {
+			result[ic - data.begin()] = true;
+		}
+		return result;
+	}
+
+}
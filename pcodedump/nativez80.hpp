@@ -0,0 +1,66 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _B7052DFF_7648_442B_BAF6_C821E4B6D4B3
+#define _B7052DFF_7648_442B_BAF6_C821E4B6D4B3
+
+#include "native.hpp"
+#include "types.hpp"
+#include "opcodesz80.hpp"
+#include <cstdint>
+#include <vector>
+#include <string>
+
+namespace pcodedump {
+
+	/* A procedure of 8080 or Z80 code. The 8080 is written with Intel mnemonics and the Z80 with
+	   Zilog mnemonics, including the instructions behind the CB, DD, ED and FD prefixes. The code
+	   is disassembled from the start of the procedure to the relocation tables. */
+	class NativeZ80Procedure : public NativeProcedure {
+	public:
+		using base = NativeProcedure;
+
+		enum class Dialect { i8080, z80 };
+
+		NativeZ80Procedure(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> range, Dialect dialect);
+
+		void disassembleRange(std::wostream& os, linkref_map_t & linkage, std::size_t first, std::size_t last) const override;
+		std::vector<bool> getInstructionStarts() const override;
+		std::vector<base::Instruction> getDecodedInstructions() const override;
+		std::wstring getMnemonic(base::Instruction const & instruction) const override;
+		std::wstring getProcessor() const override;
+
+	private:
+		/* The text of an instruction, with HL replaced by the index register of a DD or FD
+		   prefix, where its operands start and its size. The text is empty for a byte that
+		   doesn't start an instruction. */
+		struct Instruction {
+			std::wstring text;
+			std::uint8_t const * operands;
+			int size;
+		};
+
+		Instruction decode(std::uint8_t const * current) const;
+		Instruction decodeIndexed(std::uint8_t const * current, wchar_t const * index) const;
+		Instruction withOperands(std::wstring const & text, std::uint8_t const * current, int prefixSize) const;
+		std::wstring formatOperands(Instruction const & instruction, std::uint8_t const * current, linkref_map_t & linkage) const;
+
+		Dialect dialect;
+	};
+
+}
+
+#endif // !_B7052DFF_7648_442B_BAF6_C821E4B6D4B3
@@ -0,0 +1,418 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "nufx.hpp"
+
+#include <array>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <boost/endian/arithmetic.hpp>
+
+using namespace std;
+using namespace boost::endian;
+
+namespace pcodedump {
+
+	namespace {
+
+		constexpr uint8_t masterMagic[] = { 0x4e, 0xf5, 0x46, 0xe9, 0x6c, 0xe5 };
+		constexpr uint8_t recordMagic[] = { 0x4e, 0xf5, 0x46, 0xd8 };
+		constexpr uint8_t binaryIIMagic[] = { 0x0a, 0x47, 0x4c };
+		constexpr ptrdiff_t BINARY_II_SIZE = 128;
+
+		constexpr size_t CHUNK_SIZE = 4096;
+
+		enum ThreadClass {
+			messageThread = 0,
+			controlThread = 1,
+			dataThread = 2,
+			filenameThread = 3,
+		};
+
+		enum DataThreadKind {
+			dataFork = 0,
+			diskImage = 1,
+			resourceFork = 2,
+		};
+
+		struct MasterHeader {
+			uint8_t magic[6];
+			little_uint16_t masterCrc;
+			little_uint32_t totalRecords;
+			uint8_t created[8];
+			uint8_t modified[8];
+			little_uint16_t masterVersion;
+			uint8_t reserved1[8];
+			little_uint32_t masterEof;
+			uint8_t reserved2[6];
+		};
+
+		struct RecordHeader {
+			uint8_t magic[4];
+			little_uint16_t headerCrc;
+			little_uint16_t attribCount;
+			little_uint16_t version;
+			little_uint32_t totalThreads;
+			little_uint16_t fileSysId;
+			little_uint16_t fileSysInfo;
+			little_uint32_t access;
+			little_uint32_t fileType;
+			little_uint32_t extraType;
+			little_uint16_t storageType;
+			uint8_t created[8];
+			uint8_t modified[8];
+			uint8_t archived[8];
+		};
+
+		struct ThreadHeader {
+			little_uint16_t threadClass;
+			little_uint16_t format;
+			little_uint16_t kind;
+			little_uint16_t crc;
+			little_uint32_t threadEof;
+			little_uint32_t compressedEof;
+		};
+
+		template <size_t N>
+		bool hasMagic(uint8_t const * begin, uint8_t const * end, uint8_t const (&magic)[N]) {
+			return end - begin >= static_cast<ptrdiff_t>(N) && equal(magic, magic + N, begin);
+		}
+
+		/* Skip a Binary II wrapper, as used by .bxy files. */
+		uint8_t const * archiveStart(Range<uint8_t const> data) {
+			if (hasMagic(data.begin(), data.end(), binaryIIMagic) && data.end() - data.begin() > BINARY_II_SIZE) {
+				return data.begin() + BINARY_II_SIZE;
+			}
+			return data.begin();
+		}
+
+		/* Sequential little endian reads from thread data, with every read checked against the
+		   end of the data. */
+		class Reader {
+		public:
+			Reader(uint8_t const * begin, uint8_t const * end) : pos{ begin }, end{ end } {}
+
+			uint8_t const * position() const { return pos; }
+
+			uint8_t const * take(size_t count) {
+				if (static_cast<size_t>(end - pos) < count) {
+					throw runtime_error("Unexpected end of NuFX data");
+				}
+				auto result = pos;
+				pos += count;
+				return result;
+			}
+
+			uint8_t byte() {
+				return *take(1);
+			}
+
+			uint16_t word() {
+				auto bytes = take(2);
+				return static_cast<uint16_t>(bytes[0] | bytes[1] << 8);
+			}
+
+		private:
+			uint8_t const * pos;
+			uint8_t const * end;
+		};
+
+		/* Reads variable width codes, least significant bit first. */
+		class BitReader {
+		public:
+			BitReader(uint8_t const * begin, uint8_t const * end) : begin{ begin }, pos{ begin }, end{ end } {}
+
+			unsigned int read(int width) {
+				while (count < width) {
+					if (pos == end) {
+						throw runtime_error("Unexpected end of LZW data");
+					}
+					buffer |= static_cast<uint32_t>(*pos++) << count;
+					count += 8;
+				}
+				auto value = buffer & ((1u << width) - 1);
+				buffer >>= width;
+				count -= width;
+				return value;
+			}
+
+			/* Codes don't span chunks, so any bits left in the last byte read are discarded. */
+			size_t consumed() const {
+				return pos - begin;
+			}
+
+		private:
+			uint8_t const * begin;
+			uint8_t const * pos;
+			uint8_t const * end;
+			uint32_t buffer = 0;
+			int count = 0;
+		};
+
+		/* The ShrinkIt variant of LZW. Codes start at 9 bits and grow to 12 bits as the string table
+		   fills. Code 0x100 clears the table. LZW/1 clears the table for every chunk. LZW/2 keeps it
+		   from one chunk to the next unless a chunk is stored without LZW. */
+		class LzwDecoder {
+		public:
+			static constexpr unsigned int CLEAR_CODE = 0x100;
+			static constexpr unsigned int FIRST_CODE = 0x101;
+			static constexpr unsigned int TABLE_SIZE = 0x1000;
+
+			void reset() {
+				entry = FIRST_CODE;
+				started = false;
+			}
+
+			/* Expand codes until the output is full. Returns the number of input bytes used. */
+			size_t expand(uint8_t const * begin, uint8_t const * end, uint8_t * output, size_t length) {
+				BitReader input{ begin, end };
+				auto outputEnd = output + length;
+				while (output != outputEnd) {
+					auto code = input.read(codeWidth());
+					if (code == CLEAR_CODE) {
+						reset();
+						continue;
+					}
+					if (!started) {
+						if (code > 0xff) {
+							throw runtime_error("Corrupt LZW data");
+						}
+						finalChar = static_cast<uint8_t>(code);
+						*output++ = finalChar;
+						oldCode = code;
+						started = true;
+						continue;
+					}
+					auto top = stack.begin();
+					auto ptr = code;
+					if (code >= entry) {
+						if (code > entry) {
+							throw runtime_error("Corrupt LZW data");
+						}
+						*top++ = finalChar;
+						ptr = oldCode;
+					}
+					while (ptr > 0xff) {
+						*top++ = table[ptr].suffix;
+						ptr = table[ptr].prefix;
+					}
+					finalChar = static_cast<uint8_t>(ptr);
+					*output++ = finalChar;
+					while (top != stack.begin() && output != outputEnd) {
+						*output++ = *--top;
+					}
+					if (entry < TABLE_SIZE) {
+						table[entry++] = Entry{ static_cast<uint16_t>(oldCode), finalChar };
+					}
+					oldCode = code;
+				}
+				return input.consumed();
+			}
+
+		private:
+			int codeWidth() const {
+				auto high = (entry + 1) >> 8;
+				return high <= 1 ? 9 : high <= 3 ? 10 : high <= 7 ? 11 : 12;
+			}
+
+			struct Entry {
+				uint16_t prefix;
+				uint8_t suffix;
+			};
+
+			array<Entry, TABLE_SIZE> table;
+			array<uint8_t, TABLE_SIZE> stack;
+			unsigned int entry = FIRST_CODE;
+			unsigned int oldCode = 0;
+			uint8_t finalChar = 0;
+			bool started = false;
+		};
+
+		/* A run is stored as the escape character, the repeated character and the run length less one. */
+		void expandRuns(uint8_t const * begin, uint8_t const * end, uint8_t escape, uint8_t * output) {
+			auto outputEnd = output + CHUNK_SIZE;
+			while (begin != end) {
+				size_t count = 1;
+				auto value = *begin++;
+				if (value == escape) {
+					if (end - begin < 2) {
+						throw runtime_error("Corrupt run length data");
+					}
+					value = begin[0];
+					count = begin[1] + 1;
+					begin += 2;
+				}
+				if (static_cast<size_t>(outputEnd - output) < count) {
+					throw runtime_error("Corrupt run length data");
+				}
+				output = fill_n(output, count, value);
+			}
+			if (output != outputEnd) {
+				throw runtime_error("Corrupt run length data");
+			}
+		}
+
+		/* LZW/1 and LZW/2 threads are a short header followed by 4K chunks. Each chunk is run length
+		   encoded, unless that would make it larger, and then optionally LZW compressed. The last
+		   chunk is padded to a full 4K. */
+		buff_t expandLzw(ThreadFormat format, Range<uint8_t const> data, size_t length) {
+			buff_t result(length);
+			Reader input{ data.begin(), data.end() };
+			if (format == ThreadFormat::lzw1) {
+				input.word(); // CRC of the expanded data
+			}
+			input.byte(); // Volume number
+			auto escape = input.byte();
+
+			LzwDecoder decoder;
+			array<uint8_t, CHUNK_SIZE> packed;
+			array<uint8_t, CHUNK_SIZE> chunk;
+			for (size_t offset = 0; offset < length; offset += CHUNK_SIZE) {
+				size_t packedLength;
+				bool compressed;
+				if (format == ThreadFormat::lzw1) {
+					packedLength = input.word();
+					compressed = input.byte() != 0;
+				} else {
+					auto header = input.word();
+					packedLength = header & 0x1fff;
+					compressed = (header & 0x8000) != 0;
+					if (compressed) {
+						input.word(); // Compressed length of the chunk
+					}
+				}
+				if (packedLength > CHUNK_SIZE) {
+					throw runtime_error("Corrupt LZW chunk header");
+				}
+
+				if (compressed) {
+					if (format == ThreadFormat::lzw1) {
+						decoder.reset();
+					}
+					auto start = input.position();
+					input.take(decoder.expand(start, data.end(), packed.data(), packedLength));
+				} else {
+					decoder.reset();
+					copy_n(input.take(packedLength), packedLength, packed.data());
+				}
+
+				if (packedLength == CHUNK_SIZE) {
+					chunk = packed;
+				} else {
+					expandRuns(packed.data(), packed.data() + packedLength, escape, chunk.data());
+				}
+				copy_n(chunk.data(), min(CHUNK_SIZE, length - offset), result.data() + offset);
+			}
+			return result;
+		}
+
+	}
+
+	buff_t expandThread(ThreadFormat format, Range<uint8_t const> data, size_t length) {
+		switch (format) {
+		case ThreadFormat::uncompressed:
+			if (static_cast<size_t>(data.end() - data.begin()) < length) {
+				throw runtime_error("Unexpected end of NuFX data");
+			}
+			return buff_t(data.begin(), data.begin() + length);
+		case ThreadFormat::lzw1:
+		case ThreadFormat::lzw2:
+			return expandLzw(format, data, length);
+		default:
+			throw runtime_error("Unsupported NuFX thread format: " + to_string(static_cast<int>(format)));
+		}
+	}
+
+	NufxRecord::NufxRecord(wstring name, unsigned int fileType, bool diskImage, ThreadFormat format, size_t length, Range<uint8_t const> compressed) :
+		name{ name }, fileType{ fileType }, diskImage{ diskImage }, format{ format }, length{ length }, compressed{ compressed }
+	{
+	}
+
+	buff_t NufxRecord::expand() const {
+		return expandThread(format, compressed, length);
+	}
+
+	bool NufxArchive::isArchive(Range<uint8_t const> data) {
+		return hasMagic(archiveStart(data), data.end(), masterMagic);
+	}
+
+	namespace {
+
+		Range<uint8_t const> checkArchive(Range<uint8_t const> data) {
+			if (!NufxArchive::isArchive(data)) {
+				throw runtime_error("Not a NuFX archive");
+			}
+			return data;
+		}
+
+	}
+
+	NufxArchive::NufxArchive(Range<uint8_t const> data) :
+		records{ extractRecords(checkArchive(data)) }
+	{
+	}
+
+	/* Find the name and the data thread of each record. Records without a data fork or disk image,
+	   such as those holding only a resource fork, are skipped. */
+	vector<NufxRecord> NufxArchive::extractRecords(Range<uint8_t const> data) const {
+		static_assert(sizeof(MasterHeader) == 48 && sizeof(RecordHeader) == 56 && sizeof(ThreadHeader) == 16, "NuFX header sizes");
+		vector<NufxRecord> result;
+		Reader input{ archiveStart(data), data.end() };
+		auto & master = place<MasterHeader>(input.take(sizeof(MasterHeader)));
+		for (uint32_t index = 0; index != master.totalRecords; ++index) {
+			auto start = input.position();
+			if (!hasMagic(start, data.end(), recordMagic)) {
+				throw runtime_error("Corrupt NuFX record header");
+			}
+			auto & header = place<RecordHeader>(input.take(sizeof(RecordHeader)));
+			if (header.attribCount < sizeof(RecordHeader) + 2) {
+				throw runtime_error("Corrupt NuFX record header");
+			}
+			input.take(header.attribCount - sizeof(RecordHeader) - 2);
+			auto nameLength = input.word();
+			auto nameBytes = input.take(nameLength);
+			wstring name{ nameBytes, nameBytes + nameLength };
+
+			auto threads = reinterpret_cast<ThreadHeader const *>(input.take(header.totalThreads * sizeof(ThreadHeader)));
+			Range<uint8_t const> contents;
+			ThreadHeader const * contentsThread = nullptr;
+			for (uint32_t thread = 0; thread != header.totalThreads; ++thread) {
+				auto & threadHeader = threads[thread];
+				auto threadData = input.take(threadHeader.compressedEof);
+				if (threadHeader.threadClass == filenameThread) {
+					name.assign(threadData, threadData + min(threadHeader.threadEof, threadHeader.compressedEof));
+				} else if (threadHeader.threadClass == dataThread && (threadHeader.kind == dataFork || threadHeader.kind == diskImage)) {
+					contents = Range<uint8_t const>{ threadData, threadData + threadHeader.compressedEof };
+					contentsThread = &threadHeader;
+				}
+			}
+			// Path names use the separator of the original file system.
+			replace(name.begin(), name.end(), static_cast<wchar_t>(header.fileSysInfo & 0xff), L'/');
+			if (contentsThread) {
+				bool image = contentsThread->kind == diskImage;
+				// Older versions of ShrinkIt didn't record the length of a disk image thread.
+				size_t length = image
+					? static_cast<size_t>(header.extraType) * header.storageType
+					: static_cast<size_t>(contentsThread->threadEof);
+				result.emplace_back(name, header.fileType, image, static_cast<ThreadFormat>(contentsThread->format.value()), length, contents);
+			}
+		}
+		return result;
+	}
+
+}
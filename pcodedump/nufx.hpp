@@ -0,0 +1,85 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _BB724A48_F3D2_4FBD_94E0_E84C64C6FF5F
+#define _BB724A48_F3D2_4FBD_94E0_E84C64C6FF5F
+
+#include "types.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace pcodedump {
+
+	enum class ThreadFormat {
+		uncompressed,
+		squeezed,
+		lzw1,
+		lzw2,
+		lzwUnix12,
+		lzwUnix16,
+	};
+
+	/* One file or disk image stored in a ShrinkIt archive. Only the data fork or disk image
+	   thread of the record is kept. It stays compressed in the archive until it is expanded. */
+	class NufxRecord {
+	public:
+		NufxRecord(std::wstring name, unsigned int fileType, bool diskImage, ThreadFormat format, std::size_t length, Range<std::uint8_t const> compressed);
+
+		std::wstring const & getName() const { return name; }
+		unsigned int getFileType() const { return fileType; }
+		bool isDiskImage() const { return diskImage; }
+		ThreadFormat getFormat() const { return format; }
+		std::size_t getLength() const { return length; }
+
+		buff_t expand() const;
+
+	private:
+		std::wstring name;
+		unsigned int fileType;
+		bool diskImage;
+		ThreadFormat format;
+		std::size_t length;
+		Range<std::uint8_t const> compressed;
+	};
+
+	/* A ShrinkIt (NuFX) archive, optionally wrapped in a Binary II header. The archive is a master
+	   header followed by records, each of which is a header, a list of thread headers and then
+	   the data of each thread in turn. */
+	class NufxArchive {
+	public:
+		explicit NufxArchive(Range<std::uint8_t const> data);
+
+		std::vector<NufxRecord> const & getRecords() const { return records; }
+
+		static bool isArchive(Range<std::uint8_t const> data);
+
+	private:
+		std::vector<NufxRecord> extractRecords(Range<std::uint8_t const> data) const;
+
+		std::vector<NufxRecord> records;
+	};
+
+	/* Expand the data of a thread to its original length. Data is expanded a 4K chunk at a time
+	   directly into the result, so the only other memory used is the LZW string table and two
+	   chunk buffers. */
+	buff_t expandThread(ThreadFormat format, Range<std::uint8_t const> data, std::size_t length);
+
+}
+
+#endif // !_BB724A48_F3D2_4FBD_94E0_E84C64C6FF5F
@@ -0,0 +1,629 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _B32DFBB8_3A3A_4BA2_B424_6E55E3DEB439
+#define _B32DFBB8_3A3A_4BA2_B424_6E55E3DEB439
+
+#include "options.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+namespace pcodedump {
+
+	enum class AddressMode {
+		implied,
+		immediate,
+		accumulator,
+		absolute,
+		absoluteIndirect,
+		absoluteIndexedIndirect,
+		zeroPage,
+		zeroPageIndirect,
+		absoluteIndexedX,
+		absoluteIndexedY,
+		zeroPageIndexedX,
+		zeroPageIndexedY,
+		relative,
+		indexedIndirect,
+		indirectIndexed,
+		// 65c816
+		immediateAccumulator,
+		immediateIndex,
+		absoluteLong,
+		absoluteLongIndexedX,
+		absoluteIndirectLong,
+		zeroPageIndirectLong,
+		zeroPageIndirectLongIndexedY,
+		stackRelative,
+		stackRelativeIndirectIndexed,
+		relativeLong,
+		blockMove,
+	};
+
+	/* The number of bytes that follow the opcode. */
+	constexpr int operandSize(AddressMode mode) {
+		switch (mode) {
+		case AddressMode::implied:
+		case AddressMode::accumulator:
+			return 0;
+		case AddressMode::absolute:
+		case AddressMode::absoluteIndirect:
+		case AddressMode::absoluteIndexedIndirect:
+		case AddressMode::absoluteIndexedX:
+		case AddressMode::absoluteIndexedY:
+		case AddressMode::absoluteIndirectLong:
+		case AddressMode::relativeLong:
+		case AddressMode::blockMove:
+			return 2;
+		case AddressMode::absoluteLong:
+		case AddressMode::absoluteLongIndexedX:
+			return 3;
+		default:
+			return 1;
+		}
+	}
+
+	/* The widths of the 65c816 accumulator and index registers, which are 8 bits unless the M
+	   or X flag is clear. A width that can't be told from the code, such as where two paths
+	   meet with different widths, is unknown, and is taken to be 8 bits. */
+	struct RegisterWidths {
+		bool wideAccumulator = false;
+		bool wideIndex = false;
+		bool unknownAccumulator = false;
+		bool unknownIndex = false;
+
+		bool operator==(RegisterWidths const & other) const {
+			return wideAccumulator == other.wideAccumulator && wideIndex == other.wideIndex
+				&& unknownAccumulator == other.unknownAccumulator && unknownIndex == other.unknownIndex;
+		}
+
+		bool operator!=(RegisterWidths const & other) const {
+			return !(*this == other);
+		}
+	};
+
+	/* A width is unknown where the two widths differ. */
+	constexpr RegisterWidths mergeWidths(RegisterWidths left, RegisterWidths right) {
+		RegisterWidths result = left;
+		if (left.unknownAccumulator || right.unknownAccumulator || left.wideAccumulator != right.wideAccumulator) {
+			result.wideAccumulator = false;
+			result.unknownAccumulator = true;
+		}
+		if (left.unknownIndex || right.unknownIndex || left.wideIndex != right.wideIndex) {
+			result.wideIndex = false;
+			result.unknownIndex = true;
+		}
+		return result;
+	}
+
+	/* Whether the size of an immediate operand depends on a width that isn't known. */
+	constexpr bool unknownSize(AddressMode mode, RegisterWidths widths) {
+		return (mode == AddressMode::immediateAccumulator && widths.unknownAccumulator)
+			|| (mode == AddressMode::immediateIndex && widths.unknownIndex);
+	}
+
+	/* The number of bytes that follow the opcode, where an immediate operand is as wide as the
+	   register it is for. */
+	constexpr int operandSize(AddressMode mode, RegisterWidths widths) {
+		if (mode == AddressMode::immediateAccumulator) {
+			return widths.wideAccumulator ? 2 : 1;
+		} else if (mode == AddressMode::immediateIndex) {
+			return widths.wideIndex ? 2 : 1;
+		}
+		return operandSize(mode);
+	}
+
+	struct Opcode6502 {
+		wchar_t const * mnemonic;
+		AddressMode mode;
+
+		bool defined() const {
+			return mnemonic[0] != L'?';
+		}
+	};
+
+	using OpcodeTable6502 = std::array<Opcode6502, 256>;
+
+	/* The mnemonic and address mode of each opcode. The disassembler and anything else that needs
+	   to decode native code use these tables, so that they always agree. */
+	inline constexpr OpcodeTable6502 opcodes6502 = { {
+		// 0x00
+		{ L"BRK", AddressMode::implied },
+		{ L"ORA", AddressMode::indexedIndirect },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"ORA", AddressMode::zeroPage },
+		{ L"ASL", AddressMode::zeroPage },
+		{ L"???", AddressMode::implied },
+		{ L"PHP", AddressMode::implied },
+		{ L"ORA", AddressMode::immediate },
+		{ L"ASL", AddressMode::accumulator },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"ORA", AddressMode::absolute },
+		{ L"ASL", AddressMode::absolute },
+		{ L"???", AddressMode::implied },
+		// 0x10
+		{ L"BPL", AddressMode::relative },
+		{ L"ORA", AddressMode::indirectIndexed },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"ORA", AddressMode::zeroPageIndexedX },
+		{ L"ASL", AddressMode::zeroPageIndexedX },
+		{ L"???", AddressMode::implied },
+		{ L"CLC", AddressMode::implied },
+		{ L"ORA", AddressMode::absoluteIndexedY },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"ORA", AddressMode::absoluteIndexedX },
+		{ L"ASL", AddressMode::absoluteIndexedX },
+		{ L"???", AddressMode::implied },
+		// 0x20
+		{ L"JSR", AddressMode::absolute },
+		{ L"AND", AddressMode::indexedIndirect },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"BIT", AddressMode::zeroPage },
+		{ L"AND", AddressMode::zeroPage },
+		{ L"ROL", AddressMode::zeroPage },
+		{ L"???", AddressMode::implied },
+		{ L"PLP", AddressMode::implied },
+		{ L"AND", AddressMode::immediate },
+		{ L"ROL", AddressMode::accumulator },
+		{ L"???", AddressMode::implied },
+		{ L"BIT", AddressMode::absolute },
+		{ L"AND", AddressMode::absolute },
+		{ L"ROL", AddressMode::absolute },
+		{ L"???", AddressMode::implied },
+		// 0x30
+		{ L"BMI", AddressMode::relative },
+		{ L"AND", AddressMode::indirectIndexed },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"AND", AddressMode::zeroPageIndexedX },
+		{ L"ROL", AddressMode::zeroPageIndexedX },
+		{ L"???", AddressMode::implied },
+		{ L"SEC", AddressMode::implied },
+		{ L"AND", AddressMode::absoluteIndexedY },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"AND", AddressMode::absoluteIndexedX },
+		{ L"ROL", AddressMode::absoluteIndexedX },
+		{ L"???", AddressMode::implied },
+		// 0x40
+		{ L"RTI", AddressMode::implied },
+		{ L"EOR", AddressMode::indexedIndirect },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"EOR", AddressMode::zeroPage },
+		{ L"LSR", AddressMode::zeroPage },
+		{ L"???", AddressMode::implied },
+		{ L"PHA", AddressMode::implied },
+		{ L"EOR", AddressMode::immediate },
+		{ L"LSR", AddressMode::accumulator },
+		{ L"???", AddressMode::implied },
+		{ L"JMP", AddressMode::absolute },
+		{ L"EOR", AddressMode::absolute },
+		{ L"LSR", AddressMode::absolute },
+		{ L"???", AddressMode::implied },
+		// 0x50
+		{ L"BVC", AddressMode::relative },
+		{ L"EOR", AddressMode::indirectIndexed },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"EOR", AddressMode::zeroPageIndexedX },
+		{ L"LSR", AddressMode::zeroPageIndexedX },
+		{ L"???", AddressMode::implied },
+		{ L"CLI", AddressMode::implied },
+		{ L"EOR", AddressMode::absoluteIndexedY },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"EOR", AddressMode::absoluteIndexedX },
+		{ L"LSR", AddressMode::absoluteIndexedX },
+		{ L"???", AddressMode::implied },
+		// 0x60
+		{ L"RTS", AddressMode::implied },
+		{ L"ADC", AddressMode::indexedIndirect },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"ADC", AddressMode::zeroPage },
+		{ L"ROR", AddressMode::zeroPage },
+		{ L"???", AddressMode::implied },
+		{ L"PLA", AddressMode::implied },
+		{ L"ADC", AddressMode::immediate },
+		{ L"ROR", AddressMode::accumulator },
+		{ L"???", AddressMode::implied },
+		{ L"JMP", AddressMode::absoluteIndirect },
+		{ L"ADC", AddressMode::absolute },
+		{ L"ROR", AddressMode::absolute },
+		{ L"???", AddressMode::implied },
+		// 0x70
+		{ L"BVS", AddressMode::relative },
+		{ L"ADC", AddressMode::indirectIndexed },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"ADC", AddressMode::zeroPageIndexedX },
+		{ L"ROR", AddressMode::zeroPageIndexedX },
+		{ L"???", AddressMode::implied },
+		{ L"SEI", AddressMode::implied },
+		{ L"ADC", AddressMode::absoluteIndexedY },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"ADC", AddressMode::absoluteIndexedX },
+		{ L"ROR", AddressMode::absoluteIndexedX },
+		{ L"???", AddressMode::implied },
+		// 0x80
+		{ L"???", AddressMode::implied },
+		{ L"STA", AddressMode::indexedIndirect },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"STY", AddressMode::zeroPage },
+		{ L"STA", AddressMode::zeroPage },
+		{ L"STX", AddressMode::zeroPage },
+		{ L"???", AddressMode::implied },
+		{ L"DEY", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"TXA", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"STY", AddressMode::absolute },
+		{ L"STA", AddressMode::absolute },
+		{ L"STX", AddressMode::absolute },
+		{ L"???", AddressMode::implied },
+		// 0x90
+		{ L"BCC", AddressMode::relative },
+		{ L"STA", AddressMode::indirectIndexed },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"STY", AddressMode::zeroPageIndexedX },
+		{ L"STA", AddressMode::zeroPageIndexedX },
+		{ L"STX", AddressMode::zeroPageIndexedY },
+		{ L"???", AddressMode::implied },
+		{ L"TYA", AddressMode::implied },
+		{ L"STA", AddressMode::absoluteIndexedY },
+		{ L"TXS", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"STA", AddressMode::absoluteIndexedX },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		// 0xA0
+		{ L"LDY", AddressMode::immediate },
+		{ L"LDA", AddressMode::indexedIndirect },
+		{ L"LDX", AddressMode::immediate },
+		{ L"???", AddressMode::implied },
+		{ L"LDY", AddressMode::zeroPage },
+		{ L"LDA", AddressMode::zeroPage },
+		{ L"LDX", AddressMode::zeroPage },
+		{ L"???", AddressMode::implied },
+		{ L"TAY", AddressMode::implied },
+		{ L"LDA", AddressMode::immediate },
+		{ L"TAX", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"LDY", AddressMode::absolute },
+		{ L"LDA", AddressMode::absolute },
+		{ L"LDX", AddressMode::absolute },
+		{ L"???", AddressMode::implied },
+		// 0xB0
+		{ L"BCS", AddressMode::relative },
+		{ L"LDA", AddressMode::indirectIndexed },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"LDY", AddressMode::zeroPageIndexedX },
+		{ L"LDA", AddressMode::zeroPageIndexedX },
+		{ L"LDX", AddressMode::zeroPageIndexedY },
+		{ L"???", AddressMode::implied },
+		{ L"CLV", AddressMode::implied },
+		{ L"LDA", AddressMode::absoluteIndexedY },
+		{ L"TSX", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"LDY", AddressMode::absoluteIndexedX },
+		{ L"LDA", AddressMode::absoluteIndexedX },
+		{ L"LDX", AddressMode::absoluteIndexedY },
+		{ L"???", AddressMode::implied },
+		// 0xC0
+		{ L"CPY", AddressMode::immediate },
+		{ L"CMP", AddressMode::indexedIndirect },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"CPY", AddressMode::zeroPage },
+		{ L"CMP", AddressMode::zeroPage },
+		{ L"DEC", AddressMode::zeroPage },
+		{ L"???", AddressMode::implied },
+		{ L"INY", AddressMode::implied },
+		{ L"CMP", AddressMode::immediate },
+		{ L"DEX", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"CPY", AddressMode::absolute },
+		{ L"CMP", AddressMode::absolute },
+		{ L"DEC", AddressMode::absolute },
+		{ L"???", AddressMode::implied },
+		// 0xD0
+		{ L"BNE", AddressMode::relative },
+		{ L"CMP", AddressMode::indirectIndexed },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"CMP", AddressMode::zeroPageIndexedX },
+		{ L"DEC", AddressMode::zeroPageIndexedX },
+		{ L"???", AddressMode::implied },
+		{ L"CLD", AddressMode::implied },
+		{ L"CMP", AddressMode::absoluteIndexedY },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"CMP", AddressMode::absoluteIndexedX },
+		{ L"DEC", AddressMode::absoluteIndexedX },
+		{ L"???", AddressMode::implied },
+		// 0xE0
+		{ L"CPX", AddressMode::immediate },
+		{ L"SBC", AddressMode::indexedIndirect },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"CPX", AddressMode::zeroPage },
+		{ L"SBC", AddressMode::zeroPage },
+		{ L"INC", AddressMode::zeroPage },
+		{ L"???", AddressMode::implied },
+		{ L"INX", AddressMode::implied },
+		{ L"SBC", AddressMode::immediate },
+		{ L"NOP", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"CPX", AddressMode::absolute },
+		{ L"SBC", AddressMode::absolute },
+		{ L"INC", AddressMode::absolute },
+		{ L"???", AddressMode::implied },
+		// 0xF0
+		{ L"BEQ", AddressMode::relative },
+		{ L"SBC", AddressMode::indirectIndexed },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"SBC", AddressMode::zeroPageIndexedX },
+		{ L"INC", AddressMode::zeroPageIndexedX },
+		{ L"???", AddressMode::implied },
+		{ L"SED", AddressMode::implied },
+		{ L"SBC", AddressMode::absoluteIndexedY },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"???", AddressMode::implied },
+		{ L"SBC", AddressMode::absoluteIndexedX },
+		{ L"INC", AddressMode::absoluteIndexedX },
+		{ L"???", AddressMode::implied },
+	} };
+
+	namespace detail {
+
+		/* The 65c02 adds instructions in opcodes that are undefined on the 6502. */
+		constexpr OpcodeTable6502 patch65c02(OpcodeTable6502 table) {
+			table[0x04] = { L"TSB", AddressMode::zeroPage };
+			table[0x0C] = { L"TSB", AddressMode::absolute };
+			table[0x12] = { L"ORA", AddressMode::zeroPageIndirect };
+			table[0x14] = { L"TRB", AddressMode::zeroPage };
+			table[0x1A] = { L"INC", AddressMode::accumulator };
+			table[0x1C] = { L"TRB", AddressMode::absolute };
+			table[0x32] = { L"AND", AddressMode::zeroPageIndirect };
+			table[0x34] = { L"BIT", AddressMode::zeroPageIndexedX };
+			table[0x3A] = { L"DEC", AddressMode::accumulator };
+			table[0x3C] = { L"BIT", AddressMode::absoluteIndexedX };
+			table[0x52] = { L"EOR", AddressMode::zeroPageIndirect };
+			table[0x5A] = { L"PHY", AddressMode::implied };
+			table[0x64] = { L"STZ", AddressMode::zeroPage };
+			table[0x72] = { L"ADC", AddressMode::zeroPageIndirect };
+			table[0x74] = { L"STZ", AddressMode::zeroPageIndexedX };
+			table[0x7A] = { L"PLY", AddressMode::implied };
+			table[0x7C] = { L"JMP", AddressMode::absoluteIndexedIndirect };
+			table[0x80] = { L"BRA", AddressMode::relative };
+			table[0x89] = { L"BIT", AddressMode::immediate };
+			table[0x92] = { L"STA", AddressMode::zeroPageIndirect };
+			table[0x9C] = { L"STZ", AddressMode::absolute };
+			table[0x9E] = { L"STZ", AddressMode::absoluteIndexedX };
+			table[0xB2] = { L"LDA", AddressMode::zeroPageIndirect };
+			table[0xD2] = { L"CMP", AddressMode::zeroPageIndirect };
+			table[0xDA] = { L"PHX", AddressMode::implied };
+			table[0xF2] = { L"SBC", AddressMode::zeroPageIndirect };
+			table[0xFA] = { L"PLX", AddressMode::implied };
+			return table;
+		}
+
+	}
+
+	inline constexpr OpcodeTable6502 opcodes65c02 = detail::patch65c02(opcodes6502);
+
+	namespace detail {
+
+		/* The 65c816 defines every opcode. Immediate operands of the accumulator and index
+		   registers are as wide as the register. */
+		constexpr OpcodeTable6502 patch65c816(OpcodeTable6502 table) {
+			for (auto opcode : { 0x09, 0x29, 0x49, 0x69, 0x89, 0xA9, 0xC9, 0xE9 }) {
+				table[opcode].mode = AddressMode::immediateAccumulator;
+			}
+			for (auto opcode : { 0xA0, 0xA2, 0xC0, 0xE0 }) {
+				table[opcode].mode = AddressMode::immediateIndex;
+			}
+			wchar_t const * const longGroup[] = { L"ORA", L"AND", L"EOR", L"ADC", L"STA", L"LDA", L"CMP", L"SBC" };
+			for (int row = 0; row != 8; ++row) {
+				auto mnemonic = longGroup[row];
+				table[row * 0x20 + 0x03] = { mnemonic, AddressMode::stackRelative };
+				table[row * 0x20 + 0x07] = { mnemonic, AddressMode::zeroPageIndirectLong };
+				table[row * 0x20 + 0x0F] = { mnemonic, AddressMode::absoluteLong };
+				table[row * 0x20 + 0x13] = { mnemonic, AddressMode::stackRelativeIndirectIndexed };
+				table[row * 0x20 + 0x17] = { mnemonic, AddressMode::zeroPageIndirectLongIndexedY };
+				table[row * 0x20 + 0x1F] = { mnemonic, AddressMode::absoluteLongIndexedX };
+			}
+			table[0x02] = { L"COP", AddressMode::immediate };
+			table[0x0B] = { L"PHD", AddressMode::implied };
+			table[0x1B] = { L"TCS", AddressMode::implied };
+			table[0x22] = { L"JSL", AddressMode::absoluteLong };
+			table[0x2B] = { L"PLD", AddressMode::implied };
+			table[0x3B] = { L"TSC", AddressMode::implied };
+			table[0x42] = { L"WDM", AddressMode::immediate };
+			table[0x44] = { L"MVP", AddressMode::blockMove };
+			table[0x4B] = { L"PHK", AddressMode::implied };
+			table[0x54] = { L"MVN", AddressMode::blockMove };
+			table[0x5B] = { L"TCD", AddressMode::implied };
+			table[0x5C] = { L"JML", AddressMode::absoluteLong };
+			table[0x62] = { L"PER", AddressMode::relativeLong };
+			table[0x6B] = { L"RTL", AddressMode::implied };
+			table[0x7B] = { L"TDC", AddressMode::implied };
+			table[0x82] = { L"BRL", AddressMode::relativeLong };
+			table[0x8B] = { L"PHB", AddressMode::implied };
+			table[0x9B] = { L"TXY", AddressMode::implied };
+			table[0xAB] = { L"PLB", AddressMode::implied };
+			table[0xBB] = { L"TYX", AddressMode::implied };
+			table[0xC2] = { L"REP", AddressMode::immediate };
+			table[0xCB] = { L"WAI", AddressMode::implied };
+			table[0xD4] = { L"PEI", AddressMode::zeroPageIndirect };
+			table[0xDB] = { L"STP", AddressMode::implied };
+			table[0xDC] = { L"JML", AddressMode::absoluteIndirectLong };
+			table[0xE2] = { L"SEP", AddressMode::immediate };
+			table[0xEB] = { L"XBA", AddressMode::implied };
+			table[0xF4] = { L"PEA", AddressMode::absolute };
+			table[0xFB] = { L"XCE", AddressMode::implied };
+			table[0xFC] = { L"JSR", AddressMode::absoluteIndexedIndirect };
+			return table;
+		}
+
+	}
+
+	inline constexpr OpcodeTable6502 opcodes65c816 = detail::patch65c816(opcodes65c02);
+
+	inline OpcodeTable6502 const & opcodeTable(cpu_t cpu) {
+		switch (cpu) {
+		case cpu_t::_65c02:
+			return opcodes65c02;
+		case cpu_t::_65c816:
+			return opcodes65c816;
+		default:
+			return opcodes6502;
+		}
+	}
+
+	/* The cycles an opcode takes, and whether indexing across a page boundary takes one more.
+	   A branch takes one more cycle when it is taken, and another if it goes to a different
+	   page. On the 65c02, ADC and SBC take one more cycle in decimal mode. */
+	struct Cycles6502 {
+		std::uint8_t base;
+		bool pageCross;
+	};
+
+	using CycleTable6502 = std::array<Cycles6502, 256>;
+
+	namespace detail {
+
+		constexpr std::uint8_t P = 0x10;
+
+		/* The cycles of each opcode, with P added where a page crossing costs a cycle. The
+		   opcodes that are undefined on the 6502 are given two cycles. */
+		constexpr std::array<std::uint8_t, 256> timing6502 = {
+			7, 6,   2, 2, 2, 3, 5, 2, 3, 2,   2, 2, 2,   4,   6, 2, // 0x00
+			2, 5|P, 2, 2, 2, 4, 6, 2, 2, 4|P, 2, 2, 2,   4|P, 7, 2, // 0x10
+			6, 6,   2, 2, 3, 3, 5, 2, 4, 2,   2, 2, 4,   4,   6, 2, // 0x20
+			2, 5|P, 2, 2, 2, 4, 6, 2, 2, 4|P, 2, 2, 2,   4|P, 7, 2, // 0x30
+			6, 6,   2, 2, 2, 3, 5, 2, 3, 2,   2, 2, 3,   4,   6, 2, // 0x40
+			2, 5|P, 2, 2, 2, 4, 6, 2, 2, 4|P, 2, 2, 2,   4|P, 7, 2, // 0x50
+			6, 6,   2, 2, 2, 3, 5, 2, 4, 2,   2, 2, 5,   4,   6, 2, // 0x60
+			2, 5|P, 2, 2, 2, 4, 6, 2, 2, 4|P, 2, 2, 2,   4|P, 7, 2, // 0x70
+			2, 6,   2, 2, 3, 3, 3, 2, 2, 2,   2, 2, 4,   4,   4, 2, // 0x80
+			2, 6,   2, 2, 4, 4, 4, 2, 2, 5,   2, 2, 2,   5,   2, 2, // 0x90
+			2, 6,   2, 2, 3, 3, 3, 2, 2, 2,   2, 2, 4,   4,   4, 2, // 0xA0
+			2, 5|P, 2, 2, 4, 4, 4, 2, 2, 4|P, 2, 2, 4|P, 4|P, 4|P, 2, // 0xB0
+			2, 6,   2, 2, 3, 3, 5, 2, 2, 2,   2, 2, 4,   4,   6, 2, // 0xC0
+			2, 5|P, 2, 2, 2, 4, 6, 2, 2, 4|P, 2, 2, 2,   4|P, 7, 2, // 0xD0
+			2, 6,   2, 2, 3, 3, 5, 2, 2, 2,   2, 2, 4,   4,   6, 2, // 0xE0
+			2, 5|P, 2, 2, 2, 4, 6, 2, 2, 4|P, 2, 2, 2,   4|P, 7, 2, // 0xF0
+		};
+
+		constexpr CycleTable6502 cycleTable(std::array<std::uint8_t, 256> const & timing) {
+			CycleTable6502 result{};
+			for (std::size_t opcode = 0; opcode != timing.size(); ++opcode) {
+				result[opcode] = { static_cast<std::uint8_t>(timing[opcode] & ~P), (timing[opcode] & P) != 0 };
+			}
+			return result;
+		}
+
+		/* The timing of the 65c02 opcodes, including the shifts and rotates of an indexed address,
+		   which only take the extra cycle when the page is crossed, and JMP (abs), which no longer
+		   wraps within a page. */
+		constexpr std::array<std::uint8_t, 256> patchTiming65c02(std::array<std::uint8_t, 256> timing) {
+			constexpr std::pair<int, int> changes[] = { { 0x04, 5 }, { 0x0C, 6 }, { 0x12, 5 }, { 0x14, 5 }, { 0x1A, 2 }, { 0x1C, 6 },
+				{ 0x32, 5 }, { 0x34, 4 }, { 0x3A, 2 }, { 0x3C, 4|P }, { 0x52, 5 }, { 0x5A, 3 }, { 0x64, 3 }, { 0x72, 5 },
+				{ 0x74, 4 }, { 0x7A, 4 }, { 0x7C, 6 }, { 0x80, 2 }, { 0x89, 2 }, { 0x92, 5 }, { 0x9C, 4 }, { 0x9E, 5 },
+				{ 0xB2, 5 }, { 0xD2, 5 }, { 0xDA, 3 }, { 0xF2, 5 }, { 0xFA, 4 },
+				{ 0x1E, 6|P }, { 0x3E, 6|P }, { 0x5E, 6|P }, { 0x7E, 6|P }, { 0x6C, 6 } };
+			for (auto [opcode, cycles] : changes) {
+				timing[opcode] = static_cast<std::uint8_t>(cycles);
+			}
+			return timing;
+		}
+
+	}
+
+	namespace detail {
+
+		/* The timing of the 65c816 with 8 bit registers and the direct page on a page boundary.
+		   A 16 bit register takes one more cycle for each extra byte it reads or writes. */
+		constexpr std::array<std::uint8_t, 256> timing65c816 = {
+			7, 6,   7, 4, 5, 3, 5, 6, 3, 2,   2, 4, 6,   4,   6, 5, // 0x00
+			2, 5|P, 5, 7, 5, 4, 6, 6, 2, 4|P, 2, 2, 6,   4|P, 7, 5, // 0x10
+			6, 6,   8, 4, 3, 3, 5, 6, 4, 2,   2, 5, 4,   4,   6, 5, // 0x20
+			2, 5|P, 5, 7, 4, 4, 6, 6, 2, 4|P, 2, 2, 4|P, 4|P, 7, 5, // 0x30
+			6, 6,   2, 4, 7, 3, 5, 6, 3, 2,   2, 3, 3,   4,   6, 5, // 0x40
+			2, 5|P, 5, 7, 7, 4, 6, 6, 2, 4|P, 3, 2, 4,   4|P, 7, 5, // 0x50
+			6, 6,   6, 4, 3, 3, 5, 6, 4, 2,   2, 6, 5,   4,   6, 5, // 0x60
+			2, 5|P, 5, 7, 4, 4, 6, 6, 2, 4|P, 4, 2, 6,   4|P, 7, 5, // 0x70
+			2, 6,   4, 4, 3, 3, 3, 6, 2, 2,   2, 3, 4,   4,   4, 5, // 0x80
+			2, 6,   5, 7, 4, 4, 4, 6, 2, 5,   2, 2, 4,   5,   5, 5, // 0x90
+			2, 6,   2, 4, 3, 3, 3, 6, 2, 2,   2, 4, 4,   4,   4, 5, // 0xA0
+			2, 5|P, 5, 7, 4, 4, 4, 6, 2, 4|P, 2, 2, 4|P, 4|P, 4|P, 5, // 0xB0
+			2, 6,   3, 4, 3, 3, 5, 6, 2, 2,   2, 3, 4,   4,   6, 5, // 0xC0
+			2, 5|P, 5, 7, 6, 4, 6, 6, 2, 4|P, 3, 3, 6,   4|P, 7, 5, // 0xD0
+			2, 6,   3, 4, 3, 3, 5, 6, 2, 2,   2, 3, 4,   4,   6, 5, // 0xE0
+			2, 5|P, 5, 7, 5, 4, 6, 6, 2, 4|P, 4, 2, 8,   4|P, 7, 5, // 0xF0
+		};
+
+	}
+
+	inline constexpr CycleTable6502 cycles6502 = detail::cycleTable(detail::timing6502);
+	inline constexpr CycleTable6502 cycles65c02 = detail::cycleTable(detail::patchTiming65c02(detail::timing6502));
+	inline constexpr CycleTable6502 cycles65c816 = detail::cycleTable(detail::timing65c816);
+
+	inline CycleTable6502 const & cycleTable(cpu_t cpu) {
+		switch (cpu) {
+		case cpu_t::_65c02:
+			return cycles65c02;
+		case cpu_t::_65c816:
+			return cycles65c816;
+		default:
+			return cycles6502;
+		}
+	}
+
+}
+
+#endif // !_B32DFBB8_3A3A_4BA2_B424_6E55E3DEB439
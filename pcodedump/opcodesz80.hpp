@@ -0,0 +1,1135 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _4683CA22_8A8E_40BB_8DD5_B47585A702C0
+#define _4683CA22_8A8E_40BB_8DD5_B47585A702C0
+
+#include <array>
+
+namespace pcodedump {
+
+	/* The text of each instruction, with its operands written in lower case: n is a byte,
+	   nn a word, e a relative jump and d the displacement of an index register. Opcodes
+	   that aren't instructions are ???. */
+	using OpcodeTableZ80 = std::array<wchar_t const *, 256>;
+
+	/* The Intel mnemonics of the 8080. */
+	inline constexpr OpcodeTableZ80 opcodes8080 = { {
+		// 0x00
+		L"NOP",
+		L"LXI B,nn",
+		L"STAX B",
+		L"INX B",
+		L"INR B",
+		L"DCR B",
+		L"MVI B,n",
+		L"RLC",
+		L"???",
+		L"DAD B",
+		L"LDAX B",
+		L"DCX B",
+		L"INR C",
+		L"DCR C",
+		L"MVI C,n",
+		L"RRC",
+		// 0x10
+		L"???",
+		L"LXI D,nn",
+		L"STAX D",
+		L"INX D",
+		L"INR D",
+		L"DCR D",
+		L"MVI D,n",
+		L"RAL",
+		L"???",
+		L"DAD D",
+		L"LDAX D",
+		L"DCX D",
+		L"INR E",
+		L"DCR E",
+		L"MVI E,n",
+		L"RAR",
+		// 0x20
+		L"???",
+		L"LXI H,nn",
+		L"SHLD nn",
+		L"INX H",
+		L"INR H",
+		L"DCR H",
+		L"MVI H,n",
+		L"DAA",
+		L"???",
+		L"DAD H",
+		L"LHLD nn",
+		L"DCX H",
+		L"INR L",
+		L"DCR L",
+		L"MVI L,n",
+		L"CMA",
+		// 0x30
+		L"???",
+		L"LXI SP,nn",
+		L"STA nn",
+		L"INX SP",
+		L"INR M",
+		L"DCR M",
+		L"MVI M,n",
+		L"STC",
+		L"???",
+		L"DAD SP",
+		L"LDA nn",
+		L"DCX SP",
+		L"INR A",
+		L"DCR A",
+		L"MVI A,n",
+		L"CMC",
+		// 0x40
+		L"MOV B,B",
+		L"MOV B,C",
+		L"MOV B,D",
+		L"MOV B,E",
+		L"MOV B,H",
+		L"MOV B,L",
+		L"MOV B,M",
+		L"MOV B,A",
+		L"MOV C,B",
+		L"MOV C,C",
+		L"MOV C,D",
+		L"MOV C,E",
+		L"MOV C,H",
+		L"MOV C,L",
+		L"MOV C,M",
+		L"MOV C,A",
+		// 0x50
+		L"MOV D,B",
+		L"MOV D,C",
+		L"MOV D,D",
+		L"MOV D,E",
+		L"MOV D,H",
+		L"MOV D,L",
+		L"MOV D,M",
+		L"MOV D,A",
+		L"MOV E,B",
+		L"MOV E,C",
+		L"MOV E,D",
+		L"MOV E,E",
+		L"MOV E,H",
+		L"MOV E,L",
+		L"MOV E,M",
+		L"MOV E,A",
+		// 0x60
+		L"MOV H,B",
+		L"MOV H,C",
+		L"MOV H,D",
+		L"MOV H,E",
+		L"MOV H,H",
+		L"MOV H,L",
+		L"MOV H,M",
+		L"MOV H,A",
+		L"MOV L,B",
+		L"MOV L,C",
+		L"MOV L,D",
+		L"MOV L,E",
+		L"MOV L,H",
+		L"MOV L,L",
+		L"MOV L,M",
+		L"MOV L,A",
+		// 0x70
+		L"MOV M,B",
+		L"MOV M,C",
+		L"MOV M,D",
+		L"MOV M,E",
+		L"MOV M,H",
+		L"MOV M,L",
+		L"HLT",
+		L"MOV M,A",
+		L"MOV A,B",
+		L"MOV A,C",
+		L"MOV A,D",
+		L"MOV A,E",
+		L"MOV A,H",
+		L"MOV A,L",
+		L"MOV A,M",
+		L"MOV A,A",
+		// 0x80
+		L"ADD B",
+		L"ADD C",
+		L"ADD D",
+		L"ADD E",
+		L"ADD H",
+		L"ADD L",
+		L"ADD M",
+		L"ADD A",
+		L"ADC B",
+		L"ADC C",
+		L"ADC D",
+		L"ADC E",
+		L"ADC H",
+		L"ADC L",
+		L"ADC M",
+		L"ADC A",
+		// 0x90
+		L"SUB B",
+		L"SUB C",
+		L"SUB D",
+		L"SUB E",
+		L"SUB H",
+		L"SUB L",
+		L"SUB M",
+		L"SUB A",
+		L"SBB B",
+		L"SBB C",
+		L"SBB D",
+		L"SBB E",
+		L"SBB H",
+		L"SBB L",
+		L"SBB M",
+		L"SBB A",
+		// 0xA0
+		L"ANA B",
+		L"ANA C",
+		L"ANA D",
+		L"ANA E",
+		L"ANA H",
+		L"ANA L",
+		L"ANA M",
+		L"ANA A",
+		L"XRA B",
+		L"XRA C",
+		L"XRA D",
+		L"XRA E",
+		L"XRA H",
+		L"XRA L",
+		L"XRA M",
+		L"XRA A",
+		// 0xB0
+		L"ORA B",
+		L"ORA C",
+		L"ORA D",
+		L"ORA E",
+		L"ORA H",
+		L"ORA L",
+		L"ORA M",
+		L"ORA A",
+		L"CMP B",
+		L"CMP C",
+		L"CMP D",
+		L"CMP E",
+		L"CMP H",
+		L"CMP L",
+		L"CMP M",
+		L"CMP A",
+		// 0xC0
+		L"RNZ",
+		L"POP B",
+		L"JNZ nn",
+		L"JMP nn",
+		L"CNZ nn",
+		L"PUSH B",
+		L"ADI n",
+		L"RST 0",
+		L"RZ",
+		L"RET",
+		L"JZ nn",
+		L"???",
+		L"CZ nn",
+		L"CALL nn",
+		L"ACI n",
+		L"RST 1",
+		// 0xD0
+		L"RNC",
+		L"POP D",
+		L"JNC nn",
+		L"OUT n",
+		L"CNC nn",
+		L"PUSH D",
+		L"SUI n",
+		L"RST 2",
+		L"RC",
+		L"???",
+		L"JC nn",
+		L"IN n",
+		L"CC nn",
+		L"???",
+		L"SBI n",
+		L"RST 3",
+		// 0xE0
+		L"RPO",
+		L"POP H",
+		L"JPO nn",
+		L"XTHL",
+		L"CPO nn",
+		L"PUSH H",
+		L"ANI n",
+		L"RST 4",
+		L"RPE",
+		L"PCHL",
+		L"JPE nn",
+		L"XCHG",
+		L"CPE nn",
+		L"???",
+		L"XRI n",
+		L"RST 5",
+		// 0xF0
+		L"RP",
+		L"POP PSW",
+		L"JP nn",
+		L"DI",
+		L"CP nn",
+		L"PUSH PSW",
+		L"ORI n",
+		L"RST 6",
+		L"RM",
+		L"SPHL",
+		L"JM nn",
+		L"EI",
+		L"CM nn",
+		L"???",
+		L"CPI n",
+		L"RST 7",
+	} };
+
+	/* The Zilog mnemonics of the Z80, without the prefixes CB, DD, ED and FD. */
+	inline constexpr OpcodeTableZ80 opcodesZ80 = { {
+		// 0x00
+		L"NOP",
+		L"LD BC,nn",
+		L"LD (BC),A",
+		L"INC BC",
+		L"INC B",
+		L"DEC B",
+		L"LD B,n",
+		L"RLCA",
+		L"EX AF,AF'",
+		L"ADD HL,BC",
+		L"LD A,(BC)",
+		L"DEC BC",
+		L"INC C",
+		L"DEC C",
+		L"LD C,n",
+		L"RRCA",
+		// 0x10
+		L"DJNZ e",
+		L"LD DE,nn",
+		L"LD (DE),A",
+		L"INC DE",
+		L"INC D",
+		L"DEC D",
+		L"LD D,n",
+		L"RLA",
+		L"JR e",
+		L"ADD HL,DE",
+		L"LD A,(DE)",
+		L"DEC DE",
+		L"INC E",
+		L"DEC E",
+		L"LD E,n",
+		L"RRA",
+		// 0x20
+		L"JR NZ,e",
+		L"LD HL,nn",
+		L"LD (nn),HL",
+		L"INC HL",
+		L"INC H",
+		L"DEC H",
+		L"LD H,n",
+		L"DAA",
+		L"JR Z,e",
+		L"ADD HL,HL",
+		L"LD HL,(nn)",
+		L"DEC HL",
+		L"INC L",
+		L"DEC L",
+		L"LD L,n",
+		L"CPL",
+		// 0x30
+		L"JR NC,e",
+		L"LD SP,nn",
+		L"LD (nn),A",
+		L"INC SP",
+		L"INC (HL)",
+		L"DEC (HL)",
+		L"LD (HL),n",
+		L"SCF",
+		L"JR C,e",
+		L"ADD HL,SP",
+		L"LD A,(nn)",
+		L"DEC SP",
+		L"INC A",
+		L"DEC A",
+		L"LD A,n",
+		L"CCF",
+		// 0x40
+		L"LD B,B",
+		L"LD B,C",
+		L"LD B,D",
+		L"LD B,E",
+		L"LD B,H",
+		L"LD B,L",
+		L"LD B,(HL)",
+		L"LD B,A",
+		L"LD C,B",
+		L"LD C,C",
+		L"LD C,D",
+		L"LD C,E",
+		L"LD C,H",
+		L"LD C,L",
+		L"LD C,(HL)",
+		L"LD C,A",
+		// 0x50
+		L"LD D,B",
+		L"LD D,C",
+		L"LD D,D",
+		L"LD D,E",
+		L"LD D,H",
+		L"LD D,L",
+		L"LD D,(HL)",
+		L"LD D,A",
+		L"LD E,B",
+		L"LD E,C",
+		L"LD E,D",
+		L"LD E,E",
+		L"LD E,H",
+		L"LD E,L",
+		L"LD E,(HL)",
+		L"LD E,A",
+		// 0x60
+		L"LD H,B",
+		L"LD H,C",
+		L"LD H,D",
+		L"LD H,E",
+		L"LD H,H",
+		L"LD H,L",
+		L"LD H,(HL)",
+		L"LD H,A",
+		L"LD L,B",
+		L"LD L,C",
+		L"LD L,D",
+		L"LD L,E",
+		L"LD L,H",
+		L"LD L,L",
+		L"LD L,(HL)",
+		L"LD L,A",
+		// 0x70
+		L"LD (HL),B",
+		L"LD (HL),C",
+		L"LD (HL),D",
+		L"LD (HL),E",
+		L"LD (HL),H",
+		L"LD (HL),L",
+		L"HALT",
+		L"LD (HL),A",
+		L"LD A,B",
+		L"LD A,C",
+		L"LD A,D",
+		L"LD A,E",
+		L"LD A,H",
+		L"LD A,L",
+		L"LD A,(HL)",
+		L"LD A,A",
+		// 0x80
+		L"ADD A,B",
+		L"ADD A,C",
+		L"ADD A,D",
+		L"ADD A,E",
+		L"ADD A,H",
+		L"ADD A,L",
+		L"ADD A,(HL)",
+		L"ADD A,A",
+		L"ADC A,B",
+		L"ADC A,C",
+		L"ADC A,D",
+		L"ADC A,E",
+		L"ADC A,H",
+		L"ADC A,L",
+		L"ADC A,(HL)",
+		L"ADC A,A",
+		// 0x90
+		L"SUB B",
+		L"SUB C",
+		L"SUB D",
+		L"SUB E",
+		L"SUB H",
+		L"SUB L",
+		L"SUB (HL)",
+		L"SUB A",
+		L"SBC A,B",
+		L"SBC A,C",
+		L"SBC A,D",
+		L"SBC A,E",
+		L"SBC A,H",
+		L"SBC A,L",
+		L"SBC A,(HL)",
+		L"SBC A,A",
+		// 0xA0
+		L"AND B",
+		L"AND C",
+		L"AND D",
+		L"AND E",
+		L"AND H",
+		L"AND L",
+		L"AND (HL)",
+		L"AND A",
+		L"XOR B",
+		L"XOR C",
+		L"XOR D",
+		L"XOR E",
+		L"XOR H",
+		L"XOR L",
+		L"XOR (HL)",
+		L"XOR A",
+		// 0xB0
+		L"OR B",
+		L"OR C",
+		L"OR D",
+		L"OR E",
+		L"OR H",
+		L"OR L",
+		L"OR (HL)",
+		L"OR A",
+		L"CP B",
+		L"CP C",
+		L"CP D",
+		L"CP E",
+		L"CP H",
+		L"CP L",
+		L"CP (HL)",
+		L"CP A",
+		// 0xC0
+		L"RET NZ",
+		L"POP BC",
+		L"JP NZ,nn",
+		L"JP nn",
+		L"CALL NZ,nn",
+		L"PUSH BC",
+		L"ADD A,n",
+		L"RST $00",
+		L"RET Z",
+		L"RET",
+		L"JP Z,nn",
+		L"???",
+		L"CALL Z,nn",
+		L"CALL nn",
+		L"ADC A,n",
+		L"RST $08",
+		// 0xD0
+		L"RET NC",
+		L"POP DE",
+		L"JP NC,nn",
+		L"OUT (n),A",
+		L"CALL NC,nn",
+		L"PUSH DE",
+		L"SUB n",
+		L"RST $10",
+		L"RET C",
+		L"EXX",
+		L"JP C,nn",
+		L"IN A,(n)",
+		L"CALL C,nn",
+		L"???",
+		L"SBC A,n",
+		L"RST $18",
+		// 0xE0
+		L"RET PO",
+		L"POP HL",
+		L"JP PO,nn",
+		L"EX (SP),HL",
+		L"CALL PO,nn",
+		L"PUSH HL",
+		L"AND n",
+		L"RST $20",
+		L"RET PE",
+		L"JP (HL)",
+		L"JP PE,nn",
+		L"EX DE,HL",
+		L"CALL PE,nn",
+		L"???",
+		L"XOR n",
+		L"RST $28",
+		// 0xF0
+		L"RET P",
+		L"POP AF",
+		L"JP P,nn",
+		L"DI",
+		L"CALL P,nn",
+		L"PUSH AF",
+		L"OR n",
+		L"RST $30",
+		L"RET M",
+		L"LD SP,HL",
+		L"JP M,nn",
+		L"EI",
+		L"CALL M,nn",
+		L"???",
+		L"CP n",
+		L"RST $38",
+	} };
+
+	/* Instructions prefixed by CB: rotates, shifts and bit operations. */
+	inline constexpr OpcodeTableZ80 opcodesZ80cb = { {
+		// 0x00
+		L"RLC B",
+		L"RLC C",
+		L"RLC D",
+		L"RLC E",
+		L"RLC H",
+		L"RLC L",
+		L"RLC (HL)",
+		L"RLC A",
+		L"RRC B",
+		L"RRC C",
+		L"RRC D",
+		L"RRC E",
+		L"RRC H",
+		L"RRC L",
+		L"RRC (HL)",
+		L"RRC A",
+		// 0x10
+		L"RL B",
+		L"RL C",
+		L"RL D",
+		L"RL E",
+		L"RL H",
+		L"RL L",
+		L"RL (HL)",
+		L"RL A",
+		L"RR B",
+		L"RR C",
+		L"RR D",
+		L"RR E",
+		L"RR H",
+		L"RR L",
+		L"RR (HL)",
+		L"RR A",
+		// 0x20
+		L"SLA B",
+		L"SLA C",
+		L"SLA D",
+		L"SLA E",
+		L"SLA H",
+		L"SLA L",
+		L"SLA (HL)",
+		L"SLA A",
+		L"SRA B",
+		L"SRA C",
+		L"SRA D",
+		L"SRA E",
+		L"SRA H",
+		L"SRA L",
+		L"SRA (HL)",
+		L"SRA A",
+		// 0x30
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"SRL B",
+		L"SRL C",
+		L"SRL D",
+		L"SRL E",
+		L"SRL H",
+		L"SRL L",
+		L"SRL (HL)",
+		L"SRL A",
+		// 0x40
+		L"BIT 0,B",
+		L"BIT 0,C",
+		L"BIT 0,D",
+		L"BIT 0,E",
+		L"BIT 0,H",
+		L"BIT 0,L",
+		L"BIT 0,(HL)",
+		L"BIT 0,A",
+		L"BIT 1,B",
+		L"BIT 1,C",
+		L"BIT 1,D",
+		L"BIT 1,E",
+		L"BIT 1,H",
+		L"BIT 1,L",
+		L"BIT 1,(HL)",
+		L"BIT 1,A",
+		// 0x50
+		L"BIT 2,B",
+		L"BIT 2,C",
+		L"BIT 2,D",
+		L"BIT 2,E",
+		L"BIT 2,H",
+		L"BIT 2,L",
+		L"BIT 2,(HL)",
+		L"BIT 2,A",
+		L"BIT 3,B",
+		L"BIT 3,C",
+		L"BIT 3,D",
+		L"BIT 3,E",
+		L"BIT 3,H",
+		L"BIT 3,L",
+		L"BIT 3,(HL)",
+		L"BIT 3,A",
+		// 0x60
+		L"BIT 4,B",
+		L"BIT 4,C",
+		L"BIT 4,D",
+		L"BIT 4,E",
+		L"BIT 4,H",
+		L"BIT 4,L",
+		L"BIT 4,(HL)",
+		L"BIT 4,A",
+		L"BIT 5,B",
+		L"BIT 5,C",
+		L"BIT 5,D",
+		L"BIT 5,E",
+		L"BIT 5,H",
+		L"BIT 5,L",
+		L"BIT 5,(HL)",
+		L"BIT 5,A",
+		// 0x70
+		L"BIT 6,B",
+		L"BIT 6,C",
+		L"BIT 6,D",
+		L"BIT 6,E",
+		L"BIT 6,H",
+		L"BIT 6,L",
+		L"BIT 6,(HL)",
+		L"BIT 6,A",
+		L"BIT 7,B",
+		L"BIT 7,C",
+		L"BIT 7,D",
+		L"BIT 7,E",
+		L"BIT 7,H",
+		L"BIT 7,L",
+		L"BIT 7,(HL)",
+		L"BIT 7,A",
+		// 0x80
+		L"RES 0,B",
+		L"RES 0,C",
+		L"RES 0,D",
+		L"RES 0,E",
+		L"RES 0,H",
+		L"RES 0,L",
+		L"RES 0,(HL)",
+		L"RES 0,A",
+		L"RES 1,B",
+		L"RES 1,C",
+		L"RES 1,D",
+		L"RES 1,E",
+		L"RES 1,H",
+		L"RES 1,L",
+		L"RES 1,(HL)",
+		L"RES 1,A",
+		// 0x90
+		L"RES 2,B",
+		L"RES 2,C",
+		L"RES 2,D",
+		L"RES 2,E",
+		L"RES 2,H",
+		L"RES 2,L",
+		L"RES 2,(HL)",
+		L"RES 2,A",
+		L"RES 3,B",
+		L"RES 3,C",
+		L"RES 3,D",
+		L"RES 3,E",
+		L"RES 3,H",
+		L"RES 3,L",
+		L"RES 3,(HL)",
+		L"RES 3,A",
+		// 0xA0
+		L"RES 4,B",
+		L"RES 4,C",
+		L"RES 4,D",
+		L"RES 4,E",
+		L"RES 4,H",
+		L"RES 4,L",
+		L"RES 4,(HL)",
+		L"RES 4,A",
+		L"RES 5,B",
+		L"RES 5,C",
+		L"RES 5,D",
+		L"RES 5,E",
+		L"RES 5,H",
+		L"RES 5,L",
+		L"RES 5,(HL)",
+		L"RES 5,A",
+		// 0xB0
+		L"RES 6,B",
+		L"RES 6,C",
+		L"RES 6,D",
+		L"RES 6,E",
+		L"RES 6,H",
+		L"RES 6,L",
+		L"RES 6,(HL)",
+		L"RES 6,A",
+		L"RES 7,B",
+		L"RES 7,C",
+		L"RES 7,D",
+		L"RES 7,E",
+		L"RES 7,H",
+		L"RES 7,L",
+		L"RES 7,(HL)",
+		L"RES 7,A",
+		// 0xC0
+		L"SET 0,B",
+		L"SET 0,C",
+		L"SET 0,D",
+		L"SET 0,E",
+		L"SET 0,H",
+		L"SET 0,L",
+		L"SET 0,(HL)",
+		L"SET 0,A",
+		L"SET 1,B",
+		L"SET 1,C",
+		L"SET 1,D",
+		L"SET 1,E",
+		L"SET 1,H",
+		L"SET 1,L",
+		L"SET 1,(HL)",
+		L"SET 1,A",
+		// 0xD0
+		L"SET 2,B",
+		L"SET 2,C",
+		L"SET 2,D",
+		L"SET 2,E",
+		L"SET 2,H",
+		L"SET 2,L",
+		L"SET 2,(HL)",
+		L"SET 2,A",
+		L"SET 3,B",
+		L"SET 3,C",
+		L"SET 3,D",
+		L"SET 3,E",
+		L"SET 3,H",
+		L"SET 3,L",
+		L"SET 3,(HL)",
+		L"SET 3,A",
+		// 0xE0
+		L"SET 4,B",
+		L"SET 4,C",
+		L"SET 4,D",
+		L"SET 4,E",
+		L"SET 4,H",
+		L"SET 4,L",
+		L"SET 4,(HL)",
+		L"SET 4,A",
+		L"SET 5,B",
+		L"SET 5,C",
+		L"SET 5,D",
+		L"SET 5,E",
+		L"SET 5,H",
+		L"SET 5,L",
+		L"SET 5,(HL)",
+		L"SET 5,A",
+		// 0xF0
+		L"SET 6,B",
+		L"SET 6,C",
+		L"SET 6,D",
+		L"SET 6,E",
+		L"SET 6,H",
+		L"SET 6,L",
+		L"SET 6,(HL)",
+		L"SET 6,A",
+		L"SET 7,B",
+		L"SET 7,C",
+		L"SET 7,D",
+		L"SET 7,E",
+		L"SET 7,H",
+		L"SET 7,L",
+		L"SET 7,(HL)",
+		L"SET 7,A",
+	} };
+
+	/* Instructions prefixed by ED. */
+	inline constexpr OpcodeTableZ80 opcodesZ80ed = { {
+		// 0x00
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0x10
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0x20
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0x30
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0x40
+		L"IN B,(C)",
+		L"OUT (C),B",
+		L"SBC HL,BC",
+		L"LD (nn),BC",
+		L"NEG",
+		L"RETN",
+		L"IM 0",
+		L"LD I,A",
+		L"IN C,(C)",
+		L"OUT (C),C",
+		L"ADC HL,BC",
+		L"LD BC,(nn)",
+		L"???",
+		L"RETI",
+		L"???",
+		L"LD R,A",
+		// 0x50
+		L"IN D,(C)",
+		L"OUT (C),D",
+		L"SBC HL,DE",
+		L"LD (nn),DE",
+		L"???",
+		L"???",
+		L"IM 1",
+		L"LD A,I",
+		L"IN E,(C)",
+		L"OUT (C),E",
+		L"ADC HL,DE",
+		L"LD DE,(nn)",
+		L"???",
+		L"???",
+		L"IM 2",
+		L"LD A,R",
+		// 0x60
+		L"IN H,(C)",
+		L"OUT (C),H",
+		L"SBC HL,HL",
+		L"LD (nn),HL",
+		L"???",
+		L"???",
+		L"???",
+		L"RRD",
+		L"IN L,(C)",
+		L"OUT (C),L",
+		L"ADC HL,HL",
+		L"LD HL,(nn)",
+		L"???",
+		L"???",
+		L"???",
+		L"RLD",
+		// 0x70
+		L"???",
+		L"???",
+		L"SBC HL,SP",
+		L"LD (nn),SP",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"IN A,(C)",
+		L"OUT (C),A",
+		L"ADC HL,SP",
+		L"LD SP,(nn)",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0x80
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0x90
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0xA0
+		L"LDI",
+		L"CPI",
+		L"INI",
+		L"OUTI",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"LDD",
+		L"CPD",
+		L"IND",
+		L"OUTD",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0xB0
+		L"LDIR",
+		L"CPIR",
+		L"INIR",
+		L"OTIR",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"LDDR",
+		L"CPDR",
+		L"INDR",
+		L"OTDR",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0xC0
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0xD0
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0xE0
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		// 0xF0
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+		L"???",
+	} };
+
+}
+
+#endif // !_4683CA22_8A8E_40BB_8DD5_B47585A702C0
@@ -24,6 +24,8 @@
 #include <iterator>
 #include <map>
 #include <functional>
+#include <thread>
+#include <stdexcept>
 
 #include <boost/program_options.hpp>
 
@@ -31,17 +33,43 @@
 #include "segment.hpp"
 #include "basecode.hpp"
 #include "native6502.hpp"
+#include "text.hpp"
+#include "volume.hpp"
+#include "xref.hpp"
+#include "strings.hpp"
+#include "stats.hpp"
+#include "search.hpp"
+#include "dedup.hpp"
+#include "similar.hpp"
+#include "pmachine.hpp"
+#include "translate.hpp"
+#include "cpu6502.hpp"
+#include "library.hpp"
+#include "linker.hpp"
+#include "types.hpp"
 
 using namespace std;
 
 namespace pcodedump {
 
-	string filename;
+	vector<string> filenames;
+	string outputDirectory;
+	unsigned int jobs;
+	size_t inputOffset = 0;
+	size_t inputLength = 0;
+	bool scanImages = false;
+	graph_format_t callGraph = graph_format_t::none;
+	optional<CodeLocation> locate;
+	int locateWindow = 4;
+	cpu_t cpu = cpu_t::_6502;
+	bool runCode = false;
+	ProcedureRef runEntry{ 1, 1 };
 
 	namespace {
 		map<string, cpu_t> string_to_cpu = {
 			{"6502", cpu_t::_6502},
 			{"65c02", cpu_t::_65c02},
+			{"65c816", cpu_t::_65c816},
 		};
 
 		map<cpu_t, string> cpu_to_string = {
@@ -67,6 +95,94 @@ namespace pcodedump {
 		return out;
 	}
 
+	istream& operator >> (istream& in, graph_format_t & format) {
+		string token;
+		in >> token;
+		if (token == "dot") {
+			format = graph_format_t::dot;
+		} else if (token == "json") {
+			format = graph_format_t::json;
+		} else {
+			throw boost::program_options::invalid_option_value{ token };
+		}
+		return in;
+	}
+
+	istream& operator >> (istream& in, FileExtent & extent) {
+		string token;
+		in >> token;
+		size_t scale = 1;
+		if (token.size() > 3 && token.compare(token.size() - 3, 3, "blk") == 0) {
+			token.erase(token.size() - 3);
+			scale = BLOCK_SIZE;
+		}
+		bool hex = token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X');
+		size_t used = 0;
+		try {
+			extent.bytes = stoull(token, &used, hex ? 16 : 10) * scale;
+		} catch (logic_error &) {
+			used = 0;
+		}
+		if (used == 0 || used != token.size() || token[0] == '-') {
+			throw boost::program_options::invalid_option_value{ token };
+		}
+		return in;
+	}
+
+	/* Offsets are hexadecimal, as they are in listings, with or without a 0x or $ prefix. */
+	istream& operator >> (istream& in, CodeLocation & location) {
+		string token;
+		in >> token;
+		auto colon = token.find(':');
+		auto dot = token.find('.');
+		try {
+			if (colon == string::npos || colon + 1 == token.size()) {
+				throw invalid_argument{ token };
+			}
+			auto offset = token.substr(colon + 1);
+			if (offset[0] == '$') {
+				offset.erase(0, 1);
+			} else if (offset.size() > 2 && offset[0] == '0' && (offset[1] == 'x' || offset[1] == 'X')) {
+				offset.erase(0, 2);
+			}
+			size_t used = 0;
+			location.offset = stoull(offset, &used, 16);
+			if (used != offset.size() || offset[0] == '-') {
+				throw invalid_argument{ token };
+			}
+			if (dot < colon) {
+				location.segment = stoi(token.substr(0, dot));
+				location.procedure = stoi(token.substr(dot + 1, colon - dot - 1));
+			} else {
+				location.segment = stoi(token.substr(0, colon));
+				location.procedure.reset();
+			}
+		} catch (logic_error &) {
+			throw boost::program_options::invalid_option_value{ token };
+		}
+		return in;
+	}
+
+	istream& operator >> (istream& in, ProcedureRef & procedure) {
+		string token;
+		in >> token;
+		auto dot = token.find('.');
+		try {
+			size_t used = 0;
+			procedure.segment = stoi(token.substr(0, dot), &used);
+			if (dot == string::npos || used != dot) {
+				throw invalid_argument{ token };
+			}
+			procedure.procedure = stoi(token.substr(dot + 1), &used);
+			if (used != token.size() - dot - 1) {
+				throw invalid_argument{ token };
+			}
+		} catch (logic_error &) {
+			throw boost::program_options::invalid_option_value{ token };
+		}
+		return in;
+	}
+
 	/* Parse program options and store the values in global values. Return true if the program
 	   should then continue processing. */
 	bool parseOptions(int argc, char *argv[]) {
@@ -83,24 +199,74 @@ namespace pcodedump {
 				("procs", bool_switch(&CodeSegment::listProcs), "Display segment procedures")
 				("tree", bool_switch(&CodePart::treeProcs), "Display procedure nesting (implies procs)")
 				("disasm", bool_switch(&CodePart::disasmProcs), "Display code disassembly (implies procs)")
-				("cpu", value<cpu_t>()->default_value(cpu_t::_6502)->notifier(Native6502Procedure::initialiseCpu),
+				("cpu", value<cpu_t>(&cpu)->default_value(cpu)->notifier(Native6502Procedure::initialiseCpu),
 					"CPU type for disassembled native code:\n"
 					"  6502\n"
-					"  65c02")
-				("link", bool_switch(&CodeSegment::showLinkage), "Display linker information");
+					"  65c02\n"
+					"  65c816")
+				("flow", bool_switch(&Native6502Procedure::followFlow), "Follow control flow when disassembling native code")
+				("cycles", bool_switch(&Native6502Procedure::showCycles), "Show the cycles of each native instruction, and the totals of each basic block and procedure")
+				("xref", bool_switch(&VariableXref::showXref), "Display a cross-reference of global, intermediate and external variables")
+				("xref-offset", value<int>()->notifier([](int value) { VariableXref::offset = value; }),
+					"Only cross-reference variables at this offset (implies xref)")
+				("link", bool_switch(&CodeSegment::showLinkage), "Display linker information")
+				("library", value<vector<string>>(&LibraryIndex::libraryFiles)->composing(),
+					"Resolve intrinsic units and unit segments against the units of this library, e.g. SYSTEM.LIBRARY")
+				("link-check", bool_switch(&SymbolTable::checkLinks), "Resolve the link references of all files against the definitions in all files, and list unresolved and duplicate symbols")
+				("dedup", bool_switch(&RenderedProcedures::elideCopies), "Disassemble copies of a procedure once, and refer to that listing for the rest")
+				("volume", bool_switch(&Volume::treatAsVolume), "Treat input files as Apple Pascal volume images")
+				("totext", bool_switch(&TextFile::convert), "Convert Apple Pascal text files to plain text")
+				("output-dir", value<string>(&outputDirectory), "Write converted files to this directory instead of standard output")
+				("offset", value<FileExtent>()->notifier([](FileExtent extent) { inputOffset = extent.bytes; }),
+					"Decode from this position in each file, in bytes or blocks (e.g. 24blk)")
+				("length", value<FileExtent>()->notifier([](FileExtent extent) { inputLength = extent.bytes; }),
+					"Decode only this many bytes or blocks from the offset")
+				("scan", bool_switch(&scanImages), "Search files for plausible code files")
+				("locate", value<CodeLocation>()->notifier([](CodeLocation location) { locate = location; }),
+					"Disassemble the instructions around an offset in hexadecimal, from the start of a segment (seg:offset) or a procedure (seg.proc:offset)")
+				("window", value<int>(&locateWindow)->default_value(locateWindow), "Number of instructions to show either side of a located offset")
+				("run", bool_switch(&runCode), "Run the p-code of each code file in an emulated p-machine, writing console output")
+				("entry", value<ProcedureRef>(&runEntry)->default_value(runEntry, "1.1"), "Procedure to run, as seg.proc")
+				("profile", bool_switch(&PMachine::showProfile), "Count the p-code instructions run (implies run)")
+				("translate", bool_switch(&PcodeTranslator::translate), "Translate the p-code of each code file to a C++ program that runs it from the entry procedure")
+				("emulate", bool_switch(&Cpu6502::emulate), "Run the native procedure given by entry on an emulated CPU, tracing each instruction and its cycles")
+				("memory-map", value<string>(&Cpu6502::memoryMap), "Script of the load address, relocation bases, interpreter stubs and memory contents for emulate")
+				("stats", bool_switch(&CodeStatistics::showStats), "Count opcodes, operand formats, opcode n-grams and procedure sizes")
+				("strings", bool_switch(&StringIndex::listStrings), "List the string literals of each code file")
+				("find-string", value<string>(&StringIndex::search), "Search the string literals of all files for this text")
+				("duplicates", bool_switch(&DuplicateIndex::showDuplicates), "Find procedures that are copied in more than one place in all files")
+				("similar", value<string>(&SimilarityIndex::queryFile), "Find the procedures in all files that are most like each procedure in this file")
+				("similar-count", value<size_t>(&SimilarityIndex::matchCount)->default_value(SimilarityIndex::matchCount),
+					"Number of alike procedures to find for each procedure")
+				("find-pcode", value<vector<string>>(&InstructionSearch::pcodePatterns)->composing(),
+					"Search p-code for an instruction sequence, e.g. \"LDL 1; * ; CXP 3 *\"")
+				("find-native", value<vector<string>>(&InstructionSearch::nativePatterns)->composing(),
+					"Search native code for an instruction sequence, e.g. \"LDA #$00; JSR\"")
+				("callgraph", value<graph_format_t>(&callGraph),
+					"Write the call graph of each code file instead of a listing:\n"
+					"  dot\n"
+					"  json")
+				("jobs", value<unsigned int>(&jobs)->default_value(max(thread::hardware_concurrency(), 1u)), "Number of files to process in parallel");
 			options_description allopts{ "All options" };
 			allopts.add_options()
-				("input-file", value<string>(&filename), "");
+				("input-file", value<vector<string>>(&filenames), "");
 			allopts.add(opts);
 			positional_options_description positional{};
-			positional.add("input-file", 1);
+			positional.add("input-file", -1);
 			variables_map vm;
 			store(command_line_parser(argc, argv).options(allopts).positional(positional).run(), vm);
 			notify(vm);
+			if (locateWindow < 0) {
+				invalid_option_value error{ to_string(locateWindow) };
+				error.set_option_name("window");
+				throw error;
+			}
 			CodeSegment::listProcs |= CodePart::disasmProcs || CodePart::treeProcs;
+			VariableXref::showXref |= VariableXref::offset.has_value();
 
 			if (help) {
 				cout << opts << endl;
+				cout << "The segments of Version IV code files are listed, but their code and linkage aren't decoded yet." << endl;
 			}
 			return !help;
 		} catch (boost::program_options::error &ex) {
@@ -18,13 +18,56 @@
 #define _7A0EDA10_B113_4733_8A7C_0F131220A28C
 
 #include <string>
+#include <vector>
+#include <cstddef>
+#include <istream>
+#include <optional>
 
 namespace pcodedump {
 
 	enum class cpu_t { _6502, _65c02, _65c816 };
 
-	extern std::string filename;
+	enum class graph_format_t { none, dot, json };
+
+	std::istream& operator >> (std::istream& in, graph_format_t & format);
+
+	/* A position or length in a file, given in bytes or, with a "blk" suffix, in blocks. */
+	struct FileExtent {
+		std::size_t bytes;
+	};
+
+	std::istream& operator >> (std::istream& in, FileExtent & extent);
+
+	/* A place in the code, as a segment number and an offset from the start of the segment, or
+	   from the start of one of its procedures. Written as seg:offset or seg.proc:offset. */
+	struct CodeLocation {
+		int segment;
+		std::optional<int> procedure;
+		std::size_t offset;
+	};
+
+	std::istream& operator >> (std::istream& in, CodeLocation & location);
+
+	/* A procedure, written as seg.proc. */
+	struct ProcedureRef {
+		int segment;
+		int procedure;
+	};
+
+	std::istream& operator >> (std::istream& in, ProcedureRef & procedure);
+
+	extern std::vector<std::string> filenames;
+	extern std::string outputDirectory;
+	extern unsigned int jobs;
+	extern std::size_t inputOffset;
+	extern std::size_t inputLength;
+	extern bool scanImages;
+	extern graph_format_t callGraph;
 	extern cpu_t cpu;
+	extern std::optional<CodeLocation> locate;
+	extern int locateWindow;
+	extern bool runCode;
+	extern ProcedureRef runEntry;
 
 	bool parseOptions(int argc, char *argv[]);
 
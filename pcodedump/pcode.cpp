@@ -26,11 +26,11 @@
 #include <vector>
 #include <map>
 #include <cstdint>
-#include <functional>
 #include <algorithm>
+#include <stdexcept>
+#include <type_traits>
 
 using namespace std;
-using namespace std::placeholders;
 using namespace boost::endian;
 
 namespace {
@@ -54,6 +54,9 @@ namespace {
 
 namespace pcodedump {
 
+	/* The attribute table ends a procedure. Its last word holds the procedure number in the
+	   low byte and the lexical level in the high byte. */
+	template <typename Endian>
 	class PcodeProcedure::AttributeTable {
 	private:
 		AttributeTable() = delete;
@@ -64,19 +67,29 @@ namespace pcodedump {
 
 	public:
 		static AttributeTable const & place(std::uint8_t const * tabStart);
-		boost::endian::little_uint16_t jumpTableStart;
-		boost::endian::little_uint16_t dataSize;
-		boost::endian::little_uint16_t paramaterSize;
-		boost::endian::little_uint16_t exitIc;
-		boost::endian::little_uint16_t enterIc;
-		boost::endian::little_uint8_t procedureNumber;
-		boost::endian::little_uint8_t lexLevel;
+
+		int procedureNumber() const {
+			return lastWord[Endian::low];
+		}
+
+		int lexLevel() const {
+			return lastWord[Endian::high];
+		}
+
+		typename Endian::uint16_t jumpTableStart;
+		typename Endian::uint16_t dataSize;
+		typename Endian::uint16_t paramaterSize;
+		typename Endian::uint16_t exitIc;
+		typename Endian::uint16_t enterIc;
+		std::uint8_t lastWord[2];
 	};
 
-	PcodeProcedure::AttributeTable const & PcodeProcedure::AttributeTable::place(std::uint8_t const * tabStart) {
+	template <typename Endian>
+	PcodeProcedure::AttributeTable<Endian> const & PcodeProcedure::AttributeTable<Endian>::place(std::uint8_t const * tabStart) {
 		return pcodedump::place<AttributeTable>(tabStart);
 	}
 
+	template <typename Endian>
 	class PcodeProcedure::Disassembler final {
 	public:
 		Disassembler(std::wostream& os, PcodeProcedure const& procedure, linkref_map_t& linkage);
@@ -87,67 +100,73 @@ namespace pcodedump {
 		inline intptr_t getNextJumpAddress(std::uint8_t const *& address) const;
 		inline intptr_t getNextCaseAddress(std::uint8_t const *& address) const;
 
-		std::uint8_t const* decode_implied(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_unsignedByte(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_big(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_intermediate(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_extended(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_word(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_wordBlock(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_stringConstant(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_packedConstant(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_jump(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_return(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_doubleByte(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_case(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_callStandardProc(std::wstring& opCode, std::uint8_t const* current) const;
-		std::uint8_t const* decode_compare(std::wstring& opCode, std::uint8_t const* current) const;
-
-		using decode_function_t = std::uint8_t const* (Disassembler::*)(std::wstring&, std::uint8_t const*) const;
-		// using decode_binding_t = decltype(bind(declval<decode_function_t>(), _1, declval<wstring &&>(), _2));
-		using decode_binding_t = function<std::uint8_t const* (Disassembler const*, std::uint8_t const*)>;
-
-		static std::vector<decode_binding_t> dispatch;
+		std::uint8_t const* decode_implied(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_unsignedByte(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_big(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_intermediate(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_extended(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_word(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_wordBlock(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_stringConstant(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_packedConstant(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_jump(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_return(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_doubleByte(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_case(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_callStandardProc(std::wstring const& opCode, std::uint8_t const* current) const;
+		std::uint8_t const* decode_compare(std::wstring const& opCode, std::uint8_t const* current) const;
+
+		void writeTarget(intptr_t target) const;
+
+		using decode_function_t = std::uint8_t const* (Disassembler::*)(std::wstring const&, std::uint8_t const*) const;
+
+		static decode_function_t const formatDecoders[];
 
 		std::wostream& os;
 		PcodeProcedure const& procedure;
 		linkref_map_t& linkage;
 	};
 
-	PcodeProcedure::Disassembler::Disassembler(std::wostream& os, PcodeProcedure const& procedure, linkref_map_t& linkage) :
+	template <typename Endian>
+	PcodeProcedure::Disassembler<Endian>::Disassembler(std::wostream& os, PcodeProcedure const& procedure, linkref_map_t& linkage) :
 		os{ os }, procedure{ procedure }, linkage{ linkage }
 	{}
 
-	inline intptr_t PcodeProcedure::Disassembler::getNextJumpAddress(std::uint8_t const *& address) const {
+	template <typename Endian>
+	inline intptr_t PcodeProcedure::Disassembler<Endian>::getNextJumpAddress(std::uint8_t const *& address) const {
 		auto offset = getNext<int8_t>(address);
 		if (offset >= 0) {
 			return (address + offset) - procedure.getProcBegin();
 		} else {
-			return derefSelfPtr(procedure.jtab(offset)) - procedure.getProcBegin();
+			return derefSelfPtr<Endian>(procedure.jtab(offset)) - procedure.getProcBegin();
 		}
 
 	}
 
-	inline intptr_t PcodeProcedure::Disassembler::getNextCaseAddress(std::uint8_t const *& address) const
+	template <typename Endian>
+	inline intptr_t PcodeProcedure::Disassembler<Endian>::getNextCaseAddress(std::uint8_t const *& address) const
 	{
-		auto result = derefSelfPtr(address) - procedure.getProcBegin();
+		auto result = derefSelfPtr<Endian>(address) - procedure.getProcBegin();
 		address += 2;
 		return result;
 	}
 
-	uint8_t const* PcodeProcedure::Disassembler::decode_implied(wstring& opCode, uint8_t const* current) const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_implied(wstring const& opCode, uint8_t const* current) const {
 		os << opCode << endl;
 		return current;
 	}
 
 	/* ub */
-	uint8_t const* PcodeProcedure::Disassembler::decode_unsignedByte(wstring& opCode, uint8_t const* current)  const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_unsignedByte(wstring const& opCode, uint8_t const* current)  const {
 		os << setfill(L' ') << left << setw(9) << opCode << dec << getNext<uint8_t>(current) << endl;
 		return current;
 	}
 
 	/* b */
-	uint8_t const * PcodeProcedure::Disassembler::decode_big(wstring &opCode, uint8_t const * current)  const {
+	template <typename Endian>
+	uint8_t const * PcodeProcedure::Disassembler<Endian>::decode_big(wstring const &opCode, uint8_t const * current)  const {
 		if (linkage.count(current)) {
 			os << setfill(L' ') << left << setw(9) << opCode << L"<" << linkage[current]->getName() << L">" << endl;
 			current += 2;
@@ -158,7 +177,8 @@ namespace pcodedump {
 	}
 
 	/* db, b */
-	uint8_t const* PcodeProcedure::Disassembler::decode_intermediate(wstring& opCode, uint8_t const* current) const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_intermediate(wstring const& opCode, uint8_t const* current) const {
 		auto linkCount = getNext<uint8_t>(current);
 		auto offset = getNextBig(current);
 		os << setfill(L' ') << left << setw(9) << opCode << dec << linkCount << L", " << offset << endl;
@@ -166,7 +186,8 @@ namespace pcodedump {
 	}
 
 	/* ub, b */
-	uint8_t const* PcodeProcedure::Disassembler::decode_extended(wstring& opCode, uint8_t const* current)  const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_extended(wstring const& opCode, uint8_t const* current)  const {
 		auto dataSegment = getNext<uint8_t>(current);
 		auto offset = getNextBig(current);
 		os << setfill(L' ') << left << setw(9) << opCode << dec << dataSegment << L", " << offset << endl;
@@ -174,36 +195,41 @@ namespace pcodedump {
 	}
 
 	/* w */
-	uint8_t const* PcodeProcedure::Disassembler::decode_word(wstring& opCode, uint8_t const* current)  const {
-		os << setfill(L' ') << left << setw(9) << opCode << dec << getNext<little_int16_t>(current) << endl;
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_word(wstring const& opCode, uint8_t const* current)  const {
+		os << setfill(L' ') << left << setw(9) << opCode << dec << getNext<typename Endian::int16_t>(current) << endl;
 		return current;
 	}
 
 	/* Convert four bytes to real, taking into account the reversed order of words in the block.
 	   
-	 The real value when loaded on to stack will be a 32 bit little-endian float.
+	 The real value when loaded on to stack will be a 32 bit float.
 	 However, the words in the word block are in reverse order with respect to the
-	 order they will be on the stack. Therefore, the words need to be reversed before the
-	 little-endian float is converted.
+	 order they will be on the stack. Therefore, the first word of the block is the
+	 high word of the float, whatever the byte order of the words.
 	 */
+	template <typename Endian>
 	float convertToReal(uint8_t const * buff) {
-		auto original = reinterpret_cast<little_int16_t const *>(buff);
-		little_int16_t reversedCopy[2] = {};
-		reverse_copy(original, original + 2, reversedCopy);
-		return *reinterpret_cast<little_float32_t *>(reversedCopy);
+		auto original = reinterpret_cast<typename Endian::uint16_t const *>(buff);
+		little_uint32_t bits = static_cast<uint32_t>(original[0]) << 16 | original[1];
+		return *reinterpret_cast<little_float32_t const *>(&bits);
 	}
 
+	template float convertToReal<LittleEndian>(uint8_t const * buff);
+	template float convertToReal<BigEndian>(uint8_t const * buff);
+
 	/* ub, word aligned block of words */
-	uint8_t const* PcodeProcedure::Disassembler::decode_wordBlock(wstring& opCode, uint8_t const* current)  const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_wordBlock(wstring const& opCode, uint8_t const* current)  const {
 		auto total = getNext<uint8_t>(current);
-		current = procedure.align<little_int16_t>(current);
+		current = procedure.align<typename Endian::int16_t>(current);
 		os << setfill(L' ') << left << setw(9) << opCode << dec << setw(9) << total;
 		if (total == 2) {
-			os << L"; As a real value: " << convertToReal(current);
+			os << L"; As a real value: " << convertToReal<Endian>(current);
 		}
 		os << endl;
 		for (int count = 0; count != total; ++count) {
-			auto value = getNext<little_int16_t>(current);
+			auto value = getNext<typename Endian::int16_t>(current);
 			os
 				<< setfill(L' ') << setw(18) << L""
 				<< setfill(L' ') << left << dec << setw(9) << value
@@ -214,44 +240,61 @@ namespace pcodedump {
 	}
 
 	/* ub, <chars> */
-	uint8_t const* PcodeProcedure::Disassembler::decode_stringConstant(wstring& opCode, uint8_t const* current) const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_stringConstant(wstring const& opCode, uint8_t const* current) const {
 		auto total = getNext<uint8_t>(current);
 		os << setfill(L' ') << left << setw(9) << opCode << dec << total << endl;
 		uint8_t const* finish = current + total;
-		FmtSentry<wostream::char_type> sentry{ wcout };
+		FmtSentry<wostream::char_type> sentry{ os };
 		while (current != finish) {
 			uint8_t const* next = distance(current, finish) >= 80 ? current + 80 : finish;
-			wcout << L"                  ";
-			line_chardump(wcout, current, next);
+			os << L"                  ";
+			line_chardump(os, current, next);
 			current = next;
-			wcout << endl;
+			os << endl;
 		}
 		return finish;
 	}
 
 	/* ub, <bytes> */
-	uint8_t const* PcodeProcedure::Disassembler::decode_packedConstant(wstring& opCode, uint8_t const* current) const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_packedConstant(wstring const& opCode, uint8_t const* current) const {
 		auto count = getNext<uint8_t>(current);
 		os << setfill(L' ') << left << setw(9) << opCode << dec << count << endl;
-		hexdump(wcout, L"                  " , current, current + count);
+		hexdump(os, L"                  " , current, current + count);
 		current += count;
 		return current;
 	}
 
+	/* Branch targets that start a block are written as labels. Anything else is written as a raw offset. */
+	template <typename Endian>
+	void PcodeProcedure::Disassembler<Endian>::writeTarget(intptr_t target) const {
+		if (procedure.getFlowGraph().isTarget(static_cast<int>(target))) {
+			os << L"L" << hex << setfill(L'0') << right << setw(4) << target;
+		} else {
+			os << L"(" << hex << setfill(L'0') << right << setw(4) << target << L")";
+		}
+	}
+
 	/* sb */
-	uint8_t const* PcodeProcedure::Disassembler::decode_jump(wstring& opCode, uint8_t const* current) const {
-		os << setfill(L' ') << left << setw(9) << opCode << L"(" << hex << setfill(L'0') << right << setw(4) << getNextJumpAddress(current) << L")" << endl;
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_jump(wstring const& opCode, uint8_t const* current) const {
+		os << setfill(L' ') << left << setw(9) << opCode;
+		writeTarget(getNextJumpAddress(current));
+		os << endl;
 		return current;
 	}
 
 	/* db */
-	uint8_t const* PcodeProcedure::Disassembler::decode_return(wstring& opCode, uint8_t const* current) const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_return(wstring const& opCode, uint8_t const*) const {
 		os << opCode << endl;
 		return nullptr;
 	}
 
 	/* ub, ub */
-	uint8_t const* PcodeProcedure::Disassembler::decode_doubleByte(wstring& opCode, uint8_t const* current) const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_doubleByte(wstring const& opCode, uint8_t const* current) const {
 		if (linkage.count(current)) {
 			auto segName = linkage[current]->getName();
 			current += 1;
@@ -266,14 +309,19 @@ namespace pcodedump {
 	}
 
 	/* word aligned -> idx_min, idx_max, (ujp sb), table */
-	uint8_t const* PcodeProcedure::Disassembler::decode_case(wstring& opCode, uint8_t const* current)  const {
-		current = procedure.align<little_int16_t>(current);
-		auto min = getNext<little_int16_t>(current);
-		auto max = getNext<little_int16_t>(current);
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_case(wstring const& opCode, uint8_t const* current)  const {
+		current = procedure.align<typename Endian::int16_t>(current);
+		auto min = getNext<typename Endian::int16_t>(current);
+		auto max = getNext<typename Endian::int16_t>(current);
 		current++; // Skip the UJP opcode
-		os << setfill(L' ') << left << setw(9) << opCode << dec << min << ", " << max << " (" << hex << setfill(L'0') << right << setw(4) << getNextJumpAddress(current) << ")" << endl;
-		for (int count = min; count != max + 1; ++count) {
-			os << setfill(L' ') << setw(18) << L"" << L"(" << hex << setfill(L'0') << right << setw(4) << getNextCaseAddress(current) << L")" << endl;
+		os << setfill(L' ') << left << setw(9) << opCode << dec << min << ", " << max << " ";
+		writeTarget(getNextJumpAddress(current));
+		os << endl;
+		for (int count = min; count <= max; ++count) {
+			os << setfill(L' ') << setw(18) << L"";
+			writeTarget(getNextCaseAddress(current));
+			os << endl;
 		}
 		return current;
 	}
@@ -320,7 +368,8 @@ namespace pcodedump {
 	};
 
 	/* CSP ub */
-	uint8_t const* PcodeProcedure::Disassembler::decode_callStandardProc(wstring& opCode, uint8_t const* current)  const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_callStandardProc(wstring const& opCode, uint8_t const* current)  const {
 		int standardProcNumber = *current++;
 		os << setfill(L' ') << left << setw(9) << opCode << dec << setw(6) << standardProcNumber;
 		if (standardProcs.count(standardProcNumber)) {
@@ -331,7 +380,8 @@ namespace pcodedump {
 	}
 
 	/* 2-reals, 4-strings, 6-booleans, 8-sets, 10-byte arrays, 12-words. 10 and 12 have b as well */
-	uint8_t const* PcodeProcedure::Disassembler::decode_compare(wstring& opCode, uint8_t const* current)  const {
+	template <typename Endian>
+	uint8_t const* PcodeProcedure::Disassembler<Endian>::decode_compare(wstring const& opCode, uint8_t const* current)  const {
 		os << opCode << L" ";
 		switch (*current++) {
 		case 2:
@@ -369,312 +419,638 @@ namespace pcodedump {
 		return current;
 	}
 
-	vector<PcodeProcedure::Disassembler::decode_binding_t> PcodeProcedure::Disassembler::dispatch = {
-		bind(&decode_implied, _1, wstring{ L"SDLC_0" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_1" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_2" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_3" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_4" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_5" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_6" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_7" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_8" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_9" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_10" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_11" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_12" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_13" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_14" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_15" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_16" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_17" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_18" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_19" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_20" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_21" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_22" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_23" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_24" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_25" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_26" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_27" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_28" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_29" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_30" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_31" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_32" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_33" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_34" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_35" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_36" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_37" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_38" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_39" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_40" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_41" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_42" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_43" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_44" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_45" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_46" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_47" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_48" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_49" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_50" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_51" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_52" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_53" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_54" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_55" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_56" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_57" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_58" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_59" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_60" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_61" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_62" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_63" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_64" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_65" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_66" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_67" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_68" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_69" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_70" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_71" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_72" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_73" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_74" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_75" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_76" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_77" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_78" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_79" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_80" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_81" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_82" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_83" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_84" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_85" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_86" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_87" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_88" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_89" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_90" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_91" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_92" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_93" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_94" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_95" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_96" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_97" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_98" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_99" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_100" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_101" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_102" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_103" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_104" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_105" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_106" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_107" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_108" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_109" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_110" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_111" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_112" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_113" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_114" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_115" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_116" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_117" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_118" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_119" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_120" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_121" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_122" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_123" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_124" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_125" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_126" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SDLC_127" }, _2),
-		bind(&decode_implied, _1, wstring{ L"ABI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"ABR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"ADI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"ADR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"LAND" }, _2),
-		bind(&decode_implied, _1, wstring{ L"DIF" }, _2),
-		bind(&decode_implied, _1, wstring{ L"DVI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"DVR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"CHK" }, _2),
-		bind(&decode_implied, _1, wstring{ L"FLO" }, _2),
-		bind(&decode_implied, _1, wstring{ L"FLT" }, _2),
-		bind(&decode_implied, _1, wstring{ L"INN" }, _2),
-		bind(&decode_implied, _1, wstring{ L"INT" }, _2),
-		bind(&decode_implied, _1, wstring{ L"LOR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"MODI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"MPI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"MPR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"NGI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"NGR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"LNOT" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SRS" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SBI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SBR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SGS" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SQI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SQR" }, _2),
-		bind(&decode_implied, _1, wstring{ L"STO" }, _2),
-		bind(&decode_implied, _1, wstring{ L"IXS" }, _2),
-		bind(&decode_implied, _1, wstring{ L"UNI" }, _2),
-		bind(&decode_extended, _1, wstring{ L"LDE" }, _2),
-		bind(&decode_callStandardProc, _1, wstring{ L"CSP" }, _2),
-		bind(&decode_implied, _1, wstring{ L"LDCN" }, _2),
-		bind(&decode_unsignedByte, _1, wstring{ L"ADJ" }, _2),
-		bind(&decode_jump, _1, wstring{ L"FJP" }, _2),
-		bind(&decode_big, _1, wstring{ L"INC" }, _2),
-		bind(&decode_big, _1, wstring{ L"IND" }, _2),
-		bind(&decode_big, _1, wstring{ L"IXA" }, _2),
-		bind(&decode_big, _1, wstring{ L"LAO" }, _2),
-		bind(&decode_stringConstant, _1, wstring{ L"LSA" }, _2),
-		bind(&decode_extended, _1, wstring{ L"LAE" }, _2),
-		bind(&decode_big, _1, wstring{ L"MOV" }, _2),
-		bind(&decode_big, _1, wstring{ L"LDO" }, _2),
-		bind(&decode_unsignedByte, _1, wstring{ L"SAS" }, _2),
-		bind(&decode_big, _1, wstring{ L"SRO" }, _2),
-		bind(&decode_case, _1, wstring{ L"XJP" }, _2),
-		bind(&decode_return, _1, wstring{ L"RNP" }, _2),
-		bind(&decode_unsignedByte, _1, wstring{ L"CIP" }, _2),
-		bind(&decode_compare, _1, wstring{ L"EQU" }, _2),
-		bind(&decode_compare, _1, wstring{ L"GEQ" }, _2),
-		bind(&decode_compare, _1, wstring{ L"GRT" }, _2),
-		bind(&decode_intermediate, _1, wstring{ L"LDA" }, _2),
-		bind(&decode_wordBlock, _1, wstring{ L"LDC" }, _2),
-		bind(&decode_compare, _1, wstring{ L"LEQ" }, _2),
-		bind(&decode_compare, _1, wstring{ L"LES" }, _2),
-		bind(&decode_intermediate, _1, wstring{ L"LOD" }, _2),
-		bind(&decode_compare, _1, wstring{ L"NEQ" }, _2),
-		bind(&decode_intermediate, _1, wstring{ L"STR" }, _2),
-		bind(&decode_jump, _1, wstring{ L"UJP" }, _2),
-		bind(&decode_implied, _1, wstring{ L"LDP" }, _2),
-		bind(&decode_implied, _1, wstring{ L"STP" }, _2),
-		bind(&decode_unsignedByte, _1, wstring{ L"LDM" }, _2),
-		bind(&decode_unsignedByte, _1, wstring{ L"STM" }, _2),
-		bind(&decode_implied, _1, wstring{ L"LDB" }, _2),
-		bind(&decode_implied, _1, wstring{ L"STB" }, _2),
-		bind(&decode_doubleByte, _1, wstring{ L"IXP" }, _2),
-		bind(&decode_return, _1, wstring{ L"RBP" }, _2),
-		bind(&decode_unsignedByte, _1, wstring{ L"CBP" }, _2),
-		bind(&decode_implied, _1, wstring{ L"EQUI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"GEQI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"GRTI" }, _2),
-		bind(&decode_big, _1, wstring{ L"LLA" }, _2),
-		bind(&decode_word, _1, wstring{ L"LDCI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"LEQI" }, _2),
-		bind(&decode_implied, _1, wstring{ L"LESI" }, _2),
-		bind(&decode_big, _1, wstring{ L"LDL" }, _2),
-		bind(&decode_implied, _1, wstring{ L"NEQI" }, _2),
-		bind(&decode_big, _1, wstring{ L"STL" }, _2),
-		bind(&decode_doubleByte, _1, wstring{ L"CXP" }, _2),
-		bind(&decode_unsignedByte, _1, wstring{ L"CLP" }, _2),
-		bind(&decode_unsignedByte, _1, wstring{ L"CGP" }, _2),
-		bind(&decode_packedConstant, _1, wstring{ L"LPA" }, _2),
-		bind(&decode_extended, _1, wstring{ L"STE" }, _2),
-		bind(&decode_implied, _1, wstring{ L"" }, _2),
-		bind(&decode_jump, _1, wstring{ L"EFJ" }, _2),
-		bind(&decode_jump, _1, wstring{ L"NFJ" }, _2),
-		bind(&decode_big, _1, wstring{ L"BPT" }, _2),
-		bind(&decode_implied, _1, wstring{ L"XIT" }, _2),
-		bind(&decode_implied, _1, wstring{ L"NOP" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_1" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_2" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_3" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_4" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_5" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_6" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_7" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_8" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_9" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_10" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_11" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_12" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_13" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_14" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_15" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDL_16" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_1" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_2" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_3" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_4" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_5" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_6" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_7" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_8" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_9" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_10" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_11" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_12" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_13" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_14" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_15" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SLDO_16" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SIND_0" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SIND_1" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SIND_2" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SIND_3" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SIND_4" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SIND_5" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SIND_6" }, _2),
-		bind(&decode_implied, _1, wstring{ L"SIND_7" }, _2),
+	array<PcodeOpcode, 256> const pcodeOpcodes = { {
+		{ L"SDLC_0", PcodeFormat::implied },
+		{ L"SDLC_1", PcodeFormat::implied },
+		{ L"SDLC_2", PcodeFormat::implied },
+		{ L"SDLC_3", PcodeFormat::implied },
+		{ L"SDLC_4", PcodeFormat::implied },
+		{ L"SDLC_5", PcodeFormat::implied },
+		{ L"SDLC_6", PcodeFormat::implied },
+		{ L"SDLC_7", PcodeFormat::implied },
+		{ L"SDLC_8", PcodeFormat::implied },
+		{ L"SDLC_9", PcodeFormat::implied },
+		{ L"SDLC_10", PcodeFormat::implied },
+		{ L"SDLC_11", PcodeFormat::implied },
+		{ L"SDLC_12", PcodeFormat::implied },
+		{ L"SDLC_13", PcodeFormat::implied },
+		{ L"SDLC_14", PcodeFormat::implied },
+		{ L"SDLC_15", PcodeFormat::implied },
+		{ L"SDLC_16", PcodeFormat::implied },
+		{ L"SDLC_17", PcodeFormat::implied },
+		{ L"SDLC_18", PcodeFormat::implied },
+		{ L"SDLC_19", PcodeFormat::implied },
+		{ L"SDLC_20", PcodeFormat::implied },
+		{ L"SDLC_21", PcodeFormat::implied },
+		{ L"SDLC_22", PcodeFormat::implied },
+		{ L"SDLC_23", PcodeFormat::implied },
+		{ L"SDLC_24", PcodeFormat::implied },
+		{ L"SDLC_25", PcodeFormat::implied },
+		{ L"SDLC_26", PcodeFormat::implied },
+		{ L"SDLC_27", PcodeFormat::implied },
+		{ L"SDLC_28", PcodeFormat::implied },
+		{ L"SDLC_29", PcodeFormat::implied },
+		{ L"SDLC_30", PcodeFormat::implied },
+		{ L"SDLC_31", PcodeFormat::implied },
+		{ L"SDLC_32", PcodeFormat::implied },
+		{ L"SDLC_33", PcodeFormat::implied },
+		{ L"SDLC_34", PcodeFormat::implied },
+		{ L"SDLC_35", PcodeFormat::implied },
+		{ L"SDLC_36", PcodeFormat::implied },
+		{ L"SDLC_37", PcodeFormat::implied },
+		{ L"SDLC_38", PcodeFormat::implied },
+		{ L"SDLC_39", PcodeFormat::implied },
+		{ L"SDLC_40", PcodeFormat::implied },
+		{ L"SDLC_41", PcodeFormat::implied },
+		{ L"SDLC_42", PcodeFormat::implied },
+		{ L"SDLC_43", PcodeFormat::implied },
+		{ L"SDLC_44", PcodeFormat::implied },
+		{ L"SDLC_45", PcodeFormat::implied },
+		{ L"SDLC_46", PcodeFormat::implied },
+		{ L"SDLC_47", PcodeFormat::implied },
+		{ L"SDLC_48", PcodeFormat::implied },
+		{ L"SDLC_49", PcodeFormat::implied },
+		{ L"SDLC_50", PcodeFormat::implied },
+		{ L"SDLC_51", PcodeFormat::implied },
+		{ L"SDLC_52", PcodeFormat::implied },
+		{ L"SDLC_53", PcodeFormat::implied },
+		{ L"SDLC_54", PcodeFormat::implied },
+		{ L"SDLC_55", PcodeFormat::implied },
+		{ L"SDLC_56", PcodeFormat::implied },
+		{ L"SDLC_57", PcodeFormat::implied },
+		{ L"SDLC_58", PcodeFormat::implied },
+		{ L"SDLC_59", PcodeFormat::implied },
+		{ L"SDLC_60", PcodeFormat::implied },
+		{ L"SDLC_61", PcodeFormat::implied },
+		{ L"SDLC_62", PcodeFormat::implied },
+		{ L"SDLC_63", PcodeFormat::implied },
+		{ L"SDLC_64", PcodeFormat::implied },
+		{ L"SDLC_65", PcodeFormat::implied },
+		{ L"SDLC_66", PcodeFormat::implied },
+		{ L"SDLC_67", PcodeFormat::implied },
+		{ L"SDLC_68", PcodeFormat::implied },
+		{ L"SDLC_69", PcodeFormat::implied },
+		{ L"SDLC_70", PcodeFormat::implied },
+		{ L"SDLC_71", PcodeFormat::implied },
+		{ L"SDLC_72", PcodeFormat::implied },
+		{ L"SDLC_73", PcodeFormat::implied },
+		{ L"SDLC_74", PcodeFormat::implied },
+		{ L"SDLC_75", PcodeFormat::implied },
+		{ L"SDLC_76", PcodeFormat::implied },
+		{ L"SDLC_77", PcodeFormat::implied },
+		{ L"SDLC_78", PcodeFormat::implied },
+		{ L"SDLC_79", PcodeFormat::implied },
+		{ L"SDLC_80", PcodeFormat::implied },
+		{ L"SDLC_81", PcodeFormat::implied },
+		{ L"SDLC_82", PcodeFormat::implied },
+		{ L"SDLC_83", PcodeFormat::implied },
+		{ L"SDLC_84", PcodeFormat::implied },
+		{ L"SDLC_85", PcodeFormat::implied },
+		{ L"SDLC_86", PcodeFormat::implied },
+		{ L"SDLC_87", PcodeFormat::implied },
+		{ L"SDLC_88", PcodeFormat::implied },
+		{ L"SDLC_89", PcodeFormat::implied },
+		{ L"SDLC_90", PcodeFormat::implied },
+		{ L"SDLC_91", PcodeFormat::implied },
+		{ L"SDLC_92", PcodeFormat::implied },
+		{ L"SDLC_93", PcodeFormat::implied },
+		{ L"SDLC_94", PcodeFormat::implied },
+		{ L"SDLC_95", PcodeFormat::implied },
+		{ L"SDLC_96", PcodeFormat::implied },
+		{ L"SDLC_97", PcodeFormat::implied },
+		{ L"SDLC_98", PcodeFormat::implied },
+		{ L"SDLC_99", PcodeFormat::implied },
+		{ L"SDLC_100", PcodeFormat::implied },
+		{ L"SDLC_101", PcodeFormat::implied },
+		{ L"SDLC_102", PcodeFormat::implied },
+		{ L"SDLC_103", PcodeFormat::implied },
+		{ L"SDLC_104", PcodeFormat::implied },
+		{ L"SDLC_105", PcodeFormat::implied },
+		{ L"SDLC_106", PcodeFormat::implied },
+		{ L"SDLC_107", PcodeFormat::implied },
+		{ L"SDLC_108", PcodeFormat::implied },
+		{ L"SDLC_109", PcodeFormat::implied },
+		{ L"SDLC_110", PcodeFormat::implied },
+		{ L"SDLC_111", PcodeFormat::implied },
+		{ L"SDLC_112", PcodeFormat::implied },
+		{ L"SDLC_113", PcodeFormat::implied },
+		{ L"SDLC_114", PcodeFormat::implied },
+		{ L"SDLC_115", PcodeFormat::implied },
+		{ L"SDLC_116", PcodeFormat::implied },
+		{ L"SDLC_117", PcodeFormat::implied },
+		{ L"SDLC_118", PcodeFormat::implied },
+		{ L"SDLC_119", PcodeFormat::implied },
+		{ L"SDLC_120", PcodeFormat::implied },
+		{ L"SDLC_121", PcodeFormat::implied },
+		{ L"SDLC_122", PcodeFormat::implied },
+		{ L"SDLC_123", PcodeFormat::implied },
+		{ L"SDLC_124", PcodeFormat::implied },
+		{ L"SDLC_125", PcodeFormat::implied },
+		{ L"SDLC_126", PcodeFormat::implied },
+		{ L"SDLC_127", PcodeFormat::implied },
+		{ L"ABI", PcodeFormat::implied },
+		{ L"ABR", PcodeFormat::implied },
+		{ L"ADI", PcodeFormat::implied },
+		{ L"ADR", PcodeFormat::implied },
+		{ L"LAND", PcodeFormat::implied },
+		{ L"DIF", PcodeFormat::implied },
+		{ L"DVI", PcodeFormat::implied },
+		{ L"DVR", PcodeFormat::implied },
+		{ L"CHK", PcodeFormat::implied },
+		{ L"FLO", PcodeFormat::implied },
+		{ L"FLT", PcodeFormat::implied },
+		{ L"INN", PcodeFormat::implied },
+		{ L"INT", PcodeFormat::implied },
+		{ L"LOR", PcodeFormat::implied },
+		{ L"MODI", PcodeFormat::implied },
+		{ L"MPI", PcodeFormat::implied },
+		{ L"MPR", PcodeFormat::implied },
+		{ L"NGI", PcodeFormat::implied },
+		{ L"NGR", PcodeFormat::implied },
+		{ L"LNOT", PcodeFormat::implied },
+		{ L"SRS", PcodeFormat::implied },
+		{ L"SBI", PcodeFormat::implied },
+		{ L"SBR", PcodeFormat::implied },
+		{ L"SGS", PcodeFormat::implied },
+		{ L"SQI", PcodeFormat::implied },
+		{ L"SQR", PcodeFormat::implied },
+		{ L"STO", PcodeFormat::implied },
+		{ L"IXS", PcodeFormat::implied },
+		{ L"UNI", PcodeFormat::implied },
+		{ L"LDE", PcodeFormat::extended },
+		{ L"CSP", PcodeFormat::callStandardProc },
+		{ L"LDCN", PcodeFormat::implied },
+		{ L"ADJ", PcodeFormat::unsignedByte },
+		{ L"FJP", PcodeFormat::jump },
+		{ L"INC", PcodeFormat::big },
+		{ L"IND", PcodeFormat::big },
+		{ L"IXA", PcodeFormat::big },
+		{ L"LAO", PcodeFormat::big },
+		{ L"LSA", PcodeFormat::stringConstant },
+		{ L"LAE", PcodeFormat::extended },
+		{ L"MOV", PcodeFormat::big },
+		{ L"LDO", PcodeFormat::big },
+		{ L"SAS", PcodeFormat::unsignedByte },
+		{ L"SRO", PcodeFormat::big },
+		{ L"XJP", PcodeFormat::caseJump },
+		{ L"RNP", PcodeFormat::procedureReturn },
+		{ L"CIP", PcodeFormat::unsignedByte },
+		{ L"EQU", PcodeFormat::compare },
+		{ L"GEQ", PcodeFormat::compare },
+		{ L"GRT", PcodeFormat::compare },
+		{ L"LDA", PcodeFormat::intermediate },
+		{ L"LDC", PcodeFormat::wordBlock },
+		{ L"LEQ", PcodeFormat::compare },
+		{ L"LES", PcodeFormat::compare },
+		{ L"LOD", PcodeFormat::intermediate },
+		{ L"NEQ", PcodeFormat::compare },
+		{ L"STR", PcodeFormat::intermediate },
+		{ L"UJP", PcodeFormat::jump },
+		{ L"LDP", PcodeFormat::implied },
+		{ L"STP", PcodeFormat::implied },
+		{ L"LDM", PcodeFormat::unsignedByte },
+		{ L"STM", PcodeFormat::unsignedByte },
+		{ L"LDB", PcodeFormat::implied },
+		{ L"STB", PcodeFormat::implied },
+		{ L"IXP", PcodeFormat::doubleByte },
+		{ L"RBP", PcodeFormat::procedureReturn },
+		{ L"CBP", PcodeFormat::unsignedByte },
+		{ L"EQUI", PcodeFormat::implied },
+		{ L"GEQI", PcodeFormat::implied },
+		{ L"GRTI", PcodeFormat::implied },
+		{ L"LLA", PcodeFormat::big },
+		{ L"LDCI", PcodeFormat::word },
+		{ L"LEQI", PcodeFormat::implied },
+		{ L"LESI", PcodeFormat::implied },
+		{ L"LDL", PcodeFormat::big },
+		{ L"NEQI", PcodeFormat::implied },
+		{ L"STL", PcodeFormat::big },
+		{ L"CXP", PcodeFormat::doubleByte },
+		{ L"CLP", PcodeFormat::unsignedByte },
+		{ L"CGP", PcodeFormat::unsignedByte },
+		{ L"LPA", PcodeFormat::packedConstant },
+		{ L"STE", PcodeFormat::extended },
+		{ L"", PcodeFormat::implied },
+		{ L"EFJ", PcodeFormat::jump },
+		{ L"NFJ", PcodeFormat::jump },
+		{ L"BPT", PcodeFormat::big },
+		{ L"XIT", PcodeFormat::implied },
+		{ L"NOP", PcodeFormat::implied },
+		{ L"SLDL_1", PcodeFormat::implied },
+		{ L"SLDL_2", PcodeFormat::implied },
+		{ L"SLDL_3", PcodeFormat::implied },
+		{ L"SLDL_4", PcodeFormat::implied },
+		{ L"SLDL_5", PcodeFormat::implied },
+		{ L"SLDL_6", PcodeFormat::implied },
+		{ L"SLDL_7", PcodeFormat::implied },
+		{ L"SLDL_8", PcodeFormat::implied },
+		{ L"SLDL_9", PcodeFormat::implied },
+		{ L"SLDL_10", PcodeFormat::implied },
+		{ L"SLDL_11", PcodeFormat::implied },
+		{ L"SLDL_12", PcodeFormat::implied },
+		{ L"SLDL_13", PcodeFormat::implied },
+		{ L"SLDL_14", PcodeFormat::implied },
+		{ L"SLDL_15", PcodeFormat::implied },
+		{ L"SLDL_16", PcodeFormat::implied },
+		{ L"SLDO_1", PcodeFormat::implied },
+		{ L"SLDO_2", PcodeFormat::implied },
+		{ L"SLDO_3", PcodeFormat::implied },
+		{ L"SLDO_4", PcodeFormat::implied },
+		{ L"SLDO_5", PcodeFormat::implied },
+		{ L"SLDO_6", PcodeFormat::implied },
+		{ L"SLDO_7", PcodeFormat::implied },
+		{ L"SLDO_8", PcodeFormat::implied },
+		{ L"SLDO_9", PcodeFormat::implied },
+		{ L"SLDO_10", PcodeFormat::implied },
+		{ L"SLDO_11", PcodeFormat::implied },
+		{ L"SLDO_12", PcodeFormat::implied },
+		{ L"SLDO_13", PcodeFormat::implied },
+		{ L"SLDO_14", PcodeFormat::implied },
+		{ L"SLDO_15", PcodeFormat::implied },
+		{ L"SLDO_16", PcodeFormat::implied },
+		{ L"SIND_0", PcodeFormat::implied },
+		{ L"SIND_1", PcodeFormat::implied },
+		{ L"SIND_2", PcodeFormat::implied },
+		{ L"SIND_3", PcodeFormat::implied },
+		{ L"SIND_4", PcodeFormat::implied },
+		{ L"SIND_5", PcodeFormat::implied },
+		{ L"SIND_6", PcodeFormat::implied },
+		{ L"SIND_7", PcodeFormat::implied },
+	} };
+
+	/* Indexed by PcodeFormat. */
+	template <typename Endian>
+	typename PcodeProcedure::Disassembler<Endian>::decode_function_t const PcodeProcedure::Disassembler<Endian>::formatDecoders[] = {
+		&Disassembler::decode_implied,
+		&Disassembler::decode_unsignedByte,
+		&Disassembler::decode_big,
+		&Disassembler::decode_intermediate,
+		&Disassembler::decode_extended,
+		&Disassembler::decode_word,
+		&Disassembler::decode_wordBlock,
+		&Disassembler::decode_stringConstant,
+		&Disassembler::decode_packedConstant,
+		&Disassembler::decode_jump,
+		&Disassembler::decode_return,
+		&Disassembler::decode_doubleByte,
+		&Disassembler::decode_case,
+		&Disassembler::decode_callStandardProc,
+		&Disassembler::decode_compare,
 	};
 
-	std::uint8_t const* PcodeProcedure::Disassembler::decode(std::uint8_t const* current) const {
-		auto opcode = *current++;
-		return dispatch[opcode](this, current);
+	template <typename Endian>
+	std::uint8_t const* PcodeProcedure::Disassembler<Endian>::decode(std::uint8_t const* current) const {
+		auto & opcode = pcodeOpcodes[*current++];
+		return (this->*formatDecoders[static_cast<int>(opcode.format)])(opcode.mnemonic, current);
+	}
+
+	namespace {
+
+		constexpr uint8_t UJP = 185;
+		constexpr uint8_t CIP = 174;
+		constexpr uint8_t CBP = 194;
+		constexpr uint8_t CXP = 205;
+		constexpr uint8_t LDE = 157;
+		constexpr uint8_t LAE = 167;
+		constexpr uint8_t STE = 209;
+		constexpr uint8_t CLP = 206;
+		constexpr uint8_t CGP = 207;
+
+		/* Reads operands for the flow graph, checking that they are inside the procedure. */
+		template <typename Endian>
+		class OperandReader {
+		public:
+			OperandReader(uint8_t const *& current, uint8_t const * end) : current{ current }, end{ end } {}
+
+			void need(ptrdiff_t count) const {
+				if (end - current < count) {
+					throw runtime_error("Instruction extends past the end of the procedure");
+				}
+			}
+
+			uint8_t byte() {
+				need(1);
+				return *current++;
+			}
+
+			int big() {
+				int value = byte();
+				if (value & 0x80) {
+					value = ((value & 0x7f) << 8) + byte();
+				}
+				return value;
+			}
+
+			int word() {
+				need(2);
+				return getNext<typename Endian::int16_t>(current);
+			}
+
+			void skip(ptrdiff_t count) {
+				need(count);
+				current += count;
+			}
+
+		private:
+			uint8_t const *& current;
+			uint8_t const * end;
+		};
+
+	}
+
+	PcodeFlowGraph::PcodeFlowGraph(PcodeProcedure const & procedure) {
+		if (procedure.isBigEndian()) {
+			decode<BigEndian>(procedure);
+		} else {
+			decode<LittleEndian>(procedure);
+		}
+		buildBlocks();
+	}
+
+	template <typename Endian>
+	void PcodeFlowGraph::decode(PcodeProcedure const & procedure) {
+		auto begin = procedure.getProcBegin();
+		auto end = procedure.data.end();
+		targetMap.assign(end - begin, false);
+		intptr_t furthestTarget = 0;
+		auto addTarget = [&](intptr_t target) {
+			if (0 <= target && target < end - begin) {
+				targetMap[target] = true;
+				branchTargets.push_back(static_cast<uint16_t>(target));
+				furthestTarget = max(furthestTarget, target);
+			}
+		};
+
+		auto current = begin;
+		OperandReader<Endian> reader{ current, end };
+		while (current < end) {
+			PcodeInstruction instruction{};
+			instruction.offset = static_cast<uint16_t>(current - begin);
+			instruction.opcode = *current++;
+			instruction.firstTarget = static_cast<uint32_t>(branchTargets.size());
+			switch (instruction.format()) {
+			case PcodeFormat::implied:
+				break;
+			case PcodeFormat::unsignedByte:
+			case PcodeFormat::callStandardProc:
+			case PcodeFormat::procedureReturn:
+				instruction.operand1 = reader.byte();
+				break;
+			case PcodeFormat::big:
+				instruction.operand1 = reader.big();
+				break;
+			case PcodeFormat::intermediate:
+			case PcodeFormat::extended:
+				instruction.operand1 = reader.byte();
+				instruction.operand2 = reader.big();
+				break;
+			case PcodeFormat::doubleByte:
+				instruction.operand1 = reader.byte();
+				instruction.operand2 = reader.byte();
+				break;
+			case PcodeFormat::word:
+				instruction.operand1 = reader.word();
+				break;
+			case PcodeFormat::wordBlock:
+				instruction.operand1 = reader.byte();
+				current = procedure.align<typename Endian::int16_t>(current);
+				instruction.operand2 = static_cast<int32_t>(current - begin);
+				reader.skip(2 * instruction.operand1);
+				break;
+			case PcodeFormat::stringConstant:
+			case PcodeFormat::packedConstant:
+				instruction.operand1 = reader.byte();
+				instruction.operand2 = static_cast<int32_t>(current - begin);
+				reader.skip(instruction.operand1);
+				break;
+			case PcodeFormat::compare:
+				instruction.operand1 = reader.byte();
+				if (instruction.operand1 == 10 || instruction.operand1 == 12) {
+					instruction.operand2 = reader.big();
+				}
+				break;
+			case PcodeFormat::jump: {
+				auto offset = static_cast<int8_t>(reader.byte());
+				instruction.operand1 = static_cast<int32_t>(offset >= 0
+					? current + offset - begin
+					: derefSelfPtr<Endian>(procedure.jtab(offset)) - begin);
+				addTarget(instruction.operand1);
+				break;
+			}
+			case PcodeFormat::caseJump: {
+				current = procedure.align<typename Endian::int16_t>(current);
+				instruction.operand1 = reader.word();
+				instruction.operand2 = reader.word();
+				reader.byte(); // UJP opcode of the default branch
+				auto offset = static_cast<int8_t>(reader.byte());
+				addTarget(offset >= 0 ? current + offset - begin : derefSelfPtr<Endian>(procedure.jtab(offset)) - begin);
+				for (int count = instruction.operand1; count <= instruction.operand2; ++count) {
+					reader.need(2);
+					addTarget(derefSelfPtr<Endian>(current) - begin);
+					current += 2;
+				}
+				break;
+			}
+			}
+			instruction.length = static_cast<uint16_t>(current - begin - instruction.offset);
+			instruction.targetCount = static_cast<uint16_t>(branchTargets.size() - instruction.firstTarget);
+			instructions.push_back(instruction);
+			if (instruction.format() == PcodeFormat::procedureReturn && furthestTarget < current - begin) {
+				break;
+			}
+		}
+	}
+
+	/* Blocks start at the first instruction, at branch targets, and after branches and returns.
+	   A table of the block starting at each offset makes finding successors linear. */
+	void PcodeFlowGraph::buildBlocks() {
+		vector<int32_t> blockAt(targetMap.size(), -1);
+		for (uint32_t index = 0; index != instructions.size(); ++index) {
+			auto & instruction = instructions[index];
+			bool leader = index == 0 || targetMap[instruction.offset];
+			if (index != 0) {
+				auto format = instructions[index - 1].format();
+				leader |= format == PcodeFormat::jump || format == PcodeFormat::caseJump || format == PcodeFormat::procedureReturn;
+			}
+			if (leader) {
+				if (!blocks.empty()) {
+					blocks.back().endInstruction = index;
+				}
+				blockAt[instruction.offset] = static_cast<int32_t>(blocks.size());
+				blocks.push_back(BasicBlock{ index, index, {} });
+			}
+		}
+		if (blocks.empty()) {
+			return;
+		}
+		blocks.back().endInstruction = static_cast<uint32_t>(instructions.size());
+
+		for (auto & block : blocks) {
+			auto & last = instructions[block.endInstruction - 1];
+			auto addSuccessor = [&](size_t offset) {
+				if (offset < blockAt.size() && blockAt[offset] >= 0
+						&& find(block.successors.begin(), block.successors.end(), blockAt[offset]) == block.successors.end()) {
+					block.successors.push_back(blockAt[offset]);
+				}
+			};
+			for (auto target : targets(last)) {
+				addSuccessor(target);
+			}
+			auto format = last.format();
+			if (format != PcodeFormat::procedureReturn && format != PcodeFormat::caseJump && last.opcode != UJP) {
+				addSuccessor(last.offset + last.length);
+			}
+		}
 	}
 
-	PcodeProcedure::PcodeProcedure(CodePart& codePart, int procedureNumber, Range<std::uint8_t const> range) :
+	/* The jump table is below the last word of the attribute table. */
+	template <typename Endian>
+	PcodeProcedure::PcodeProcedure(CodePart& codePart, int procedureNumber, Range<std::uint8_t const> range, Endian) :
 		base(codePart, procedureNumber, range),
-		attributeTable{ AttributeTable::place(data.end() - sizeof(AttributeTable)) }
-	{}
+		bigEndian{ std::is_same_v<Endian, BigEndian> }
+	{
+		auto & attributeTable = AttributeTable<Endian>::place(data.end() - sizeof(AttributeTable<Endian>));
+		enterIc = derefSelfPtr<Endian>(&attributeTable.enterIc);
+		exitIc = derefSelfPtr<Endian>(&attributeTable.exitIc);
+		jumpTable = attributeTable.lastWord;
+		lexLevel = attributeTable.lexLevel();
+		parameterSize = attributeTable.paramaterSize;
+		dataSize = attributeTable.dataSize;
+	}
+
+	template PcodeProcedure::PcodeProcedure(CodePart& codePart, int procedureNumber, Range<std::uint8_t const> range, LittleEndian);
+	template PcodeProcedure::PcodeProcedure(CodePart& codePart, int procedureNumber, Range<std::uint8_t const> range, BigEndian);
 
 	std::optional<int> PcodeProcedure::getLexicalLevel() const {
-		return attributeTable.lexLevel;
+		return lexLevel;
+	}
+
+	int PcodeProcedure::getParameterSize() const {
+		return parameterSize;
+	}
+
+	int PcodeProcedure::getDataSize() const {
+		return dataSize;
 	}
 
 	std::uint8_t const* PcodeProcedure::getEnterIc() const {
-		return derefSelfPtr(reinterpret_cast<std::uint8_t const*>(&attributeTable.enterIc));
+		return enterIc;
 	}
 
 	std::uint8_t const* PcodeProcedure::getExitIc() const {
-		return derefSelfPtr(reinterpret_cast<std::uint8_t const*>(&attributeTable.exitIc));
+		return exitIc;
 	}
 
 	uint8_t const* PcodeProcedure::jtab(int index) const {
-		return reinterpret_cast<uint8_t const*>(&attributeTable.procedureNumber) + index;
+		return jumpTable + index;
 	}
 
 	void PcodeProcedure::writeHeader(std::wostream& os) const {
 		auto procBegin = data.begin();
 		auto procLength = data.end() - data.begin();
 		os << "Proc #" << dec << setfill(L' ') << left << setw(4) << procedureNumber << L" (";
-		os << hex << setfill(L'0') << right << setw(4) << distance(codePart.begin(), procBegin) << ":" << setw(4) << distance(codePart.begin(), procBegin) + procLength - 1 << ")  P-Code (LSB)   ";
+		os << hex << setfill(L'0') << right << setw(4) << distance(codePart.begin(), procBegin) << ":" << setw(4) << distance(codePart.begin(), procBegin) + procLength - 1 << (bigEndian ? L")  P-Code (MSB)   " : L")  P-Code (LSB)   ");
 		os << setfill(L' ') << dec << left;
-		os << L"Lex level = " << setw(4) << attributeTable.lexLevel;
-		os << L"Parameters = " << setw(4) << attributeTable.paramaterSize;
-		os << L"Variables = " << setw(4) << attributeTable.dataSize;
+		os << L"Lex level = " << setw(4) << lexLevel;
+		os << L"Parameters = " << setw(4) << parameterSize;
+		os << L"Variables = " << setw(4) << dataSize;
 		os << endl;
 	}
 
-	void PcodeProcedure::disassemble(std::wostream& os, linkref_map_t& linkage) const {
-		Disassembler disassember{ os, *this, linkage };
-		uint8_t const* ic = data.begin();
-		while (ic && ic < data.end()) {
-			printIc(os, ic);
-			ic = disassember.decode(ic);
+	/* The flow graph is built the first time that it's needed, and kept for later analysis. */
+	PcodeFlowGraph const & PcodeProcedure::getFlowGraph() const {
+		if (!flowGraph) {
+			flowGraph = make_unique<PcodeFlowGraph const>(*this);
+		}
+		return *flowGraph;
+	}
+
+	/* CXP names the segment of the procedure that it calls, or the unit when the linker sets
+	   the segment number. The other calls are all to procedures in the same segment. */
+	CallList PcodeProcedure::getCalls(linkref_map_t const & linkage) const {
+		CallList result;
+		int segment = codePart.getSegmentNumber();
+		for (auto & instruction : getFlowGraph().getInstructions()) {
+			switch (instruction.opcode) {
+			case CXP: {
+				auto unit = linkage.find(data.begin() + instruction.offset + 1);
+				result.push_back({ instruction.operand1, instruction.operand2, unit != linkage.end() ? unit->second->getName() : L"" });
+				break;
+			}
+			case CIP:
+			case CBP:
+			case CLP:
+			case CGP:
+				result.push_back({ segment, instruction.operand1 });
+				break;
+			}
+		}
+		return result;
+	}
+
+	/* The segment numbers of external calls and variables are set by the linker, as are the
+	   operands that refer to linkage records. The procedure number depends on where the
+	   procedure is in its segment. */
+	vector<uint8_t> PcodeProcedure::getNormalisedCode(linkref_map_t const & linkage) const {
+		vector<uint8_t> result(data.begin(), data.end());
+		for (auto & instruction : getFlowGraph().getInstructions()) {
+			size_t operands = instruction.offset + 1;
+			size_t end = instruction.offset + instruction.length;
+			switch (instruction.opcode) {
+			case CXP:
+			case LDE:
+			case LAE:
+			case STE:
+				result[operands] = 0;
+				break;
+			}
+			for (auto field = linkage.lower_bound(data.begin() + operands); field != linkage.end() && field->first < data.begin() + end; ++field) {
+				auto first = static_cast<size_t>(field->first - data.begin());
+				fill(result.begin() + first, result.begin() + min(first + 2, end), 0);
+			}
+		}
+		result[result.size() - (bigEndian ? 1 : 2)] = 0;
+		return result;
+	}
+
+	void PcodeProcedure::disassembleRange(std::wostream& os, linkref_map_t& linkage, std::size_t first, std::size_t last) const {
+		if (bigEndian) {
+			disassembleRange<BigEndian>(os, linkage, first, last);
+		} else {
+			disassembleRange<LittleEndian>(os, linkage, first, last);
+		}
+	}
+
+	/* Basic blocks are separated by a blank line. */
+	template <typename Endian>
+	void PcodeProcedure::disassembleRange(std::wostream& os, linkref_map_t& linkage, std::size_t first, std::size_t last) const {
+		Disassembler<Endian> disassember{ os, *this, linkage };
+		auto & graph = getFlowGraph();
+		auto & instructions = graph.getInstructions();
+		bool written = false;
+		for (auto & block : graph.getBlocks()) {
+			for (auto index = block.firstInstruction; index != block.endInstruction; ++index) {
+				if (first <= instructions[index].offset && instructions[index].offset < last) {
+					if (written && index == block.firstInstruction) {
+						os << endl;
+					}
+					auto ic = getProcBegin() + instructions[index].offset;
+					printIc(os, ic);
+					disassember.decode(ic);
+					written = true;
+				}
+			}
 		}
 	}
 
+	vector<bool> PcodeProcedure::getInstructionStarts() const {
+		vector<bool> result(getSize());
+		for (auto & instruction : getFlowGraph().getInstructions()) {
+			result[instruction.offset] = true;
+		}
+		return result;
+	}
+
 	void PcodeProcedure::printIc(std::wostream& os, uint8_t const* current)  const {
 		if (getEnterIc() == current) {
 			os << L"ENTER  :" << endl;
@@ -682,6 +1058,9 @@ namespace pcodedump {
 		if (getExitIc() == current) {
 			os << L"EXIT   :" << endl;
 		}
+		if (getFlowGraph().isTarget(static_cast<int>(current - getProcBegin()))) {
+			os << L"L" << hex << setfill(L'0') << right << setw(4) << static_cast<int>(current - getProcBegin()) << L"  :" << endl;
+		}
 		os << L"   ";
 		os << hex << setfill(L'0') << right << setw(4) << static_cast<int>(current - getProcBegin()) << L": ";
 	}
@@ -25,36 +25,167 @@
 #include <vector>
 #include <tuple>
 #include <memory>
+#include <array>
+#include <cstdint>
 
 #include <boost/endian/arithmetic.hpp>
 
 namespace pcodedump {
 
+	/* The layout of the operands that follow an opcode. */
+	enum class PcodeFormat {
+		implied,
+		unsignedByte,
+		big,
+		intermediate,
+		extended,
+		word,
+		wordBlock,
+		stringConstant,
+		packedConstant,
+		jump,
+		procedureReturn,
+		doubleByte,
+		caseJump,
+		callStandardProc,
+		compare,
+	};
+
+	struct PcodeOpcode {
+		wchar_t const * mnemonic;
+		PcodeFormat format;
+	};
+
+	extern std::array<PcodeOpcode, 256> const pcodeOpcodes;
+
+	/* Opcode numbers, for code that acts on particular instructions. The short forms of SLDL,
+	   SLDO and SIND follow on from the first of them, and every opcode below ABI is an SLDC. */
+	namespace op {
+		enum Opcode : std::uint8_t {
+			ABI = 128, ABR, ADI, ADR, LAND, DIF, DVI, DVR, CHK, FLO, FLT, INN, INT, LOR, MODI, MPI,
+			MPR, NGI, NGR, LNOT, SRS, SBI, SBR, SGS, SQI, SQR, STO, IXS, UNI, LDE, CSP, LDCN,
+			ADJ, FJP, INC, IND, IXA, LAO, LSA, LAE, MOV, LDO, SAS, SRO, XJP, RNP, CIP, EQU,
+			GEQ, GRT, LDA, LDC, LEQ, LES, LOD, NEQ, STR, UJP, LDP, STP, LDM, STM, LDB, STB,
+			IXP, RBP, CBP, EQUI, GEQI, GRTI, LLA, LDCI, LEQI, LESI, LDL, NEQI, STL, CXP, CLP, CGP,
+			LPA, STE, UNUSED, EFJ, NFJ, BPT, XIT, NOP, SLDL_1, SLDO_1 = 232, SIND_0 = 248,
+		};
+
+		static_assert(NOP == 215 && SLDL_1 == 216, "Opcode numbers out of step");
+	}
+
+	/* One decoded instruction. Offsets are from the start of the procedure. The operands depend
+	   on the format of the opcode, in the order they appear in the code. Blocks of constants and
+	   strings have their length as the first operand and their offset as the second. Branch
+	   targets are held in the flow graph, starting at firstTarget. */
+	struct PcodeInstruction {
+		std::uint16_t offset;
+		std::uint16_t length;
+		std::uint8_t opcode;
+		std::int32_t operand1;
+		std::int32_t operand2;
+		std::uint32_t firstTarget;
+		std::uint16_t targetCount;
+
+		PcodeFormat format() const {
+			return pcodeOpcodes[opcode].format;
+		}
+	};
+
+	/* A straight line run of instructions, [firstInstruction, endInstruction), and the indices of
+	   the blocks that control can pass to from its last instruction. */
+	struct BasicBlock {
+		std::uint32_t firstInstruction;
+		std::uint32_t endInstruction;
+		std::vector<std::uint32_t> successors;
+	};
+
+	class PcodeProcedure;
+
+	/* The instructions of a p-code procedure, decoded once, and the control flow graph between
+	   them. Instructions are decoded in a single linear pass from the start of the procedure
+	   until a return that isn't followed by a branch target. Branch targets are recorded in a
+	   bitmap over the bytes of the procedure, which then marks the start of basic blocks. */
+	class PcodeFlowGraph {
+	public:
+		explicit PcodeFlowGraph(PcodeProcedure const & procedure);
+
+		std::vector<PcodeInstruction> const & getInstructions() const { return instructions; }
+		std::vector<BasicBlock> const & getBlocks() const { return blocks; }
+
+		Range<std::uint16_t const> targets(PcodeInstruction const & instruction) const {
+			auto first = branchTargets.data() + instruction.firstTarget;
+			return Range<std::uint16_t const>{ first, first + instruction.targetCount };
+		}
+
+		bool isTarget(int offset) const {
+			return 0 <= offset && offset < static_cast<int>(targetMap.size()) && targetMap[offset];
+		}
+
+	private:
+		template <typename Endian>
+		void decode(PcodeProcedure const & procedure);
+		void buildBlocks();
+
+		std::vector<PcodeInstruction> instructions;
+		std::vector<std::uint16_t> branchTargets;
+		std::vector<bool> targetMap;
+		std::vector<BasicBlock> blocks;
+	};
+
+	/* A procedure of p-code, of either byte order. The attribute table is read when the
+	   procedure is made, and the code is decoded by the instantiation for its byte order. */
 	class PcodeProcedure : public Procedure {
+		friend class PcodeFlowGraph;
 
 	public:
 		using base = Procedure;
-		PcodeProcedure(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> range);
+		template <typename Endian>
+		PcodeProcedure(CodePart & codePart, int procedureNumber, Range<std::uint8_t const> range, Endian);
 
 		std::optional<int> getLexicalLevel() const override;
 
 		void writeHeader(std::wostream& os) const override;
-		void disassemble(std::wostream& os, linkref_map_t & linkage) const override;
+		void disassembleRange(std::wostream& os, linkref_map_t & linkage, std::size_t first, std::size_t last) const override;
+		std::vector<bool> getInstructionStarts() const override;
+		CallList getCalls(linkref_map_t const & linkage) const override;
+		std::vector<std::uint8_t> getNormalisedCode(linkref_map_t const & linkage) const override;
 
 		std::uint8_t const * jtab(int index) const;
-	private:
+		PcodeFlowGraph const & getFlowGraph() const;
 		std::uint8_t const * getEnterIc() const;
 		std::uint8_t const * getExitIc() const;
+		int getParameterSize() const;
+		int getDataSize() const;
+
+		bool isBigEndian() const {
+			return bigEndian;
+		}
+
+	private:
 
 		void printIc(std::wostream& os, std::uint8_t const * current)  const;
 
+		template <typename Endian>
+		void disassembleRange(std::wostream& os, linkref_map_t & linkage, std::size_t first, std::size_t last) const;
+
 	private:
+		template <typename Endian>
 		class AttributeTable;
-		AttributeTable const & attributeTable;
 
+		bool const bigEndian;
+		std::uint8_t const * enterIc;
+		std::uint8_t const * exitIc;
+		std::uint8_t const * jumpTable;
+		int lexLevel;
+		int parameterSize;
+		int dataSize;
+		mutable std::unique_ptr<PcodeFlowGraph const> flowGraph;
+
+		template <typename Endian>
 		class Disassembler;
 	};
 
+	template <typename Endian = LittleEndian>
 	float convertToReal(std::uint8_t const * buff);
 
 }
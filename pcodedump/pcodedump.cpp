@@ -15,8 +15,29 @@
 */
 
 #include "pcodefile.hpp"
+#include "segment.hpp"
+#include "basecode.hpp"
 #include "types.hpp"
 #include "options.hpp"
+#include "text.hpp"
+#include "batch.hpp"
+#include "mappedfile.hpp"
+#include "volume.hpp"
+#include "blockdevice.hpp"
+#include "nufx.hpp"
+#include "callgraph.hpp"
+#include "xref.hpp"
+#include "strings.hpp"
+#include "stats.hpp"
+#include "search.hpp"
+#include "dedup.hpp"
+#include "similar.hpp"
+#include "pmachine.hpp"
+#include "translate.hpp"
+#include "cpu6502.hpp"
+#include "native6502.hpp"
+#include "library.hpp"
+#include "linker.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -25,27 +46,516 @@
 #include <filesystem>
 #include <stdexcept>
 #include <system_error>
+#include <algorithm>
+#include <cwctype>
+#include <mutex>
+#include <thread>
+#include <map>
+#include <set>
 
 using namespace std;
 
 namespace {
-	using pcodedump::buff_t;
 
-	unique_ptr<buff_t const> readFile(filesystem::path filename) {
-		using file_t = std::ifstream;
-	    using iterator_t = istreambuf_iterator<file_t::char_type>;
+	using namespace pcodedump;
+
+	constexpr unsigned int PCD_FILE_TYPE = 0x02;
+	constexpr unsigned int PTX_FILE_TYPE = 0x03;
+
+	template <typename CharT, typename SourceT>
+	basic_string<CharT> convert(basic_string<SourceT> const & text) {
+		return basic_string<CharT>(text.begin(), text.end());
+	}
+
+	/* Write a heading for each file when more than one file is processed. */
+	template <typename CharT>
+	void writeFileHeading(basic_ostream<CharT> & os, string const & filename) {
+		if (filenames.size() > 1) {
+			os << "File: " << convert<CharT>(filename) << endl;
+		}
+	}
+
+	/* Apply an action to every file of a given kind in a volume. A file that can't be decoded is
+	   reported and the rest of the volume is still processed. */
+	template <typename CharT, typename Action>
+	void forEachVolumeFile(Volume const & volume, FileKind kind, basic_ostream<CharT> & os, Action action) {
+		int failures = 0;
+		for (auto & entry : volume.getEntries()) {
+			if (entry.getKind() == kind) {
+				try {
+					action(entry, volume.fileData(entry));
+				} catch (exception & ex) {
+					os << convert<CharT>(volume.getName() + L":" + entry.getName()) << ": " << ex.what() << endl;
+					++failures;
+				}
+			}
+		}
+		if (failures) {
+			throw runtime_error(to_string(failures) + " file(s) in the volume could not be decoded");
+		}
+	}
+
+	/* Apply an action to every record of an archive that is a disk image or is selected. Each
+	   record is expanded in turn, and its data is released before the next is expanded. */
+	template <typename CharT, typename Selector, typename Action>
+	void forEachArchiveRecord(NufxArchive const & archive, Selector selected, basic_ostream<CharT> & os, Action action) {
+		int failures = 0;
+		for (auto & record : archive.getRecords()) {
+			if (record.isDiskImage() || selected(record)) {
+				try {
+					auto data = record.expand();
+					LinearBlockDevice device{ { data.data(), data.data() + data.size() }, L"ShrinkIt disk image", record.isDiskImage() };
+					action(record, device);
+				} catch (exception & ex) {
+					os << convert<CharT>(record.getName()) << ": " << ex.what() << endl;
+					++failures;
+				}
+			}
+		}
+		if (failures) {
+			throw runtime_error(to_string(failures) + " record(s) in the archive could not be decoded");
+		}
+	}
+
+	/* Archive records are selected by their ProDOS file type, or failing that by their name. */
+	bool isArchivedFile(NufxRecord const & record, unsigned int fileType, wstring const & suffix) {
+		auto & name = record.getName();
+		return record.getFileType() == fileType || (name.size() > suffix.size()
+			&& equal(suffix.rbegin(), suffix.rend(), name.rbegin(), [](wchar_t a, wchar_t b) { return a == static_cast<wchar_t>(towupper(b)); }));
+	}
+
+	/* The part of a file selected with --offset and --length. A length of zero selects the rest of
+	   the file. */
+	Range<uint8_t const> selectWindow(Range<uint8_t const> data) {
+		auto size = static_cast<size_t>(data.end() - data.begin());
+		if (inputOffset > size) {
+			throw runtime_error("Offset is past the end of the file");
+		}
+		auto length = inputLength ? inputLength : size - inputOffset;
+		if (length > size - inputOffset) {
+			throw runtime_error("Length extends past the end of the file");
+		}
+		return Range<uint8_t const>{ data.begin() + inputOffset, data.begin() + inputOffset + length };
+	}
+
+	/* A window of a file is read as it is, without regard to the container format of the file. */
+	unique_ptr<BlockDevice> openDevice(Range<uint8_t const> data, string const & filename) {
+		if (inputOffset || inputLength) {
+			return make_unique<LinearBlockDevice>(data);
+		}
+		return BlockDevice::open(data, filename);
+	}
+
+	/* Disk images are always read as volumes. Other files are only read as volumes when asked. */
+	bool isVolume(BlockDevice const & device) {
+		return Volume::treatAsVolume || device.isDiskImage();
+	}
+
+	/* The code file is named so that copies of its procedures in other files can refer to it. */
+	void writeCodeFile(Range<uint8_t const> data, wstring const & name, wostream & os) {
+		RenderedProcedures::source = name;
+		PcodeFile file{ data };
+		os << file;
+		if (VariableXref::showXref) {
+			VariableXref{ file }.write(os);
+		}
+		if (!LibraryIndex::libraryFiles.empty()) {
+			LibraryIndex::libraries().write(os, file);
+		}
+	}
+
+	void dumpCode(BlockDevice const & device, wstring const & name, wostream & os) {
+		if (isVolume(device)) {
+			Volume volume{ device };
+			os << L"Disk image: " << device.getFormat() << endl;
+			os << volume << endl;
+			forEachVolumeFile(volume, FileKind::code, os, [&](VolumeEntry const & entry, Range<uint8_t const> data) {
+				os << L"Code file: " << volume.getName() << L":" << entry.getName() << endl;
+				writeCodeFile(data, name + L":" + volume.getName() + L":" + entry.getName(), os);
+			});
+		} else {
+			writeCodeFile(device.contents(), name, os);
+		}
+	}
+
+	void dumpCodeFile(string const & filename, wostream & os) {
+		MappedFile input{ filename };
+		auto data = selectWindow(input.data());
+		writeFileHeading(os, filename);
+		auto name = convert<wchar_t>(filesystem::path(filename).filename().string());
+		if (NufxArchive::isArchive(data)) {
+			NufxArchive archive{ data };
+			auto isCode = [](NufxRecord const & record) { return isArchivedFile(record, PCD_FILE_TYPE, L".CODE"); };
+			forEachArchiveRecord(archive, isCode, os, [&](NufxRecord const & record, BlockDevice const & device) {
+				os << L"Archive record: " << record.getName() << endl;
+				dumpCode(device, name + L":" + record.getName(), os);
+			});
+		} else {
+			dumpCode(*openDevice(data, filename), name, os);
+		}
+	}
+
+	/* List the plausible code files in a file, with the options that would decode each one. */
+	void scanFile(string const & filename, wostream & os) {
+		MappedFile input{ filename };
+		auto data = selectWindow(input.data());
+		writeFileHeading(os, filename);
+		for (auto & location : findCodeFiles(data)) {
+			auto offset = inputOffset + location.offset;
+			os << L"Code file at ";
+			if (offset % BLOCK_SIZE == 0) {
+				os << L"--offset " << offset / BLOCK_SIZE << L"blk";
+			} else {
+				os << L"--offset " << offset;
+			}
+			os << L" --length " << location.blocks << L"blk :";
+			for (auto & name : location.segmentNames) {
+				os << L" " << name;
+			}
+			os << endl;
+		}
+	}
+
+	/* Apply an action to every code file in a file, whether the file is a code file, a volume or
+	   an archive. Each code file is named after the file, the archive record and the volume
+	   that hold it, rather than having headings, so that the output can be read by other tools. */
+	template <typename Action>
+	void forEachCodeFile(string const & filename, wostream & os, Action action) {
+		MappedFile input{ filename };
+		auto data = selectWindow(input.data());
+		auto name = convert<wchar_t>(filesystem::path(filename).filename().string());
+		auto deviceAction = [&](BlockDevice const & device, wstring const & deviceName) {
+			if (isVolume(device)) {
+				Volume volume{ device };
+				forEachVolumeFile(volume, FileKind::code, os, [&](VolumeEntry const & entry, Range<uint8_t const> data) {
+					action(deviceName + L":" + volume.getName() + L":" + entry.getName(), PcodeFile{ data });
+				});
+			} else {
+				action(deviceName, PcodeFile{ device.contents() });
+			}
+		};
+		if (NufxArchive::isArchive(data)) {
+			NufxArchive archive{ data };
+			auto isCode = [](NufxRecord const & record) { return isArchivedFile(record, PCD_FILE_TYPE, L".CODE"); };
+			forEachArchiveRecord(archive, isCode, os, [&](NufxRecord const & record, BlockDevice const & device) {
+				deviceAction(device, name + L":" + record.getName());
+			});
+		} else {
+			deviceAction(*openDevice(data, filename), name);
+		}
+	}
+
+	void graphCodeFile(string const & filename, wostream & os) {
+		forEachCodeFile(filename, os, [&](wstring const & name, PcodeFile const & file) {
+			CallGraph{ file }.write(os, name, callGraph);
+		});
+	}
+
+	void listStringsFile(string const & filename, wostream & os) {
+		forEachCodeFile(filename, os, [&](wstring const & name, PcodeFile const & file) {
+			StringIndex index;
+			index.add(name, file);
+			for (size_t literal = 0; literal != index.size(); ++literal) {
+				index.write(os, literal);
+			}
+		});
+	}
 
-		if (!filesystem::is_regular_file(filename)) {
-			throw runtime_error(string("File not found: ") + filename.string());
+	/* Every pattern is compiled into one search before any file is read. The search isn't
+	   changed after that, so it is shared by the workers. */
+	InstructionSearch codeSearch;
+
+	void compileSearch() {
+		for (auto & pattern : InstructionSearch::pcodePatterns) {
+			codeSearch.addPattern(pattern, false);
+		}
+		for (auto & pattern : InstructionSearch::nativePatterns) {
+			codeSearch.addPattern(pattern, true);
+		}
+		codeSearch.compile();
+	}
+
+	void searchCodeFile(string const & filename, wostream & os) {
+		forEachCodeFile(filename, os, [&](wstring const & name, PcodeFile const & file) {
+			for (auto & match : codeSearch.find(file)) {
+				codeSearch.write(os, name, match);
+			}
+		});
+	}
+
+	/* The literals of each code file are collected by the workers, and then indexed together in
+	   the order the files were given. A code file that can't be decoded doesn't lose the
+	   literals of the others in the same volume or archive. */
+	int searchStrings(wostream & os) {
+		vector<StringIndex> indexes(filenames.size());
+		mutex lock;
+		int failures = processFiles<wchar_t>(filenames, [&](size_t position, string const & filename, wostream & fileOs) {
+			forEachCodeFile(filename, fileOs, [&](wstring const & name, PcodeFile const & file) {
+				StringIndex index;
+				index.add(name, file);
+				lock_guard<mutex> guard{ lock };
+				indexes[position].add(index);
+			});
+		}, os);
+		StringIndex corpus;
+		for (auto & index : indexes) {
+			corpus.add(index);
+		}
+		corpus.build();
+		for (auto literal : corpus.find(StringIndex::search)) {
+			corpus.write(os, literal);
 		}
+		return failures;
+	}
+
+	/* A procedure relative offset is made relative to the segment, so that both are found in the
+	   same way. */
+	void locateCodeFile(string const & filename, wostream & os) {
+		forEachCodeFile(filename, os, [&](wstring const & name, PcodeFile const & file) {
+			os << L"Code file: " << name << endl;
+			for (auto & segment : file.getSegments()) {
+				auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+				if (codeSegment && codeSegment->getSegmentNumber() == locate->segment) {
+					auto offset = locate->procedure ? codeSegment->procedureOffset(*locate->procedure, locate->offset) : locate->offset;
+					if (!codeSegment->disassembleAround(os, offset, locateWindow)) {
+						throw runtime_error("Offset is not in a procedure of segment " + to_string(locate->segment));
+					}
+					return;
+				}
+			}
+			throw runtime_error("No code segment " + to_string(locate->segment));
+		});
+	}
 
-	    file_t file(filename, ios_base::binary);
-		file.exceptions(ifstream::failbit);
-		auto buffer = make_unique<buff_t>();
-		buffer->reserve(filesystem::file_size(filename));
-		buffer->assign(iterator_t(file), iterator_t());
-		file.close();
-		return buffer;
+	/* Each code file runs on a machine of its own. */
+	void runCodeFile(string const & filename, wostream & os) {
+		forEachCodeFile(filename, os, [&](wstring const & name, PcodeFile const & file) {
+			PMachine machine{ file, os };
+			machine.run(runEntry.segment, runEntry.procedure);
+			if (PMachine::showProfile) {
+				os << endl << L"Code file: " << name << endl;
+				machine.writeProfile(os);
+			}
+		});
+	}
+
+	void translateCodeFile(string const & filename, wostream & os) {
+		forEachCodeFile(filename, os, [&](wstring const & name, PcodeFile const & file) {
+			PcodeTranslator{ file }.write(os, name, runEntry.segment, runEntry.procedure);
+		});
+	}
+
+	void emulateCodeFile(string const & filename, wostream & os, MemoryMap const & map) {
+		forEachCodeFile(filename, os, [&](wstring const & name, PcodeFile const & file) {
+			os << L"Code file: " << name << endl;
+			for (auto & segment : file.getSegments()) {
+				auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+				auto codePart = codeSegment ? codeSegment->getCodePart() : nullptr;
+				if (codePart && codePart->getProcedures() && codeSegment->getSegmentNumber() == runEntry.segment) {
+					auto & procedures = *codePart->getProcedures();
+					auto procedure = find_if(procedures.begin(), procedures.end(), [](auto & entry) { return entry->getProcedureNumber() == runEntry.procedure; });
+					auto native = procedure == procedures.end() ? nullptr : dynamic_cast<Native6502Procedure const *>(procedure->get());
+					if (!native) {
+						throw runtime_error("No 6502 procedure " + to_string(runEntry.segment) + "." + to_string(runEntry.procedure));
+					}
+					Cpu6502 processor{ cpu, os };
+					processor.load(*codePart, *native, map);
+					processor.run();
+					return;
+				}
+			}
+			throw runtime_error("No code segment " + to_string(runEntry.segment));
+		});
+	}
+
+	/* Procedures are collected in the same way as string literals, and grouped once every file
+	   has been read. */
+	int findDuplicates(wostream & os) {
+		vector<DuplicateIndex> indexes(filenames.size());
+		mutex lock;
+		int failures = processFiles<wchar_t>(filenames, [&](size_t position, string const & filename, wostream & fileOs) {
+			forEachCodeFile(filename, fileOs, [&](wstring const & name, PcodeFile const & file) {
+				DuplicateIndex index;
+				index.add(name, file);
+				lock_guard<mutex> guard{ lock };
+				indexes[position].add(index);
+			});
+		}, os);
+		DuplicateIndex corpus;
+		for (auto & index : indexes) {
+			corpus.add(index);
+		}
+		corpus.write(os);
+		return failures;
+	}
+
+	/* Copies of a procedure are found before anything is listed, so that the copy that is
+	   disassembled is the first one in input order. Only inputs that can be read in full take
+	   part, and any errors are left for the listing to report. */
+	int dumpCodeFiles(wostream & os) {
+		if (RenderedProcedures::elideCopies && CodePart::disasmProcs) {
+			vector<DuplicateIndex> indexes(filenames.size());
+			wostream discard{ nullptr };
+			processFiles<wchar_t>(filenames, [&](size_t position, string const & filename, wostream & fileOs) {
+				DuplicateIndex index;
+				forEachCodeFile(filename, fileOs, [&](wstring const & name, PcodeFile const & file) {
+					index.add(name, file);
+				});
+				indexes[position] = move(index);
+			}, discard);
+			DuplicateIndex corpus;
+			for (auto & index : indexes) {
+				corpus.add(index);
+			}
+			RenderedProcedures::listFirst(corpus);
+		}
+		return processFiles<wchar_t>(filenames, dumpCodeFile, os);
+	}
+
+	/* The link records of each code file are collected in the same way as string literals, and
+	   resolved once every file has been read. Unresolved and duplicate symbols are failures. */
+	int checkLinks(wostream & os) {
+		vector<SymbolTable> tables(filenames.size());
+		mutex lock;
+		int failures = processFiles<wchar_t>(filenames, [&](size_t position, string const & filename, wostream & fileOs) {
+			forEachCodeFile(filename, fileOs, [&](wstring const & name, PcodeFile const & file) {
+				for (auto & segment : file.getSegments()) {
+					if (segment->isVersionIV()) {
+						fileOs << name << L": link records of Version IV segment " << segment->getSegmentNumber() << L" aren't read" << endl;
+					}
+				}
+				SymbolTable table;
+				table.add(name, file);
+				lock_guard<mutex> guard{ lock };
+				tables[position].add(table);
+			});
+		}, os);
+		SymbolTable corpus;
+		for (auto & table : tables) {
+			corpus.add(table);
+		}
+		return failures + corpus.write(os);
+	}
+
+	/* The procedures of every file given are fingerprinted by the workers and indexed together.
+	   The file being looked for is then read on its own, and matched against the index. */
+	int findSimilar(wostream & os) {
+		vector<SimilarityIndex> indexes(filenames.size());
+		mutex lock;
+		int failures = processFiles<wchar_t>(filenames, [&](size_t position, string const & filename, wostream & fileOs) {
+			forEachCodeFile(filename, fileOs, [&](wstring const & name, PcodeFile const & file) {
+				SimilarityIndex index;
+				index.add(name, file);
+				lock_guard<mutex> guard{ lock };
+				indexes[position].add(index);
+			});
+		}, os);
+		SimilarityIndex corpus;
+		for (auto & index : indexes) {
+			corpus.add(index);
+		}
+		corpus.build();
+		failures += processFiles<wchar_t>({ SimilarityIndex::queryFile }, [&](string const & filename, wostream & fileOs) {
+			forEachCodeFile(filename, fileOs, [&](wstring const & name, PcodeFile const & file) {
+				corpus.writeMatches(fileOs, name, file);
+			});
+		}, os);
+		return failures;
+	}
+
+	/* The statistics of each code file are written with the file, and added to the totals of
+	   the worker thread that read it. Only finding a thread's totals is locked. The totals of
+	   the threads are added together once every file has been read. */
+	int collectStatistics(wostream & os) {
+		mutex lock;
+		map<thread::id, CodeStatistics> threadTotals;
+		int failures = processFiles<wchar_t>(filenames, [&](string const & filename, wostream & fileOs) {
+			forEachCodeFile(filename, fileOs, [&](wstring const & name, PcodeFile const & file) {
+				CodeStatistics statistics;
+				statistics.add(file);
+				fileOs << L"Statistics: " << name << endl;
+				statistics.write(fileOs);
+				CodeStatistics * threadTotal;
+				{
+					lock_guard<mutex> guard{ lock };
+					threadTotal = &threadTotals[this_thread::get_id()];
+				}
+				threadTotal->add(statistics);
+			});
+		}, os);
+		if (filenames.size() > 1) {
+			CodeStatistics total;
+			for (auto & [id, statistics] : threadTotals) {
+				total.add(statistics);
+			}
+			os << L"Statistics: all files" << endl;
+			total.write(os);
+		}
+		return failures;
+	}
+
+	/* Files given with the same name in different directories would be converted to the same
+	   output file, so a file that this run has already written isn't written again. */
+	mutex writtenLock;
+	set<filesystem::path> writtenPaths;
+
+	void writeTextFile(TextFile const & file, filesystem::path const & outputPath) {
+		{
+			lock_guard<mutex> guard{ writtenLock };
+			if (!writtenPaths.insert(outputPath.lexically_normal()).second) {
+				throw runtime_error("Not overwriting " + outputPath.string() + ", which was written from another input");
+			}
+		}
+		filesystem::create_directories(outputPath.parent_path());
+		ofstream output(outputPath, ios_base::binary);
+		output.exceptions(ofstream::failbit | ofstream::badbit);
+		file.write(output);
+	}
+
+	/* Convert a text file to plain text. Converted files are written to the output directory,
+	   if one was given, with a .txt extension replacing the original extension. The text files
+	   of a volume are written to a directory named after the volume image. */
+	void convertText(BlockDevice const & device, filesystem::path const & name, ostream & os) {
+		if (isVolume(device)) {
+			Volume volume{ device };
+			forEachVolumeFile(volume, FileKind::text, os, [&](VolumeEntry const & entry, Range<uint8_t const> data) {
+				TextFile file{ data };
+				if (outputDirectory.empty()) {
+					os << "Text file: " << convert<char>(volume.getName() + L":" + entry.getName()) << endl;
+					file.write(os);
+				} else {
+					auto textName = filesystem::path(entry.getName()).replace_extension(".txt");
+					writeTextFile(file, filesystem::path(outputDirectory) / name.parent_path() / name.stem() / textName);
+				}
+			});
+		} else {
+			TextFile file{ device.contents() };
+			if (outputDirectory.empty()) {
+				file.write(os);
+			} else {
+				writeTextFile(file, filesystem::path(outputDirectory) / filesystem::path(name).replace_extension(".txt"));
+			}
+		}
+	}
+
+	/* The text files of an archive are written to a directory named after the archive. */
+	void convertTextFile(string const & filename, ostream & os) {
+		MappedFile input{ filename };
+		auto data = selectWindow(input.data());
+		writeFileHeading(os, filename);
+		auto name = filesystem::path(filename).filename();
+		if (NufxArchive::isArchive(data)) {
+			NufxArchive archive{ data };
+			auto isText = [](NufxRecord const & record) { return isArchivedFile(record, PTX_FILE_TYPE, L".TEXT"); };
+			forEachArchiveRecord(archive, isText, os, [&](NufxRecord const & record, BlockDevice const & device) {
+				if (outputDirectory.empty()) {
+					os << "Archive record: " << convert<char>(record.getName()) << endl;
+				}
+				convertText(device, name.stem() / record.getName(), os);
+			});
+		} else {
+			convertText(*openDevice(data, filename), name, os);
+		}
 	}
 }
 
@@ -55,9 +565,48 @@ main(int argc, char *argv[]) {
 
 	try {
 		if (parseOptions(argc, argv)) {
-			auto buffer = readFile(filename);
-			PcodeFile file{*buffer};
-			wcout << file;
+			if (filenames.empty()) {
+				throw runtime_error("No input files");
+			}
+			if (!LibraryIndex::libraryFiles.empty()) {
+				// A library that can't be read is reported once, rather than for every file.
+				LibraryIndex::libraries();
+			}
+			int failures;
+			if (TextFile::convert) {
+				failures = processFiles<char>(filenames, convertTextFile, cout);
+			} else if (locate) {
+				failures = processFiles<wchar_t>(filenames, locateCodeFile, wcout);
+			} else if (runCode || PMachine::showProfile) {
+				failures = processFiles<wchar_t>(filenames, runCodeFile, wcout);
+			} else if (PcodeTranslator::translate) {
+				failures = processFiles<wchar_t>(filenames, translateCodeFile, wcout);
+			} else if (Cpu6502::emulate) {
+				auto map = MemoryMap::read(Cpu6502::memoryMap);
+				failures = processFiles<wchar_t>(filenames, [&](string const & filename, wostream & os) { emulateCodeFile(filename, os, map); }, wcout);
+			} else if (scanImages) {
+				failures = processFiles<wchar_t>(filenames, scanFile, wcout);
+			} else if (CodeStatistics::showStats) {
+				failures = collectStatistics(wcout);
+			} else if (!SimilarityIndex::queryFile.empty()) {
+				failures = findSimilar(wcout);
+			} else if (SymbolTable::checkLinks) {
+				failures = checkLinks(wcout);
+			} else if (DuplicateIndex::showDuplicates) {
+				failures = findDuplicates(wcout);
+			} else if (!StringIndex::search.empty()) {
+				failures = searchStrings(wcout);
+			} else if (!InstructionSearch::pcodePatterns.empty() || !InstructionSearch::nativePatterns.empty()) {
+				compileSearch();
+				failures = processFiles<wchar_t>(filenames, searchCodeFile, wcout);
+			} else if (StringIndex::listStrings) {
+				failures = processFiles<wchar_t>(filenames, listStringsFile, wcout);
+			} else if (callGraph != graph_format_t::none) {
+				failures = processFiles<wchar_t>(filenames, graphCodeFile, wcout);
+			} else {
+				failures = dumpCodeFiles(wcout);
+			}
+			return failures ? 1 : 0;
 		}
 		return 0;
 	} catch (system_error &ex) {
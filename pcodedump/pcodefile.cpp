@@ -16,26 +16,45 @@
 
 #include "pcodefile.hpp"
 #include "segment.hpp"
+#include "basecode.hpp"
+#include "text.hpp"
+#include "linkage.hpp"
 #include "options.hpp"
 #include "textio.hpp"
 
 #include <iomanip>
 #include <algorithm>
+#include <stdexcept>
 
 using namespace std;
 using namespace boost::endian;
 
 namespace pcodedump {
 
-	PcodeFile::PcodeFile(buff_t const & buffer) :
-		buffer{ buffer },
-		segmentDictionary{SegmentDictionary::place(buffer.data())},
+	namespace {
+
+		Range<uint8_t const> checkSize(Range<uint8_t const> data) {
+			if (data.end() - data.begin() < static_cast<ptrdiff_t>(BLOCK_SIZE)) {
+				throw runtime_error("File is too small to be a code file");
+			}
+			return data;
+		}
+
+	}
+
+	PcodeFile::PcodeFile(Range<std::uint8_t const> data) :
+		data{ checkSize(data) },
+		dictionaries{ this->data },
 		segments{ extractSegments() }
 	{
 	}
 
-	bool descendingStartAddress(SegmentDictionaryEntry & left, SegmentDictionaryEntry & right) {
-		return left.startAddress() > right.startAddress();
+	int PcodeFile::totalBlocks() const {
+		return static_cast<int>((data.end() - data.begin() - 1) / BLOCK_SIZE + 1);
+	}
+
+	uint64_t PcodeFile::intrinsicSegments() const {
+		return dictionaries.first().intrinsicSegments();
 	}
 
 	bool segmentNumber(shared_ptr<Segment const> left, shared_ptr<Segment const> right) {
@@ -48,23 +67,25 @@ namespace pcodedump {
 
 	   The main reason for doing this is that the directory entry objects need to be able to write
 	   block ranges for linkage information, but these block ranges are inferred from the gaps
-	   between the end of code in one segment and the start of the next segment.  Directory entries
-	   are self contained and don't refer to each other.  So the inferred endings for each segment
-	   are calculated and passed to directory entry constructors.
+	   between the end of code in one segment and the start of the next segment, or the next
+	   dictionary block of a Version IV file.  Directory entries are self contained and don't refer
+	   to each other.  So the inferred endings for each segment are calculated and passed to
+	   directory entry constructors.  The dictionary chain is read only as far as each ending
+	   needs.
 
 	   Data blocks use 0 as a special value for the segment end. Segment block ranges are treated
 	   as [begin, end), so the block number returned is actually one block past the end block of
 	   the segment.  For the last segment in a file, this block number be past the end of the file. */
 	unique_ptr<Segments> PcodeFile::extractSegments() {
-		vector<SegmentDictionaryEntry> dictionaryEntries(cbegin(segmentDictionary), cend(segmentDictionary));
-		sort(begin(dictionaryEntries), end(dictionaryEntries), descendingStartAddress);
 		auto segments = make_unique<Segments>();
-		int currentEnd = static_cast<int>((buffer.size() - 1) / BLOCK_SIZE + 1);
 
-		for (auto & dictionaryEntry : dictionaryEntries) {
+		for (int index = 0; dictionaries.contains(index); ++index) {
+			auto dictionaryEntry = dictionaries[index];
 			if (dictionaryEntry.codeAddress() != 0) {
-				segments->push_back(make_shared<CodeSegment>(buffer, dictionaryEntry, currentEnd));
-				currentEnd = dictionaryEntry.startAddress();
+				if (dictionaryEntry.codeAddress() * BLOCK_SIZE + dictionaryEntry.codeLength() > static_cast<size_t>(data.end() - data.begin())) {
+					throw runtime_error("Segment extends past the end of the file");
+				}
+				segments->push_back(make_shared<CodeSegment>(data, dictionaryEntry, dictionaries.nextStart(dictionaryEntry.startAddress(), totalBlocks())));
 			} else if (dictionaryEntry.codeLength() != 0) {
 				segments->push_back(make_shared<DataSegment>(dictionaryEntry));
 			}
@@ -98,15 +119,35 @@ namespace pcodedump {
 
 	std::wostream& operator<<(std::wostream& os, const PcodeFile& file) {
 		FmtSentry<wostream::char_type> sentry{ os };
-		wcout << "Total blocks: " << (file.buffer.size() - 1) / BLOCK_SIZE + 1 << endl;
-		wstring comment = file.segmentDictionary.fileComment();
+		os << L"Total blocks: " << file.totalBlocks() << endl;
+		wstring comment = file.dictionaries.first().fileComment();
 		transform(begin(comment), end(comment), begin(comment), [](const auto &c) { return 32 <= c && c <= 126 ? c : L'.'; });
 		os << L"Comment: " << comment << endl;
-		writeIntrinsicUnits(os, file.segmentDictionary.intrinsicSegments());
+		writeIntrinsicUnits(os, file.intrinsicSegments());
 		os << endl;
 		for (auto segment : *file.segments) {
 			os << *segment << endl;
 		}
 		return os;
 	}
+
+	/* Check every block of an image for a segment dictionary. Only the dictionary invariants are
+	   checked, so this is fast enough for hard disk images, but a match still needs to be
+	   decoded to be sure that it is a code file. */
+	vector<CodeFileLocation> findCodeFiles(Range<uint8_t const> image) {
+		vector<CodeFileLocation> result;
+		for (auto block = image.begin(); image.end() - block >= static_cast<ptrdiff_t>(BLOCK_SIZE); block += BLOCK_SIZE) {
+			int blocks = SegmentDictionary::plausibleExtent({ block, image.end() });
+			if (blocks) {
+				vector<wstring> names;
+				for (auto entry : SegmentDictionaryChain({ block, image.end() })) {
+					if (entry.codeAddress() != 0) {
+						names.push_back(entry.name());
+					}
+				}
+				result.push_back({ static_cast<size_t>(block - image.begin()), blocks, names });
+			}
+		}
+		return result;
+	}
 }
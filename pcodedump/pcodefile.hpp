@@ -18,36 +18,51 @@
 #define _773BCD58_B2D9_43BA_BC08_12754CD95096
 
 #include "types.hpp"
+#include "segment.hpp"
 
 #include <iostream>
 #include <string>
 #include <memory>
 #include <vector>
+#include <cstddef>
 
 namespace pcodedump {
 
-	class Segment;
-	class SegmentDictionary;
-
 	using Segments = std::vector<std::shared_ptr<Segment>>;
 
 	class PcodeFile {
 		friend std::wostream& operator<<(std::wostream&, const PcodeFile&);
 
 	public:
-		PcodeFile(buff_t const & buffer);
+		PcodeFile(Range<std::uint8_t const> data);
+
+		int totalBlocks() const;
+		std::uint64_t intrinsicSegments() const;
+		Segments const & getSegments() const {
+			return *segments;
+		}
 
 	private:
 		std::unique_ptr<Segments> extractSegments();
 	
 	private:
-		buff_t const & buffer;
-		SegmentDictionary const & segmentDictionary;
+		Range<std::uint8_t const> data;
+		SegmentDictionaryChain dictionaries;
 		std::unique_ptr<Segments> segments;
 	};
 
 	std::wostream& operator<<(std::wostream& os, const PcodeFile& value);
 
+	/* A block aligned position in an image that holds a plausible segment dictionary, and the
+	   number of blocks up to the end of the last code segment. */
+	struct CodeFileLocation {
+		std::size_t offset;
+		int blocks;
+		std::vector<std::wstring> segmentNames;
+	};
+
+	std::vector<CodeFileLocation> findCodeFiles(Range<std::uint8_t const> image);
+
 }
 
 #endif // !_773BCD58_B2D9_43BA_BC08_12754CD95096
@@ -0,0 +1,1119 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "pmachine.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "basecode.hpp"
+#include "pcode.hpp"
+#include "textio.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+
+using namespace std;
+
+namespace pcodedump {
+
+	namespace {
+
+		using namespace op;
+
+		/* The code of the instruction after the last one of a procedure. */
+		constexpr uint8_t PAST_END = UNUSED;
+
+		constexpr int MEMORY_SIZE = 0x10000;
+		constexpr uint16_t HEAP_BOTTOM = 0x0100;
+		constexpr uint16_t STACK_MARGIN = 0x0400;
+		constexpr int CONSOLE = 1;
+		constexpr int SYSTERM = 2;
+
+		inline int16_t loadWord(uint8_t const * memory, uint16_t address) {
+			return static_cast<int16_t>(memory[address] | memory[address + 1] << 8);
+		}
+
+		inline void storeWord(uint8_t * memory, uint16_t address, int value) {
+			memory[address] = static_cast<uint8_t>(value);
+			memory[address + 1] = static_cast<uint8_t>(value >> 8);
+		}
+
+		/* A real is a little endian float once it is in memory, because LDC pushes the words of
+		   a real constant in the reverse of their order in the code. */
+		float loadReal(uint8_t const * memory, uint16_t address) {
+			uint32_t bits = memory[address] | memory[address + 1] << 8 | memory[address + 2] << 16 | static_cast<uint32_t>(memory[address + 3]) << 24;
+			float result;
+			memcpy(&result, &bits, sizeof result);
+			return result;
+		}
+
+		void storeReal(uint8_t * memory, uint16_t address, float value) {
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof bits);
+			for (int index = 0; index != 4; ++index) {
+				memory[address + index] = static_cast<uint8_t>(bits >> (8 * index));
+			}
+		}
+
+		bool test(uint8_t opcode, int order) {
+			switch (opcode) {
+			case EQU:
+				return order == 0;
+			case NEQ:
+				return order != 0;
+			case LES:
+				return order < 0;
+			case LEQ:
+				return order <= 0;
+			case GRT:
+				return order > 0;
+			default:
+				return order >= 0;
+			}
+		}
+
+		template<typename T>
+		int order(T left, T right) {
+			return (left > right) - (left < right);
+		}
+
+	}
+
+	bool PMachine::showProfile = false;
+
+	PMachine::PMachine(PcodeFile const & file, std::wostream & console) :
+		file{ file }, console{ console }, memory(MEMORY_SIZE + 4), codeBottom{ 0 }, heapTop{ HEAP_BOTTOM }
+	{
+		uint32_t bottom = MEMORY_SIZE;
+		for (auto & segment : file.getSegments()) {
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			auto codePart = codeSegment ? codeSegment->getCodePart() : nullptr;
+			if (codePart && codeSegment->getMachineType() == MachineType::pcode_little && !segments[codeSegment->getSegmentNumber()].segment) {
+				auto size = static_cast<uint32_t>(codePart->end() - codePart->begin());
+				if (size + STACK_MARGIN > bottom - HEAP_BOTTOM) {
+					throw runtime_error("Not enough p-machine memory to load the code file");
+				}
+				bottom = (bottom - size) & ~1u;
+				copy(codePart->begin(), codePart->end(), memory.begin() + bottom);
+				auto & loaded = segments[codeSegment->getSegmentNumber()];
+				loaded.segment = codeSegment;
+				loaded.address = static_cast<uint16_t>(bottom);
+			}
+		}
+		codeBottom = static_cast<uint16_t>(bottom & 0xfffe);
+	}
+
+	/* The routines of a segment are decoded as they are first called. */
+	PMachine::Routine const & PMachine::routine(int segment, int procedure) {
+		auto & loaded = segments[segment & 0xff];
+		if (!loaded.segment) {
+			throw fault("No p-code segment " + to_string(segment));
+		}
+		if (procedure >= static_cast<int>(loaded.routines.size())) {
+			loaded.routines.resize(procedure + 1);
+		}
+		auto & result = loaded.routines[procedure];
+		if (!result) {
+			result = decode(loaded, procedure);
+		}
+		return *result;
+	}
+
+	/* The short forms of loads and constants become their long forms. The offsets of locals,
+	   globals and intermediate variables are made into byte offsets, and case tables are kept
+	   in the routine as the highest case, the default target and then the case targets. */
+	unique_ptr<PMachine::Routine> PMachine::decode(LoadedSegment const & loaded, int procedureNumber) const {
+		auto codePart = loaded.segment->getCodePart();
+		auto procedures = codePart->getProcedures();
+		auto found = procedures ? find_if(procedures->begin(), procedures->end(), [=](auto & entry) { return entry->getProcedureNumber() == procedureNumber; }) : CodePart::Procedures::const_iterator{};
+		auto location = to_string(loaded.segment->getSegmentNumber()) + "." + to_string(procedureNumber);
+		if (!procedures || found == procedures->end()) {
+			throw fault("No procedure " + location);
+		}
+		auto procedure = dynamic_cast<PcodeProcedure const *>(found->get());
+		if (!procedure) {
+			throw fault("Procedure " + location + " is native code");
+		}
+
+		auto result = make_unique<Routine>();
+		result->segment = loaded.segment->getSegmentNumber();
+		result->procedure = procedureNumber;
+		result->lexLevel = static_cast<int8_t>(procedure->getLexicalLevel().value_or(0));
+		result->parameterSize = static_cast<uint16_t>(procedure->getParameterSize());
+		result->dataSize = static_cast<uint16_t>(procedure->getDataSize());
+
+		auto & flowGraph = procedure->getFlowGraph();
+		auto & instructions = flowGraph.getInstructions();
+		vector<int32_t> indexAt(procedure->getSize() + 1, -1);
+		for (size_t index = 0; index != instructions.size(); ++index) {
+			indexAt[instructions[index].offset] = static_cast<int32_t>(index);
+		}
+		auto indexOf = [&](intptr_t offset) {
+			if (offset < 0 || offset >= static_cast<intptr_t>(indexAt.size()) || indexAt[offset] < 0) {
+				throw runtime_error("Procedure " + location + " has a branch to offset " + to_string(offset) + " that isn't an instruction");
+			}
+			return indexAt[offset];
+		};
+		auto address = [&](int32_t offset) {
+			return static_cast<int32_t>(loaded.address + (procedure->getProcBegin() - codePart->begin()) + offset);
+		};
+
+		for (auto & instruction : instructions) {
+			Op op{ instruction.opcode, instruction.opcode, instruction.offset, instruction.operand1, instruction.operand2 };
+			switch (instruction.opcode) {
+			case LDL: case LLA: case STL: case LDO: case LAO: case SRO:
+				op.a = 2 * (instruction.operand1 - 1);
+				break;
+			case IND: case INC: case IXA: case MOV:
+				op.a = 2 * instruction.operand1;
+				break;
+			case LOD: case LDA: case STR: case LDE: case LAE: case STE:
+				op.b = 2 * (instruction.operand2 - 1);
+				break;
+			case LSA:
+				op.a = address(instruction.operand2 - 1);
+				break;
+			case LPA:
+				op.a = address(instruction.operand2);
+				break;
+			case LDC:
+				op.a = address(instruction.operand2);
+				op.b = instruction.operand1;
+				break;
+			case FJP: case UJP: case EFJ: case NFJ:
+				op.a = indexOf(instruction.operand1);
+				break;
+			case XJP: {
+				auto targets = flowGraph.targets(instruction);
+				if (instruction.operand2 < instruction.operand1 || instruction.targetCount != (instruction.operand2 - instruction.operand1 + 2)) {
+					throw runtime_error("Procedure " + location + " has a case table out of range");
+				}
+				op.a = static_cast<int32_t>(result->cases.size());
+				op.b = instruction.operand1;
+				result->cases.push_back(instruction.operand2);
+				for (auto target : targets) {
+					result->cases.push_back(indexOf(target));
+				}
+				break;
+			}
+			default:
+				if (instruction.opcode < ABI) {
+					op.code = LDCI;
+					op.a = instruction.opcode;
+				} else if (instruction.opcode >= SIND_0) {
+					op.code = IND;
+					op.a = 2 * (instruction.opcode - SIND_0);
+				} else if (instruction.opcode >= SLDO_1) {
+					op.code = LDO;
+					op.a = 2 * (instruction.opcode - SLDO_1);
+				} else if (instruction.opcode >= SLDL_1) {
+					op.code = LDL;
+					op.a = 2 * (instruction.opcode - SLDL_1);
+				}
+				break;
+			}
+			result->code.push_back(op);
+		}
+		auto end = instructions.empty() ? 0 : instructions.back().offset + instructions.back().length;
+		result->code.push_back({ PAST_END, PAST_END, static_cast<uint16_t>(end), 0, 0 });
+		result->enter = indexOf(procedure->getEnterIc() - procedure->getProcBegin());
+		result->exit = indexOf(procedure->getExitIc() - procedure->getProcBegin());
+		return result;
+	}
+
+	/* The location of a fault is the instruction before the one that the current frame would
+	   resume at. */
+	std::runtime_error PMachine::fault(std::string const & reason) const {
+		if (frames.empty()) {
+			return runtime_error("P-machine fault: " + reason);
+		}
+		auto & frame = frames.back();
+		auto & op = frame.routine->code[frame.ip ? frame.ip - 1 : 0];
+		ostringstream message;
+		message << "P-machine fault at " << frame.routine->segment << "." << frame.routine->procedure << ":";
+		message << hex << setfill('0') << setw(4) << op.offset << ": " << reason;
+		return runtime_error(message.str());
+	}
+
+	void PMachine::run(int segment, int procedure) {
+		frames.clear();
+		halted = false;
+		auto & entry = routine(segment, procedure);
+		uint16_t sp = codeBottom;
+		sp -= entry.parameterSize;
+		fill(memory.begin() + sp, memory.begin() + sp + entry.parameterSize, 0);
+		call(entry, sp);
+		auto start = chrono::steady_clock::now();
+		execute();
+		seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+
+	/* The static link of a procedure is the nearest frame on the static chain of the caller that
+	   is at a lower lexical level. A procedure at level 0 or below is a base procedure, and its
+	   locals are the globals until it returns. */
+	std::uint16_t PMachine::call(Routine const & callee, std::uint16_t sp) {
+		uint16_t top = sp;
+		if (!frames.empty() && sp + callee.parameterSize > frames.back().locals) {
+			throw fault("Stack underflow");
+		}
+		if (sp < heapTop + callee.dataSize + STACK_MARGIN) {
+			throw fault("Stack overflow");
+		}
+		sp -= callee.dataSize;
+		fill(memory.begin() + sp, memory.begin() + top, 0);
+		int32_t staticLink = frames.empty() ? -1 : static_cast<int32_t>(frames.size() - 1);
+		while (staticLink >= 0 && frames[staticLink].routine->lexLevel >= callee.lexLevel) {
+			staticLink = frames[staticLink].staticLink;
+		}
+		frames.push_back({ &callee, callee.enter, sp, static_cast<uint16_t>(top + callee.parameterSize), globals, staticLink });
+		if (callee.lexLevel <= 0) {
+			globals = sp;
+			segments[callee.segment].globals = sp;
+		}
+		return sp;
+	}
+
+	/* The globals of a unit are those of its outermost procedure. If that hasn't run, they are
+	   made on the heap. */
+	std::uint16_t PMachine::segmentGlobals(int segment) {
+		auto & loaded = segments[segment & 0xff];
+		if (!loaded.globals) {
+			auto & outer = routine(segment, 1);
+			if (heapTop + outer.dataSize + STACK_MARGIN > MEMORY_SIZE) {
+				throw fault("Heap overflow");
+			}
+			loaded.globals = heapTop;
+			heapTop += outer.dataSize;
+		}
+		return loaded.globals;
+	}
+
+	std::uint16_t PMachine::allocate(std::uint16_t size, std::uint16_t sp) {
+		if (heapTop + size + STACK_MARGIN > sp) {
+			throw fault("Heap overflow");
+		}
+		auto result = heapTop;
+		fill(memory.begin() + heapTop, memory.begin() + heapTop + size, 0);
+		heapTop += size;
+		return result;
+	}
+
+	/* Comparisons that aren't of integers. Strings are compared on their characters, then on
+	   their length, and sets on inclusion. */
+	std::uint16_t PMachine::compare(Op const & op, std::uint16_t sp) {
+		auto mem = memory.data();
+		int result = 0;
+		switch (op.a) {
+		case 2: {
+			auto right = loadReal(mem, sp);
+			auto left = loadReal(mem, sp + 4);
+			sp += 8;
+			result = order(left, right);
+			break;
+		}
+		case 4: {
+			uint16_t right = loadWord(mem, sp);
+			uint16_t left = loadWord(mem, sp + 2);
+			sp += 4;
+			if (left + mem[left] + 1 > MEMORY_SIZE || right + mem[right] + 1 > MEMORY_SIZE) {
+				throw fault("Memory access out of range");
+			}
+			auto length = min(mem[left], mem[right]);
+			result = memcmp(mem + left + 1, mem + right + 1, length);
+			result = result ? order(result, 0) : order(mem[left], mem[right]);
+			break;
+		}
+		case 6: {
+			auto right = loadWord(mem, sp) & 1;
+			auto left = loadWord(mem, sp + 2) & 1;
+			sp += 4;
+			result = order(left, right);
+			break;
+		}
+		case 8: {
+			auto rightSize = static_cast<uint16_t>(loadWord(mem, sp));
+			uint16_t right = sp + 2;
+			auto leftSize = static_cast<uint16_t>(loadWord(mem, right + 2 * rightSize));
+			uint16_t left = right + 2 * rightSize + 2;
+			sp = left + 2 * leftSize;
+			bool leftInRight = true;
+			bool rightInLeft = true;
+			for (int index = 0; index != max(leftSize, rightSize); ++index) {
+				auto leftWord = index < leftSize ? loadWord(mem, left + 2 * index) : 0;
+				auto rightWord = index < rightSize ? loadWord(mem, right + 2 * index) : 0;
+				leftInRight &= (leftWord & ~rightWord) == 0;
+				rightInLeft &= (rightWord & ~leftWord) == 0;
+			}
+			bool truth;
+			switch (op.code) {
+			case EQU:
+				truth = leftInRight && rightInLeft;
+				break;
+			case NEQ:
+				truth = !(leftInRight && rightInLeft);
+				break;
+			case LEQ:
+				truth = leftInRight;
+				break;
+			case GEQ:
+				truth = rightInLeft;
+				break;
+			default:
+				throw fault("Invalid set comparison");
+			}
+			sp -= 2;
+			storeWord(mem, sp, truth);
+			return sp;
+		}
+		case 10: case 12: {
+			uint16_t right = loadWord(mem, sp);
+			uint16_t left = loadWord(mem, sp + 2);
+			sp += 4;
+			auto length = op.a == 10 ? op.b : 2 * op.b;
+			if (left + length > MEMORY_SIZE || right + length > MEMORY_SIZE) {
+				throw fault("Memory access out of range");
+			}
+			result = order(memcmp(mem + left, mem + right, length), 0);
+			break;
+		}
+		default:
+			throw fault("Invalid comparison type " + to_string(op.a));
+		}
+		sp -= 2;
+		storeWord(mem, sp, test(op.code, result));
+		return sp;
+	}
+
+	/* A set on the stack is its words, lowest first, under a word with the number of them. */
+	std::uint16_t PMachine::setOperation(Op const & op, std::uint16_t sp) {
+		auto mem = memory.data();
+		auto popSet = [&] {
+			auto size = static_cast<uint16_t>(loadWord(mem, sp));
+			vector<uint16_t> result(size);
+			for (int index = 0; index != size; ++index) {
+				result[index] = loadWord(mem, sp + 2 + 2 * index);
+			}
+			sp += 2 + 2 * size;
+			return result;
+		};
+		auto pushSet = [&](vector<uint16_t> const & set) {
+			sp -= 2 * static_cast<uint16_t>(set.size());
+			for (size_t index = 0; index != set.size(); ++index) {
+				storeWord(mem, sp + 2 * static_cast<uint16_t>(index), set[index]);
+			}
+			sp -= 2;
+			storeWord(mem, sp, static_cast<int>(set.size()));
+		};
+		switch (op.code) {
+		case ADJ: {
+			auto set = popSet();
+			set.resize(op.a);
+			pushSet(set);
+			sp += 2;
+			break;
+		}
+		case SGS: case SRS: {
+			int high = loadWord(mem, sp);
+			int low = high;
+			sp += 2;
+			if (op.code == SRS) {
+				low = loadWord(mem, sp);
+				sp += 2;
+			}
+			if (low < 0 || high > 4079) {
+				throw fault("Set element out of range");
+			}
+			vector<uint16_t> set(low <= high ? high / 16 + 1 : 0);
+			for (int element = low; element <= high; ++element) {
+				set[element / 16] |= 1 << (element % 16);
+			}
+			pushSet(set);
+			break;
+		}
+		case INN: {
+			auto set = popSet();
+			int element = loadWord(mem, sp);
+			bool member = element >= 0 && element / 16 < static_cast<int>(set.size()) && (set[element / 16] >> (element % 16) & 1);
+			storeWord(mem, sp, member);
+			break;
+		}
+		default: {
+			auto right = popSet();
+			auto left = popSet();
+			auto size = op.code == UNI ? max(left.size(), right.size()) : left.size();
+			left.resize(size);
+			right.resize(max(size, right.size()));
+			for (size_t index = 0; index != size; ++index) {
+				switch (op.code) {
+				case UNI:
+					left[index] |= right[index];
+					break;
+				case INT:
+					left[index] &= right[index];
+					break;
+				default:
+					left[index] &= ~right[index];
+					break;
+				}
+			}
+			pushSet(left);
+			break;
+		}
+		}
+		return sp;
+	}
+
+	/* An exit resumes the procedure at its exit code, with the frames above it discarded. */
+	std::uint16_t PMachine::exitProcedure(int segment, int procedure, std::uint16_t sp) {
+		auto frame = frames.size();
+		while (frame != 0 && (frames[frame - 1].routine->segment != segment || frames[frame - 1].routine->procedure != procedure)) {
+			--frame;
+		}
+		if (frame == 0) {
+			throw fault("Exit from procedure " + to_string(segment) + "." + to_string(procedure) + " that isn't active");
+		}
+		if (frame != frames.size()) {
+			sp = frames[frame].top;
+			globals = frames[frame].savedGlobals;
+			frames.resize(frame);
+		}
+		frames.back().ip = frames.back().routine->exit;
+		return sp;
+	}
+
+	/* Parameters are popped last first. */
+	std::uint16_t PMachine::callStandardProc(int number, std::uint16_t sp) {
+		auto mem = memory.data();
+		auto pop = [&] {
+			auto result = loadWord(mem, sp);
+			sp += 2;
+			return result;
+		};
+		auto push = [&](int value) {
+			sp -= 2;
+			storeWord(mem, sp, value);
+		};
+		auto checkRange = [&](uint16_t address, int length) {
+			if (length > 0 && address + length > MEMORY_SIZE) {
+				throw fault("Memory access out of range");
+			}
+		};
+		switch (number) {
+		case 0:
+			break;
+		case 1: {
+			uint16_t size = 2 * pop();
+			uint16_t pointer = pop();
+			storeWord(mem, pointer, allocate(size, sp));
+			break;
+		}
+		case 2: case 3: {
+			int count = pop();
+			uint16_t destination = pop();
+			uint16_t source = pop();
+			checkRange(source, count);
+			checkRange(destination, count);
+			for (int index = 0; index < count; ++index) {
+				auto at = number == 2 ? index : count - 1 - index;
+				mem[destination + at] = mem[source + at];
+			}
+			break;
+		}
+		case 4: {
+			int procedure = pop();
+			int segment = pop();
+			sp = exitProcedure(segment, procedure, sp);
+			break;
+		}
+		case 5: case 6: {
+			pop();
+			pop();
+			int length = pop();
+			uint16_t buffer = pop();
+			int unit = pop();
+			checkRange(buffer, length);
+			if (number == 5) {
+				fill(mem + buffer, mem + buffer + max(length, 0), 0);
+			} else if (unit == CONSOLE || unit == SYSTERM) {
+				for (int index = 0; index < length; ++index) {
+					auto character = mem[buffer + index];
+					console << (character == '\r' ? L'\n' : static_cast<wchar_t>(character));
+				}
+			}
+			break;
+		}
+		case 9: {
+			uint16_t low = pop();
+			uint16_t high = pop();
+			storeWord(mem, low, 0);
+			storeWord(mem, high, 0);
+			break;
+		}
+		case 10: {
+			int character = pop();
+			int count = pop();
+			uint16_t destination = pop();
+			checkRange(destination, count);
+			fill(mem + destination, mem + destination + max(count, 0), static_cast<uint8_t>(character));
+			break;
+		}
+		case 12:
+			pop();
+			pop();
+			pop();
+			break;
+		case 21: case 22:
+			pop();
+			break;
+		case 23: case 24: {
+			auto value = loadReal(mem, sp);
+			sp += 4;
+			value = number == 23 ? trunc(value) : round(value);
+			if (value < -32768 || value > 32767) {
+				throw fault("Integer overflow");
+			}
+			push(static_cast<int>(value));
+			break;
+		}
+		case 25: case 26: case 27: case 28: case 29: case 30: case 31: {
+			auto value = loadReal(mem, sp);
+			switch (number) {
+			case 25:
+				value = sin(value);
+				break;
+			case 26:
+				value = cos(value);
+				break;
+			case 27:
+				value = log10(value);
+				break;
+			case 28:
+				value = atan(value);
+				break;
+			case 29:
+				value = log(value);
+				break;
+			case 30:
+				value = exp(value);
+				break;
+			default:
+				value = sqrt(value);
+				break;
+			}
+			storeReal(mem, sp, value);
+			break;
+		}
+		case 32: {
+			uint16_t pointer = pop();
+			storeWord(mem, pointer, heapTop);
+			break;
+		}
+		case 33: {
+			uint16_t pointer = pop();
+			heapTop = max(HEAP_BOTTOM, static_cast<uint16_t>(loadWord(mem, pointer)));
+			break;
+		}
+		case 34:
+			push(0);
+			break;
+		case 35:
+			pop();
+			push(0);
+			break;
+		case 36: {
+			int power = pop();
+			sp -= 4;
+			storeReal(mem, sp, pow(10.0f, static_cast<float>(power)));
+			break;
+		}
+		case 37: case 38:
+			pop();
+			break;
+		case 39:
+			halted = true;
+			break;
+		case 40:
+			push((sp - heapTop - STACK_MARGIN) / 2);
+			break;
+		default:
+			throw fault("Standard procedure " + to_string(number) + " isn't supported");
+		}
+		return sp;
+	}
+
+	/* The machine registers are locals of the loop. They are written back to the frame before
+	   anything that calls, returns or might fault, and read again afterwards. */
+	void PMachine::execute() {
+		auto mem = memory.data();
+		Frame * frame = nullptr;
+		Op const * code = nullptr;
+		Op const * ip = nullptr;
+		int32_t const * cases = nullptr;
+		uint16_t locals = 0;
+		uint16_t sp = frames.back().locals;
+		auto counts = this->counts.data();
+
+		auto resume = [&] {
+			frame = &frames.back();
+			code = frame->routine->code.data();
+			cases = frame->routine->cases.data();
+			ip = code + frame->ip;
+			locals = frame->locals;
+		};
+		auto suspend = [&] {
+			frames.back().ip = static_cast<uint32_t>(ip - code);
+		};
+		auto fail = [&](string const & reason) {
+			suspend();
+			return fault(reason);
+		};
+		/* The operand stack of a procedure is below its locals. */
+		auto checkStack = [&](int length) {
+			if (sp + length > locals) {
+				throw fail("Stack underflow");
+			}
+		};
+		auto peek = [&] {
+			checkStack(2);
+			return loadWord(mem, sp);
+		};
+		auto pop = [&] {
+			auto result = peek();
+			sp += 2;
+			return result;
+		};
+		auto push = [&](int value) {
+			sp -= 2;
+			storeWord(mem, sp, value);
+		};
+		auto intermediate = [&](int levels) {
+			auto link = static_cast<int32_t>(frames.size() - 1);
+			for (; levels != 0 && link >= 0; --levels) {
+				link = frames[link].staticLink;
+			}
+			if (link < 0) {
+				throw fail("No enclosing procedure");
+			}
+			return frames[link].locals;
+		};
+		auto checkRange = [&](uint16_t address, int length) {
+			if (address + length > MEMORY_SIZE) {
+				throw fail("Memory access out of range");
+			}
+		};
+		/* A packed field lies within a word. */
+		auto checkField = [&](int width, int right) {
+			if (width < 0 || width > 16 || right < 0 || right > 15) {
+				throw fail("Packed field out of range");
+			}
+		};
+
+		resume();
+		for (;;) {
+			auto & op = *ip++;
+			++counts[op.opcode];
+			switch (op.code) {
+			case LDCI:
+				push(op.a);
+				break;
+			case LDL:
+				push(loadWord(mem, locals + op.a));
+				break;
+			case LLA:
+				push(locals + op.a);
+				break;
+			case STL:
+				storeWord(mem, locals + op.a, pop());
+				break;
+			case LDO:
+				push(loadWord(mem, globals + op.a));
+				break;
+			case LAO:
+				push(globals + op.a);
+				break;
+			case SRO:
+				storeWord(mem, globals + op.a, pop());
+				break;
+			case LOD:
+				push(loadWord(mem, intermediate(op.a) + op.b));
+				break;
+			case LDA:
+				push(intermediate(op.a) + op.b);
+				break;
+			case STR:
+				storeWord(mem, intermediate(op.a) + op.b, pop());
+				break;
+			case LDE: case LAE: case STE: {
+				suspend();
+				uint16_t address = segmentGlobals(op.a) + op.b;
+				if (op.code == LDE) {
+					push(loadWord(mem, address));
+				} else if (op.code == LAE) {
+					push(address);
+				} else {
+					storeWord(mem, address, pop());
+				}
+				break;
+			}
+			case IND:
+				storeWord(mem, sp, loadWord(mem, static_cast<uint16_t>(peek() + op.a)));
+				break;
+			case INC:
+				storeWord(mem, sp, peek() + op.a);
+				break;
+			case IXA: {
+				auto index = pop();
+				storeWord(mem, sp, peek() + op.a * index);
+				break;
+			}
+			case STO: {
+				auto value = pop();
+				storeWord(mem, static_cast<uint16_t>(pop()), value);
+				break;
+			}
+			case LDCN:
+				push(0);
+				break;
+			case LSA: case LPA:
+				push(op.a);
+				break;
+			case LDC:
+				for (int word = 0; word != op.b; ++word) {
+					push(loadWord(mem, static_cast<uint16_t>(op.a + 2 * word)));
+				}
+				break;
+			case LDM: {
+				uint16_t source = pop();
+				checkRange(source, 2 * op.a);
+				if (sp < heapTop + 2 * op.a) {
+					throw fail("Stack overflow");
+				}
+				sp -= 2 * op.a;
+				memmove(mem + sp, mem + source, 2 * op.a);
+				break;
+			}
+			case STM: {
+				checkStack(2 * op.a + 2);
+				uint16_t destination = loadWord(mem, sp + 2 * op.a);
+				checkRange(destination, 2 * op.a);
+				memmove(mem + destination, mem + sp, 2 * op.a);
+				sp += 2 * op.a + 2;
+				break;
+			}
+			case MOV: {
+				uint16_t source = pop();
+				uint16_t destination = pop();
+				checkRange(source, op.a);
+				checkRange(destination, op.a);
+				memmove(mem + destination, mem + source, op.a);
+				break;
+			}
+			case LDB: {
+				auto index = pop();
+				storeWord(mem, sp, mem[static_cast<uint16_t>(peek() + index)]);
+				break;
+			}
+			case STB: {
+				auto value = pop();
+				auto index = pop();
+				mem[static_cast<uint16_t>(pop() + index)] = static_cast<uint8_t>(value);
+				break;
+			}
+			case LDP: {
+				auto right = pop();
+				auto width = pop();
+				checkField(width, right);
+				auto mask = (1u << width) - 1;
+				storeWord(mem, sp, (static_cast<uint16_t>(loadWord(mem, static_cast<uint16_t>(peek()))) >> right) & mask);
+				break;
+			}
+			case STP: {
+				auto value = pop();
+				auto right = pop();
+				auto width = pop();
+				uint16_t address = pop();
+				checkField(width, right);
+				auto mask = ((1u << width) - 1) << right;
+				auto word = static_cast<uint16_t>(loadWord(mem, address));
+				storeWord(mem, address, (word & ~mask) | ((value << right) & mask));
+				break;
+			}
+			case IXP: {
+				if (op.a == 0) {
+					throw fail("Packed array with no elements in a word");
+				}
+				auto index = pop();
+				auto address = peek();
+				storeWord(mem, sp, address + 2 * (index / op.a));
+				push(op.b);
+				push((index % op.a) * op.b);
+				break;
+			}
+			case IXS: {
+				checkStack(4);
+				auto index = peek();
+				auto text = static_cast<uint16_t>(loadWord(mem, sp + 2));
+				if (index < 1 || index > mem[text]) {
+					throw fail("String index out of range");
+				}
+				break;
+			}
+			case SAS: {
+				auto source = static_cast<uint16_t>(pop());
+				auto destination = static_cast<uint16_t>(pop());
+				if (source < 256) {
+					mem[destination] = 1;
+					mem[destination + 1] = static_cast<uint8_t>(source);
+				} else {
+					if (mem[source] > op.a) {
+						throw fail("String overflow");
+					}
+					checkRange(source, mem[source] + 1);
+					checkRange(destination, mem[source] + 1);
+					memmove(mem + destination, mem + source, mem[source] + 1);
+				}
+				break;
+			}
+			case ABI: {
+				auto value = peek();
+				storeWord(mem, sp, value < 0 ? -value : value);
+				break;
+			}
+			case ADI: {
+				auto right = pop();
+				storeWord(mem, sp, peek() + right);
+				break;
+			}
+			case SBI: {
+				auto right = pop();
+				storeWord(mem, sp, peek() - right);
+				break;
+			}
+			case MPI: {
+				auto right = pop();
+				storeWord(mem, sp, peek() * right);
+				break;
+			}
+			case DVI: case MODI: {
+				auto right = pop();
+				if (right == 0) {
+					throw fail("Divide by zero");
+				}
+				auto left = peek();
+				storeWord(mem, sp, op.code == DVI ? left / right : left % right);
+				break;
+			}
+			case NGI:
+				storeWord(mem, sp, -peek());
+				break;
+			case SQI: {
+				auto value = peek();
+				storeWord(mem, sp, value * value);
+				break;
+			}
+			case LAND: {
+				auto right = pop();
+				storeWord(mem, sp, peek() & right);
+				break;
+			}
+			case LOR: {
+				auto right = pop();
+				storeWord(mem, sp, peek() | right);
+				break;
+			}
+			case LNOT:
+				storeWord(mem, sp, ~peek());
+				break;
+			case CHK: {
+				auto high = pop();
+				auto low = pop();
+				auto value = peek();
+				if (value < low || value > high) {
+					throw fail("Value range error");
+				}
+				break;
+			}
+			case EQUI: case NEQI: case LESI: case LEQI: case GRTI: case GEQI: {
+				auto right = pop();
+				auto left = peek();
+				bool result;
+				switch (op.code) {
+				case EQUI:
+					result = left == right;
+					break;
+				case NEQI:
+					result = left != right;
+					break;
+				case LESI:
+					result = left < right;
+					break;
+				case LEQI:
+					result = left <= right;
+					break;
+				case GRTI:
+					result = left > right;
+					break;
+				default:
+					result = left >= right;
+					break;
+				}
+				storeWord(mem, sp, result);
+				break;
+			}
+			case EQU: case NEQ: case LES: case LEQ: case GRT: case GEQ:
+				suspend();
+				sp = compare(op, sp);
+				checkStack(0);
+				break;
+			case ABR: case NGR: case SQR: {
+				checkStack(4);
+				auto value = loadReal(mem, sp);
+				storeReal(mem, sp, op.code == ABR ? fabs(value) : op.code == NGR ? -value : value * value);
+				break;
+			}
+			case ADR: case SBR: case MPR: case DVR: {
+				checkStack(8);
+				auto right = loadReal(mem, sp);
+				sp += 4;
+				auto left = loadReal(mem, sp);
+				if (op.code == DVR && right == 0) {
+					throw fail("Divide by zero");
+				}
+				storeReal(mem, sp, op.code == ADR ? left + right : op.code == SBR ? left - right : op.code == MPR ? left * right : left / right);
+				break;
+			}
+			case FLT: {
+				auto value = pop();
+				sp -= 4;
+				storeReal(mem, sp, value);
+				break;
+			}
+			case FLO: {
+				checkStack(6);
+				auto right = loadReal(mem, sp);
+				auto value = loadWord(mem, sp + 4);
+				sp -= 2;
+				storeReal(mem, sp + 4, value);
+				storeReal(mem, sp, right);
+				break;
+			}
+			case ADJ: case SGS: case SRS: case INN: case UNI: case INT: case DIF:
+				suspend();
+				sp = setOperation(op, sp);
+				checkStack(0);
+				break;
+			case UJP:
+				ip = code + op.a;
+				break;
+			case FJP:
+				if (!(pop() & 1)) {
+					ip = code + op.a;
+				}
+				break;
+			case EFJ: {
+				auto right = pop();
+				if (pop() != right) {
+					ip = code + op.a;
+				}
+				break;
+			}
+			case NFJ: {
+				auto right = pop();
+				if (pop() == right) {
+					ip = code + op.a;
+				}
+				break;
+			}
+			case XJP: {
+				auto index = pop() - op.b;
+				auto table = cases + op.a;
+				ip = code + (index >= 0 && index <= table[0] - op.b ? table[2 + index] : table[1]);
+				break;
+			}
+			case CIP: case CLP: case CGP: case CBP: case CXP: {
+				suspend();
+				auto & callee = op.code == CXP ? routine(op.a, op.b) : routine(frame->routine->segment, op.a);
+				sp = call(callee, sp);
+				resume();
+				break;
+			}
+			case RNP: case RBP: {
+				auto results = 2 * op.a;
+				auto top = frame->top;
+				if (results > top - locals) {
+					throw fail("Function result out of range");
+				}
+				globals = frame->savedGlobals;
+				memmove(mem + top - results, mem + locals, results);
+				sp = top - results;
+				frames.pop_back();
+				if (frames.empty()) {
+					return;
+				}
+				resume();
+				break;
+			}
+			case CSP:
+				suspend();
+				sp = callStandardProc(op.a, sp);
+				if (halted) {
+					return;
+				}
+				resume();
+				checkStack(0);
+				break;
+			case XIT:
+				return;
+			case BPT: case NOP:
+				break;
+			case PAST_END:
+				throw fail("Ran past the end of the procedure");
+			default:
+				throw fail("Invalid opcode " + to_string(op.opcode));
+			}
+		}
+	}
+
+	std::uint64_t PMachine::getInstructionCount() const {
+		return accumulate(counts.begin(), counts.end(), uint64_t{ 0 });
+	}
+
+	void PMachine::writeProfile(std::wostream & os) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		auto total = getInstructionCount();
+		os << L"Instructions : " << dec << total << endl;
+		os << L"Seconds : " << fixed << setprecision(3) << seconds << endl;
+		if (seconds > 0) {
+			os << L"Instructions per second : " << setprecision(0) << total / seconds << endl;
+		}
+		vector<int> opcodes;
+		for (int opcode = 0; opcode != 256; ++opcode) {
+			if (counts[opcode]) {
+				opcodes.push_back(opcode);
+			}
+		}
+		stable_sort(opcodes.begin(), opcodes.end(), [this](int left, int right) { return counts[left] > counts[right]; });
+		for (auto opcode : opcodes) {
+			os << L"  " << setfill(L' ') << left << setw(9) << pcodeOpcodes[opcode].mnemonic << right << setw(14) << counts[opcode];
+			os << L"  " << fixed << setprecision(2) << setw(6) << 100.0 * counts[opcode] / total << L"%" << endl;
+		}
+	}
+
+}
@@ -0,0 +1,130 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _3AD13470_2B26_41E4_97E6_F7D69F8A92D3
+#define _3AD13470_2B26_41E4_97E6_F7D69F8A92D3
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+
+namespace pcodedump {
+
+	class PcodeFile;
+	class CodeSegment;
+
+	/* An emulated p-machine that runs the p-code procedures of one code file.
+
+	   Memory is a 64K arena of little endian words. Every p-code segment of the file is copied
+	   to the top of the arena when the machine is made. The heap grows up from the bottom and
+	   the stack grows down from below the code. An activation record is the data area of the
+	   procedure, below the parameters that the caller pushed, so local 1 is the lowest word of
+	   the data area. A function result is in its first locals, and is pushed on the stack of
+	   the caller when the function returns.
+
+	   Each procedure is decoded when it is first called, into instructions with operands that
+	   are ready to use: offsets in bytes, constants as arena addresses and branch targets as
+	   instruction indices. Standard procedures that do I/O are stubs. Writing to the console
+	   writes to the output stream, reading gives zeros, and every I/O result is zero. */
+	class PMachine {
+	public:
+		PMachine(PcodeFile const & file, std::wostream & console);
+
+		/* Run a procedure until it returns or the machine halts. Parameters are zero. */
+		void run(int segment, int procedure);
+
+		std::uint64_t getInstructionCount() const;
+
+		/* The number of times each opcode has run, most often first, and the rate they ran at. */
+		void writeProfile(std::wostream & os) const;
+
+	private:
+		struct Op {
+			std::uint8_t code;
+			std::uint8_t opcode;
+			std::uint16_t offset;
+			std::int32_t a;
+			std::int32_t b;
+		};
+
+		struct Routine {
+			std::vector<Op> code;
+			std::vector<std::int32_t> cases;
+			int segment;
+			int procedure;
+			int lexLevel;
+			std::uint16_t parameterSize;
+			std::uint16_t dataSize;
+			std::uint32_t enter;
+			std::uint32_t exit;
+		};
+
+		struct LoadedSegment {
+			CodeSegment const * segment = nullptr;
+			std::uint16_t address = 0;
+			std::uint16_t globals = 0;
+			std::vector<std::unique_ptr<Routine>> routines;
+		};
+
+		/* The instruction index is where the procedure resumes once a call returns. */
+		struct Frame {
+			Routine const * routine;
+			std::uint32_t ip;
+			std::uint16_t locals;
+			std::uint16_t top;
+			std::uint16_t savedGlobals;
+			std::int32_t staticLink;
+		};
+
+		void load(CodeSegment const & segment);
+		Routine const & routine(int segment, int procedure);
+		std::unique_ptr<Routine> decode(LoadedSegment const & loaded, int procedure) const;
+
+		void execute();
+		std::uint16_t call(Routine const & callee, std::uint16_t sp);
+		std::uint16_t segmentGlobals(int segment);
+		std::uint16_t compare(Op const & op, std::uint16_t sp);
+		std::uint16_t setOperation(Op const & op, std::uint16_t sp);
+		std::uint16_t callStandardProc(int number, std::uint16_t sp);
+		std::uint16_t exitProcedure(int segment, int procedure, std::uint16_t sp);
+		std::uint16_t allocate(std::uint16_t size, std::uint16_t sp);
+
+		std::runtime_error fault(std::string const & reason) const;
+
+		PcodeFile const & file;
+		std::wostream & console;
+		std::vector<std::uint8_t> memory;
+		std::array<LoadedSegment, 256> segments;
+		std::vector<Frame> frames;
+		std::uint16_t codeBottom;
+		std::uint16_t heapTop;
+		std::uint16_t globals = 0;
+		std::uint32_t faultIp = 0;
+		bool halted = false;
+		std::array<std::uint64_t, 256> counts{};
+		double seconds = 0;
+
+	public:
+		static bool showProfile;
+	};
+
+}
+
+#endif // !_3AD13470_2B26_41E4_97E6_F7D69F8A92D3
@@ -0,0 +1,291 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "search.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "basecode.hpp"
+#include "pcode.hpp"
+#include "native6502.hpp"
+#include "opcodesz80.hpp"
+#include "textio.hpp"
+
+#include <array>
+#include <map>
+#include <deque>
+#include <tuple>
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+#include <cwctype>
+
+using namespace std;
+
+namespace pcodedump {
+
+	namespace {
+
+		constexpr uint16_t NATIVE_SYMBOLS = 256;
+		constexpr int SYMBOL_BITS = 10;
+
+		/* The symbol of each native mnemonic. A 6502 mnemonic has the symbol of the first of its
+		   opcodes, and the 8080 and Z80 mnemonics that the 6502 doesn't have come after them. */
+		map<wstring, uint16_t> nativeSymbols() {
+			auto & table = Native6502Procedure::getOpcodes();
+			map<wstring, uint16_t> result;
+			for (int opcode = 0; opcode != 256; ++opcode) {
+				result.insert({ table[opcode].mnemonic, static_cast<uint16_t>(NATIVE_SYMBOLS + opcode) });
+			}
+			auto next = static_cast<uint16_t>(NATIVE_SYMBOLS + 256);
+			for (auto z80Table : { &opcodes8080, &opcodesZ80, &opcodesZ80cb, &opcodesZ80ed }) {
+				for (wstring text : *z80Table) {
+					if (result.insert({ text.substr(0, text.find(L' ')), next }).second) {
+						++next;
+					}
+				}
+			}
+			return result;
+		}
+
+		optional<uint16_t> symbolFor(wstring const & mnemonic, bool native) {
+			if (native) {
+				auto symbols = nativeSymbols();
+				auto symbol = symbols.find(mnemonic);
+				if (symbol != symbols.end()) {
+					return symbol->second;
+				}
+			} else {
+				for (int opcode = 0; opcode != 256; ++opcode) {
+					if (mnemonic == pcodeOpcodes[opcode].mnemonic) {
+						return static_cast<uint16_t>(opcode);
+					}
+				}
+			}
+			return nullopt;
+		}
+
+		/* Operands are decimal, or hexadecimal with a $ or 0x prefix. A 6502 immediate operand can
+		   be written with a leading #. */
+		int32_t parseOperand(string token) {
+			if (token.size() > 1 && token[0] == '#') {
+				token.erase(0, 1);
+			}
+			size_t used = 0;
+			int32_t value = 0;
+			try {
+				if (token.size() > 1 && token[0] == '$') {
+					value = stoi(token.substr(1), &used, 16);
+					++used;
+				} else {
+					value = stoi(token, &used, 0);
+				}
+			} catch (logic_error &) {
+				used = 0;
+			}
+			if (used == 0 || used != token.size()) {
+				throw runtime_error("Invalid operand in pattern: " + token);
+			}
+			return value;
+		}
+
+	}
+
+	std::vector<std::string> InstructionSearch::pcodePatterns;
+	std::vector<std::string> InstructionSearch::nativePatterns;
+
+	/* The anchor of a pattern is its longest run of instructions that have a mnemonic. */
+	void InstructionSearch::addPattern(std::string const & text, bool native) {
+		Pattern pattern{ text, {}, 0, 0 };
+		istringstream elements{ text };
+		string elementText;
+		while (getline(elements, elementText, ';')) {
+			replace(elementText.begin(), elementText.end(), ',', ' ');
+			istringstream tokens{ elementText };
+			string token;
+			if (!(tokens >> token)) {
+				throw runtime_error("Empty instruction in pattern: " + text);
+			}
+			Element element;
+			if (token != "*") {
+				wstring mnemonic;
+				transform(token.begin(), token.end(), back_inserter(mnemonic), [](char c) { return static_cast<wchar_t>(towupper(c)); });
+				element.symbol = symbolFor(mnemonic, native);
+				if (!element.symbol) {
+					throw runtime_error("Unknown mnemonic in pattern: " + token);
+				}
+			}
+			while (tokens >> token) {
+				element.operands.push_back(token == "*" ? nullopt : optional<int32_t>{ parseOperand(token) });
+			}
+			if (element.operands.size() > 2) {
+				throw runtime_error("Too many operands in pattern: " + elementText);
+			}
+			pattern.elements.push_back(element);
+		}
+
+		size_t runBegin = 0;
+		for (size_t index = 0; index <= pattern.elements.size(); ++index) {
+			if (index == pattern.elements.size() || !pattern.elements[index].symbol) {
+				if (index - runBegin > pattern.anchorEnd - pattern.anchorBegin) {
+					pattern.anchorBegin = runBegin;
+					pattern.anchorEnd = index;
+				}
+				runBegin = index + 1;
+			}
+		}
+		if (pattern.anchorBegin == pattern.anchorEnd) {
+			throw runtime_error("Pattern has no mnemonics: " + text);
+		}
+		patterns.push_back(move(pattern));
+	}
+
+	optional<uint32_t> InstructionSearch::transition(uint32_t state, uint16_t symbol) const {
+		auto next = transitions.find(state << SYMBOL_BITS | symbol);
+		return next == transitions.end() ? nullopt : optional<uint32_t>{ next->second };
+	}
+
+	/* Build a trie of the pattern anchors, then add failure links breadth first. The output link
+	   of a state is the nearest state on its failure chain that ends an anchor. */
+	void InstructionSearch::compile() {
+		states.assign(1, State{});
+		transitions.clear();
+		for (size_t index = 0; index != patterns.size(); ++index) {
+			auto & pattern = patterns[index];
+			uint32_t state = 0;
+			for (auto element = pattern.anchorBegin; element != pattern.anchorEnd; ++element) {
+				auto symbol = *pattern.elements[element].symbol;
+				auto next = transition(state, symbol);
+				if (!next) {
+					next = static_cast<uint32_t>(states.size());
+					states.emplace_back();
+					states[state].children.push_back({ symbol, *next });
+					transitions[state << SYMBOL_BITS | symbol] = *next;
+				}
+				state = *next;
+			}
+			states[state].patterns.push_back(index);
+		}
+
+		deque<uint32_t> queue;
+		for (auto & child : states[0].children) {
+			queue.push_back(child.second);
+		}
+		while (!queue.empty()) {
+			auto state = queue.front();
+			queue.pop_front();
+			for (auto [symbol, child] : states[state].children) {
+				auto failure = states[state].failure;
+				while (failure != 0 && !transition(failure, symbol)) {
+					failure = states[failure].failure;
+				}
+				states[child].failure = transition(failure, symbol).value_or(0);
+				auto & failureState = states[states[child].failure];
+				states[child].output = failureState.patterns.empty() ? failureState.output : states[child].failure;
+				queue.push_back(child);
+			}
+		}
+	}
+
+	bool InstructionSearch::matchesAt(Pattern const & pattern, SearchInstruction const * first) const {
+		for (size_t index = 0; index != pattern.elements.size(); ++index) {
+			auto & element = pattern.elements[index];
+			auto & instruction = first[index];
+			if (element.symbol && *element.symbol != instruction.symbol) {
+				return false;
+			}
+			int32_t operands[] = { instruction.operand1, instruction.operand2 };
+			for (size_t operand = 0; operand != element.operands.size(); ++operand) {
+				if (element.operands[operand] && *element.operands[operand] != operands[operand]) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	/* Each instruction is one step of the automaton. Where an anchor ends, the whole pattern is
+	   checked from the instruction that it would start at. */
+	void InstructionSearch::scan(vector<SearchInstruction> const & instructions, int segment, int procedure, vector<PatternMatch> & result) const {
+		uint32_t state = 0;
+		for (size_t position = 0; position != instructions.size(); ++position) {
+			auto symbol = instructions[position].symbol;
+			auto next = transition(state, symbol);
+			while (!next && state != 0) {
+				state = states[state].failure;
+				next = transition(state, symbol);
+			}
+			state = next.value_or(0);
+			for (auto found = state; found != 0; found = states[found].output) {
+				for (auto index : states[found].patterns) {
+					auto & pattern = patterns[index];
+					if (position + 1 >= pattern.anchorEnd) {
+						auto first = position + 1 - pattern.anchorEnd;
+						if (first + pattern.elements.size() <= instructions.size() && matchesAt(pattern, &instructions[first])) {
+							result.push_back({ index, segment, procedure, instructions[first].offset });
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/* Matches are in segment, procedure and offset order. The operand of a native instruction
+	   is its value as it is in the code. */
+	vector<PatternMatch> InstructionSearch::find(PcodeFile const & file) const {
+		vector<PatternMatch> result;
+		auto symbols = nativeSymbols();
+		vector<SearchInstruction> instructions;
+		for (auto & segment : file.getSegments()) {
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			auto codePart = codeSegment ? codeSegment->getCodePart() : nullptr;
+			if (codePart && codePart->getProcedures()) {
+				for (auto & procedure : *codePart->getProcedures()) {
+					instructions.clear();
+					if (auto pcodeProcedure = dynamic_cast<PcodeProcedure const *>(procedure.get())) {
+						for (auto & instruction : pcodeProcedure->getFlowGraph().getInstructions()) {
+							instructions.push_back({ instruction.opcode, instruction.offset, instruction.operand1, instruction.operand2 });
+						}
+					} else if (auto nativeProcedure = dynamic_cast<NativeProcedure const *>(procedure.get())) {
+						for (auto & instruction : nativeProcedure->getDecodedInstructions()) {
+							auto operands = procedure->getProcBegin() + instruction.offset + instruction.operandOffset;
+							int32_t operand = 0;
+							for (int index = min<int>(instruction.operandSize, 3) - 1; index >= 0; --index) {
+								operand = operand << 8 | operands[index];
+							}
+							instructions.push_back({ symbols.at(nativeProcedure->getMnemonic(instruction)), instruction.offset, operand, 0 });
+						}
+					}
+					scan(instructions, codeSegment->getSegmentNumber(), procedure->getProcedureNumber(), result);
+				}
+			}
+		}
+		sort(result.begin(), result.end(), [](PatternMatch const & left, PatternMatch const & right) {
+			return tie(left.segment, left.procedure, left.offset, left.pattern) < tie(right.segment, right.procedure, right.offset, right.pattern);
+		});
+		return result;
+	}
+
+	/* A match is written like a string literal: the code file, segment.procedure:offset and the
+	   pattern. */
+	void InstructionSearch::write(std::wostream & os, std::wstring const & source, PatternMatch const & match) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		auto & text = patterns[match.pattern].text;
+		os << source << L" " << dec << match.segment << L"." << match.procedure << L":";
+		os << hex << setfill(L'0') << right << setw(4) << match.offset << L" " << wstring(text.begin(), text.end()) << endl;
+	}
+
+}
@@ -0,0 +1,109 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _D3261139_461C_4FC9_BA25_D39467EA760F
+#define _D3261139_461C_4FC9_BA25_D39467EA760F
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+namespace pcodedump {
+
+	class PcodeFile;
+
+	/* An instruction as it is matched against patterns. The symbol of a p-code instruction is
+	   its opcode. The symbol of a native instruction is its mnemonic, after the p-code opcodes, so
+	   that a pattern matches every address mode of a mnemonic, whatever the processor. */
+	struct SearchInstruction {
+		std::uint16_t symbol;
+		std::uint16_t offset;
+		std::int32_t operand1;
+		std::int32_t operand2;
+	};
+
+	struct PatternMatch {
+		std::size_t pattern;
+		int segment;
+		int procedure;
+		int offset;
+	};
+
+	/* A set of instruction patterns, compiled into one Aho-Corasick automaton and matched
+	   against the decoded instructions of every procedure in a code file.
+
+	   A pattern is a list of instructions separated by semicolons. Each instruction is a
+	   mnemonic followed by its operands, and any of them can be * to match anything. Operands
+	   that are left out match anything. For example, "CSP 21; CXP 3 *".
+
+	   The automaton matches the longest run of each pattern without a wildcard mnemonic. The
+	   rest of the pattern and the operands are checked where that run is found. */
+	class InstructionSearch {
+	public:
+		void addPattern(std::string const & text, bool native);
+		void compile();
+
+		std::string const & getPattern(std::size_t pattern) const {
+			return patterns[pattern].text;
+		}
+
+		bool empty() const {
+			return patterns.empty();
+		}
+
+		std::vector<PatternMatch> find(PcodeFile const & file) const;
+		void write(std::wostream & os, std::wstring const & source, PatternMatch const & match) const;
+
+	private:
+		struct Element {
+			std::optional<std::uint16_t> symbol;
+			std::vector<std::optional<std::int32_t>> operands;
+		};
+
+		struct Pattern {
+			std::string text;
+			std::vector<Element> elements;
+			std::size_t anchorBegin;
+			std::size_t anchorEnd;
+		};
+
+		struct State {
+			std::uint32_t failure = 0;
+			std::uint32_t output = 0;
+			std::vector<std::size_t> patterns;
+			std::vector<std::pair<std::uint16_t, std::uint32_t>> children;
+		};
+
+		std::optional<std::uint32_t> transition(std::uint32_t state, std::uint16_t symbol) const;
+		void scan(std::vector<SearchInstruction> const & instructions, int segment, int procedure, std::vector<PatternMatch> & result) const;
+		bool matchesAt(Pattern const & pattern, SearchInstruction const * first) const;
+
+		std::vector<Pattern> patterns;
+		std::vector<State> states;
+		std::unordered_map<std::uint32_t, std::uint32_t> transitions;
+
+	public:
+		static std::vector<std::string> pcodePatterns;
+		static std::vector<std::string> nativePatterns;
+	};
+
+}
+
+#endif // !_D3261139_461C_4FC9_BA25_D39467EA760F
@@ -31,18 +31,159 @@ using namespace boost::endian;
 
 namespace pcodedump {
 
+	template <typename Reader>
+	auto SegmentDictionary::read(Reader reader) const {
+		return read(isBigEndian(), reader);
+	}
+
+	template <typename Reader>
+	auto SegmentDictionary::read(bool bigEndian, Reader reader) const {
+		if (bigEndian) {
+			return reader(pcodedump::place<Layout<BigEndian>>(block));
+		} else {
+			return reader(pcodedump::place<Layout<LittleEndian>>(block));
+		}
+	}
+
 	uint64_t SegmentDictionary::intrinsicSegments() const {
-		return intrinsicSegs;
+		return isVersionIV() ? 0 : read([](auto & layout) { return uint64_t{ layout.apple.intrinsicSegs }; });
 	}
 
 	wstring SegmentDictionary::fileComment() const {
-		int size = comment[0];
-		return wstring{ comment + 1, comment + 1 + size };
+		auto versionIV = isVersionIV();
+		return read([versionIV](auto & layout) {
+			auto comment = versionIV ? layout.version4.copyNote : layout.apple.comment;
+			int size = min<int>(static_cast<uint8_t>(comment[0]), versionIV ? sizeof(layout.version4.copyNote) - 1 : sizeof(layout.apple.comment) - 1);
+			return wstring{ comment + 1, comment + 1 + size };
+		});
+	}
+
+	template <typename Endian>
+	bool SegmentDictionary::versionIV(Layout<Endian> const & layout) {
+		for (int index = 0; index != NUM_SEGMENTS; ++index) {
+			if ((layout.diskInfo[index].codeaddr || layout.diskInfo[index].codeleng) && (int{ layout.segInfo[index] } >> 13 & 0x7) >= 4) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool SegmentDictionary::isVersionIV() const {
+		return read([](auto & layout) { return versionIV(layout); });
+	}
+
+	int SegmentDictionary::nextDictionary() const {
+		return isVersionIV() ? read([](auto & layout) { return int{ layout.version4.nextDict }; }) : 0;
 	}
+
+	template <typename Endian>
+	int SegmentDictionary::firstBlock(Layout<Endian> const & layout) {
+		int result = 0;
+		for (int index = 0; index != NUM_SEGMENTS; ++index) {
+			int start = layout.textAddr[index] ? layout.textAddr[index] : layout.diskInfo[index].codeaddr;
+			if (layout.diskInfo[index].codeaddr && (!result || start < result)) {
+				result = start;
+			}
+		}
+		return result;
+	}
+
+	/* The version is in the top bits of a word, so it is looked for in both byte orders before
+	   the byte order is known. */
+	bool SegmentDictionary::isBigEndian() const {
+		auto & little = pcodedump::place<Layout<LittleEndian>>(block);
+		auto & big = pcodedump::place<Layout<BigEndian>>(block);
+		if (versionIV(little) || versionIV(big)) {
+			return big.version4.sex == 1;
+		}
+		return firstBlock(little) != 1 && firstBlock(big) == 1;
+	}
+
+	bool SegmentDictionary::hasByteOrder() const {
+		return !isVersionIV() || read([](auto & layout) { return int{ layout.version4.sex } == 1; });
+	}
+
 	SegmentDictionary const & SegmentDictionary::place(std::uint8_t const * buffer) {
 		return pcodedump::place<SegmentDictionary>(buffer);
 	}
 
+	/* Check the invariants of a segment dictionary at the start of the data, cheapest checks first,
+	   so that a large image can be scanned a block at a time. Code segments must lie within the
+	   data without overlapping, have printable names, and end with a procedure dictionary that
+	   has at least one procedure. The dictionaries chained from a Version IV dictionary must also
+	   lie within the data, and not overlap the segments. Returns the number of blocks up to the
+	   end of the last code segment or dictionary, or 0 if the data doesn't start with a plausible
+	   dictionary. */
+	int SegmentDictionary::plausibleExtent(Range<std::uint8_t const> data) {
+		static_assert(sizeof(SegmentDictionary) == BLOCK_SIZE, "Segment dictionary is one block");
+		auto size = data.end() - data.begin();
+		if (size < static_cast<ptrdiff_t>(BLOCK_SIZE)) {
+			return 0;
+		}
+		vector<pair<int, int>> ranges;
+		vector<int> dictionaries;
+		int block = 0;
+		do {
+			if (block < 0 || (static_cast<ptrdiff_t>(block) + 1) * BLOCK_SIZE > size
+					|| find(dictionaries.begin(), dictionaries.end(), block) != dictionaries.end()) {
+				return 0;
+			}
+			dictionaries.push_back(block);
+			auto & dictionary = place(data.begin() + block * BLOCK_SIZE);
+			if (!dictionary.hasByteOrder() || dictionary.isBigEndian() != place(data.begin()).isBigEndian()
+					|| !dictionary.plausibleSegments(data, ranges)) {
+				return 0;
+			}
+			block = dictionary.nextDictionary();
+		} while (block != 0);
+		if (ranges.empty()) {
+			return 0;
+		}
+		for (auto block : dictionaries) {
+			ranges.push_back({ block, block + 1 });
+		}
+		sort(ranges.begin(), ranges.end());
+		for (size_t index = 1; index < ranges.size(); ++index) {
+			if (ranges[index].first < ranges[index - 1].second) {
+				return 0;
+			}
+		}
+		return ranges.back().second;
+	}
+
+	/* Check the code segments of one dictionary block, adding the blocks each one spans. */
+	bool SegmentDictionary::plausibleSegments(Range<std::uint8_t const> data, vector<pair<int, int>> & ranges) const {
+		auto size = data.end() - data.begin();
+		for (auto entry : *this) {
+			int codeaddr = entry.codeAddress();
+			int codeleng = entry.codeLength();
+			int kind = static_cast<int>(entry.segmentKind());
+			int mType = static_cast<int>(entry.machineType());
+			if (codeaddr < 0 || codeleng < 0 || kind < 0 || kind > static_cast<int>(SegmentKind::dataSeg)
+					|| mType > static_cast<int>(MachineType::native_tms9900)) {
+				return false;
+			}
+			if (codeaddr == 0) {
+				continue;
+			}
+			int textaddr = entry.textAddress();
+			auto codeEnd = static_cast<ptrdiff_t>(codeaddr) * BLOCK_SIZE + codeleng;
+			if (codeleng < 4 || codeEnd > size || textaddr < 0 || textaddr >= codeaddr) {
+				return false;
+			}
+			auto name = entry.name();
+			if (!all_of(name.begin(), name.end(), [](wchar_t c) { return 32 <= c && c <= 126; })) {
+				return false;
+			}
+			auto numProcedures = data.begin()[codeEnd - 1];
+			if (numProcedures == 0 || numProcedures * 2 + 2 > codeleng) {
+				return false;
+			}
+			ranges.push_back({ textaddr ? textaddr : codeaddr, codeaddr + (codeleng + BLOCK_SIZE - 1) / BLOCK_SIZE });
+		}
+		return true;
+	}
+
 	SegmentDictionaryEntry SegmentDictionary::operator[](int index) const {
 		if (index < 0 || index >= SegmentDictionary::NUM_SEGMENTS) {
 			throw out_of_range("Segment index out of range: " + index);
@@ -58,8 +199,8 @@ namespace pcodedump {
 		return SegmentDictionaryIterator(this, SegmentDictionary::NUM_SEGMENTS);
 	}
 
-	SegmentDictionaryEntry::SegmentDictionaryEntry(SegmentDictionary const * segmentDictionary, int index) :
-		segmentDictionary{ segmentDictionary }, index{ index }
+	SegmentDictionaryEntry::SegmentDictionaryEntry(SegmentDictionary const * segmentDictionary, int index, int first) :
+		segmentDictionary{ segmentDictionary }, index{ index }, first{ first }, bigEndian{ segmentDictionary && segmentDictionary->isBigEndian() }
 	{
 		if (0 > index || index >= SegmentDictionary::NUM_SEGMENTS) {
 			throw out_of_range("Segment dictionary index out of bounds: " + index);
@@ -70,35 +211,43 @@ namespace pcodedump {
 	}
 
 	int SegmentDictionaryEntry::codeAddress() const {
-		return segmentDictionary->diskInfo[index].codeaddr;
+		return segmentDictionary->read(bigEndian, [this](auto & layout) { return int{ layout.diskInfo[index].codeaddr }; });
 	}
 
 	int SegmentDictionaryEntry::codeLength() const {
-		return segmentDictionary->diskInfo[index].codeleng;
+		return segmentDictionary->read(bigEndian, [this](auto & layout) { return int{ layout.diskInfo[index].codeleng }; });
 	}
 
 	std::wstring SegmentDictionaryEntry::name() const {
-		return wstring{ segmentDictionary->segName[index], segmentDictionary->segName[index] + 8 };
+		return segmentDictionary->read(bigEndian, [this](auto & layout) { return wstring{ layout.segName[index], layout.segName[index] + 8 }; });
 	}
 
 	int SegmentDictionaryEntry::textAddress() const {
-		return segmentDictionary->textAddr[index];
+		return segmentDictionary->read(bigEndian, [this](auto & layout) { return int{ layout.textAddr[index] }; });
 	}
 
 	SegmentKind SegmentDictionaryEntry::segmentKind() const {
-		return static_cast<SegmentKind>(int{ segmentDictionary->segKind[index] });
+		return static_cast<SegmentKind>(segmentDictionary->read(bigEndian, [this](auto & layout) { return int{ layout.segKind[index] }; }));
 	}
 
 	int SegmentDictionaryEntry::segmentNumber() const {
-		return int{ segmentDictionary->segInfo[index] } &0xff;
+		return segInfo() & 0xff;
 	}
 
 	MachineType SegmentDictionaryEntry::machineType() const {
-		return static_cast<MachineType>(int{ segmentDictionary->segInfo[index] } >> 8 & 0xf);
+		return static_cast<MachineType>(segInfo() >> 8 & 0xf);
 	}
 
 	int SegmentDictionaryEntry::version() const {
-		return int{ segmentDictionary->segInfo[index] } >> 13 & 0x7;
+		return segInfo() >> 13 & 0x7;
+	}
+
+	bool SegmentDictionaryEntry::isVersionIV() const {
+		return version() >= 4;
+	}
+
+	int SegmentDictionaryEntry::segInfo() const {
+		return segmentDictionary->read(bigEndian, [this](auto & layout) { return int{ layout.segInfo[index] }; });
 	}
 
 	int SegmentDictionaryEntry::startAddress() const {
@@ -169,6 +318,107 @@ namespace pcodedump {
 		return temporary;
 	}
 
+	SegmentDictionaryChain::SegmentDictionaryChain(Range<std::uint8_t const> file) :
+		file{ file }, entries{}, dictionaryBlocks{}, complete{ false }
+	{
+		extend();
+	}
+
+	SegmentDictionary const & SegmentDictionaryChain::first() const {
+		return SegmentDictionary::place(file.begin());
+	}
+
+	/* Add the entries of the next dictionary in the chain, if there is one. A chain that leads
+	   out of the file, or back to a dictionary already read, isn't followed. Each dictionary is
+	   read in its own byte order, but they must all have the same one. */
+	bool SegmentDictionaryChain::extend() const {
+		if (complete) {
+			return false;
+		}
+		int block = 0;
+		if (!dictionaryBlocks.empty()) {
+			block = SegmentDictionary::place(file.begin() + dictionaryBlocks.back() * BLOCK_SIZE).nextDictionary();
+			if (block == 0) {
+				complete = true;
+				return false;
+			}
+		}
+		if (block < 0 || (static_cast<ptrdiff_t>(block) + 1) * BLOCK_SIZE > file.end() - file.begin()) {
+			throw runtime_error("Segment dictionary chain runs past the end of the file");
+		}
+		if (find(dictionaryBlocks.begin(), dictionaryBlocks.end(), block) != dictionaryBlocks.end()) {
+			throw runtime_error("Segment dictionary chain loops");
+		}
+		auto & dictionary = SegmentDictionary::place(file.begin() + block * BLOCK_SIZE);
+		if (!dictionary.hasByteOrder()) {
+			throw runtime_error("Segment dictionary has no byte order");
+		}
+		if (dictionary.isBigEndian() != this->first().isBigEndian()) {
+			throw runtime_error("Segment dictionary chain mixes byte orders");
+		}
+		int first = static_cast<int>(entries.size());
+		for (int index = 0; index != SegmentDictionary::NUM_SEGMENTS; ++index) {
+			entries.push_back(SegmentDictionaryEntry{ &dictionary, index, first });
+		}
+		dictionaryBlocks.push_back(block);
+		return true;
+	}
+
+	SegmentDictionaryEntry SegmentDictionaryChain::operator[](int index) const {
+		if (!contains(index)) {
+			throw out_of_range("Segment index out of range: " + to_string(index));
+		}
+		return entries[index];
+	}
+
+	bool SegmentDictionaryChain::contains(int index) const {
+		while (index >= static_cast<int>(entries.size())) {
+			if (!extend()) {
+				return false;
+			}
+		}
+		return index >= 0;
+	}
+
+	int SegmentDictionaryChain::size() const {
+		while (extend()) {}
+		return static_cast<int>(entries.size());
+	}
+
+	SegmentDictionaryChain::const_iterator SegmentDictionaryChain::begin() const {
+		while (extend()) {}
+		return entries.cbegin();
+	}
+
+	SegmentDictionaryChain::const_iterator SegmentDictionaryChain::end() const {
+		while (extend()) {}
+		return entries.cend();
+	}
+
+	int SegmentDictionaryChain::nextStart(int block, int limit) const {
+		for (;;) {
+			int next = limit;
+			for (int dictionaryBlock : dictionaryBlocks) {
+				if (dictionaryBlock > block) {
+					next = min(next, dictionaryBlock);
+				}
+			}
+			for (auto & entry : entries) {
+				if (entry.codeAddress() != 0 && entry.startAddress() > block) {
+					next = min(next, entry.startAddress());
+				}
+			}
+			int link = complete ? 0 : SegmentDictionary::place(file.begin() + dictionaryBlocks.back() * BLOCK_SIZE).nextDictionary();
+			if (link == 0) {
+				return next;
+			}
+			if (link > block) {
+				return min(next, link);
+			}
+			extend();
+		}
+	}
+
 	map<SegmentKind, wstring> segKind = {
 		{SegmentKind::linked,          L"LINKED"},
 		{SegmentKind::hostseg,         L"HOSTSEG"},
@@ -236,9 +486,9 @@ namespace pcodedump {
 	bool CodeSegment::showLinkage = false;
 	vector<int> CodeSegment::segments{};
 	
-	CodeSegment::CodeSegment(buff_t const & buffer, SegmentDictionaryEntry const dictionaryEntry, int endBlock) :
+	CodeSegment::CodeSegment(Range<std::uint8_t const> file, SegmentDictionaryEntry const dictionaryEntry, int endBlock) :
 		Segment{ dictionaryEntry},
-		buffer{ buffer },
+		file{ file },
 		endBlock{ endBlock },
 		codePart{ createCodePart() },
 		interfaceText{ createInterfaceText() },
@@ -261,6 +511,9 @@ namespace pcodedump {
 			if (showLinkage && linkageInfo) {
 				linkageInfo->write(os);
 				os << endl;
+			} else if (showLinkage && dictionaryEntry.linkageAddress() != endBlock) {
+				os << L"Linkage records: not decoded in a " << (isVersionIV() ? L"Version IV segment" : L"big-endian code file") << endl;
+				os << endl;
 			}
 		}
 		return os;
@@ -271,9 +524,42 @@ namespace pcodedump {
 		return segments.empty() || find(segments.begin(), segments.end(), dictionaryEntry.segmentNumber()) != segments.end();
 	}
 
+	map<int, CallList> CodeSegment::getCalls() const {
+		return codePart ? codePart->getCalls(linkageInfo.get()) : map<int, CallList>{};
+	}
+
+	map<int, uint64_t> CodeSegment::getCodeHashes() const {
+		return codePart ? codePart->getCodeHashes(linkageInfo.get()) : map<int, uint64_t>{};
+	}
+
+	bool CodeSegment::disassembleAround(std::wostream& os, std::size_t offset, int window) const {
+		return codePart && codePart->disassembleAround(os, linkageInfo.get(), offset, window);
+	}
+
+	/* An offset past the end of the procedure is an error, rather than a place in whatever
+	   follows it. A segment whose procedures aren't decoded has nothing to find the offset in. */
+	std::size_t CodeSegment::procedureOffset(int procedure, std::size_t offset) const {
+		if (!codePart || !codePart->getProcedures()) {
+			return offset;
+		}
+		auto & procedures = *codePart->getProcedures();
+		auto found = find_if(procedures.begin(), procedures.end(), [&](auto & entry) { return entry->getProcedureNumber() == procedure; });
+		if (found == procedures.end()) {
+			throw runtime_error("No procedure " + to_string(procedure) + " in segment " + to_string(getSegmentNumber()));
+		}
+		if (offset >= (*found)->getSize()) {
+			throw runtime_error("Offset is past the end of procedure " + to_string(procedure) + " of segment " + to_string(getSegmentNumber()));
+		}
+		return offset + ((*found)->getProcBegin() - codePart->begin());
+	}
+
+	/* Version IV segments have a layout of their own, which isn't decoded. */
 	unique_ptr<CodePart> CodeSegment::createCodePart() {
 		assert(dictionaryEntry.codeAddress());
-		return make_unique<CodePart>(*this, buffer.data() + dictionaryEntry.codeAddress() * BLOCK_SIZE, dictionaryEntry.codeLength());
+		if (dictionaryEntry.isVersionIV()) {
+			return unique_ptr<CodePart>();
+		}
+		return make_unique<CodePart>(*this, file.begin() + dictionaryEntry.codeAddress() * BLOCK_SIZE, dictionaryEntry.codeLength());
 	}
 
 	/* Create a new interface text segment if this directry entry points to one. */
@@ -281,8 +567,8 @@ namespace pcodedump {
 		if (dictionaryEntry.textAddress()) {
 			return make_unique<InterfaceText>(
 				*this,
-				buffer.data() + dictionaryEntry.textAddress() * BLOCK_SIZE,
-				buffer.data() + dictionaryEntry.codeAddress() * BLOCK_SIZE
+				file.begin() + dictionaryEntry.textAddress() * BLOCK_SIZE,
+				file.begin() + dictionaryEntry.codeAddress() * BLOCK_SIZE
 			);
 		} else {
 			return unique_ptr<InterfaceText>();
@@ -290,11 +576,12 @@ namespace pcodedump {
 	}
 
 	/* Create a new linkage segment if this directory entry has unlinked code.
-	   The location of linkage data has to be inferred as the block following code data. */
+	   The location of linkage data has to be inferred as the block following code data. Link
+	   records are only read little-endian. */
 	unique_ptr<LinkageInfo> CodeSegment::createLinkageInfo()
 	{
-		if (dictionaryEntry.linkageAddress() != this->endBlock) {
-			return make_unique<LinkageInfo>(*this, buffer.data() + dictionaryEntry.linkageAddress() * BLOCK_SIZE);
+		if (dictionaryEntry.linkageAddress() != this->endBlock && !dictionaryEntry.isVersionIV() && !dictionaryEntry.isBigEndian()) {
+			return make_unique<LinkageInfo>(*this, file.begin() + dictionaryEntry.linkageAddress() * BLOCK_SIZE);
 		} else {
 			return unique_ptr<LinkageInfo>();
 		}
@@ -318,7 +605,7 @@ namespace pcodedump {
 			os << L"-----" << endl;
 		}
 		os << L"   Link blocks : ";
-		if (dictionaryEntry.linkageAddress() != this->endBlock) {
+		if (this->linkageInfo) {
 			os << dictionaryEntry.linkageAddress() << L" - " << this->endBlock - 1 << endl;
 		} else {
 			os << L"-----" << endl;
@@ -18,12 +18,15 @@
 #define _4F5901F5_E50C_44CC_BCC3_861305540578
 
 #include "types.hpp"
+#include "basecode.hpp"
 
 #include <iostream>
 #include <memory>
 #include <string>
 #include <iterator>
 #include <vector>
+#include <map>
+#include <utility>
 #include <boost/endian/arithmetic.hpp>
 
 namespace pcodedump {
@@ -56,6 +59,7 @@ namespace pcodedump {
 
 	std::wostream& operator<<(std::wostream& os, const MachineType& value);
 
+	class SegmentDictionaryEntry;
 	class SegmentDictionaryIterator;
 
 	class SegmentDictionary {
@@ -73,6 +77,7 @@ namespace pcodedump {
 		static constexpr int NUM_SEGMENTS = 16;
 
 		static SegmentDictionary const & place(std::uint8_t const *);
+		static int plausibleExtent(Range<std::uint8_t const> data);
 
 		SegmentDictionaryEntry operator[](int index) const;
 		const_iterator begin() const;
@@ -81,29 +86,78 @@ namespace pcodedump {
 		uint64_t intrinsicSegments() const;
 		std::wstring fileComment() const;
 
+		/* Version IV dictionaries replace the intrinsic units and comment with segment families, a
+		   copyright note and the block of the next dictionary in the chain. */
+		bool isVersionIV() const;
+		/* The block of the next dictionary in the chain, or 0 for the last. */
+		int nextDictionary() const;
+		/* Version IV dictionaries end with a word of 1 in the byte order of the host that wrote
+		   them. Other dictionaries don't record their byte order, and the last word is part of the
+		   comment. The first segment of such a file starts in the block after the dictionary, so
+		   the dictionary is big-endian if that is only so when it is read big-endian. */
+		bool isBigEndian() const;
+		/* False for a Version IV dictionary whose last word is 1 in neither byte order. */
+		bool hasByteOrder() const;
+
+	private:
+		bool plausibleSegments(Range<std::uint8_t const> data, std::vector<std::pair<int, int>> & ranges) const;
+
+		/* The fields of the dictionary, with words in the byte order of the policy. */
+		template <typename Endian>
+		struct Layout {
+			struct {
+				typename Endian::int16_t codeaddr;
+				typename Endian::int16_t codeleng;
+			} diskInfo[NUM_SEGMENTS];
+			char segName[NUM_SEGMENTS][8];
+			typename Endian::int16_t segKind[NUM_SEGMENTS];
+			typename Endian::int16_t textAddr[NUM_SEGMENTS];
+			typename Endian::int16_t segInfo[NUM_SEGMENTS];
+			union {
+				struct {
+					typename Endian::uint64_t intrinsicSegs;
+					typename Endian::uint16_t filler[68];
+					char comment[80];
+				} apple;
+				struct {
+					char segFamily[NUM_SEGMENTS][8];
+					typename Endian::int16_t nextDict;
+					typename Endian::uint16_t filler[7];
+					char copyNote[78];
+					typename Endian::int16_t sex;
+				} version4;
+			};
+		};
+
+		/* Whether a segment in use is Version IV, with the fields read in one byte order. */
+		template <typename Endian>
+		static bool versionIV(Layout<Endian> const & layout);
+
+		/* The first block of the segments in the file, or 0 if there are none. */
+		template <typename Endian>
+		static int firstBlock(Layout<Endian> const & layout);
+
+		/* Apply a reader to the fields of the dictionary in its byte order. */
+		template <typename Reader>
+		auto read(Reader reader) const;
+		template <typename Reader>
+		auto read(bool bigEndian, Reader reader) const;
+
 	private:
-		struct {
-			boost::endian::little_int16_t codeaddr;
-			boost::endian::little_int16_t codeleng;
-		} diskInfo[NUM_SEGMENTS];
-		char segName[NUM_SEGMENTS][8];
-		boost::endian::little_int16_t segKind[NUM_SEGMENTS];
-		boost::endian::little_int16_t textAddr[NUM_SEGMENTS];
-		boost::endian::little_int16_t segInfo[NUM_SEGMENTS];
-		boost::endian::little_uint64_t intrinsicSegs;
-		boost::endian::little_uint16_t filler[68];
-		char comment[80];
+		std::uint8_t block[BLOCK_SIZE];
 	};
 
 	class SegmentDictionaryEntry {
 		friend class SegmentDictionary;
 		friend class SegmentDictionaryIterator;
+		friend class SegmentDictionaryChain;
 
 	private:
-		SegmentDictionaryEntry(SegmentDictionary const * segmentDictionary, int index);
+		SegmentDictionaryEntry(SegmentDictionary const * segmentDictionary, int index, int first = 0);
 
 	public:
-		int getIndex() const { return index; }
+		/* The position of the entry in the whole dictionary chain. */
+		int getIndex() const { return first + index; }
 		int codeAddress() const;
 		int codeLength() const;
 		std::wstring name() const;
@@ -112,6 +166,9 @@ namespace pcodedump {
 		int segmentNumber() const;
 		MachineType machineType() const;
 		int version() const;
+		bool isVersionIV() const;
+		/* The byte order of the dictionary, which is found once for each entry. */
+		bool isBigEndian() const { return bigEndian; }
 
 		int startAddress() const;
 		int linkageAddress() const;
@@ -119,9 +176,14 @@ namespace pcodedump {
 	public:
 		SegmentDictionaryEntry const * operator->() const;
 
+	private:
+		int segInfo() const;
+
 	private:
 		SegmentDictionary const * segmentDictionary;
 		int index;
+		int first;
+		bool bigEndian;
 	};
 
 	class SegmentDictionaryIterator {
@@ -156,6 +218,38 @@ namespace pcodedump {
 
 	bool operator!=(SegmentDictionaryIterator const & lhs, SegmentDictionaryIterator const & rhs);
 
+	/* The dictionary blocks of a code file. Version IV files have room for more than 16 segments
+	   by chaining dictionary blocks, each giving the block of the next. The chain is followed only
+	   as far as an entry is asked for, and the entries found are kept in one table so that any of
+	   them is found by its index in constant time. Other code files have a single block. */
+	class SegmentDictionaryChain {
+	public:
+		using const_iterator = std::vector<SegmentDictionaryEntry>::const_iterator;
+
+		SegmentDictionaryChain(Range<std::uint8_t const> file);
+
+		SegmentDictionary const & first() const;
+		SegmentDictionaryEntry operator[](int index) const;
+		int size() const;
+		const_iterator begin() const;
+		const_iterator end() const;
+		/* True if the chain has an entry at this index, reading only as far down the chain as that. */
+		bool contains(int index) const;
+		/* The first block after this one where a segment or a dictionary starts, or the limit if
+		   there is none before it. The segments of a dictionary follow it in the file, so the chain
+		   is read only until the next dictionary lies past the block. */
+		int nextStart(int block, int limit) const;
+
+	private:
+		bool extend() const;
+
+	private:
+		Range<std::uint8_t const> file;
+		mutable std::vector<SegmentDictionaryEntry> entries;
+		mutable std::vector<int> dictionaryBlocks;
+		mutable bool complete;
+	};
+
 	class Segment {
 	public:
 		Segment(SegmentDictionaryEntry const dictionaryEntry);
@@ -174,6 +268,18 @@ namespace pcodedump {
 			return dictionaryEntry.segmentKind();
 		}
 
+		MachineType getMachineType() const {
+			return dictionaryEntry.machineType();
+		}
+		std::wstring getName() const {
+			return dictionaryEntry.name();
+		}
+
+		/* Version IV code and linkage have layouts of their own, which aren't decoded. */
+		bool isVersionIV() const {
+			return dictionaryEntry.isVersionIV();
+		}
+
 		virtual int getFirstBlock() const = 0;
 		virtual std::wostream& writeOut(std::wostream&) const;
 
@@ -199,7 +305,7 @@ namespace pcodedump {
 
 	class CodeSegment : public Segment {
 	public:
-		CodeSegment(buff_t const & buffer, SegmentDictionaryEntry const dictionaryEntry, int endBlock);
+		CodeSegment(Range<std::uint8_t const> file, SegmentDictionaryEntry const dictionaryEntry, int endBlock);
 
 		int getFirstBlock() const override {
 			return dictionaryEntry.startAddress();
@@ -207,6 +313,17 @@ namespace pcodedump {
 
 		std::wostream& writeOut(std::wostream&) const override;
 		bool detailEnabled() const;
+		std::map<int, CallList> getCalls() const;
+		std::map<int, std::uint64_t> getCodeHashes() const;
+		bool disassembleAround(std::wostream& os, std::size_t offset, int window) const;
+		/* The offset from the start of the segment of an offset into one of its procedures. */
+		std::size_t procedureOffset(int procedure, std::size_t offset) const;
+		CodePart const * getCodePart() const {
+			return codePart.get();
+		}
+		LinkageInfo const * getLinkageInfo() const {
+			return linkageInfo.get();
+		}
 
 	private:
 		void writeHeader(std::wostream& os) const;
@@ -215,7 +332,7 @@ namespace pcodedump {
 		std::unique_ptr<LinkageInfo> createLinkageInfo();
 
 	private:
-		buff_t const & buffer;
+		Range<std::uint8_t const> file;
 		int endBlock;
 		std::unique_ptr<CodePart> codePart;
 		std::unique_ptr<InterfaceText> interfaceText;
@@ -0,0 +1,217 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "similar.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "basecode.hpp"
+#include "pcode.hpp"
+#include "native.hpp"
+#include "textio.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <functional>
+
+using namespace std;
+
+namespace pcodedump {
+
+	namespace {
+
+		constexpr size_t SHINGLE = 3;
+		constexpr uint64_t NATIVE_SHINGLE = uint64_t{ 1 } << 32;
+		constexpr uint64_t GOLDEN = 0x9e3779b97f4a7c15;
+
+		/* The splitmix64 finaliser. */
+		uint64_t mix(uint64_t value) {
+			value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+			value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+			return value ^ (value >> 31);
+		}
+
+		/* Native code for each processor has its own kind of trigram. */
+		uint64_t nativeKind(wstring const & processor) {
+			static wstring const processors[] = { L"6502", L"Z80", L"8080" };
+			auto found = find(begin(processors), end(processors), processor);
+			return NATIVE_SHINGLE * static_cast<uint64_t>(1 + (found - begin(processors)));
+		}
+
+		/* The opcodes of a procedure, with p-code and the native code of each processor told
+		   apart by the key of their trigrams. */
+		vector<uint32_t> opcodesOf(Procedure const & procedure, uint64_t & kind) {
+			vector<uint32_t> result;
+			if (auto pcodeProcedure = dynamic_cast<PcodeProcedure const *>(&procedure)) {
+				kind = 0;
+				for (auto & instruction : pcodeProcedure->getFlowGraph().getInstructions()) {
+					result.push_back(instruction.opcode);
+				}
+			} else if (auto nativeProcedure = dynamic_cast<NativeProcedure const *>(&procedure)) {
+				kind = nativeKind(nativeProcedure->getProcessor());
+				for (auto & instruction : nativeProcedure->getDecodedInstructions()) {
+					result.push_back(instruction.opcode);
+				}
+			}
+			return result;
+		}
+
+	}
+
+	std::string SimilarityIndex::queryFile;
+	std::size_t SimilarityIndex::matchCount = 5;
+
+	/* A procedure shorter than a trigram is one shingle of all its opcodes. The prefixes of
+	   prefixed opcodes are mixed into the shingle. */
+	std::optional<SimilarityIndex::Signature> SimilarityIndex::fingerprint(Procedure const & procedure) {
+		uint64_t kind = 0;
+		auto opcodes = opcodesOf(procedure, kind);
+		if (opcodes.empty()) {
+			return nullopt;
+		}
+		array<uint64_t, HASHES> minimums;
+		minimums.fill(numeric_limits<uint64_t>::max());
+		auto length = min(SHINGLE, opcodes.size());
+		for (size_t index = 0; index + length <= opcodes.size(); ++index) {
+			uint64_t shingle = kind | length << 24;
+			uint64_t prefixes = 0;
+			for (size_t opcode = 0; opcode != length; ++opcode) {
+				shingle |= static_cast<uint64_t>(opcodes[index + opcode] & 0xff) << (8 * opcode);
+				prefixes |= static_cast<uint64_t>(opcodes[index + opcode] >> 8) << (16 * opcode);
+			}
+			if (prefixes) {
+				shingle ^= mix(prefixes) << 34;
+			}
+			for (size_t hash = 0; hash != HASHES; ++hash) {
+				minimums[hash] = min(minimums[hash], mix(shingle + hash * GOLDEN));
+			}
+		}
+		Signature result;
+		transform(minimums.begin(), minimums.end(), result.begin(), [](uint64_t value) { return static_cast<uint16_t>(value); });
+		return result;
+	}
+
+	void SimilarityIndex::add(std::wstring const & source, PcodeFile const & file) {
+		auto sourceIndex = static_cast<uint32_t>(sources.size());
+		sources.push_back(source);
+		for (auto & segment : file.getSegments()) {
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			auto codePart = codeSegment ? codeSegment->getCodePart() : nullptr;
+			if (codePart && codePart->getProcedures()) {
+				for (auto & procedure : *codePart->getProcedures()) {
+					if (auto signature = fingerprint(*procedure)) {
+						entries.push_back({ sourceIndex,
+							codeSegment->getSegmentNumber(), procedure->getProcedureNumber(), static_cast<uint16_t>(procedure->getSize()) });
+						signatures.push_back(*signature);
+					}
+				}
+			}
+		}
+	}
+
+	void SimilarityIndex::add(SimilarityIndex const & other) {
+		auto sourceBase = static_cast<uint32_t>(sources.size());
+		sources.insert(sources.end(), other.sources.begin(), other.sources.end());
+		for (auto entry : other.entries) {
+			entry.source += sourceBase;
+			entries.push_back(entry);
+		}
+		signatures.insert(signatures.end(), other.signatures.begin(), other.signatures.end());
+	}
+
+	namespace {
+
+		uint64_t bandKey(SimilarityIndex::Signature const & signature, size_t band) {
+			uint64_t key = band;
+			for (size_t row = 0; row != SimilarityIndex::ROWS; ++row) {
+				key = key << 16 ^ signature[band * SimilarityIndex::ROWS + row];
+			}
+			return mix(key + band * GOLDEN);
+		}
+
+	}
+
+	/* The band keys of every procedure are held in one sorted array, so that the procedures in
+	   a bucket are found with a binary search. */
+	void SimilarityIndex::build() {
+		bands.clear();
+		bands.reserve(signatures.size() * BANDS);
+		for (size_t entry = 0; entry != signatures.size(); ++entry) {
+			for (size_t band = 0; band != BANDS; ++band) {
+				bands.push_back({ bandKey(signatures[entry], band), static_cast<uint32_t>(entry) });
+			}
+		}
+		sort(bands.begin(), bands.end());
+	}
+
+	std::vector<std::pair<std::size_t, double>> SimilarityIndex::find(Signature const & signature, std::size_t count) const {
+		vector<uint32_t> candidates;
+		for (size_t band = 0; band != BANDS; ++band) {
+			auto key = bandKey(signature, band);
+			auto first = lower_bound(bands.begin(), bands.end(), make_pair(key, uint32_t{ 0 }));
+			for (auto bucket = first; bucket != bands.end() && bucket->first == key; ++bucket) {
+				candidates.push_back(bucket->second);
+			}
+		}
+		sort(candidates.begin(), candidates.end());
+		candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+		vector<pair<size_t, double>> result;
+		for (auto candidate : candidates) {
+			auto & other = signatures[candidate];
+			auto same = inner_product(signature.begin(), signature.end(), other.begin(), size_t{ 0 }, plus<size_t>(), equal_to<uint16_t>());
+			result.push_back({ candidate, static_cast<double>(same) / HASHES });
+		}
+		auto last = result.begin() + min(count, result.size());
+		partial_sort(result.begin(), last, result.end(), [](auto & left, auto & right) {
+			return left.second > right.second || (left.second == right.second && left.first < right.first);
+		});
+		result.erase(last, result.end());
+		return result;
+	}
+
+	void SimilarityIndex::write(std::wostream & os, std::size_t index) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		auto & entry = entries[index];
+		os << sources[entry.source] << L" " << dec << entry.segment << L"." << entry.procedure;
+		os << L" (" << entry.size << L" bytes)";
+	}
+
+	/* Each procedure of a code file, followed by the procedures in the index that are most
+	   like it. */
+	void SimilarityIndex::writeMatches(std::wostream & os, std::wstring const & source, PcodeFile const & file) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		for (auto & segment : file.getSegments()) {
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			auto codePart = codeSegment ? codeSegment->getCodePart() : nullptr;
+			if (codePart && codePart->getProcedures()) {
+				for (auto & procedure : *codePart->getProcedures()) {
+					if (auto signature = fingerprint(*procedure)) {
+						os << source << L" " << dec << codeSegment->getSegmentNumber() << L"." << procedure->getProcedureNumber();
+						os << L" (" << procedure->getSize() << L" bytes)" << endl;
+						for (auto [entry, similarity] : find(*signature, matchCount)) {
+							os << L"  " << fixed << setprecision(2) << similarity << L" ";
+							write(os, entry);
+							os << endl;
+						}
+					}
+				}
+			}
+		}
+	}
+
+}
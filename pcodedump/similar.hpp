@@ -0,0 +1,89 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _CAB238F5_7084_4FD9_BFD3_E5E55DE351E7
+#define _CAB238F5_7084_4FD9_BFD3_E5E55DE351E7
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <optional>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace pcodedump {
+
+	class PcodeFile;
+	class Procedure;
+
+	/* An index of the procedures in a set of code files, for finding the procedures most like
+	   another. Each procedure is fingerprinted with a MinHash signature over the opcode
+	   trigrams of its instructions. The number of signature values that two procedures share
+	   estimates how alike their sets of trigrams are.
+
+	   Only the low 16 bits of each signature value are kept. Locality sensitive hashing, with
+	   the signature split into bands, finds the procedures that share at least one band with
+	   the one being looked for, so that only those are compared. The bands must be built again
+	   after adding. */
+	class SimilarityIndex {
+	public:
+		static constexpr std::size_t HASHES = 64;
+		static constexpr std::size_t BANDS = 16;
+		static constexpr std::size_t ROWS = HASHES / BANDS;
+
+		using Signature = std::array<std::uint16_t, HASHES>;
+
+		/* Nothing for a procedure without instructions. */
+		static std::optional<Signature> fingerprint(Procedure const & procedure);
+
+		void add(std::wstring const & source, PcodeFile const & file);
+		void add(SimilarityIndex const & other);
+		void build();
+
+		std::size_t size() const {
+			return entries.size();
+		}
+
+		/* The most alike procedures, and the fraction of their signatures that is the same,
+		   most alike first. */
+		std::vector<std::pair<std::size_t, double>> find(Signature const & signature, std::size_t count) const;
+
+		void write(std::wostream & os, std::size_t entry) const;
+		void writeMatches(std::wostream & os, std::wstring const & source, PcodeFile const & file) const;
+
+	private:
+		struct Entry {
+			std::uint32_t source;
+			int segment;
+			int procedure;
+			std::uint16_t size;
+		};
+
+		std::vector<std::wstring> sources;
+		std::vector<Entry> entries;
+		std::vector<Signature> signatures;
+		std::vector<std::pair<std::uint64_t, std::uint32_t>> bands;
+
+	public:
+		static std::string queryFile;
+		static std::size_t matchCount;
+	};
+
+}
+
+#endif // !_CAB238F5_7084_4FD9_BFD3_E5E55DE351E7
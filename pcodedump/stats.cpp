@@ -0,0 +1,278 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "stats.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "basecode.hpp"
+#include "native6502.hpp"
+#include "textio.hpp"
+
+#include <string>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+
+using namespace std;
+
+namespace pcodedump {
+
+	namespace {
+
+		constexpr uint32_t PCODE_NGRAM = 0;
+		constexpr uint32_t NATIVE_NGRAM = 1;
+		constexpr size_t TOP_NGRAMS = 20;
+
+		wchar_t const * pcodeFormatNames[] = {
+			L"implied",
+			L"unsigned byte",
+			L"big",
+			L"intermediate",
+			L"extended",
+			L"word",
+			L"word block",
+			L"string constant",
+			L"packed constant",
+			L"jump",
+			L"procedure return",
+			L"double byte",
+			L"case jump",
+			L"standard procedure",
+			L"compare",
+		};
+
+		wchar_t const * addressModeNames[] = {
+			L"implied",
+			L"immediate",
+			L"accumulator",
+			L"absolute",
+			L"(absolute)",
+			L"(absolute,X)",
+			L"zero page",
+			L"(zero page)",
+			L"absolute,X",
+			L"absolute,Y",
+			L"zero page,X",
+			L"zero page,Y",
+			L"relative",
+			L"(zero page,X)",
+			L"(zero page),Y",
+			L"immediate (M)",
+			L"immediate (X)",
+			L"long",
+			L"long,X",
+			L"[absolute]",
+			L"[zero page]",
+			L"[zero page],Y",
+			L"stack",
+			L"(stack),Y",
+			L"relative long",
+			L"block move",
+		};
+
+		/* Sizes are counted in power of two buckets. Bucket n holds sizes from 2^(n-1) to
+		   2^n - 1. */
+		size_t sizeBucket(size_t size) {
+			size_t bucket = 0;
+			while (size) {
+				++bucket;
+				size >>= 1;
+			}
+			return bucket;
+		}
+
+		/* The key of an n-gram holds the kind of code, the number of opcodes and the opcodes. */
+		uint32_t ngramKey(uint32_t kind, uint8_t const * opcodes, size_t count) {
+			uint32_t key = kind << 26 | static_cast<uint32_t>(count) << 24;
+			for (size_t index = 0; index != count; ++index) {
+				key |= static_cast<uint32_t>(opcodes[index]) << (8 * (count - 1 - index));
+			}
+			return key;
+		}
+
+		using NamedCounts = vector<pair<wstring, uint64_t>>;
+
+		/* Counts that aren't zero, most frequent first unless they are in a natural order. */
+		void writeCounts(wostream & os, wstring const & title, NamedCounts counts, size_t limit = SIZE_MAX, bool byCount = true) {
+			counts.erase(remove_if(counts.begin(), counts.end(), [](auto & count) { return count.second == 0; }), counts.end());
+			if (!counts.empty()) {
+				if (byCount) {
+					stable_sort(counts.begin(), counts.end(), [](auto & left, auto & right) { return left.second > right.second; });
+				}
+				os << L"  " << title << endl;
+				for (size_t index = 0; index != counts.size() && index != limit; ++index) {
+					os << L"    " << setfill(L' ') << left << setw(28) << counts[index].first;
+					os << right << setw(12) << counts[index].second << endl;
+				}
+			}
+		}
+
+		template <size_t N>
+		NamedCounts sizeCounts(array<uint64_t, N> const & sizes) {
+			NamedCounts result;
+			for (size_t bucket = 0; bucket != sizes.size(); ++bucket) {
+				auto first = bucket ? size_t{ 1 } << (bucket - 1) : 0;
+				auto last = bucket ? (size_t{ 1 } << bucket) - 1 : 0;
+				result.push_back({ to_wstring(first) + L"-" + to_wstring(last), sizes[bucket] });
+			}
+			return result;
+		}
+
+	}
+
+	bool CodeStatistics::showStats = false;
+
+	void CodeStatistics::add(PcodeFile const & file) {
+		++codeFiles;
+		for (auto & segment : file.getSegments()) {
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			auto codePart = codeSegment ? codeSegment->getCodePart() : nullptr;
+			if (codePart && codePart->getProcedures()) {
+				for (auto & procedure : *codePart->getProcedures()) {
+					if (auto pcodeProcedure = dynamic_cast<PcodeProcedure const *>(procedure.get())) {
+						addPcode(*pcodeProcedure);
+					} else if (auto nativeProcedure = dynamic_cast<NativeProcedure const *>(procedure.get())) {
+						addNative(*nativeProcedure);
+					}
+				}
+			}
+		}
+	}
+
+	void CodeStatistics::addPcode(PcodeProcedure const & procedure) {
+		++pcodeProcedures;
+		++pcodeSizes[sizeBucket(procedure.getSize())];
+		auto & instructions = procedure.getFlowGraph().getInstructions();
+		vector<uint8_t> opcodes;
+		opcodes.reserve(instructions.size());
+		for (auto & instruction : instructions) {
+			++pcodeCounts[instruction.opcode];
+			++pcodeFormats[static_cast<size_t>(instruction.format())];
+			opcodes.push_back(instruction.opcode);
+		}
+		addNgrams(PCODE_NGRAM, opcodes.data(), opcodes.size());
+	}
+
+	void CodeStatistics::addNative(NativeProcedure const & procedure) {
+		++nativeProcedures;
+		++nativeSizes[sizeBucket(procedure.getSize())];
+		auto processor = procedure.getProcessor();
+		if (processor == L"6502") {
+			auto & table = Native6502Procedure::getOpcodes();
+			vector<uint8_t> opcodes;
+			for (auto & instruction : procedure.getDecodedInstructions()) {
+				auto opcode = static_cast<uint8_t>(instruction.opcode);
+				++nativeCounts[opcode];
+				++addressModes[static_cast<size_t>(table[opcode].mode)];
+				opcodes.push_back(opcode);
+			}
+			addNgrams(NATIVE_NGRAM, opcodes.data(), opcodes.size());
+		} else {
+			for (auto & instruction : procedure.getDecodedInstructions()) {
+				++otherNativeCounts[processor + L" " + procedure.getMnemonic(instruction)];
+			}
+		}
+	}
+
+	void CodeStatistics::addNgrams(uint32_t kind, uint8_t const * opcodes, size_t count) {
+		for (size_t length = 2; length <= 3; ++length) {
+			for (size_t index = 0; index + length <= count; ++index) {
+				++ngrams[ngramKey(kind, opcodes + index, length)];
+			}
+		}
+	}
+
+	void CodeStatistics::add(CodeStatistics const & other) {
+		auto addCounts = [](auto & to, auto const & from) {
+			for (size_t index = 0; index != to.size(); ++index) {
+				to[index] += from[index];
+			}
+		};
+		codeFiles += other.codeFiles;
+		pcodeProcedures += other.pcodeProcedures;
+		nativeProcedures += other.nativeProcedures;
+		addCounts(pcodeCounts, other.pcodeCounts);
+		addCounts(nativeCounts, other.nativeCounts);
+		addCounts(pcodeFormats, other.pcodeFormats);
+		addCounts(addressModes, other.addressModes);
+		addCounts(pcodeSizes, other.pcodeSizes);
+		addCounts(nativeSizes, other.nativeSizes);
+		for (auto & [key, count] : other.ngrams) {
+			ngrams[key] += count;
+		}
+		for (auto & [name, count] : other.otherNativeCounts) {
+			otherNativeCounts[name] += count;
+		}
+	}
+
+	/* The most frequent n-grams of each length, written as their mnemonics. */
+	void CodeStatistics::writeNgrams(std::wostream & os, uint32_t kind) const {
+		auto & table = Native6502Procedure::getOpcodes();
+		for (uint32_t length = 2; length <= 3; ++length) {
+			NamedCounts counts;
+			for (auto & [key, count] : ngrams) {
+				if (key >> 26 == kind && (key >> 24 & 3) == length) {
+					wstring name;
+					for (uint32_t index = 0; index != length; ++index) {
+						auto opcode = key >> (8 * (length - 1 - index)) & 0xff;
+						name += (index ? L" " : L"") + wstring(kind == PCODE_NGRAM ? pcodeOpcodes[opcode].mnemonic : table[opcode].mnemonic);
+					}
+					counts.push_back({ name, count });
+				}
+			}
+			sort(counts.begin(), counts.end());
+			writeCounts(os, wstring(kind == PCODE_NGRAM ? L"P-code " : L"6502 ") + (length == 2 ? L"bigrams" : L"trigrams"), counts, TOP_NGRAMS);
+		}
+	}
+
+	void CodeStatistics::write(std::wostream & os) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		os << dec;
+		os << L"  Code files : " << codeFiles << endl;
+		os << L"  Procedures : " << pcodeProcedures << L" p-code, " << nativeProcedures << L" native" << endl;
+
+		NamedCounts counts;
+		for (size_t opcode = 0; opcode != pcodeCounts.size(); ++opcode) {
+			counts.push_back({ pcodeOpcodes[opcode].mnemonic, pcodeCounts[opcode] });
+		}
+		writeCounts(os, L"P-code opcodes", counts);
+		counts.clear();
+		for (size_t format = 0; format != pcodeFormats.size(); ++format) {
+			counts.push_back({ pcodeFormatNames[format], pcodeFormats[format] });
+		}
+		writeCounts(os, L"P-code operand formats", counts);
+		writeNgrams(os, PCODE_NGRAM);
+		writeCounts(os, L"P-code procedure sizes", sizeCounts(pcodeSizes), SIZE_MAX, false);
+
+		auto & table = Native6502Procedure::getOpcodes();
+		counts.clear();
+		for (size_t opcode = 0; opcode != nativeCounts.size(); ++opcode) {
+			counts.push_back({ wstring(table[opcode].mnemonic) + L" " + addressModeNames[static_cast<size_t>(table[opcode].mode)], nativeCounts[opcode] });
+		}
+		writeCounts(os, L"6502 opcodes", counts);
+		counts.clear();
+		for (size_t mode = 0; mode != addressModes.size(); ++mode) {
+			counts.push_back({ addressModeNames[mode], addressModes[mode] });
+		}
+		writeCounts(os, L"6502 address modes", counts);
+		writeNgrams(os, NATIVE_NGRAM);
+		writeCounts(os, L"Other native mnemonics", NamedCounts(otherNativeCounts.begin(), otherNativeCounts.end()));
+		writeCounts(os, L"Native procedure sizes", sizeCounts(nativeSizes), SIZE_MAX, false);
+		os << endl;
+	}
+
+}
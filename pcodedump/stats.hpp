@@ -0,0 +1,76 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _C39F679C_64CD_4E9E_B902_64B68359331D
+#define _C39F679C_64CD_4E9E_B902_64B68359331D
+
+#include "pcode.hpp"
+#include "opcodes6502.hpp"
+
+#include <iostream>
+#include <array>
+#include <unordered_map>
+#include <map>
+#include <string>
+#include <cstdint>
+
+namespace pcodedump {
+
+	class PcodeFile;
+	class NativeProcedure;
+
+	/* Counts of opcodes, operand formats, opcode n-grams and procedure sizes, for p-code and
+	   6502 code. Other native code is counted by processor and mnemonic. Counts are taken from
+	   decoded instructions, and statistics from different files or threads can be added together.
+	   N-grams of two and three opcodes are counted within each procedure. */
+	class CodeStatistics {
+	public:
+		void add(PcodeFile const & file);
+		void add(CodeStatistics const & other);
+
+		void write(std::wostream & os) const;
+
+	private:
+		static constexpr std::size_t PCODE_FORMATS = static_cast<std::size_t>(PcodeFormat::compare) + 1;
+		static constexpr std::size_t ADDRESS_MODES = static_cast<std::size_t>(AddressMode::blockMove) + 1;
+		static constexpr std::size_t SIZE_BUCKETS = 17;
+
+		using Counts = std::array<std::uint64_t, 256>;
+
+		void addPcode(PcodeProcedure const & procedure);
+		void addNative(NativeProcedure const & procedure);
+		void addNgrams(std::uint32_t kind, std::uint8_t const * opcodes, std::size_t count);
+		void writeNgrams(std::wostream & os, std::uint32_t kind) const;
+
+		std::uint64_t codeFiles = 0;
+		std::uint64_t pcodeProcedures = 0;
+		std::uint64_t nativeProcedures = 0;
+		Counts pcodeCounts{};
+		Counts nativeCounts{};
+		std::array<std::uint64_t, PCODE_FORMATS> pcodeFormats{};
+		std::array<std::uint64_t, ADDRESS_MODES> addressModes{};
+		std::array<std::uint64_t, SIZE_BUCKETS> pcodeSizes{};
+		std::array<std::uint64_t, SIZE_BUCKETS> nativeSizes{};
+		std::unordered_map<std::uint32_t, std::uint64_t> ngrams;
+		std::map<std::wstring, std::uint64_t> otherNativeCounts;
+
+	public:
+		static bool showStats;
+	};
+
+}
+
+#endif // !_C39F679C_64CD_4E9E_B902_64B68359331D
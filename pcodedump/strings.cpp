@@ -0,0 +1,121 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "strings.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "basecode.hpp"
+#include "pcode.hpp"
+#include "textio.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <cstring>
+
+using namespace std;
+
+namespace pcodedump {
+
+	bool StringIndex::listStrings = false;
+	std::string StringIndex::search;
+
+	/* Literals are taken from the decoded instructions of each p-code procedure, so nothing is
+	   disassembled. */
+	void StringIndex::add(std::wstring const & source, PcodeFile const & file) {
+		auto sourceIndex = static_cast<uint32_t>(sources.size());
+		sources.push_back(source);
+		for (auto & segment : file.getSegments()) {
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			auto codePart = codeSegment ? codeSegment->getCodePart() : nullptr;
+			if (codePart && codePart->getProcedures()) {
+				for (auto & procedure : *codePart->getProcedures()) {
+					auto pcodeProcedure = dynamic_cast<PcodeProcedure const *>(procedure.get());
+					if (pcodeProcedure) {
+						for (auto & instruction : pcodeProcedure->getFlowGraph().getInstructions()) {
+							if (instruction.format() == PcodeFormat::stringConstant) {
+								auto first = procedure->getProcBegin() + instruction.operand2;
+								literals.push_back({ sourceIndex,
+									codeSegment->getSegmentNumber(), procedure->getProcedureNumber(), instruction.offset,
+									static_cast<uint32_t>(text.size()), static_cast<uint8_t>(instruction.operand1) });
+								text.append(first, first + instruction.operand1);
+								text.push_back('\0');
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void StringIndex::add(StringIndex const & other) {
+		auto sourceBase = static_cast<uint32_t>(sources.size());
+		auto textBase = static_cast<uint32_t>(text.size());
+		sources.insert(sources.end(), other.sources.begin(), other.sources.end());
+		for (auto literal : other.literals) {
+			literal.source += sourceBase;
+			literal.start += textBase;
+			literals.push_back(literal);
+		}
+		text += other.text;
+	}
+
+	/* Suffixes are compared up to the zero byte that ends their literal, so a match never spans
+	   two literals, and no comparison is longer than a literal. A literal that contains a zero
+	   byte can't be matched past it. */
+	void StringIndex::build() {
+		suffixes.clear();
+		for (auto & literal : literals) {
+			for (auto position = literal.start; position != literal.start + literal.length; ++position) {
+				suffixes.push_back(position);
+			}
+		}
+		auto base = text.c_str();
+		sort(suffixes.begin(), suffixes.end(), [base](uint32_t left, uint32_t right) { return strcmp(base + left, base + right) < 0; });
+	}
+
+	/* The literals that contain the text, in the order they were added. */
+	vector<size_t> StringIndex::find(std::string const & substring) const {
+		auto base = text.c_str();
+		auto length = substring.size();
+		auto first = lower_bound(suffixes.begin(), suffixes.end(), substring, [base, length](uint32_t position, string const & value) {
+			return strncmp(base + position, value.c_str(), length) < 0;
+		});
+		auto last = upper_bound(first, suffixes.end(), substring, [base, length](string const & value, uint32_t position) {
+			return strncmp(value.c_str(), base + position, length) < 0;
+		});
+		vector<size_t> result;
+		for (auto suffix = first; suffix != last; ++suffix) {
+			auto next = upper_bound(literals.begin(), literals.end(), *suffix, [](uint32_t position, Literal const & entry) { return position < entry.start; });
+			result.push_back(next - literals.begin() - 1);
+		}
+		sort(result.begin(), result.end());
+		result.erase(unique(result.begin(), result.end()), result.end());
+		return result;
+	}
+
+	/* A literal is written with the code file it is in, and where it is loaded, as
+	   segment.procedure:offset. */
+	void StringIndex::write(std::wostream & os, std::size_t index) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		auto & literal = literals[index];
+		auto first = reinterpret_cast<uint8_t const *>(text.data()) + literal.start;
+		os << sources[literal.source] << L" " << dec << literal.segment << L"." << literal.procedure << L":";
+		os << hex << setfill(L'0') << right << setw(4) << literal.offset << L" '";
+		line_chardump(os, first, first + literal.length);
+		os << L"'" << endl;
+	}
+
+}
@@ -0,0 +1,69 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _1D5D6EF2_70E2_414D_BC08_551239F42FCE
+#define _1D5D6EF2_70E2_414D_BC08_551239F42FCE
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace pcodedump {
+
+	class PcodeFile;
+
+	/* An index of the string literals loaded by LSA in a set of code files. The text of every
+	   literal is held in one buffer, each followed by a zero byte, and a suffix array over the
+	   buffer finds the literals that contain a substring with a binary search. Literals are
+	   kept in the order they are added. The suffix array must be built again after adding. */
+	class StringIndex {
+	public:
+		void add(std::wstring const & source, PcodeFile const & file);
+		void add(StringIndex const & other);
+		void build();
+
+		std::size_t size() const {
+			return literals.size();
+		}
+
+		std::vector<std::size_t> find(std::string const & text) const;
+		void write(std::wostream & os, std::size_t literal) const;
+
+	private:
+		struct Literal {
+			std::uint32_t source;
+			int segment;
+			int procedure;
+			std::uint16_t offset;
+			std::uint32_t start;
+			std::uint8_t length;
+		};
+
+		std::vector<std::wstring> sources;
+		std::vector<Literal> literals;
+		std::string text;
+		std::vector<std::uint32_t> suffixes;
+
+	public:
+		static bool listStrings;
+		static std::string search;
+	};
+
+}
+
+#endif // !_1D5D6EF2_70E2_414D_BC08_551239F42FCE
@@ -19,6 +19,7 @@
 #include <string>
 #include <tuple>
 #include <locale>
+#include <algorithm>
 
 using namespace std;
 
@@ -33,6 +34,9 @@ namespace pcodedump {
 
 		const wstring implementation = L"IMPLEMENTATION";
 
+		constexpr uint8_t DLE = 0x10;
+		constexpr uint8_t CR = 0x0D;
+
 		template <typename charT>
 		bool compareNoCase(const charT left, const charT right) {
 			locale loc{};
@@ -73,8 +77,54 @@ namespace pcodedump {
 		while (current) {
 			wstring line;
 			tie(line, current) = readline(current);
-			wcout << line << endl;
+			os << line << endl;
 		}
 	}
 
+	bool TextFile::convert = false;
+
+	TextFile::TextFile(Range<uint8_t const> data) : data{ data }
+	{
+	}
+
+	/* Expand the text pages into plain text with newline line endings. Each page is decoded
+	   until the first null, which starts the padding at the end of the page, and decoding then
+	   resumes at the next page boundary. */
+	string TextFile::decode() const {
+		string result{};
+		auto size = distance(data.begin(), data.end());
+		if (size <= HEADER_SIZE) {
+			return result;
+		}
+		result.reserve(size - HEADER_SIZE);
+		auto current = data.begin() + HEADER_SIZE;
+		while (current != data.end()) {
+			auto pageEnd = current + min<ptrdiff_t>(PAGE_SIZE, distance(current, data.end()));
+			while (current != pageEnd) {
+				auto next = *current++;
+				if (next == 0x00) {
+					break;
+				} else if (next == CR) {
+					result.push_back('\n');
+				} else if (next == DLE) {
+					if (current != pageEnd && *current > 32) {
+						result.append(*current - 32, ' ');
+					}
+					if (current != pageEnd) {
+						++current;
+					}
+				} else {
+					result.push_back(next);
+				}
+			}
+			current = pageEnd;
+		}
+		return result;
+	}
+
+	void TextFile::write(std::ostream& os) const {
+		auto text = decode();
+		os.write(text.data(), text.size());
+	}
+
 }
@@ -17,6 +17,8 @@
 #ifndef _3FCC8EAF_9802_4C63_9008_CA4602A96E92
 #define _3FCC8EAF_9802_4C63_9008_CA4602A96E92
 
+#include "types.hpp"
+
 #include <cstdint>
 #include <iostream>
 #include <tuple>
@@ -39,6 +41,26 @@ namespace pcodedump {
 		const std::uint8_t * end;
 	};
 
+	/* A complete Apple Pascal text file. The file starts with a two block header page reserved for
+	   the editor, followed by two block pages of text. Lines end with a carriage return, may start
+	   with a DLE indentation code, and the unused tail of each page is filled with nulls. */
+	class TextFile {
+	public:
+		static constexpr unsigned int HEADER_SIZE = 2 * BLOCK_SIZE;
+		static constexpr unsigned int PAGE_SIZE = 2 * BLOCK_SIZE;
+
+		explicit TextFile(Range<std::uint8_t const> data);
+
+		std::string decode() const;
+		void write(std::ostream& os) const;
+
+	private:
+		Range<std::uint8_t const> data;
+
+	public:
+		static bool convert;
+	};
+
 }
 
 #endif // !_3FCC8EAF_9802_4C63_9008_CA4602A96E92
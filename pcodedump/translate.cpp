@@ -0,0 +1,1223 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "translate.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "basecode.hpp"
+#include "pcode.hpp"
+#include "textio.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <sstream>
+#include <boost/algorithm/string/trim.hpp>
+
+using namespace std;
+
+namespace pcodedump {
+
+	namespace {
+
+		using namespace op;
+
+		constexpr uint32_t MEMORY_SIZE = 0x10000;
+		constexpr uint16_t HEAP_BOTTOM = 0x0100;
+		constexpr uint16_t STACK_MARGIN = 0x0400;
+
+		/* The words of parameters and results that each standard procedure takes from the stack
+		   and leaves on it. */
+		map<int, pair<int, int>> const standardProcEffects = {
+			{ 0, { 0, 0 } }, { 1, { 2, 0 } }, { 2, { 3, 0 } }, { 3, { 3, 0 } }, { 5, { 5, 0 } },
+			{ 6, { 5, 0 } }, { 9, { 2, 0 } }, { 10, { 3, 0 } }, { 12, { 3, 0 } }, { 21, { 1, 0 } },
+			{ 22, { 1, 0 } }, { 23, { 2, 1 } }, { 24, { 2, 1 } }, { 25, { 2, 2 } }, { 26, { 2, 2 } },
+			{ 27, { 2, 2 } }, { 28, { 2, 2 } }, { 29, { 2, 2 } }, { 30, { 2, 2 } }, { 31, { 2, 2 } },
+			{ 32, { 1, 0 } }, { 33, { 1, 0 } }, { 34, { 0, 1 } }, { 35, { 1, 1 } }, { 36, { 1, 2 } },
+			{ 37, { 1, 0 } }, { 38, { 1, 0 } }, { 39, { 0, 0 } }, { 40, { 0, 1 } },
+		};
+
+		/* The support that every translated program needs: the memory of the p-machine, its
+		   activation records, and the standard procedures. */
+		char const * const runtime = R"(#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+
+namespace pcode {
+
+	struct Halt {};
+
+	/* Thrown by an exit, and caught by the function of the frame that is exited. */
+	struct Exit {
+		std::size_t frame;
+	};
+
+	struct Frame {
+		std::uint16_t locals;
+		std::uint16_t top;
+		std::uint16_t savedGlobals;
+		int staticLink;
+		int level;
+		int segment;
+		int procedure;
+	};
+
+	struct Machine {
+		std::vector<std::uint8_t> memory = std::vector<std::uint8_t>(0x10004);
+		std::uint16_t sp = 0;
+		std::uint16_t globals = 0;
+		std::uint16_t heapTop = 0x0100;
+		std::uint16_t segmentBase[256] = {};
+		std::vector<Frame> frames;
+
+		[[noreturn]] void fault(char const * reason, int segment, int procedure, int offset) const {
+			char location[32];
+			std::snprintf(location, sizeof location, "%d.%d:%04x", segment, procedure, offset);
+			throw std::runtime_error(std::string("P-machine fault at ") + location + ": " + reason);
+		}
+
+		int word(std::uint16_t address) const {
+			return static_cast<std::int16_t>(memory[address] | memory[address + 1] << 8);
+		}
+
+		void setWord(std::uint16_t address, int value) {
+			memory[address] = static_cast<std::uint8_t>(value);
+			memory[address + 1] = static_cast<std::uint8_t>(value >> 8);
+		}
+
+		int byte(std::uint16_t address) const {
+			return memory[address];
+		}
+
+		void setByte(std::uint16_t address, int value) {
+			memory[address] = static_cast<std::uint8_t>(value);
+		}
+
+		void push(int value) {
+			sp -= 2;
+			setWord(sp, value);
+		}
+
+		/* The operand stack of a procedure is below its locals. */
+		int pop() {
+			if (sp + 2 > frames.back().locals) {
+				throw std::runtime_error("P-machine fault: Stack underflow");
+			}
+			int result = word(sp);
+			sp += 2;
+			return result;
+		}
+
+		void load(std::uint16_t address, std::uint8_t const * code, std::size_t size) {
+			std::memcpy(memory.data() + address, code, size);
+		}
+
+		void checkRange(std::uint16_t address, int length) const {
+			if (address + length > 0x10000) {
+				throw std::runtime_error("P-machine fault: Memory access out of range");
+			}
+		}
+
+		void checkRange(std::uint16_t address, int length, int segment, int procedure, int offset) const {
+			if (address + length > 0x10000) {
+				fault("Memory access out of range", segment, procedure, offset);
+			}
+		}
+
+		/* A packed field lies within a word. */
+		void checkField(int width, int right, int segment, int procedure, int offset) const {
+			if (width < 0 || width > 16 || right < 0 || right > 15) {
+				fault("Packed field out of range", segment, procedure, offset);
+			}
+		}
+
+		std::uint16_t enter(int level, int dataSize, int parameterSize, int segment, int procedure) {
+			std::uint16_t top = sp;
+			if (!frames.empty() && sp + parameterSize > frames.back().locals) {
+				fault("Stack underflow", segment, procedure, 0);
+			}
+			if (sp < heapTop + dataSize + 0x400) {
+				throw std::runtime_error("P-machine fault: Stack overflow");
+			}
+			sp -= dataSize;
+			std::memset(memory.data() + sp, 0, dataSize);
+			int link = static_cast<int>(frames.size()) - 1;
+			while (link >= 0 && frames[link].level >= level) {
+				link = frames[link].staticLink;
+			}
+			frames.push_back({ sp, static_cast<std::uint16_t>(top + parameterSize), globals, link, level, segment, procedure });
+			if (level <= 0) {
+				globals = sp;
+				segmentBase[segment] = sp;
+			}
+			return sp;
+		}
+
+		/* The result of a function is in its first locals. */
+		void leave(int results, int segment, int procedure, int offset) {
+			Frame frame = frames.back();
+			if (2 * results > frame.top - frame.locals) {
+				fault("Function result out of range", segment, procedure, offset);
+			}
+			frames.pop_back();
+			globals = frame.savedGlobals;
+			std::memmove(memory.data() + frame.top - 2 * results, memory.data() + frame.locals, 2 * results);
+			sp = frame.top - 2 * results;
+		}
+
+		/* The frames above one that is exited are discarded. */
+		void unwind(std::size_t frame) {
+			if (frames.size() > frame + 1) {
+				sp = frames[frame + 1].top;
+				globals = frames[frame + 1].savedGlobals;
+				frames.resize(frame + 1);
+			}
+		}
+
+		void exitProcedure(int segment, int procedure, int offset) {
+			int exited = pop();
+			int exitedSegment = pop();
+			for (std::size_t frame = frames.size(); frame-- != 0;) {
+				if (frames[frame].segment == exitedSegment && frames[frame].procedure == exited) {
+					throw Exit{ frame };
+				}
+			}
+			std::string reason = "Exit from procedure " + std::to_string(exitedSegment) + "." + std::to_string(exited) + " that isn't active";
+			fault(reason.c_str(), segment, procedure, offset);
+		}
+
+		std::uint16_t intermediate(int levels) const {
+			int link = static_cast<int>(frames.size()) - 1;
+			for (; levels != 0 && link >= 0; --levels) {
+				link = frames[link].staticLink;
+			}
+			if (link < 0) {
+				throw std::runtime_error("P-machine fault: No enclosing procedure");
+			}
+			return frames[link].locals;
+		}
+
+		std::uint16_t segmentGlobals(int segment, int dataSize) {
+			if (!segmentBase[segment]) {
+				segmentBase[segment] = allocate(dataSize);
+			}
+			return segmentBase[segment];
+		}
+
+		std::uint16_t allocate(int size) {
+			if (heapTop + size + 0x400 > sp) {
+				throw std::runtime_error("P-machine fault: Heap overflow");
+			}
+			std::uint16_t result = heapTop;
+			std::memset(memory.data() + heapTop, 0, size);
+			heapTop += size;
+			return result;
+		}
+
+		static float real(int high, int low) {
+			std::uint32_t bits = static_cast<std::uint16_t>(low) | static_cast<std::uint32_t>(static_cast<std::uint16_t>(high)) << 16;
+			float result;
+			std::memcpy(&result, &bits, sizeof result);
+			return result;
+		}
+
+		static void split(float value, std::int16_t & high, std::int16_t & low) {
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof bits);
+			high = static_cast<std::int16_t>(bits >> 16);
+			low = static_cast<std::int16_t>(bits);
+		}
+
+		static int order(int left, int right) {
+			return (left > right) - (left < right);
+		}
+
+		int compareStrings(std::uint16_t left, std::uint16_t right, int segment, int procedure, int offset) const {
+			checkRange(left, memory[left] + 1, segment, procedure, offset);
+			checkRange(right, memory[right] + 1, segment, procedure, offset);
+			int length = std::min(memory[left], memory[right]);
+			int result = std::memcmp(memory.data() + left + 1, memory.data() + right + 1, length);
+			return result ? order(result, 0) : order(memory[left], memory[right]);
+		}
+
+		int compareBytes(std::uint16_t left, std::uint16_t right, int length) const {
+			checkRange(left, length);
+			checkRange(right, length);
+			return order(std::memcmp(memory.data() + left, memory.data() + right, length), 0);
+		}
+
+		void move(std::uint16_t destination, std::uint16_t source, int length) {
+			checkRange(source, length);
+			checkRange(destination, length);
+			std::memmove(memory.data() + destination, memory.data() + source, length);
+		}
+
+		/* A set on the stack is its words, lowest first, under a word with the number of them. */
+		std::vector<std::uint16_t> popSet() {
+			std::vector<std::uint16_t> result(static_cast<std::uint16_t>(pop()));
+			for (auto & bits : result) {
+				bits = static_cast<std::uint16_t>(pop());
+			}
+			return result;
+		}
+
+		void pushSet(std::vector<std::uint16_t> const & set) {
+			for (std::size_t index = set.size(); index-- != 0;) {
+				push(set[index]);
+			}
+			push(static_cast<int>(set.size()));
+		}
+
+		/* An adjusted set is left without its size. */
+		void adjustSet(int size) {
+			auto set = popSet();
+			set.resize(size);
+			pushSet(set);
+			sp += 2;
+		}
+
+		void makeSet(bool range, int segment, int procedure, int offset) {
+			int high = pop();
+			int low = range ? pop() : high;
+			if (low < 0 || high > 4079) {
+				fault("Set element out of range", segment, procedure, offset);
+			}
+			std::vector<std::uint16_t> set(low <= high ? high / 16 + 1 : 0);
+			for (int element = low; element <= high; ++element) {
+				set[element / 16] |= 1 << (element % 16);
+			}
+			pushSet(set);
+		}
+
+		void inSet() {
+			auto set = popSet();
+			int element = pop();
+			push(element >= 0 && element / 16 < static_cast<int>(set.size()) && (set[element / 16] >> (element % 16) & 1));
+		}
+
+		/* Union is '+', intersection '*' and difference '-'. */
+		void combineSets(char operation) {
+			auto right = popSet();
+			auto left = popSet();
+			auto size = operation == '+' ? std::max(left.size(), right.size()) : left.size();
+			left.resize(size);
+			right.resize(std::max(size, right.size()));
+			for (std::size_t index = 0; index != size; ++index) {
+				left[index] = operation == '+' ? left[index] | right[index] : operation == '*' ? left[index] & right[index] : left[index] & ~right[index];
+			}
+			pushSet(left);
+		}
+
+		void compareSets(bool & leftInRight, bool & rightInLeft) {
+			auto right = popSet();
+			auto left = popSet();
+			leftInRight = true;
+			rightInLeft = true;
+			for (std::size_t index = 0; index != std::max(left.size(), right.size()); ++index) {
+				int leftWord = index < left.size() ? left[index] : 0;
+				int rightWord = index < right.size() ? right[index] : 0;
+				leftInRight = leftInRight && (leftWord & ~rightWord) == 0;
+				rightInLeft = rightInLeft && (rightWord & ~leftWord) == 0;
+			}
+		}
+
+		int loadField(std::uint16_t address, int width, int right, int segment, int procedure, int offset) const {
+			checkField(width, right, segment, procedure, offset);
+			return (static_cast<std::uint16_t>(word(address)) >> right) & ((1u << width) - 1);
+		}
+
+		void storeField(std::uint16_t address, int width, int right, int value, int segment, int procedure, int offset) {
+			checkField(width, right, segment, procedure, offset);
+			unsigned mask = ((1u << width) - 1) << right;
+			setWord(address, (static_cast<std::uint16_t>(word(address)) & ~mask) | ((value << right) & mask));
+		}
+
+		void checkIndex(std::uint16_t text, int index, int segment, int procedure, int offset) const {
+			if (index < 1 || index > memory[text]) {
+				fault("String index out of range", segment, procedure, offset);
+			}
+		}
+
+		void assignString(std::uint16_t destination, std::uint16_t source, int maximum, int segment, int procedure, int offset) {
+			if (source < 256) {
+				memory[destination] = 1;
+				memory[destination + 1] = static_cast<std::uint8_t>(source);
+			} else {
+				if (memory[source] > maximum) {
+					fault("String overflow", segment, procedure, offset);
+				}
+				checkRange(source, memory[source] + 1, segment, procedure, offset);
+				checkRange(destination, memory[source] + 1, segment, procedure, offset);
+				std::memmove(memory.data() + destination, memory.data() + source, memory[source] + 1);
+			}
+		}
+
+		/* Standard procedures that do I/O are stubs, except for writing to the console. */
+		void standardProc(int number, int segment, int procedure, int offset) {
+			switch (number) {
+			case 0:
+				break;
+			case 1: {
+				int size = 2 * pop();
+				std::uint16_t pointer = pop();
+				setWord(pointer, allocate(size));
+				break;
+			}
+			case 2: case 3: {
+				int count = pop();
+				std::uint16_t destination = pop();
+				std::uint16_t source = pop();
+				checkRange(source, count);
+				checkRange(destination, count);
+				for (int index = 0; index < count; ++index) {
+					int at = number == 2 ? index : count - 1 - index;
+					memory[destination + at] = memory[source + at];
+				}
+				break;
+			}
+			case 4:
+				exitProcedure(segment, procedure, offset);
+				break;
+			case 5: case 6: {
+				pop();
+				pop();
+				int length = pop();
+				std::uint16_t buffer = pop();
+				int unit = pop();
+				checkRange(buffer, length);
+				for (int index = 0; index < length; ++index) {
+					if (number == 5) {
+						memory[buffer + index] = 0;
+					} else if (unit == 1 || unit == 2) {
+						std::cout.put(memory[buffer + index] == '\r' ? '\n' : static_cast<char>(memory[buffer + index]));
+					}
+				}
+				break;
+			}
+			case 9: {
+				std::uint16_t low = pop();
+				std::uint16_t high = pop();
+				setWord(low, 0);
+				setWord(high, 0);
+				break;
+			}
+			case 10: {
+				int character = pop();
+				int count = pop();
+				std::uint16_t destination = pop();
+				checkRange(destination, count);
+				std::memset(memory.data() + destination, character, count > 0 ? count : 0);
+				break;
+			}
+			case 12:
+				pop();
+				pop();
+				pop();
+				break;
+			case 21: case 22: case 37: case 38:
+				pop();
+				break;
+			case 23: case 24: {
+				int low = pop();
+				float value = real(pop(), low);
+				value = number == 23 ? std::trunc(value) : std::round(value);
+				if (value < -32768 || value > 32767) {
+					fault("Integer overflow", segment, procedure, offset);
+				}
+				push(static_cast<int>(value));
+				break;
+			}
+			case 25: case 26: case 27: case 28: case 29: case 30: case 31: {
+				int low = pop();
+				float value = real(pop(), low);
+				float (*functions[])(float) = {
+					[](float x) { return std::sin(x); }, [](float x) { return std::cos(x); }, [](float x) { return std::log10(x); },
+					[](float x) { return std::atan(x); }, [](float x) { return std::log(x); }, [](float x) { return std::exp(x); },
+					[](float x) { return std::sqrt(x); },
+				};
+				std::int16_t high;
+				std::int16_t result;
+				split(functions[number - 25](value), high, result);
+				push(high);
+				push(result);
+				break;
+			}
+			case 32:
+				setWord(pop(), heapTop);
+				break;
+			case 33: {
+				std::uint16_t mark = word(pop());
+				heapTop = mark < 0x0100 ? 0x0100 : mark;
+				break;
+			}
+			case 34:
+				push(0);
+				break;
+			case 35:
+				pop();
+				push(0);
+				break;
+			case 36: {
+				std::int16_t high;
+				std::int16_t low;
+				split(std::pow(10.0f, static_cast<float>(pop())), high, low);
+				push(high);
+				push(low);
+				break;
+			}
+			case 39:
+				throw Halt{};
+			case 40:
+				push((sp - heapTop - 0x400) / 2);
+				break;
+			default:
+				fault("Standard procedure isn't supported", segment, procedure, offset);
+			}
+		}
+	};
+
+}
+
+using namespace pcode;
+
+)";
+
+		wstring slot(int index) {
+			return L"s" + to_wstring(index);
+		}
+
+		wstring functionName(int segment, int procedure) {
+			return L"p" + to_wstring(segment) + L"_" + to_wstring(procedure);
+		}
+
+		wchar_t const * comparison(uint8_t opcode) {
+			switch (opcode) {
+			case EQU: case EQUI:
+				return L" == ";
+			case NEQ: case NEQI:
+				return L" != ";
+			case LES: case LESI:
+				return L" < ";
+			case LEQ: case LEQI:
+				return L" <= ";
+			case GRT: case GRTI:
+				return L" > ";
+			default:
+				return L" >= ";
+			}
+		}
+
+		bool isCall(uint8_t opcode) {
+			switch (opcode) {
+			case CXP: case CIP: case CBP: case CLP: case CGP: case CSP:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		int wordAt(uint8_t const * address) {
+			return static_cast<int16_t>(address[0] | address[1] << 8);
+		}
+
+	}
+
+	bool PcodeTranslator::translate = false;
+
+	/* Segments are placed in memory in the same way as the p-machine places them. The number of
+	   results of a function is taken from its first return. */
+	PcodeTranslator::PcodeTranslator(PcodeFile const & file) {
+		uint32_t bottom = MEMORY_SIZE;
+		for (auto & segment : file.getSegments()) {
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			auto codePart = codeSegment ? codeSegment->getCodePart() : nullptr;
+			if (codePart && codePart->getProcedures() && codeSegment->getMachineType() == MachineType::pcode_little && !images.count(codeSegment->getSegmentNumber())) {
+				auto size = static_cast<uint32_t>(codePart->end() - codePart->begin());
+				if (size + STACK_MARGIN > bottom - HEAP_BOTTOM) {
+					throw runtime_error("Not enough p-machine memory to load the code file");
+				}
+				bottom = (bottom - size) & ~1u;
+				images[codeSegment->getSegmentNumber()] = { static_cast<uint16_t>(bottom), codeSegment };
+				for (auto & procedure : *codePart->getProcedures()) {
+					if (auto pcodeProcedure = dynamic_cast<PcodeProcedure const *>(procedure.get())) {
+						auto & instructions = pcodeProcedure->getFlowGraph().getInstructions();
+						auto ret = find_if(instructions.begin(), instructions.end(), [](auto & instruction) { return instruction.format() == PcodeFormat::procedureReturn; });
+						auto address = static_cast<uint16_t>(bottom + (procedure->getProcBegin() - codePart->begin()));
+						routines[{ codeSegment->getSegmentNumber(), procedure->getProcedureNumber() }] = { codeSegment, pcodeProcedure, address, ret == instructions.end() ? 0 : ret->operand1 };
+						exits = exits || any_of(instructions.begin(), instructions.end(), [](auto & instruction) { return instruction.opcode == CSP && instruction.operand1 == 4; });
+					}
+				}
+			}
+		}
+	}
+
+	/* Nothing when the effect on the stack isn't known before the code runs. */
+	std::optional<PcodeTranslator::StackEffect> PcodeTranslator::stackEffect(PcodeInstruction const & instruction, int segment) const {
+		auto call = [&](int calledSegment, int procedure) -> optional<StackEffect> {
+			auto callee = routines.find({ calledSegment, procedure });
+			if (callee == routines.end()) {
+				return nullopt;
+			}
+			return StackEffect{ callee->second.procedure->getParameterSize() / 2, callee->second.results };
+		};
+		auto opcode = instruction.opcode;
+		if (opcode < ABI || opcode >= SLDL_1) {
+			return StackEffect{ opcode >= SIND_0, 1 };
+		}
+		switch (opcode) {
+		case LDCI: case LDCN: case LDL: case LLA: case LDO: case LAO: case LOD: case LDA: case LDE: case LAE: case LSA: case LPA:
+			return StackEffect{ 0, 1 };
+		case STL: case SRO: case STR: case STE: case FJP: case XJP:
+			return StackEffect{ 1, 0 };
+		case IND: case INC: case ABI: case NGI: case SQI: case LNOT:
+			return StackEffect{ 1, 1 };
+		case IXA: case ADI: case SBI: case MPI: case DVI: case MODI: case LAND: case LOR: case LDB:
+		case EQUI: case NEQI: case LESI: case LEQI: case GRTI: case GEQI:
+			return StackEffect{ 2, 1 };
+		case STO: case MOV: case SAS: case EFJ: case NFJ:
+			return StackEffect{ 2, 0 };
+		case STB:
+			return StackEffect{ 3, 0 };
+		case LDC:
+			return StackEffect{ 0, instruction.operand1 };
+		case LDM:
+			return StackEffect{ 1, instruction.operand1 };
+		case STM:
+			return StackEffect{ instruction.operand1 + 1, 0 };
+		case LDP: case CHK:
+			return StackEffect{ 3, 1 };
+		case STP:
+			return StackEffect{ 4, 0 };
+		case IXP:
+			return StackEffect{ 2, 3 };
+		case IXS:
+			return StackEffect{ 2, 2 };
+		case ABR: case NGR: case SQR:
+			return StackEffect{ 2, 2 };
+		case ADR: case SBR: case MPR: case DVR:
+			return StackEffect{ 4, 2 };
+		case FLT:
+			return StackEffect{ 1, 2 };
+		case FLO:
+			return StackEffect{ 3, 4 };
+		case EQU: case NEQ: case LES: case LEQ: case GRT: case GEQ:
+			switch (instruction.operand1) {
+			case 2:
+				return StackEffect{ 4, 1 };
+			case 4: case 6: case 10: case 12:
+				return StackEffect{ 2, 1 };
+			default:
+				return nullopt;
+			}
+		case UJP: case BPT: case NOP: case XIT: case RNP: case RBP:
+			return StackEffect{ 0, 0 };
+		case CSP: {
+			auto effect = standardProcEffects.find(instruction.operand1);
+			return effect == standardProcEffects.end() ? nullopt : optional<StackEffect>{ { effect->second.first, effect->second.second } };
+		}
+		case CXP:
+			return call(instruction.operand1, instruction.operand2);
+		case CIP: case CBP: case CLP: case CGP:
+			return call(segment, instruction.operand1);
+		default:
+			return nullopt;
+		}
+	}
+
+	/* The depth before each instruction, or -1 if it can't be reached, found breadth first from
+	   the entry point. Every path to an instruction must reach it with the same depth. */
+	std::optional<std::wstring> PcodeTranslator::stackDepths(Routine const & routine, std::vector<int> & depths) const {
+		auto & flowGraph = routine.procedure->getFlowGraph();
+		auto & instructions = flowGraph.getInstructions();
+		auto begin = routine.procedure->getProcBegin();
+		depths.assign(instructions.size(), -1);
+		vector<int32_t> indexAt(routine.procedure->getSize() + 1, -1);
+		for (size_t index = 0; index != instructions.size(); ++index) {
+			indexAt[instructions[index].offset] = static_cast<int32_t>(index);
+		}
+		auto hex = [](int offset) {
+			wostringstream text;
+			text << setfill(L'0') << setw(4) << std::hex << offset;
+			return text.str();
+		};
+
+		deque<pair<int32_t, int>> work{ { indexAt[routine.procedure->getEnterIc() - begin], 0 } };
+		while (!work.empty()) {
+			auto [index, depth] = work.front();
+			work.pop_front();
+			if (index < 0) {
+				return L"a branch to an offset that isn't an instruction";
+			}
+			if (static_cast<size_t>(index) == instructions.size()) {
+				return L"code that runs past the end of the procedure";
+			}
+			if (depths[index] >= 0) {
+				if (depths[index] != depth) {
+					return L"different stack depths at " + hex(instructions[index].offset);
+				}
+				continue;
+			}
+			depths[index] = depth;
+			auto & instruction = instructions[index];
+			auto effect = stackEffect(instruction, routine.segment->getSegmentNumber());
+			if (!effect) {
+				return pcodeOpcodes[instruction.opcode].mnemonic + wstring(L" at ") + hex(instruction.offset) + L" with an effect on the stack that isn't known";
+			}
+			if (depth < effect->pops) {
+				return L"a stack underflow at " + hex(instruction.offset);
+			}
+			auto next = depth - effect->pops + effect->pushes;
+			for (auto target : flowGraph.targets(instruction)) {
+				work.push_back({ indexAt[target], next });
+			}
+			switch (instruction.opcode) {
+			case UJP: case XJP: case RNP: case RBP: case XIT:
+				break;
+			default:
+				work.push_back({ static_cast<int32_t>(index + 1), next });
+				break;
+			}
+		}
+		return nullopt;
+	}
+
+	void PcodeTranslator::write(std::wostream & os, std::wstring const & name, int segment, int procedure) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		os << L"// Translated from the p-code of " << name << endl << endl;
+		os << runtime;
+		for (auto & [number, image] : images) {
+			auto codePart = image.second->getCodePart();
+			os << L"static std::uint8_t const segment" << dec << number << L"[] = {";
+			for (auto byte = codePart->begin(); byte != codePart->end(); ++byte) {
+				os << ((byte - codePart->begin()) % 16 ? L" " : L"\n\t") << L"0x" << hex << setfill(L'0') << setw(2) << *byte << L",";
+			}
+			os << dec << endl << L"};" << endl << endl;
+		}
+		for (auto & [key, routine] : routines) {
+			os << L"void " << functionName(key.first, key.second) << L"(Machine & m);" << endl;
+		}
+		os << endl;
+		for (auto & [key, routine] : routines) {
+			writeRoutine(os, key, routine);
+		}
+
+		auto entry = routines.find({ segment, procedure });
+		os << L"int main() {" << endl;
+		os << L"\ttry {" << endl;
+		os << L"\t\tMachine m;" << endl;
+		uint16_t bottom = 0;
+		for (auto & [number, image] : images) {
+			os << L"\t\tm.load(" << image.first << L", segment" << number << L", sizeof segment" << number << L");" << endl;
+			bottom = bottom && bottom < image.first ? bottom : image.first;
+		}
+		if (entry == routines.end()) {
+			os << L"\t\tthrow std::runtime_error(\"P-machine fault: No p-code procedure " << segment << L"." << procedure << L"\");" << endl;
+		} else {
+			os << L"\t\tm.sp = " << bottom - entry->second.procedure->getParameterSize() << L";" << endl;
+			os << L"\t\t" << functionName(segment, procedure) << L"(m);" << endl;
+		}
+		os << L"\t} catch (Halt &) {" << endl;
+		os << L"\t} catch (std::exception & ex) {" << endl;
+		os << L"\t\tstd::cout.flush();" << endl;
+		os << L"\t\tstd::cerr << ex.what() << std::endl;" << endl;
+		os << L"\t\treturn 1;" << endl;
+		os << L"\t}" << endl;
+		os << L"\treturn 0;" << endl;
+		os << L"}" << endl;
+	}
+
+	/* Instructions that branch to each other are labelled with their offsets. A procedure with a
+	   branch that isn't to an instruction is one that the p-machine won't decode, so it faults. */
+	void PcodeTranslator::writeRoutine(std::wostream & os, Key key, Routine const & routine) const {
+		auto & procedure = *routine.procedure;
+		auto & flowGraph = procedure.getFlowGraph();
+		auto & instructions = flowGraph.getInstructions();
+		auto label = [](int offset) {
+			wostringstream text;
+			text << L"L" << setfill(L'0') << setw(4) << hex << offset;
+			return text.str();
+		};
+		os << L"/* " << key.first << L"." << key.second << L" " << boost::trim_copy(routine.segment->getName()) << L" */" << endl;
+		os << L"void " << functionName(key.first, key.second) << L"(Machine & m) {" << endl;
+		vector<int32_t> indexAt(procedure.getSize() + 1, -1);
+		for (size_t index = 0; index != instructions.size(); ++index) {
+			indexAt[instructions[index].offset] = static_cast<int32_t>(index);
+		}
+		auto enter = procedure.getEnterIc() - procedure.getProcBegin();
+		auto exit = procedure.getExitIc() - procedure.getProcBegin();
+		auto isInstruction = [&](intptr_t offset) {
+			return offset >= 0 && offset < static_cast<intptr_t>(indexAt.size()) && indexAt[offset] >= 0;
+		};
+		auto branches = all_of(instructions.begin(), instructions.end(), [&](auto & instruction) {
+			auto targets = flowGraph.targets(instruction);
+			return all_of(targets.begin(), targets.end(), isInstruction);
+		});
+		if (!branches || !isInstruction(enter) || !isInstruction(exit)) {
+			os << L"\t// Not translated: a branch to an offset that isn't an instruction" << endl;
+			os << L"\tm.fault(\"Procedure wasn't translated\", " << key.first << L", " << key.second << L", 0);" << endl;
+			os << L"}" << endl << endl;
+			return;
+		}
+
+		vector<int> depths;
+		auto reason = stackDepths(routine, depths);
+		if (reason) {
+			os << L"\t// Operand stack in memory: " << *reason << endl;
+		}
+		auto written = [&](size_t index) {
+			return reason || depths[index] >= 0;
+		};
+		/* Calls in memory use no slots. */
+		auto maximum = 0;
+		for (size_t index = 0; index != instructions.size(); ++index) {
+			auto effect = stackEffect(instructions[index], key.first);
+			if (effect && reason && !isCall(instructions[index].opcode)) {
+				maximum = max({ maximum, effect->pops, effect->pushes });
+			} else if (effect && depths[index] >= 0) {
+				maximum = max({ maximum, depths[index], depths[index] - effect->pops + effect->pushes });
+			}
+		}
+		os << L"\t[[maybe_unused]] std::uint16_t const locals = m.enter(" << static_cast<int>(static_cast<int8_t>(procedure.getLexicalLevel().value_or(0))) << L", " << procedure.getDataSize();
+		os << L", " << procedure.getParameterSize() << L", " << key.first << L", " << key.second << L");" << endl;
+		if (maximum) {
+			os << L"\tstd::int16_t ";
+			for (int index = 0; index != maximum; ++index) {
+				os << (index ? L", " : L"") << slot(index) << L" = 0";
+			}
+			os << L";" << endl;
+		}
+		if (exits) {
+			os << L"\tstd::size_t const frame = m.frames.size() - 1;" << endl;
+			os << L"\tbool exiting = false;" << endl;
+			os << L"\tfor (;;) try {" << endl;
+			if (written(indexAt[exit])) {
+				os << L"\tif (exiting) goto " << label(static_cast<int>(exit)) << L";" << endl;
+			} else {
+				os << L"\tif (exiting) m.fault(\"Exit to code that isn't reached\", " << key.first << L", " << key.second << L", " << exit << L");" << endl;
+			}
+		}
+		if (enter != 0) {
+			os << L"\tgoto " << label(static_cast<int>(enter)) << L";" << endl;
+		}
+		for (size_t index = 0; index != instructions.size(); ++index) {
+			if (!written(index)) {
+				continue;
+			}
+			auto & instruction = instructions[index];
+			if (flowGraph.isTarget(instruction.offset) || (enter != 0 && instruction.offset == enter) || (exits && instruction.offset == exit)) {
+				os << label(instruction.offset) << L":" << endl;
+			}
+			if (reason) {
+				writeMemoryInstruction(os, key, routine, instruction);
+			} else {
+				writeInstruction(os, key, routine, instruction, depths[index]);
+			}
+		}
+		if (reason && !instructions.empty()) {
+			switch (instructions.back().opcode) {
+			case UJP: case XJP: case RNP: case RBP: case XIT:
+				break;
+			default:
+				os << L"\tm.fault(\"Ran past the end of the procedure\", " << key.first << L", " << key.second << L", " << instructions.back().offset << L");" << endl;
+				break;
+			}
+		}
+		if (exits) {
+			os << L"\t} catch (Exit & exited) {" << endl;
+			os << L"\t\tif (exited.frame != frame) throw;" << endl;
+			os << L"\t\tm.unwind(frame);" << endl;
+			os << L"\t\texiting = true;" << endl;
+			os << L"\t}" << endl;
+		}
+		os << L"}" << endl << endl;
+	}
+
+	/* An instruction with a known effect on the stack takes its operands from the stack in
+	   memory into slots, and puts its results back. Calls leave their parameters and results
+	   where they are. */
+	void PcodeTranslator::writeMemoryInstruction(std::wostream & os, Key key, Routine const & routine, PcodeInstruction const & instruction) const {
+		auto location = to_wstring(key.first) + L", " + to_wstring(key.second) + L", " + to_wstring(instruction.offset);
+		auto fault = [&](wstring const & reason) {
+			os << L"\tm.fault(\"" << reason << L"\", " << location << L");" << endl;
+		};
+		auto call = [&](int segment, int procedureNumber) {
+			if (routines.count({ segment, procedureNumber })) {
+				os << L"\t" << functionName(segment, procedureNumber) << L"(m);" << endl;
+			} else {
+				fault(L"No p-code procedure " + to_wstring(segment) + L"." + to_wstring(procedureNumber));
+			}
+		};
+		auto opcode = instruction.opcode;
+		auto operand1 = instruction.operand1;
+		switch (opcode) {
+		case CXP:
+			call(operand1, instruction.operand2);
+			return;
+		case CIP: case CBP: case CLP: case CGP:
+			call(key.first, operand1);
+			return;
+		case CSP:
+			os << L"\tm.standardProc(" << operand1 << L", " << location << L");" << endl;
+			return;
+		case ADJ:
+			os << L"\tm.adjustSet(" << operand1 << L");" << endl;
+			return;
+		case SGS: case SRS:
+			os << L"\tm.makeSet(" << (opcode == SRS ? L"true" : L"false") << L", " << location << L");" << endl;
+			return;
+		case INN:
+			os << L"\tm.inSet();" << endl;
+			return;
+		case UNI: case INT: case DIF:
+			os << L"\tm.combineSets('" << (opcode == UNI ? L'+' : opcode == INT ? L'*' : L'-') << L"');" << endl;
+			return;
+		case EQU: case NEQ: case LES: case LEQ: case GRT: case GEQ:
+			if (operand1 != 8) {
+				if (!stackEffect(instruction, key.first)) {
+					fault(L"Invalid comparison type " + to_wstring(operand1));
+					return;
+				}
+			} else {
+				if (opcode == LES || opcode == GRT) {
+					fault(L"Invalid set comparison");
+					return;
+				}
+				wchar_t const * truth = opcode == EQU ? L"leftInRight && rightInLeft" : opcode == NEQ ? L"!(leftInRight && rightInLeft)" : opcode == LEQ ? L"leftInRight" : L"rightInLeft";
+				os << L"\t{" << endl << L"\t\tbool leftInRight;" << endl << L"\t\tbool rightInLeft;" << endl;
+				os << L"\t\tm.compareSets(leftInRight, rightInLeft);" << endl;
+				os << L"\t\tm.push(" << truth << L");" << endl << L"\t}" << endl;
+				return;
+			}
+			break;
+		default:
+			break;
+		}
+		auto effect = stackEffect(instruction, key.first);
+		if (!effect) {
+			fault(L"Invalid opcode " + to_wstring(opcode));
+			return;
+		}
+		for (int index = effect->pops - 1; index >= 0; --index) {
+			os << L"\t" << slot(index) << L" = m.pop();" << endl;
+		}
+		writeInstruction(os, key, routine, instruction, effect->pops);
+		for (int index = 0; index != effect->pushes; ++index) {
+			os << L"\tm.push(" << slot(index) << L");" << endl;
+		}
+	}
+
+	/* The slot of the top of the stack is one less than the depth. Words on the stack are in
+	   slots from the bottom up, so the top of the stack is at the lowest address when they are
+	   pushed on the stack in memory. */
+	void PcodeTranslator::writeInstruction(std::wostream & os, Key key, Routine const & routine, PcodeInstruction const & instruction, int depth) const {
+		auto & procedure = *routine.procedure;
+		auto & flowGraph = procedure.getFlowGraph();
+		auto top = depth - 1;
+		auto s = [](int index) { return slot(index); };
+		auto location = to_wstring(key.first) + L", " + to_wstring(key.second) + L", " + to_wstring(instruction.offset);
+		auto label = [](int offset) {
+			wostringstream text;
+			text << L"L" << setfill(L'0') << setw(4) << hex << offset;
+			return text.str();
+		};
+		auto fault = [&](wstring const & condition, wchar_t const * reason) {
+			os << L"\tif (" << condition << L") m.fault(\"" << reason << L"\", " << location << L");" << endl;
+		};
+		auto spill = [&](int count) {
+			for (int index = depth - count; index != depth; ++index) {
+				os << L"\tm.push(" << s(index) << L");" << endl;
+			}
+		};
+		auto reload = [&](int first, int count) {
+			for (int index = first + count - 1; index >= first; --index) {
+				os << L"\t" << s(index) << L" = m.pop();" << endl;
+			}
+		};
+		auto call = [&](int segment, int procedureNumber) {
+			auto & callee = routines.at({ segment, procedureNumber });
+			auto parameters = callee.procedure->getParameterSize() / 2;
+			spill(parameters);
+			os << L"\t" << functionName(segment, procedureNumber) << L"(m);" << endl;
+			reload(depth - parameters, callee.results);
+		};
+		auto binary = [&](wchar_t const * operation) {
+			os << L"\t" << s(top - 1) << L" = " << s(top - 1) << operation << s(top) << L";" << endl;
+		};
+		auto real = [&](int high) {
+			return L"Machine::real(" + s(high) + L", " + s(high + 1) + L")";
+		};
+		auto realResult = [&](int high, wstring const & value) {
+			os << L"\tMachine::split(" << value << L", " << s(high) << L", " << s(high + 1) << L");" << endl;
+		};
+
+		auto opcode = instruction.opcode;
+		auto operand1 = instruction.operand1;
+		auto operand2 = instruction.operand2;
+		if (opcode < ABI) {
+			os << L"\t" << s(depth) << L" = " << opcode << L";" << endl;
+			return;
+		}
+		if (opcode >= SLDL_1) {
+			if (opcode >= SIND_0) {
+				os << L"\t" << s(top) << L" = m.word(" << s(top) << L" + " << 2 * (opcode - SIND_0) << L");" << endl;
+			} else if (opcode >= SLDO_1) {
+				os << L"\t" << s(depth) << L" = m.word(m.globals + " << 2 * (opcode - SLDO_1) << L");" << endl;
+			} else {
+				os << L"\t" << s(depth) << L" = m.word(locals + " << 2 * (opcode - SLDL_1) << L");" << endl;
+			}
+			return;
+		}
+		switch (opcode) {
+		case LDCI:
+			os << L"\t" << s(depth) << L" = " << operand1 << L";" << endl;
+			break;
+		case LDCN:
+			os << L"\t" << s(depth) << L" = 0;" << endl;
+			break;
+		case LDL:
+			os << L"\t" << s(depth) << L" = m.word(locals + " << 2 * (operand1 - 1) << L");" << endl;
+			break;
+		case LLA:
+			os << L"\t" << s(depth) << L" = locals + " << 2 * (operand1 - 1) << L";" << endl;
+			break;
+		case STL:
+			os << L"\tm.setWord(locals + " << 2 * (operand1 - 1) << L", " << s(top) << L");" << endl;
+			break;
+		case LDO:
+			os << L"\t" << s(depth) << L" = m.word(m.globals + " << 2 * (operand1 - 1) << L");" << endl;
+			break;
+		case LAO:
+			os << L"\t" << s(depth) << L" = m.globals + " << 2 * (operand1 - 1) << L";" << endl;
+			break;
+		case SRO:
+			os << L"\tm.setWord(m.globals + " << 2 * (operand1 - 1) << L", " << s(top) << L");" << endl;
+			break;
+		case LOD:
+			os << L"\t" << s(depth) << L" = m.word(m.intermediate(" << operand1 << L") + " << 2 * (operand2 - 1) << L");" << endl;
+			break;
+		case LDA:
+			os << L"\t" << s(depth) << L" = m.intermediate(" << operand1 << L") + " << 2 * (operand2 - 1) << L";" << endl;
+			break;
+		case STR:
+			os << L"\tm.setWord(m.intermediate(" << operand1 << L") + " << 2 * (operand2 - 1) << L", " << s(top) << L");" << endl;
+			break;
+		case LDE: case LAE: case STE: {
+			auto outer = routines.find({ operand1, 1 });
+			auto address = L"m.segmentGlobals(" + to_wstring(operand1) + L", " + to_wstring(outer == routines.end() ? 0 : outer->second.procedure->getDataSize()) + L") + " + to_wstring(2 * (operand2 - 1));
+			if (opcode == LDE) {
+				os << L"\t" << s(depth) << L" = m.word(" << address << L");" << endl;
+			} else if (opcode == LAE) {
+				os << L"\t" << s(depth) << L" = " << address << L";" << endl;
+			} else {
+				os << L"\tm.setWord(" << address << L", " << s(top) << L");" << endl;
+			}
+			break;
+		}
+		case LSA: case LPA:
+			os << L"\t" << s(depth) << L" = " << routine.address + operand2 - (opcode == LSA) << L";" << endl;
+			break;
+		case LDC:
+			for (int word = 0; word != operand1; ++word) {
+				os << L"\t" << s(depth + word) << L" = " << wordAt(procedure.getProcBegin() + operand2 + 2 * word) << L";" << endl;
+			}
+			break;
+		case IND:
+			os << L"\t" << s(top) << L" = m.word(" << s(top) << L" + " << 2 * operand1 << L");" << endl;
+			break;
+		case INC:
+			os << L"\t" << s(top) << L" = " << s(top) << L" + " << 2 * operand1 << L";" << endl;
+			break;
+		case IXA:
+			os << L"\t" << s(top - 1) << L" = " << s(top - 1) << L" + " << 2 * operand1 << L" * " << s(top) << L";" << endl;
+			break;
+		case STO:
+			os << L"\tm.setWord(" << s(top - 1) << L", " << s(top) << L");" << endl;
+			break;
+		case LDM:
+			os << L"\t{" << endl << L"\t\tstd::uint16_t address = " << s(top) << L";" << endl;
+			for (int word = 0; word != operand1; ++word) {
+				os << L"\t\t" << s(top + operand1 - 1 - word) << L" = m.word(address + " << 2 * word << L");" << endl;
+			}
+			os << L"\t}" << endl;
+			break;
+		case STM:
+			for (int word = 0; word != operand1; ++word) {
+				os << L"\tm.setWord(" << s(top - operand1) << L" + " << 2 * word << L", " << s(top - word) << L");" << endl;
+			}
+			break;
+		case MOV:
+			os << L"\tm.move(" << s(top - 1) << L", " << s(top) << L", " << 2 * operand1 << L");" << endl;
+			break;
+		case LDB:
+			os << L"\t" << s(top - 1) << L" = m.byte(" << s(top - 1) << L" + " << s(top) << L");" << endl;
+			break;
+		case STB:
+			os << L"\tm.setByte(" << s(top - 2) << L" + " << s(top - 1) << L", " << s(top) << L");" << endl;
+			break;
+		case LDP:
+			os << L"\t" << s(top - 2) << L" = m.loadField(" << s(top - 2) << L", " << s(top - 1) << L", " << s(top) << L", " << location << L");" << endl;
+			break;
+		case STP:
+			os << L"\tm.storeField(" << s(top - 3) << L", " << s(top - 2) << L", " << s(top - 1) << L", " << s(top) << L", " << location << L");" << endl;
+			break;
+		case IXP:
+			if (operand1 == 0) {
+				os << L"\tm.fault(\"Packed array with no elements in a word\", " << location << L");" << endl;
+				break;
+			}
+			os << L"\t{" << endl << L"\t\tint index = " << s(top) << L";" << endl;
+			os << L"\t\t" << s(top - 1) << L" = " << s(top - 1) << L" + 2 * (index / " << operand1 << L");" << endl;
+			os << L"\t\t" << s(top) << L" = " << operand2 << L";" << endl;
+			os << L"\t\t" << s(top + 1) << L" = index % " << operand1 << L" * " << operand2 << L";" << endl;
+			os << L"\t}" << endl;
+			break;
+		case IXS:
+			os << L"\tm.checkIndex(" << s(top - 1) << L", " << s(top) << L", " << location << L");" << endl;
+			break;
+		case SAS:
+			os << L"\tm.assignString(" << s(top - 1) << L", " << s(top) << L", " << operand1 << L", " << location << L");" << endl;
+			break;
+		case ABI:
+			os << L"\t" << s(top) << L" = " << s(top) << L" < 0 ? -" << s(top) << L" : " << s(top) << L";" << endl;
+			break;
+		case ADI:
+			binary(L" + ");
+			break;
+		case SBI:
+			binary(L" - ");
+			break;
+		case MPI:
+			binary(L" * ");
+			break;
+		case DVI: case MODI:
+			fault(s(top) + L" == 0", L"Divide by zero");
+			binary(opcode == DVI ? L" / " : L" % ");
+			break;
+		case NGI:
+			os << L"\t" << s(top) << L" = -" << s(top) << L";" << endl;
+			break;
+		case SQI:
+			os << L"\t" << s(top) << L" = " << s(top) << L" * " << s(top) << L";" << endl;
+			break;
+		case LAND:
+			binary(L" & ");
+			break;
+		case LOR:
+			binary(L" | ");
+			break;
+		case LNOT:
+			os << L"\t" << s(top) << L" = ~" << s(top) << L";" << endl;
+			break;
+		case CHK:
+			fault(s(top - 2) + L" < " + s(top - 1) + L" || " + s(top - 2) + L" > " + s(top), L"Value range error");
+			break;
+		case EQUI: case NEQI: case LESI: case LEQI: case GRTI: case GEQI:
+			binary(comparison(opcode));
+			break;
+		case EQU: case NEQ: case LES: case LEQ: case GRT: case GEQ:
+			switch (operand1) {
+			case 2:
+				os << L"\t" << s(depth - 4) << L" = " << real(depth - 4) << comparison(opcode) << real(depth - 2) << L";" << endl;
+				break;
+			case 4:
+				os << L"\t" << s(top - 1) << L" = m.compareStrings(" << s(top - 1) << L", " << s(top) << L", " << location << L")" << comparison(opcode) << L"0;" << endl;
+				break;
+			case 6:
+				os << L"\t" << s(top - 1) << L" = (" << s(top - 1) << L" & 1)" << comparison(opcode) << L"(" << s(top) << L" & 1);" << endl;
+				break;
+			default:
+				os << L"\t" << s(top - 1) << L" = m.compareBytes(" << s(top - 1) << L", " << s(top) << L", " << (operand1 == 10 ? operand2 : 2 * operand2) << L")" << comparison(opcode) << L"0;" << endl;
+				break;
+			}
+			break;
+		case ABR:
+			realResult(top - 1, L"std::fabs(" + real(top - 1) + L")");
+			break;
+		case NGR:
+			realResult(top - 1, L"-" + real(top - 1));
+			break;
+		case SQR:
+			realResult(top - 1, real(top - 1) + L" * " + real(top - 1));
+			break;
+		case ADR: case SBR: case MPR: case DVR: {
+			wchar_t const * operation = opcode == ADR ? L" + " : opcode == SBR ? L" - " : opcode == MPR ? L" * " : L" / ";
+			if (opcode == DVR) {
+				fault(real(depth - 2) + L" == 0", L"Divide by zero");
+			}
+			realResult(depth - 4, real(depth - 4) + operation + real(depth - 2));
+			break;
+		}
+		case FLT:
+			realResult(top, L"static_cast<float>(" + s(top) + L")");
+			break;
+		case FLO:
+			os << L"\t{" << endl << L"\t\tfloat right = " << real(depth - 2) << L";" << endl;
+			os << L"\t\tMachine::split(static_cast<float>(" << s(depth - 3) << L"), " << s(depth - 3) << L", " << s(depth - 2) << L");" << endl;
+			os << L"\t\tMachine::split(right, " << s(depth - 1) << L", " << s(depth) << L");" << endl;
+			os << L"\t}" << endl;
+			break;
+		case UJP:
+			os << L"\tgoto " << label(operand1) << L";" << endl;
+			break;
+		case FJP:
+			os << L"\tif (!(" << s(top) << L" & 1)) goto " << label(operand1) << L";" << endl;
+			break;
+		case EFJ: case NFJ:
+			os << L"\tif (" << s(top - 1) << (opcode == EFJ ? L" != " : L" == ") << s(top) << L") goto " << label(operand1) << L";" << endl;
+			break;
+		case XJP: {
+			auto targets = flowGraph.targets(instruction);
+			os << L"\tswitch (" << s(top) << L") {" << endl;
+			for (int value = operand1; value <= operand2; ++value) {
+				os << L"\tcase " << value << L": goto " << label(targets.begin()[value - operand1 + 1]) << L";" << endl;
+			}
+			os << L"\tdefault: goto " << label(*targets.begin()) << L";" << endl;
+			os << L"\t}" << endl;
+			break;
+		}
+		case CXP:
+			call(operand1, operand2);
+			break;
+		case CIP: case CBP: case CLP: case CGP:
+			call(key.first, operand1);
+			break;
+		case CSP: {
+			auto effect = standardProcEffects.at(operand1);
+			spill(effect.first);
+			os << L"\tm.standardProc(" << operand1 << L", " << location << L");" << endl;
+			reload(depth - effect.first, effect.second);
+			break;
+		}
+		case RNP: case RBP:
+			os << L"\tm.leave(" << operand1 << L", " << location << L");" << endl;
+			os << L"\treturn;" << endl;
+			break;
+		case XIT:
+			os << L"\tthrow Halt{};" << endl;
+			break;
+		default:
+			break;
+		}
+	}
+
+}
@@ -0,0 +1,83 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _8E514432_241D_493F_B114_0AC85B6D4BBE
+#define _8E514432_241D_493F_B114_0AC85B6D4BBE
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include <utility>
+#include <cstdint>
+
+namespace pcodedump {
+
+	class PcodeFile;
+	class CodeSegment;
+	class PcodeProcedure;
+	struct PcodeInstruction;
+
+	/* Translates the p-code procedures of a code file into a C++ program that runs them natively,
+	   with the same memory layout as the p-machine. Each procedure becomes a function. The depth
+	   of the operand stack at each instruction is found by following the flow graph, so that
+	   the words on the stack become locals of the function. Branches become gotos, case jumps
+	   become switches and calls become direct calls.
+
+	   A procedure where the depth of the stack isn't known, because it uses sets or exits, or
+	   calls a procedure that isn't in the file, keeps its operand stack in memory as the
+	   p-machine does. If any procedure exits, every function catches the exit of its own frame
+	   and resumes at its exit code. */
+	class PcodeTranslator {
+	public:
+		explicit PcodeTranslator(PcodeFile const & file);
+
+		/* A program that runs a procedure with no parameters. */
+		void write(std::wostream & os, std::wstring const & name, int segment, int procedure) const;
+
+	private:
+		struct Routine {
+			CodeSegment const * segment;
+			PcodeProcedure const * procedure;
+			std::uint16_t address;
+			int results;
+		};
+
+		struct StackEffect {
+			int pops;
+			int pushes;
+		};
+
+		using Key = std::pair<int, int>;
+
+		std::optional<StackEffect> stackEffect(PcodeInstruction const & instruction, int segment) const;
+		std::optional<std::wstring> stackDepths(Routine const & routine, std::vector<int> & depths) const;
+		void writeRoutine(std::wostream & os, Key key, Routine const & routine) const;
+		void writeInstruction(std::wostream & os, Key key, Routine const & routine, PcodeInstruction const & instruction, int depth) const;
+		void writeMemoryInstruction(std::wostream & os, Key key, Routine const & routine, PcodeInstruction const & instruction) const;
+
+		std::map<Key, Routine> routines;
+		std::map<int, std::pair<std::uint16_t, CodeSegment const *>> images;
+		bool exits = false;
+
+	public:
+		static bool translate;
+	};
+
+}
+
+#endif // !_8E514432_241D_493F_B114_0AC85B6D4BBE
@@ -38,8 +38,28 @@ namespace pcodedump {
         return *reinterpret_cast<T const *>(address);
     }
 
-    inline std::uint8_t const * derefSelfPtr(void const * selfPtr) {
-		return static_cast<std::uint8_t const *>(selfPtr) - *reinterpret_cast<boost::endian::little_int16_t const *>(selfPtr);
+	/* The byte order of the words of a segment. Code that reads words is a template on one of
+	   these, so that each byte order has its own instantiation and the choice between them is
+	   made once, not for every word. Low and high are the indices of the bytes of a word. */
+	struct LittleEndian {
+		using int16_t = boost::endian::little_int16_t;
+		using uint16_t = boost::endian::little_uint16_t;
+		using uint64_t = boost::endian::little_uint64_t;
+		static constexpr int low = 0;
+		static constexpr int high = 1;
+	};
+
+	struct BigEndian {
+		using int16_t = boost::endian::big_int16_t;
+		using uint16_t = boost::endian::big_uint16_t;
+		using uint64_t = boost::endian::big_uint64_t;
+		static constexpr int low = 1;
+		static constexpr int high = 0;
+	};
+
+	template <typename Endian = LittleEndian>
+	inline std::uint8_t const * derefSelfPtr(void const * selfPtr) {
+		return static_cast<std::uint8_t const *>(selfPtr) - *reinterpret_cast<typename Endian::int16_t const *>(selfPtr);
 	}
 
 	template <typename T>
@@ -0,0 +1,186 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "volume.hpp"
+#include "textio.hpp"
+
+#include <map>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+
+using namespace std;
+using namespace boost::endian;
+
+namespace pcodedump {
+
+	namespace {
+
+		map<FileKind, wstring> fileKindNames = {
+			{FileKind::untyped,   L"UNTYPED"},
+			{FileKind::badBlocks, L"BAD"},
+			{FileKind::code,      L"CODE"},
+			{FileKind::text,      L"TEXT"},
+			{FileKind::info,      L"INFO"},
+			{FileKind::data,      L"DATA"},
+			{FileKind::graf,      L"GRAF"},
+			{FileKind::foto,      L"FOTO"},
+			{FileKind::secureDir, L"SECUREDIR"},
+		};
+
+		wchar_t const * const monthNames[] = {
+			L"???", L"Jan", L"Feb", L"Mar", L"Apr", L"May", L"Jun",
+			L"Jul", L"Aug", L"Sep", L"Oct", L"Nov", L"Dec", L"???", L"???", L"???",
+		};
+
+		/* Directory names are stored as a length byte followed by the characters. */
+		wstring readName(char const * field, int maxLength) {
+			int length = min<int>(static_cast<uint8_t>(field[0]), maxLength);
+			return wstring{ field + 1, field + 1 + length };
+		}
+	}
+
+	std::wostream& operator<<(std::wostream& os, const FileKind& value) {
+		auto name = fileKindNames.find(value);
+		os << (name != fileKindNames.end() ? name->second : L"UNKNOWN");
+		return os;
+	}
+
+	PascalDate::PascalDate(uint16_t value) :
+		year{ value >> 9 }, month{ value & 0xf }, day{ (value >> 4) & 0x1f }
+	{
+	}
+
+	std::wostream& operator<<(std::wostream& os, const PascalDate& value) {
+		FmtSentry<wostream::char_type> sentry{ os };
+		if (value.valid()) {
+			os << dec << setfill(L' ') << right << setw(2) << value.day << L"-" << monthNames[value.month] << L"-";
+			os << setfill(L'0') << setw(2) << value.year;
+		} else {
+			os << L"---------";
+		}
+		return os;
+	}
+
+	VolumeEntry::VolumeEntry(std::wstring name, FileKind kind, int firstBlock, int nextBlock, int lastByte, PascalDate modified) :
+		name{ name }, kind{ kind }, firstBlock{ firstBlock }, nextBlock{ nextBlock }, lastByte{ lastByte }, modified{ modified }
+	{
+	}
+
+	struct Volume::Header {
+		little_int16_t firstBlock;
+		little_int16_t nextBlock;
+		little_int16_t fileKind;
+		char volumeName[8];
+		little_int16_t volumeBlocks;
+		little_int16_t fileCount;
+		little_int16_t loadTime;
+		little_uint16_t lastBoot;
+		char reserved[4];
+	};
+
+	struct Volume::Entry {
+		little_int16_t firstBlock;
+		little_int16_t nextBlock;
+		little_uint16_t fileKind;
+		char title[16];
+		little_int16_t lastByte;
+		little_uint16_t modified;
+	};
+
+	bool Volume::treatAsVolume = false;
+
+	/* Check the invariants of the volume header. This is enough to reject code files and
+	   images of other file systems. */
+	bool Volume::isVolume(BlockDevice const & device) {
+		static_assert(sizeof(Header) == 26 && sizeof(Entry) == 26, "Directory entries are 26 bytes");
+		if (device.getBlockCount() < DIRECTORY_BLOCK + 4) {
+			return false;
+		}
+		auto directory = device.blocks(DIRECTORY_BLOCK, 4);
+		if (directory.end() - directory.begin() < static_cast<ptrdiff_t>(4 * BLOCK_SIZE)) {
+			return false;
+		}
+		auto & header = place<Header>(directory.begin());
+		auto nameLength = static_cast<uint8_t>(header.volumeName[0]);
+		return header.firstBlock == 0 && header.nextBlock == DIRECTORY_BLOCK + 4 && (header.fileKind & 0xf) == 0
+			&& 0 < nameLength && nameLength <= 7
+			&& header.volumeBlocks >= DIRECTORY_BLOCK + 4
+			&& 0 <= header.fileCount && header.fileCount <= MAX_FILES;
+	}
+
+	namespace {
+
+		BlockDevice const & checkVolume(BlockDevice const & device) {
+			if (!Volume::isVolume(device)) {
+				throw runtime_error("Not an Apple Pascal volume");
+			}
+			return device;
+		}
+
+	}
+
+	Volume::Volume(BlockDevice const & device) :
+		device{ checkVolume(device) },
+		header{ place<Header>(device.blocks(DIRECTORY_BLOCK, 4).begin()) },
+		name{ readName(header.volumeName, 7) },
+		totalBlocks{ header.volumeBlocks },
+		entries{ extractEntries() }
+	{
+	}
+
+	/* Read the file entries. Entries that don't describe a plausible run of blocks are
+	   skipped rather than trusted. */
+	vector<VolumeEntry> Volume::extractEntries() const {
+		vector<VolumeEntry> result;
+		auto directory = reinterpret_cast<Entry const *>(&header + 1);
+		for (int index = 0; index != header.fileCount; ++index) {
+			auto & entry = directory[index];
+			if (entry.firstBlock < header.nextBlock || entry.nextBlock <= entry.firstBlock || entry.nextBlock > totalBlocks) {
+				continue;
+			}
+			result.emplace_back(
+				readName(entry.title, 15),
+				static_cast<FileKind>(entry.fileKind & 0xf),
+				entry.firstBlock, entry.nextBlock, entry.lastByte,
+				PascalDate{ entry.modified });
+		}
+		return result;
+	}
+
+	/* The bytes of a file, as a range of blocks of the device. All the blocks of the file are
+	   included, even if the last block is only partly used. */
+	Range<uint8_t const> Volume::fileData(VolumeEntry const & entry) const {
+		if (entry.getNextBlock() > device.getBlockCount()) {
+			throw runtime_error("File extends past the end of the volume image");
+		}
+		return device.blocks(entry.getFirstBlock(), entry.getBlocks());
+	}
+
+	std::wostream& operator<<(std::wostream& os, const Volume& volume) {
+		FmtSentry<wostream::char_type> sentry{ os };
+		os << L"Volume " << volume.name << L": " << dec << volume.totalBlocks << L" blocks, ";
+		os << volume.entries.size() << L" files, last boot " << PascalDate{ volume.header.lastBoot } << endl;
+		for (auto & entry : volume.entries) {
+			os << L"  " << setfill(L' ') << left << setw(16) << entry.getName();
+			os << setw(10) << entry.getKind();
+			os << right << setw(5) << entry.getBlocks() << L" blocks at " << left << setw(5) << entry.getFirstBlock();
+			os << L" " << entry.getModified() << endl;
+		}
+		return os;
+	}
+
+}
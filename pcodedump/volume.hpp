@@ -0,0 +1,123 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _0D3001C0_CE3F_420B_BE41_9CD4D49A32B9
+#define _0D3001C0_CE3F_420B_BE41_9CD4D49A32B9
+
+#include "types.hpp"
+#include "blockdevice.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/endian/arithmetic.hpp>
+
+namespace pcodedump {
+
+	enum class FileKind {
+		untyped,
+		badBlocks,
+		code,
+		text,
+		info,
+		data,
+		graf,
+		foto,
+		secureDir,
+	};
+
+	std::wostream& operator<<(std::wostream& os, const FileKind& value);
+
+	/* An Apple Pascal directory date. A month of zero means that no date was recorded. */
+	class PascalDate {
+	public:
+		explicit PascalDate(std::uint16_t value);
+
+		bool valid() const {
+			return month != 0;
+		}
+
+	private:
+		friend std::wostream& operator<<(std::wostream&, const PascalDate&);
+		int year;
+		int month;
+		int day;
+	};
+
+	std::wostream& operator<<(std::wostream& os, const PascalDate& value);
+
+	class VolumeEntry {
+	public:
+		VolumeEntry(std::wstring name, FileKind kind, int firstBlock, int nextBlock, int lastByte, PascalDate modified);
+
+		std::wstring const & getName() const { return name; }
+		FileKind getKind() const { return kind; }
+		int getFirstBlock() const { return firstBlock; }
+		int getNextBlock() const { return nextBlock; }
+		int getBlocks() const { return nextBlock - firstBlock; }
+		int getLastByte() const { return lastByte; }
+		PascalDate getModified() const { return modified; }
+
+	private:
+		std::wstring name;
+		FileKind kind;
+		int firstBlock;
+		int nextBlock;
+		int lastByte;
+		PascalDate modified;
+	};
+
+	/* An Apple Pascal volume. The directory occupies blocks 2 to 5 and starts with a volume
+	   header entry followed by up to 77 file entries, sorted by starting block. Files are
+	   contiguous runs of blocks, so the contents of each file are a range of blocks of the device. */
+	class Volume {
+		friend std::wostream& operator<<(std::wostream&, const Volume&);
+
+	public:
+		static constexpr int DIRECTORY_BLOCK = 2;
+		static constexpr int MAX_FILES = 77;
+
+		explicit Volume(BlockDevice const & device);
+
+		std::wstring const & getName() const { return name; }
+		std::vector<VolumeEntry> const & getEntries() const { return entries; }
+		Range<std::uint8_t const> fileData(VolumeEntry const & entry) const;
+
+		static bool isVolume(BlockDevice const & device);
+
+	private:
+		struct Header;
+		struct Entry;
+
+		std::vector<VolumeEntry> extractEntries() const;
+
+	private:
+		BlockDevice const & device;
+		Header const & header;
+		std::wstring name;
+		int totalBlocks;
+		std::vector<VolumeEntry> entries;
+
+	public:
+		static bool treatAsVolume;
+	};
+
+	std::wostream& operator<<(std::wostream& os, const Volume& value);
+
+}
+
+#endif // !_0D3001C0_CE3F_420B_BE41_9CD4D49A32B9
@@ -0,0 +1,218 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "xref.hpp"
+#include "pcodefile.hpp"
+#include "segment.hpp"
+#include "basecode.hpp"
+#include "pcode.hpp"
+#include "textio.hpp"
+
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <iomanip>
+
+using namespace std;
+
+namespace pcodedump {
+
+	namespace {
+
+		constexpr uint8_t LDE = 157;
+		constexpr uint8_t LAO = 165;
+		constexpr uint8_t LAE = 167;
+		constexpr uint8_t LDO = 169;
+		constexpr uint8_t SRO = 171;
+		constexpr uint8_t LDA = 178;
+		constexpr uint8_t LOD = 182;
+		constexpr uint8_t STR = 184;
+		constexpr uint8_t STE = 209;
+		constexpr uint8_t SLDO_1 = 232;
+		constexpr uint8_t SLDO_16 = 247;
+
+		auto variableKey(VariableReference const & reference) {
+			return make_tuple(reference.scope, reference.segment, reference.procedure, reference.offset);
+		}
+
+		auto userKey(VariableReference const & reference) {
+			return make_tuple(reference.userSegment, reference.userProcedure, reference.userOffset, reference.access);
+		}
+
+		bool variableOrder(VariableReference const & left, VariableReference const & right) {
+			return variableKey(left) < variableKey(right);
+		}
+
+		bool referenceOrder(VariableReference const & left, VariableReference const & right) {
+			return tuple_cat(variableKey(left), userKey(left)) < tuple_cat(variableKey(right), userKey(right));
+		}
+
+		struct Nesting {
+			int level;
+			int parent;
+		};
+
+		void addNesting(map<int, Nesting> & result, ScopeNode const & node, int parent) {
+			auto & procedure = node.getProcedure();
+			if (procedure.getLexicalLevel()) {
+				result[procedure.getProcedureNumber()] = { *procedure.getLexicalLevel(), parent };
+				for (auto & child : node.getChildren()) {
+					addNesting(result, *child, procedure.getProcedureNumber());
+				}
+			}
+		}
+
+		/* The lexical level and enclosing procedure of each p-code procedure, taken from the
+		   segment's procedure tree. A parent of 0 is outside the segment. */
+		map<int, Nesting> procedureNesting(CodePart const & codePart) {
+			map<int, Nesting> result;
+			if (codePart.getTree()) {
+				addNesting(result, *codePart.getTree(), 0);
+			}
+			for (auto & procedure : *codePart.getProcedures()) {
+				if (procedure->getLexicalLevel() && result.count(procedure->getProcedureNumber()) == 0) {
+					result[procedure->getProcedureNumber()] = { *procedure->getLexicalLevel(), 0 };
+				}
+			}
+			return result;
+		}
+
+		/* The procedure that declares an intermediate variable, a number of lexical levels out
+		   from the procedure that uses it. */
+		int declaringProcedure(map<int, Nesting> const & nesting, int procedure, int levels) {
+			int level = nesting.at(procedure).level - levels;
+			while (procedure != 0 && nesting.at(procedure).level > level) {
+				procedure = nesting.at(procedure).parent;
+			}
+			return procedure != 0 && nesting.at(procedure).level == level ? procedure : 0;
+		}
+
+		wchar_t const * accessNames[] = {
+			L"read",
+			L"write",
+			L"address",
+		};
+
+	}
+
+	bool VariableXref::showXref = false;
+	std::optional<int> VariableXref::offset;
+
+	VariableXref::VariableXref(PcodeFile const & file) {
+		for (auto & segment : file.getSegments()) {
+			auto codeSegment = dynamic_cast<CodeSegment const *>(segment.get());
+			auto codePart = codeSegment ? codeSegment->getCodePart() : nullptr;
+			if (codePart && codePart->getProcedures()) {
+				auto nesting = procedureNesting(*codePart);
+				auto userSegment = static_cast<uint8_t>(codeSegment->getSegmentNumber());
+				for (auto & procedure : *codePart->getProcedures()) {
+					auto pcodeProcedure = dynamic_cast<PcodeProcedure const *>(procedure.get());
+					if (pcodeProcedure) {
+						auto userProcedure = static_cast<uint8_t>(procedure->getProcedureNumber());
+						for (auto & instruction : pcodeProcedure->getFlowGraph().getInstructions()) {
+							auto add = [&](VariableScope scope, int segment, int owner, int offset, VariableAccess access) {
+								references.push_back({ scope, static_cast<uint8_t>(segment), static_cast<uint8_t>(owner), static_cast<uint16_t>(offset),
+									userSegment, userProcedure, instruction.offset, access });
+							};
+							auto intermediate = [&](VariableAccess access) {
+								add(VariableScope::intermediate, userSegment, declaringProcedure(nesting, userProcedure, instruction.operand1), instruction.operand2, access);
+							};
+							switch (instruction.opcode) {
+							case LDO:
+								add(VariableScope::global, 0, 0, instruction.operand1, VariableAccess::read);
+								break;
+							case SRO:
+								add(VariableScope::global, 0, 0, instruction.operand1, VariableAccess::write);
+								break;
+							case LAO:
+								add(VariableScope::global, 0, 0, instruction.operand1, VariableAccess::address);
+								break;
+							case LOD:
+								intermediate(VariableAccess::read);
+								break;
+							case STR:
+								intermediate(VariableAccess::write);
+								break;
+							case LDA:
+								intermediate(VariableAccess::address);
+								break;
+							case LDE:
+								add(VariableScope::external, instruction.operand1, 0, instruction.operand2, VariableAccess::read);
+								break;
+							case STE:
+								add(VariableScope::external, instruction.operand1, 0, instruction.operand2, VariableAccess::write);
+								break;
+							case LAE:
+								add(VariableScope::external, instruction.operand1, 0, instruction.operand2, VariableAccess::address);
+								break;
+							default:
+								if (SLDO_1 <= instruction.opcode && instruction.opcode <= SLDO_16) {
+									add(VariableScope::global, 0, 0, instruction.opcode - SLDO_1 + 1, VariableAccess::read);
+								}
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+		sort(references.begin(), references.end(), referenceOrder);
+	}
+
+	/* The references to one variable, in user order. */
+	Range<VariableReference const> VariableXref::users(VariableScope scope, int segment, int procedure, int offset) const {
+		VariableReference key{ scope, static_cast<uint8_t>(segment), static_cast<uint8_t>(procedure), static_cast<uint16_t>(offset), 0, 0, 0, VariableAccess::read };
+		auto [first, last] = equal_range(references.begin(), references.end(), key, variableOrder);
+		return Range<VariableReference const>{ references.data() + (first - references.begin()), references.data() + (last - references.begin()) };
+	}
+
+	/* Users are written as segment.procedure:offset, the offset being that of the instruction. */
+	void VariableXref::write(std::wostream & os) const {
+		FmtSentry<wostream::char_type> sentry{ os };
+		os << L"Variable cross-reference" << endl;
+		for (auto first = references.begin(); first != references.end();) {
+			auto last = find_if(first, references.end(), [&](VariableReference const & reference) { return !reference.sameVariable(*first); });
+			if (!offset || first->offset == *offset) {
+				os << dec;
+				switch (first->scope) {
+				case VariableScope::global:
+					os << L"  Global offset " << first->offset << endl;
+					break;
+				case VariableScope::intermediate:
+					os << L"  Intermediate " << static_cast<int>(first->segment) << L".";
+					if (first->procedure) {
+						os << static_cast<int>(first->procedure);
+					} else {
+						os << L"?";
+					}
+					os << L" offset " << first->offset << endl;
+					break;
+				case VariableScope::external:
+					os << L"  External segment " << static_cast<int>(first->segment) << L" offset " << first->offset << endl;
+					break;
+				}
+				for (auto reference = first; reference != last; ++reference) {
+					os << L"      " << setfill(L' ') << left << setw(8) << accessNames[static_cast<int>(reference->access)];
+					os << dec << static_cast<int>(reference->userSegment) << L"." << static_cast<int>(reference->userProcedure) << L":";
+					os << hex << setfill(L'0') << right << setw(4) << reference->userOffset << endl;
+				}
+			}
+			first = last;
+		}
+		os << endl;
+	}
+
+}
@@ -0,0 +1,88 @@
+/*
+   Copyright 2017-2024 Craig McGeachie
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+	   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _7071BC08_4163_4A5A_B72D_8DE8984E6183
+#define _7071BC08_4163_4A5A_B72D_8DE8984E6183
+
+#include "types.hpp"
+
+#include <iostream>
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+namespace pcodedump {
+
+	class PcodeFile;
+
+	enum class VariableScope : std::uint8_t {
+		global,
+		intermediate,
+		external,
+	};
+
+	enum class VariableAccess : std::uint8_t {
+		read,
+		write,
+		address,
+	};
+
+	/* One use of a variable by an instruction. A variable is identified by its scope, its owner
+	   and its offset. Global variables have no owner. Intermediate variables are owned by the
+	   enclosing procedure that declares them, in the segment of the instruction. An owner of 0
+	   is a procedure that isn't in the segment. External variables are owned by a data segment,
+	   and have a procedure of 0. */
+	struct VariableReference {
+		VariableScope scope;
+		std::uint8_t segment;
+		std::uint8_t procedure;
+		std::uint16_t offset;
+		std::uint8_t userSegment;
+		std::uint8_t userProcedure;
+		std::uint16_t userOffset;
+		VariableAccess access;
+
+		bool sameVariable(VariableReference const & other) const {
+			return scope == other.scope && segment == other.segment && procedure == other.procedure && offset == other.offset;
+		}
+	};
+
+	/* Every read, write and address taken of global, intermediate and external variables by the
+	   p-code procedures of a code file. References are collected in one pass over the decoded
+	   instructions, and kept in one array sorted by variable and then by user. */
+	class VariableXref {
+	public:
+		explicit VariableXref(PcodeFile const & file);
+
+		std::vector<VariableReference> const & getReferences() const {
+			return references;
+		}
+
+		Range<VariableReference const> users(VariableScope scope, int segment, int procedure, int offset) const;
+
+		void write(std::wostream & os) const;
+
+	private:
+		std::vector<VariableReference> references;
+
+	public:
+		static bool showXref;
+		static std::optional<int> offset;
+	};
+
+}
+
+#endif // !_7071BC08_4163_4A5A_B72D_8DE8984E6183